@@ -3,6 +3,7 @@
 const common = require('../common.js');
 
 const bench = common.createBenchmark(main, {
+  op: ['decode', 'encode'],
   len: [0, 1, 64, 1024],
   n: [1e7]
 });
@@ -17,6 +18,16 @@ function main(conf) {
 
   const hex = buf.toString('hex');
 
+  if (conf.op === 'encode') {
+    bench.start();
+
+    for (let i = 0; i < n; i += 1)
+      buf.toString('hex');
+
+    bench.end(n);
+    return;
+  }
+
   bench.start();
 
   for (let i = 0; i < n; i += 1)
@@ -0,0 +1,40 @@
+'use strict';
+const common = require('../common.js');
+const fs = require('fs');
+const path = require('path');
+
+const bench = common.createBenchmark(main, {
+  method: ['indexOf', 'searcher'],
+  needle: ['\r\n--boundary',
+           '\r\n--------------------------1234567890abcdefghijklmnop'],
+  len: [64, 1024, 65536],
+  n: [1e5]
+});
+
+// A part of a multipart body, the boundary follows its content.
+function makeHaystack(needle, len) {
+  const file = path.resolve(__dirname, '../fixtures/alice.html');
+  const text = fs.readFileSync(file);
+  const content = Buffer.alloc(len, text);
+  return Buffer.concat([content, Buffer.from(needle)]);
+}
+
+function main(conf) {
+  const n = conf.n | 0;
+  const needle = conf.needle;
+  const haystack = makeHaystack(needle, conf.len | 0);
+  var i;
+
+  if (conf.method === 'indexOf') {
+    bench.start();
+    for (i = 0; i < n; i += 1)
+      haystack.indexOf(needle);
+    bench.end(n);
+  } else {
+    const searcher = Buffer.createSearcher(needle);
+    bench.start();
+    for (i = 0; i < n; i += 1)
+      searcher.indexOf(haystack);
+    bench.end(n);
+  }
+}
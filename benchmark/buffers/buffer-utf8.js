@@ -0,0 +1,44 @@
+'use strict';
+
+const common = require('../common.js');
+
+const bench = common.createBenchmark(main, {
+  op: ['toString', 'write'],
+  type: ['ascii', 'mixed', 'latin1', 'cjk'],
+  len: [64, 1024, 65536],
+  n: [1e5]
+});
+
+// Text made of |len| characters, all ASCII or one in 32 of them a Latin-1
+// or a CJK character.
+function makeString(type, len) {
+  const other = { mixed: 'é', latin1: 'é', cjk: '中' }[type];
+  let s = '';
+  for (let i = 0; i < len; i++) {
+    if (type === 'latin1' || (other !== undefined && i % 32 === 31))
+      s += i % 2 ? other : 'a';
+    else
+      s += String.fromCharCode(32 + i % 95);
+  }
+  return s;
+}
+
+function main(conf) {
+  const len = conf.len | 0;
+  const n = conf.n | 0;
+  const str = makeString(conf.type, len);
+  const buf = Buffer.from(str);
+  var i;
+
+  if (conf.op === 'toString') {
+    bench.start();
+    for (i = 0; i < n; i += 1)
+      buf.toString('utf8');
+    bench.end(n);
+  } else {
+    bench.start();
+    for (i = 0; i < n; i += 1)
+      buf.write(str);
+    bench.end(n);
+  }
+}
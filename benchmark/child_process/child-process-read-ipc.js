@@ -9,6 +9,7 @@ if (process.argv[2] === 'child') {
   const common = require('../common.js');
   const bench = common.createBenchmark(main, {
     len: [64, 256, 1024, 4096, 32768],
+    serialization: ['json', 'advanced'],
     dur: [5]
   });
   const spawn = require('child_process').spawn;
@@ -18,7 +19,8 @@ if (process.argv[2] === 'child') {
     const dur = +conf.dur;
     const len = +conf.len;
 
-    const options = { 'stdio': ['ignore', 'ignore', 'ignore', 'ipc'] };
+    const options = { 'stdio': ['ignore', 'ignore', 'ignore', 'ipc'],
+                      serialization: conf.serialization };
     const child = spawn(process.argv[0],
       [process.argv[1], 'child', len], options);
 
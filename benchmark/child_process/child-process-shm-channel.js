@@ -0,0 +1,54 @@
+'use strict';
+if (process.argv[2] === 'child') {
+  const len = +process.argv[3];
+  const msg = '.'.repeat(len);
+  const channel = process.sharedMemoryChannel;
+  if (channel) {
+    const send = () => {
+      while (channel.postMessage(msg));
+    };
+    channel.on('drain', send);
+    send();
+  } else {
+    // The IPC channel has no 'drain' event, poll for the backlog instead.
+    const send = () => {
+      while (process.send(msg));
+      setImmediate(send);
+    };
+    send();
+  }
+} else {
+  const common = require('../common.js');
+  const bench = common.createBenchmark(main, {
+    len: [64, 256, 1024, 4096, 32768],
+    channel: ['ipc', 'shm'],
+    dur: [5]
+  });
+  const fork = require('child_process').fork;
+  function main(conf) {
+    bench.start();
+
+    const dur = +conf.dur;
+    const len = +conf.len;
+
+    const options = { stdio: ['ignore', 'ignore', 'ignore', 'ipc'],
+                      serialization: 'advanced',
+                      sharedMemoryChannel: conf.channel === 'shm' };
+    const child = fork(process.argv[1], ['child', len], options);
+
+    var bytes = 0;
+    function onMessage(msg) {
+      bytes += msg.length;
+    }
+    if (conf.channel === 'shm')
+      child.sharedMemoryChannel.on('message', onMessage);
+    else
+      child.on('message', onMessage);
+
+    setTimeout(function() {
+      child.kill();
+      const gbits = (bytes * 8) / (1024 * 1024 * 1024);
+      bench.end(gbits);
+    }, dur * 1000);
+  }
+}
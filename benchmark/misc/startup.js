@@ -4,7 +4,10 @@ var spawn = require('child_process').spawn;
 var path = require('path');
 var emptyJsFile = path.resolve(__dirname, '../../test/fixtures/semicolon.js');
 
+// 'empty' measures the bootstrap alone, 'builtins' additionally loads every
+// public core module, which is where an embedded code cache pays off.
 var bench = common.createBenchmark(startNode, {
+  script: ['empty', 'builtins'],
   dur: [1]
 });
 
@@ -12,6 +15,12 @@ function startNode(conf) {
   var dur = +conf.dur;
   var go = true;
   var starts = 0;
+  var args = [emptyJsFile];
+
+  if (conf.script === 'builtins') {
+    var builtins = require('repl')._builtinLibs;
+    args = ['-e', JSON.stringify(builtins) + '.forEach(require)'];
+  }
 
   setTimeout(function() {
     go = false;
@@ -21,7 +30,7 @@ function startNode(conf) {
   start();
 
   function start() {
-    var node = spawn(process.execPath || process.argv[0], [emptyJsFile]);
+    var node = spawn(process.execPath || process.argv[0], args);
     node.on('exit', function(exitCode) {
       if (exitCode !== 0) {
         throw new Error('Error during node startup');
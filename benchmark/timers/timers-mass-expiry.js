@@ -0,0 +1,38 @@
+'use strict';
+var common = require('../common.js');
+var timers = require('timers');
+
+// Many timers of the same duration that expire at once, like the request
+// timeouts after a stall. The loop is blocked until all of them are due, then
+// the time until the last callback has run is measured.
+var bench = common.createBenchmark(main, {
+  type: ['timeout', 'unref'],
+  thousands: [10, 100],
+});
+
+function main(conf) {
+  var N = +conf.thousands * 1e3;
+  var n = 0;
+
+  function cb() {
+    if (++n === N)
+      bench.end(N / 1e3);
+  }
+
+  if (conf.type === 'timeout') {
+    for (var i = 0; i < N; i++)
+      setTimeout(cb, 50);
+  } else {
+    for (i = 0; i < N; i++) {
+      var timer = { _onTimeout: cb };
+      timers.enroll(timer, 50);
+      timers._unrefActive(timer);
+    }
+    // The wheel does not keep the process open.
+    setTimeout(function() {}, 1000);
+  }
+
+  var end = Date.now() + 100;
+  while (Date.now() < end);
+  bench.start();
+}
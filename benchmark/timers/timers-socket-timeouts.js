@@ -0,0 +1,35 @@
+'use strict';
+var common = require('../common.js');
+var timers = require('timers');
+
+// Idle timeouts of many sockets that are pushed back on every bit of I/O,
+// the way net.Socket does it, without any of them expiring.
+var bench = common.createBenchmark(main, {
+  sockets: [1e3, 1e5, 2e5],
+  millions: [2],
+});
+
+function main(conf) {
+  var sockets = +conf.sockets;
+  var N = +conf.millions * 1e6;
+  var list = [];
+  for (var i = 0; i < sockets; i++) {
+    var socket = { _onTimeout: onTimeout };
+    // Spread them over a few common timeouts.
+    timers.enroll(socket, 120000 + (i % 4) * 1000);
+    timers._unrefActive(socket);
+    list.push(socket);
+  }
+
+  bench.start();
+  for (i = 0; i < N; i++)
+    timers._unrefActive(list[i % sockets]);
+  bench.end(N / 1e6);
+
+  for (i = 0; i < sockets; i++)
+    timers.unenroll(list[i]);
+}
+
+function onTimeout() {
+  throw new Error('should not time out');
+}
@@ -233,9 +233,30 @@ typedef struct uv_dirent_s uv_dirent_t;
 typedef struct uv_passwd_s uv_passwd_t;
 
 typedef enum {
-  UV_LOOP_BLOCK_SIGNAL
+  UV_LOOP_BLOCK_SIGNAL,
+  UV_LOOP_METRICS
 } uv_loop_option;
 
+/*
+ * Phases of an iteration of uv_run().  The time spent in each of them is
+ * reported by uv_loop_get_metrics().
+ */
+typedef enum {
+  UV_PHASE_TIMERS,
+  UV_PHASE_PENDING,
+  UV_PHASE_PREPARE,  /* Idle and prepare handles. */
+  UV_PHASE_POLL,     /* I/O callbacks, without the time spent waiting. */
+  UV_PHASE_CHECK,
+  UV_PHASE_CLOSING,
+  UV_PHASE_MAX
+} uv_loop_phase_t;
+
+typedef struct {
+  uint64_t iterations;
+  uint64_t idle_time;                 /* In nanoseconds, waiting for I/O. */
+  uint64_t phase_time[UV_PHASE_MAX];  /* In nanoseconds. */
+} uv_loop_metrics_t;
+
 typedef enum {
   UV_RUN_DEFAULT = 0,
   UV_RUN_ONCE,
@@ -274,6 +295,8 @@ UV_EXTERN void uv_loop_delete(uv_loop_t*);
 UV_EXTERN size_t uv_loop_size(void);
 UV_EXTERN int uv_loop_alive(const uv_loop_t* loop);
 UV_EXTERN int uv_loop_configure(uv_loop_t* loop, uv_loop_option option, ...);
+UV_EXTERN int uv_loop_get_metrics(const uv_loop_t* loop,
+                                  uv_loop_metrics_t* metrics);
 
 UV_EXTERN int uv_run(uv_loop_t*, uv_run_mode mode);
 UV_EXTERN void uv_stop(uv_loop_t*);
@@ -970,10 +993,60 @@ struct uv_work_s {
   UV_WORK_PRIVATE_FIELDS
 };
 
+/*
+ * Classes of thread pool work.  Each class has its own queue and a limit on
+ * how many of its requests can run at the same time.
+ */
+typedef enum {
+  UV_WORK_FS,     /* File system requests. */
+  UV_WORK_DNS,    /* uv_getaddrinfo() and uv_getnameinfo(). */
+  UV_WORK_CPU,    /* CPU-bound work such as hashing or compression. */
+  UV_WORK_USER,   /* uv_queue_work() */
+  UV_WORK_CLASS_MAX
+} uv_work_class_t;
+
+/*
+ * Number of buckets in the wait and run time histograms.  Bucket 0 counts
+ * requests that took less than 1 microsecond, bucket n requests that took
+ * between 2^(n-1) and 2^n microseconds.  The last bucket also counts
+ * everything slower than that.
+ */
+#define UV_THREADPOOL_HISTOGRAM_SIZE 24
+
+typedef struct {
+  unsigned int limit;
+  unsigned int queued;
+  unsigned int running;
+  uint64_t completed;
+  uint64_t wait_time;  /* In nanoseconds, summed over started requests. */
+  uint64_t run_time;   /* In nanoseconds, summed over completed requests. */
+  uint64_t wait_histogram[UV_THREADPOOL_HISTOGRAM_SIZE];
+  uint64_t run_histogram[UV_THREADPOOL_HISTOGRAM_SIZE];
+} uv_threadpool_stats_t;
+
+typedef struct {
+  unsigned int min_size;
+  unsigned int max_size;
+  unsigned int size;     /* Number of threads currently in the pool. */
+  unsigned int idle;     /* Number of threads waiting for work. */
+  unsigned int queued;   /* Number of requests waiting for a thread. */
+} uv_threadpool_info_t;
+
 UV_EXTERN int uv_queue_work(uv_loop_t* loop,
                             uv_work_t* req,
                             uv_work_cb work_cb,
                             uv_after_work_cb after_work_cb);
+UV_EXTERN int uv_queue_work_class(uv_loop_t* loop,
+                                  uv_work_t* req,
+                                  uv_work_class_t cls,
+                                  uv_work_cb work_cb,
+                                  uv_after_work_cb after_work_cb);
+UV_EXTERN int uv_threadpool_set_limit(uv_work_class_t cls, unsigned int limit);
+UV_EXTERN int uv_threadpool_get_stats(uv_work_class_t cls,
+                                      uv_threadpool_stats_t* stats);
+UV_EXTERN int uv_threadpool_set_size(unsigned int min_size,
+                                     unsigned int max_size);
+UV_EXTERN int uv_threadpool_get_info(uv_threadpool_info_t* info);
 
 UV_EXTERN int uv_cancel(uv_req_t* req);
 
@@ -1442,6 +1515,24 @@ UV_EXTERN void uv_key_set(uv_key_t* key, void* value);
 typedef void (*uv_thread_cb)(void* arg);
 
 UV_EXTERN int uv_thread_create(uv_thread_t* tid, uv_thread_cb entry, void* arg);
+
+typedef enum {
+  UV_THREAD_NO_FLAGS = 0x00,
+  UV_THREAD_HAS_STACK_SIZE = 0x01
+} uv_thread_create_flags;
+
+struct uv_thread_options_s {
+  unsigned int flags;
+  size_t stack_size;
+  /* More fields may be added at any time. */
+};
+
+typedef struct uv_thread_options_s uv_thread_options_t;
+
+UV_EXTERN int uv_thread_create_ex(uv_thread_t* tid,
+                                  const uv_thread_options_t* params,
+                                  uv_thread_cb entry,
+                                  void* arg);
 UV_EXTERN uv_thread_t uv_thread_self(void);
 UV_EXTERN int uv_thread_join(uv_thread_t *tid);
 UV_EXTERN int uv_thread_equal(const uv_thread_t* t1, const uv_thread_t* t2);
@@ -1464,7 +1555,12 @@ struct uv_loop_s {
   /* Loop reference counting. */
   unsigned int active_handles;
   void* handle_queue[2];
-  void* active_reqs[2];
+  union {
+    void* unused;
+    unsigned int count;
+  } active_reqs;
+  /* Internal storage for future extensions. */
+  void* internal_fields;
   /* Internal flag to signal loop stop. */
   unsigned int stop_flag;
   UV_LOOP_PRIVATE_FIELDS
@@ -38,18 +38,72 @@ static void uv__req_init(uv_loop_t* loop,
 #endif
 
 #include <stdlib.h>
+#include <string.h>
 
 #define MAX_THREADPOOL_SIZE 128
 
+/* An idle thread above the minimum pool size exits after this long. */
+#define IDLE_TIMEOUT ((uint64_t) 5e9)
+
+/* The pool grows when the oldest runnable request has waited at least this
+ * long and no thread is idle.
+ */
+#define GROW_DELAY ((uint64_t) 1e6)
+
+/* Work is queued per class.  A class can have at most |limit| requests
+ * running at the same time, so that e.g. a burst of slow file system
+ * requests can't occupy every thread and hold up DNS lookups queued behind
+ * them.  When a thread becomes free it picks the oldest request of the
+ * highest priority class that is below its limit.
+ */
+struct uv__work_class {
+  QUEUE queue;
+  unsigned int limit;     /* 0 means "use the default". */
+  unsigned int queued;
+  unsigned int running;
+  uint64_t completed;
+  uint64_t wait_time;
+  uint64_t run_time;
+  uint64_t wait_histogram[UV_THREADPOOL_HISTOGRAM_SIZE];
+  uint64_t run_histogram[UV_THREADPOOL_HISTOGRAM_SIZE];
+};
+
+/* A queued request is linked into its class's queue through its reserved
+ * fields, which also hold its class.  The time it was queued is kept in the
+ * wq field of its uv__work, which is not used again before the request is
+ * done.  That keeps the public request structs the same size.
+ */
+#define REQ_QUEUE(req) ((QUEUE*) &(req)->reserved[0])
+#define REQ_CLASS(req) ((uv_work_class_t) (uintptr_t) (req)->reserved[2])
+
+/* From highest to lowest priority.  DNS lookups are short and gate every
+ * new outbound connection; file system requests are usually short too;
+ * CPU-bound and user work can run for a long time.
+ */
+static const uv_work_class_t priority_order[] = {
+  UV_WORK_DNS,
+  UV_WORK_FS,
+  UV_WORK_CPU,
+  UV_WORK_USER
+};
+
+enum {
+  THREAD_SLOT_FREE,
+  THREAD_SLOT_RUNNING,
+  THREAD_SLOT_EXITED   /* Thread returned but has not been joined yet. */
+};
+
 static uv_once_t once = UV_ONCE_INIT;
 static uv_cond_t cond;
 static uv_mutex_t mutex;
 static unsigned int idle_threads;
 static unsigned int nthreads;
-static uv_thread_t* threads;
-static uv_thread_t default_threads[4];
-static QUEUE exit_message;
-static QUEUE wq;
+static unsigned int min_threads;
+static unsigned int max_threads;
+static uv_thread_t threads[MAX_THREADPOOL_SIZE];
+static unsigned char thread_slots[MAX_THREADPOOL_SIZE];
+static struct uv__work_class classes[UV_WORK_CLASS_MAX];
+static int exiting;
 static volatile int initialized;
 
 
@@ -58,42 +112,208 @@ static void uv__cancelled(struct uv__work* w) {
 }
 
 
+static struct uv__work* uv__req_work(uv_req_t* req) {
+  switch (req->type) {
+  case UV_FS:
+    return &((uv_fs_t*) req)->work_req;
+  case UV_GETADDRINFO:
+    return &((uv_getaddrinfo_t*) req)->work_req;
+  case UV_GETNAMEINFO:
+    return &((uv_getnameinfo_t*) req)->work_req;
+  case UV_WORK:
+    return &((uv_work_t*) req)->work_req;
+  default:
+    return NULL;
+  }
+}
+
+
+static uint64_t uv__work_queue_time(const struct uv__work* w) {
+  uint64_t t;
+
+  memcpy(&t, w->wq, sizeof(t));
+  return t;
+}
+
+
+/* The default concurrency limit of each class, relative to the maximum pool
+ * size.  File system requests can block for a long time on network file
+ * systems, so they always leave one thread free for other work.  DNS lookups
+ * can stall for seconds when a name server is unresponsive and get at most
+ * half the threads.
+ */
+static unsigned int class_limit(uv_work_class_t cls) {
+  if (classes[cls].limit != 0)
+    return classes[cls].limit;
+
+  switch (cls) {
+  case UV_WORK_FS:
+    return max_threads > 1 ? max_threads - 1 : 1;
+  case UV_WORK_DNS:
+    return max_threads > 1 ? max_threads / 2 : 1;
+  default:
+    return max_threads;
+  }
+}
+
+
+static unsigned int histogram_bucket(uint64_t ns) {
+  uint64_t us;
+  unsigned int n;
+
+  us = ns / 1000;
+  for (n = 0; us != 0 && n < UV_THREADPOOL_HISTOGRAM_SIZE - 1; n++)
+    us >>= 1;
+
+  return n;
+}
+
+
+/* Must be called with |mutex| held. */
+static struct uv__work_class* next_runnable_class(void) {
+  struct uv__work_class* c;
+  unsigned int i;
+
+  for (i = 0; i < ARRAY_SIZE(priority_order); i++) {
+    c = &classes[priority_order[i]];
+    if (c->queued > 0 && c->running < class_limit(priority_order[i]))
+      return c;
+  }
+
+  return NULL;
+}
+
+
+static void worker(void* arg);
+
+
+/* Must be called with |mutex| held. */
+static int spawn_thread(void) {
+  unsigned int i;
+  int err;
+
+  for (i = 0; i < ARRAY_SIZE(thread_slots); i++)
+    if (thread_slots[i] != THREAD_SLOT_RUNNING)
+      break;
+
+  if (i == ARRAY_SIZE(thread_slots))
+    return UV_EAGAIN;
+
+  if (thread_slots[i] == THREAD_SLOT_EXITED)
+    if (uv_thread_join(threads + i))
+      abort();
+
+  thread_slots[i] = THREAD_SLOT_FREE;
+  err = uv_thread_create(threads + i, worker, (void*) (uintptr_t) i);
+  if (err)
+    return err;
+
+  thread_slots[i] = THREAD_SLOT_RUNNING;
+  nthreads += 1;
+  return 0;
+}
+
+
+/* Adds a thread when no thread is idle and runnable work has been waiting for
+ * at least GROW_DELAY.  Must be called with |mutex| held.
+ */
+static void maybe_grow(uint64_t now) {
+  struct uv__work_class* c;
+  uv_req_t* req;
+
+  if (exiting || idle_threads > 0 || nthreads >= max_threads)
+    return;
+
+  c = next_runnable_class();
+  if (c == NULL)
+    return;
+
+  req = QUEUE_DATA(QUEUE_HEAD(&c->queue), uv_req_t, reserved);
+  /* On failure, try again the next time the pool is under pressure. */
+  if (now - uv__work_queue_time(uv__req_work(req)) >= GROW_DELAY)
+    spawn_thread();
+}
+
+
 /* To avoid deadlock with uv_cancel() it's crucial that the worker
  * never holds the global mutex and the loop-local mutex at the same time.
  */
 static void worker(void* arg) {
+  struct uv__work_class* c;
   struct uv__work* w;
+  uv_req_t* req;
+  uint64_t start;
+  uint64_t wait_time;
+  uint64_t run_time;
+  unsigned int slot;
+  int timed_out;
   QUEUE* q;
 
-  (void) arg;
+  slot = (unsigned int) (uintptr_t) arg;
+  timed_out = 0;
 
   for (;;) {
     uv_mutex_lock(&mutex);
 
-    while (QUEUE_EMPTY(&wq)) {
+    for (;;) {
+      /* Leave when the pool is shutting down, when it has been shrunk below
+       * the current number of threads, or when this thread has been idle for
+       * IDLE_TIMEOUT and the pool is above its minimum size.
+       */
+      if (exiting || nthreads > max_threads)
+        goto out;
+
+      c = next_runnable_class();
+      if (c != NULL)
+        break;
+
+      if (timed_out && nthreads > min_threads)
+        goto out;
+
       idle_threads += 1;
-      uv_cond_wait(&cond, &mutex);
+      if (nthreads > min_threads)
+        timed_out = uv_cond_timedwait(&cond, &mutex, IDLE_TIMEOUT) != 0;
+      else {
+        uv_cond_wait(&cond, &mutex);
+        timed_out = 0;
+      }
       idle_threads -= 1;
     }
 
-    q = QUEUE_HEAD(&wq);
+    timed_out = 0;
 
-    if (q == &exit_message)
-      uv_cond_signal(&cond);
-    else {
-      QUEUE_REMOVE(q);
-      QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is
-                             executing. */
-    }
+    q = QUEUE_HEAD(&c->queue);
+    QUEUE_REMOVE(q);
+    QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is
+                       executing. */
+    c->queued -= 1;
+    c->running += 1;
 
-    uv_mutex_unlock(&mutex);
+    req = QUEUE_DATA(q, uv_req_t, reserved);
+    w = uv__req_work(req);
+    start = uv_hrtime();
+    wait_time = start - uv__work_queue_time(w);
+    c->wait_time += wait_time;
+    c->wait_histogram[histogram_bucket(wait_time)] += 1;
 
-    if (q == &exit_message)
-      break;
+    maybe_grow(start);
+
+    uv_mutex_unlock(&mutex);
 
-    w = QUEUE_DATA(q, struct uv__work, wq);
     w->work(w);
 
+    run_time = uv_hrtime() - start;
+
+    /* Account for the request before its completion is posted, so that the
+     * done callback sees it in uv_threadpool_get_stats().
+     */
+    uv_mutex_lock(&mutex);
+    c->running -= 1;
+    c->completed += 1;
+    c->run_time += run_time;
+    c->run_histogram[histogram_bucket(run_time)] += 1;
+    uv_mutex_unlock(&mutex);
+
     uv_mutex_lock(&w->loop->wq_mutex);
     w->work = NULL;  /* Signal uv_cancel() that the work req is done
                         executing. */
@@ -101,65 +321,90 @@ static void worker(void* arg) {
     uv_async_send(&w->loop->wq_async);
     uv_mutex_unlock(&w->loop->wq_mutex);
   }
+
+out:
+  nthreads -= 1;
+  thread_slots[slot] = THREAD_SLOT_EXITED;
+  /* A thread that leaves because the pool shrank may have been woken up by
+   * post() for work that is still queued.  Pass the wakeup on.
+   */
+  if (!exiting && next_runnable_class() != NULL)
+    uv_cond_signal(&cond);
+  uv_mutex_unlock(&mutex);
 }
 
 
-static void post(QUEUE* q) {
+static void post(uv_req_t* req, uv_work_class_t cls, uint64_t now) {
+  struct uv__work_class* c;
+
+  c = &classes[cls];
   uv_mutex_lock(&mutex);
-  QUEUE_INSERT_TAIL(&wq, q);
-  if (idle_threads > 0)
+  QUEUE_INSERT_TAIL(&c->queue, REQ_QUEUE(req));
+  c->queued += 1;
+  if (idle_threads > 0 && c->running < class_limit(cls))
     uv_cond_signal(&cond);
+  else
+    maybe_grow(now);
   uv_mutex_unlock(&mutex);
 }
 
 
 #ifndef _WIN32
 UV_DESTRUCTOR(static void cleanup(void)) {
+  unsigned char slots[MAX_THREADPOOL_SIZE];
   unsigned int i;
 
   if (initialized == 0)
     return;
 
-  post(&exit_message);
-
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_join(threads + i))
-      abort();
+  uv_mutex_lock(&mutex);
+  exiting = 1;
+  uv_cond_broadcast(&cond);
+  memcpy(slots, thread_slots, sizeof(slots));
+  uv_mutex_unlock(&mutex);
 
-  if (threads != default_threads)
-    uv__free(threads);
+  /* No threads are started once |exiting| is set. */
+  for (i = 0; i < ARRAY_SIZE(slots); i++)
+    if (slots[i] != THREAD_SLOT_FREE)
+      if (uv_thread_join(threads + i))
+        abort();
 
   uv_mutex_destroy(&mutex);
   uv_cond_destroy(&cond);
 
-  threads = NULL;
+  memset(thread_slots, 0, sizeof(thread_slots));
   nthreads = 0;
+  exiting = 0;
   initialized = 0;
 }
 #endif
 
 
+static unsigned int getenv_size(const char* name, unsigned int def) {
+  const char* val;
+  unsigned int size;
+
+  val = getenv(name);
+  if (val == NULL)
+    return def;
+
+  size = atoi(val);
+  if (size == 0)
+    size = 1;
+  if (size > MAX_THREADPOOL_SIZE)
+    size = MAX_THREADPOOL_SIZE;
+
+  return size;
+}
+
+
 static void init_once(void) {
   unsigned int i;
-  const char* val;
 
-  nthreads = ARRAY_SIZE(default_threads);
-  val = getenv("UV_THREADPOOL_SIZE");
-  if (val != NULL)
-    nthreads = atoi(val);
-  if (nthreads == 0)
-    nthreads = 1;
-  if (nthreads > MAX_THREADPOOL_SIZE)
-    nthreads = MAX_THREADPOOL_SIZE;
-
-  threads = default_threads;
-  if (nthreads > ARRAY_SIZE(default_threads)) {
-    threads = uv__malloc(nthreads * sizeof(threads[0]));
-    if (threads == NULL) {
-      nthreads = ARRAY_SIZE(default_threads);
-      threads = default_threads;
-    }
-  }
+  min_threads = getenv_size("UV_THREADPOOL_SIZE", 4);
+  max_threads = getenv_size("UV_THREADPOOL_MAX_SIZE", min_threads);
+  if (max_threads < min_threads)
+    max_threads = min_threads;
 
   if (uv_cond_init(&cond))
     abort();
@@ -167,25 +412,39 @@ static void init_once(void) {
   if (uv_mutex_init(&mutex))
     abort();
 
-  QUEUE_INIT(&wq);
+  for (i = 0; i < UV_WORK_CLASS_MAX; i++)
+    QUEUE_INIT(&classes[i].queue);
 
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_create(threads + i, worker, NULL))
-      abort();
+  uv_mutex_lock(&mutex);
+  for (i = 0; i < min_threads; i++)
+    if (spawn_thread())
+      break;
+  uv_mutex_unlock(&mutex);
+
+  if (nthreads == 0)
+    abort();
 
   initialized = 1;
 }
 
 
 void uv__work_submit(uv_loop_t* loop,
-                     struct uv__work* w,
+                     uv_req_t* req,
+                     uv_work_class_t cls,
                      void (*work)(struct uv__work* w),
                      void (*done)(struct uv__work* w, int status)) {
+  struct uv__work* w;
+  uint64_t now;
+
   uv_once(&once, init_once);
+  w = uv__req_work(req);
   w->loop = loop;
   w->work = work;
   w->done = done;
-  post(&w->wq);
+  now = uv_hrtime();
+  memcpy(w->wq, &now, sizeof(now));
+  req->reserved[2] = (void*) (uintptr_t) cls;
+  post(req, cls, now);
 }
 
 
@@ -195,9 +454,11 @@ static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
   uv_mutex_lock(&mutex);
   uv_mutex_lock(&w->loop->wq_mutex);
 
-  cancelled = !QUEUE_EMPTY(&w->wq) && w->work != NULL;
-  if (cancelled)
-    QUEUE_REMOVE(&w->wq);
+  cancelled = !QUEUE_EMPTY(REQ_QUEUE(req)) && w->work != NULL;
+  if (cancelled) {
+    QUEUE_REMOVE(REQ_QUEUE(req));
+    classes[REQ_CLASS(req)].queued -= 1;
+  }
 
   uv_mutex_unlock(&w->loop->wq_mutex);
   uv_mutex_unlock(&mutex);
@@ -215,6 +476,92 @@ static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
 }
 
 
+int uv_threadpool_set_limit(uv_work_class_t cls, unsigned int limit) {
+  if ((unsigned int) cls >= UV_WORK_CLASS_MAX || limit == 0)
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);
+  uv_mutex_lock(&mutex);
+  classes[cls].limit = limit;
+  /* Requests that were held back by the old limit may be runnable now. */
+  if (idle_threads > 0)
+    uv_cond_broadcast(&cond);
+  uv_mutex_unlock(&mutex);
+
+  return 0;
+}
+
+
+int uv_threadpool_get_stats(uv_work_class_t cls,
+                            uv_threadpool_stats_t* stats) {
+  struct uv__work_class* c;
+
+  if ((unsigned int) cls >= UV_WORK_CLASS_MAX || stats == NULL)
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);
+  c = &classes[cls];
+  uv_mutex_lock(&mutex);
+  stats->limit = class_limit(cls);
+  stats->queued = c->queued;
+  stats->running = c->running;
+  stats->completed = c->completed;
+  stats->wait_time = c->wait_time;
+  stats->run_time = c->run_time;
+  memcpy(stats->wait_histogram,
+         c->wait_histogram,
+         sizeof(stats->wait_histogram));
+  memcpy(stats->run_histogram, c->run_histogram, sizeof(stats->run_histogram));
+  uv_mutex_unlock(&mutex);
+
+  return 0;
+}
+
+
+int uv_threadpool_set_size(unsigned int min_size, unsigned int max_size) {
+  if (min_size == 0 || max_size < min_size || max_size > MAX_THREADPOOL_SIZE)
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);
+  uv_mutex_lock(&mutex);
+  min_threads = min_size;
+  max_threads = max_size;
+
+  while (nthreads < min_threads)
+    if (spawn_thread())
+      break;
+
+  /* Wake up idle threads so that surplus ones exit, and so that requests
+   * held back by a default class limit can run if the limit went up.
+   */
+  uv_cond_broadcast(&cond);
+  uv_mutex_unlock(&mutex);
+
+  return 0;
+}
+
+
+int uv_threadpool_get_info(uv_threadpool_info_t* info) {
+  unsigned int i;
+
+  if (info == NULL)
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);
+  uv_mutex_lock(&mutex);
+  info->min_size = min_threads;
+  info->max_size = max_threads;
+  info->size = nthreads;
+  info->idle = idle_threads;
+  info->queued = 0;
+  for (i = 0; i < UV_WORK_CLASS_MAX; i++)
+    info->queued += classes[i].queued;
+  uv_mutex_unlock(&mutex);
+
+  return 0;
+}
+
+
 void uv__work_done(uv_async_t* handle) {
   struct uv__work* w;
   uv_loop_t* loop;
@@ -262,42 +609,50 @@ int uv_queue_work(uv_loop_t* loop,
                   uv_work_t* req,
                   uv_work_cb work_cb,
                   uv_after_work_cb after_work_cb) {
-  if (work_cb == NULL)
+  return uv_queue_work_class(loop, req, UV_WORK_USER, work_cb, after_work_cb);
+}
+
+
+int uv_queue_work_class(uv_loop_t* loop,
+                        uv_work_t* req,
+                        uv_work_class_t cls,
+                        uv_work_cb work_cb,
+                        uv_after_work_cb after_work_cb) {
+  if (work_cb == NULL || (unsigned int) cls >= UV_WORK_CLASS_MAX)
     return UV_EINVAL;
 
   uv__req_init(loop, req, UV_WORK);
   req->loop = loop;
   req->work_cb = work_cb;
   req->after_work_cb = after_work_cb;
-  uv__work_submit(loop, &req->work_req, uv__queue_work, uv__queue_done);
+  uv__work_submit(loop,
+                  (uv_req_t*) req,
+                  cls,
+                  uv__queue_work,
+                  uv__queue_done);
   return 0;
 }
 
 
 int uv_cancel(uv_req_t* req) {
-  struct uv__work* wreq;
   uv_loop_t* loop;
 
   switch (req->type) {
   case UV_FS:
     loop =  ((uv_fs_t*) req)->loop;
-    wreq = &((uv_fs_t*) req)->work_req;
     break;
   case UV_GETADDRINFO:
     loop =  ((uv_getaddrinfo_t*) req)->loop;
-    wreq = &((uv_getaddrinfo_t*) req)->work_req;
     break;
   case UV_GETNAMEINFO:
     loop = ((uv_getnameinfo_t*) req)->loop;
-    wreq = &((uv_getnameinfo_t*) req)->work_req;
     break;
   case UV_WORK:
     loop =  ((uv_work_t*) req)->loop;
-    wreq = &((uv_work_t*) req)->work_req;
     break;
   default:
     return UV_EINVAL;
   }
 
-  return uv__work_cancel(loop, req, wreq);
+  return uv__work_cancel(loop, req, uv__req_work(req));
 }
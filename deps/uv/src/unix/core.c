@@ -329,7 +329,30 @@ int uv_loop_alive(const uv_loop_t* loop) {
 }
 
 
+/* Adds the time since `start` to a phase of a loop with UV_LOOP_METRICS and
+ * returns the start of the next phase, or 0 when metrics are disabled.
+ */
+static uint64_t uv__metrics_phase(uv_loop_t* loop,
+                                  uv_loop_phase_t phase,
+                                  uint64_t start) {
+  uv_loop_metrics_t* metrics;
+  uint64_t now;
+
+  metrics = uv__get_internal_fields(loop)->metrics;
+  if (metrics == NULL)
+    return 0;
+
+  now = uv__hrtime(UV_CLOCK_PRECISE);
+  if (start != 0 && phase != UV_PHASE_MAX)
+    metrics->phase_time[phase] += now - start;
+  return now;
+}
+
+
 int uv_run(uv_loop_t* loop, uv_run_mode mode) {
+  uv_loop_metrics_t* metrics;
+  uint64_t start;
+  uint64_t idle;
   int timeout;
   int r;
   int ran_pending;
@@ -340,18 +363,31 @@ int uv_run(uv_loop_t* loop, uv_run_mode mode) {
 
   while (r != 0 && loop->stop_flag == 0) {
     uv__update_time(loop);
+    start = uv__metrics_phase(loop, UV_PHASE_MAX, 0);
     uv__run_timers(loop);
+    start = uv__metrics_phase(loop, UV_PHASE_TIMERS, start);
     ran_pending = uv__run_pending(loop);
+    start = uv__metrics_phase(loop, UV_PHASE_PENDING, start);
     uv__run_idle(loop);
     uv__run_prepare(loop);
+    start = uv__metrics_phase(loop, UV_PHASE_PREPARE, start);
 
     timeout = 0;
     if ((mode == UV_RUN_ONCE && !ran_pending) || mode == UV_RUN_DEFAULT)
       timeout = uv_backend_timeout(loop);
 
+    metrics = uv__get_internal_fields(loop)->metrics;
+    idle = metrics != NULL ? metrics->idle_time : 0;
     uv__io_poll(loop, timeout);
+    if (metrics != NULL && start != 0) {
+      /* The time spent blocked in the backend is not part of the phase. */
+      metrics->phase_time[UV_PHASE_POLL] -= metrics->idle_time - idle;
+    }
+    start = uv__metrics_phase(loop, UV_PHASE_POLL, start);
     uv__run_check(loop);
+    start = uv__metrics_phase(loop, UV_PHASE_CHECK, start);
     uv__run_closing_handles(loop);
+    start = uv__metrics_phase(loop, UV_PHASE_CLOSING, start);
 
     if (mode == UV_RUN_ONCE) {
       /* UV_RUN_ONCE implies forward progress: at least one callback must have
@@ -364,8 +400,12 @@ int uv_run(uv_loop_t* loop, uv_run_mode mode) {
        */
       uv__update_time(loop);
       uv__run_timers(loop);
+      uv__metrics_phase(loop, UV_PHASE_TIMERS, start);
     }
 
+    if (metrics != NULL)
+      metrics->iterations++;
+
     r = uv__loop_alive(loop);
     if (mode == UV_RUN_ONCE || mode == UV_RUN_NOWAIT)
       break;
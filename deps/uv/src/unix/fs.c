@@ -112,10 +112,18 @@
   }                                                                           \
   while (0)
 
+#if defined(__linux__)
+# define UV__FS_SUBMIT_IOU(loop, req) uv__iou_fs_submit((loop), (req))
+#else
+# define UV__FS_SUBMIT_IOU(loop, req) 0
+#endif
+
 #define POST                                                                  \
   do {                                                                        \
     if (cb != NULL) {                                                         \
-      uv__work_submit(loop, &req->work_req, uv__fs_work, uv__fs_done);        \
+      if (UV__FS_SUBMIT_IOU(loop, req))                                       \
+        return 0;                                                             \
+      uv__fs_post(loop, req);                                                 \
       return 0;                                                               \
     }                                                                         \
     else {                                                                    \
@@ -998,6 +1006,15 @@ static void uv__fs_done(struct uv__work* w, int status) {
 }
 
 
+void uv__fs_post(uv_loop_t* loop, uv_fs_t* req) {
+  uv__work_submit(loop,
+                  (uv_req_t*) req,
+                  UV_WORK_FS,
+                  uv__fs_work,
+                  uv__fs_done);
+}
+
+
 int uv_fs_access(uv_loop_t* loop,
                  uv_fs_t* req,
                  const char* path,
@@ -108,7 +108,8 @@ int uv_getnameinfo(uv_loop_t* loop,
 
   if (getnameinfo_cb) {
     uv__work_submit(loop,
-                    &req->work_req,
+                    (uv_req_t*) req,
+                    UV_WORK_DNS,
                     uv__getnameinfo_work,
                     uv__getnameinfo_done);
     return 0;
@@ -235,6 +235,10 @@ int uv__kqueue_init(uv_loop_t* loop);
 int uv__platform_loop_init(uv_loop_t* loop);
 void uv__platform_loop_delete(uv_loop_t* loop);
 void uv__platform_invalidate_fd(uv_loop_t* loop, int fd);
+#if defined(__linux__)
+int uv__iou_fs_submit(uv_loop_t* loop, uv_fs_t* req);
+#endif
+void uv__fs_post(uv_loop_t* loop, uv_fs_t* req);
 
 /* various */
 void uv__async_close(uv_async_t* handle);
@@ -306,6 +310,34 @@ UV_UNUSED(static void uv__req_init(uv_loop_t* loop,
 #define uv__req_init(loop, req, type) \
   uv__req_init((loop), (uv_req_t*)(req), (type))
 
+/* Loop state that is not part of uv_loop_t, so that adding to it does not
+ * change the layout of the public struct.  Allocated by uv_loop_init().
+ */
+struct uv__loop_internal_fields {
+  uv_loop_metrics_t* metrics;  /* NULL unless UV_LOOP_METRICS is set. */
+#if defined(__linux__)
+  void* iou;  /* struct uv__iou, NULL until io_uring is first used. */
+  int iou_disabled;  /* Set when this loop can't or mustn't use io_uring. */
+#endif
+};
+
+#define uv__get_internal_fields(loop)                                         \
+  ((struct uv__loop_internal_fields*) (loop)->internal_fields)
+
+/* Time spent waiting for I/O, for loops with UV_LOOP_METRICS. */
+UV_UNUSED(static uint64_t uv__metrics_idle_begin(const uv_loop_t* loop)) {
+  return uv__get_internal_fields(loop)->metrics != NULL ?
+      uv__hrtime(UV_CLOCK_PRECISE) : 0;
+}
+
+UV_UNUSED(static void uv__metrics_idle_end(uv_loop_t* loop, uint64_t start)) {
+  uv_loop_metrics_t* metrics;
+
+  metrics = uv__get_internal_fields(loop)->metrics;
+  if (metrics != NULL && start != 0)
+    metrics->idle_time += uv__hrtime(UV_CLOCK_PRECISE) - start;
+}
+
 UV_UNUSED(static void uv__update_time(uv_loop_t* loop)) {
   /* Use a fast time source if available.  We only need millisecond precision.
    */
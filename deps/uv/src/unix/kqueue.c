@@ -78,6 +78,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   sigset_t set;
   uint64_t base;
   uint64_t diff;
+  uint64_t idle;
   int have_signals;
   int filter;
   int fflags;
@@ -158,12 +159,14 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
     if (pset != NULL)
       pthread_sigmask(SIG_BLOCK, pset, NULL);
 
+    idle = uv__metrics_idle_begin(loop);
     nfds = kevent(loop->backend_fd,
                   events,
                   nevents,
                   events,
                   ARRAY_SIZE(events),
                   timeout == -1 ? NULL : &spec);
+    uv__metrics_idle_end(loop, idle);
 
     if (pset != NULL)
       pthread_sigmask(SIG_UNBLOCK, pset, NULL);
@@ -34,9 +34,11 @@
 #include <errno.h>
 
 #include <net/if.h>
+#include <sys/mman.h>
 #include <sys/param.h>
 #include <sys/prctl.h>
 #include <sys/sysinfo.h>
+#include <sys/sysmacros.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <time.h>
@@ -73,6 +75,37 @@
 # define CLOCK_BOOTTIME 7
 #endif
 
+/* Size of the submission queue of the per-loop io_uring.  The completion
+ * queue is twice as large and the kernel buffers overflowing completions.
+ */
+#define UV__IOU_ENTRIES 64
+
+/* State of the io_uring that services file system requests.  The rings are
+ * created lazily, the first time a loop submits an eligible request.
+ */
+struct uv__iou {
+  uint32_t* sqhead;
+  uint32_t* sqtail;
+  uint32_t* sqarray;
+  uint32_t* sqflags;
+  uint32_t sqmask;
+  uint32_t sqentries;
+  uint32_t* cqhead;
+  uint32_t* cqtail;
+  uint32_t cqmask;
+  struct uv__io_uring_cqe* cqe;
+  struct uv__io_uring_sqe* sqe;
+  void* sq;
+  size_t maxlen;
+  size_t sqelen;
+  unsigned int unsubmitted;
+  unsigned int in_flight;
+  int ringfd;
+  uv__io_t watcher;
+};
+
+static void uv__iou_delete(uv_loop_t* loop);
+static void uv__iou_flush(uv_loop_t* loop, struct uv__iou* iou);
 static int read_models(unsigned int numcpus, uv_cpu_info_t* ci);
 static int read_times(FILE* statfile_fp,
                       unsigned int numcpus,
@@ -108,6 +141,7 @@ int uv__platform_loop_init(uv_loop_t* loop) {
 
 
 void uv__platform_loop_delete(uv_loop_t* loop) {
+  uv__iou_delete(loop);
   if (loop->inotify_fd == -1) return;
   uv__io_stop(loop, &loop->inotify_read_watcher, POLLIN);
   uv__close(loop->inotify_fd);
@@ -147,6 +181,459 @@ void uv__platform_invalidate_fd(uv_loop_t* loop, int fd) {
 }
 
 
+static void uv__iou_statx_to_stat(const struct uv__statx* statxbuf,
+                                  uv_stat_t* buf) {
+  buf->st_dev = makedev(statxbuf->stx_dev_major, statxbuf->stx_dev_minor);
+  buf->st_mode = statxbuf->stx_mode;
+  buf->st_nlink = statxbuf->stx_nlink;
+  buf->st_uid = statxbuf->stx_uid;
+  buf->st_gid = statxbuf->stx_gid;
+  buf->st_rdev = makedev(statxbuf->stx_rdev_major, statxbuf->stx_rdev_minor);
+  buf->st_ino = statxbuf->stx_ino;
+  buf->st_size = statxbuf->stx_size;
+  buf->st_blksize = statxbuf->stx_blksize;
+  buf->st_blocks = statxbuf->stx_blocks;
+  buf->st_atim.tv_sec = statxbuf->stx_atime.tv_sec;
+  buf->st_atim.tv_nsec = statxbuf->stx_atime.tv_nsec;
+  buf->st_mtim.tv_sec = statxbuf->stx_mtime.tv_sec;
+  buf->st_mtim.tv_nsec = statxbuf->stx_mtime.tv_nsec;
+  buf->st_ctim.tv_sec = statxbuf->stx_ctime.tv_sec;
+  buf->st_ctim.tv_nsec = statxbuf->stx_ctime.tv_nsec;
+  /* Match uv__to_stat(), which reports ctime as the birth time on Linux. */
+  buf->st_birthtim.tv_sec = statxbuf->stx_ctime.tv_sec;
+  buf->st_birthtim.tv_nsec = statxbuf->stx_ctime.tv_nsec;
+  buf->st_flags = 0;
+  buf->st_gen = 0;
+}
+
+
+static void uv__iou_fs_done(uv_loop_t* loop, uv_fs_t* req, int res) {
+  struct uv__statx* statxbuf;
+
+  uv__req_unregister(loop, req);
+
+  switch (req->fs_type) {
+  case UV_FS_READ:
+  case UV_FS_WRITE:
+    if (req->bufs != req->bufsml)
+      uv__free(req->bufs);
+    req->bufs = NULL;
+    req->nbufs = 0;
+    break;
+
+  case UV_FS_STAT:
+  case UV_FS_LSTAT:
+  case UV_FS_FSTAT:
+    statxbuf = req->ptr;
+    req->ptr = NULL;
+    if (res == 0) {
+      uv__iou_statx_to_stat(statxbuf, &req->statbuf);
+      req->ptr = &req->statbuf;
+    }
+    uv__free(statxbuf);
+    break;
+
+  default:
+    break;
+  }
+
+  req->result = res;
+  req->cb(req);
+}
+
+
+static void uv__iou_cb(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
+  struct uv__io_uring_cqe* cqe;
+  struct uv__iou* iou;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t i;
+  int rc;
+
+  iou = container_of(w, struct uv__iou, watcher);
+  head = *iou->cqhead;
+  tail = __atomic_load_n(iou->cqtail, __ATOMIC_ACQUIRE);
+
+  for (i = head; i != tail; i++) {
+    cqe = &iou->cqe[i & iou->cqmask];
+    iou->in_flight--;
+    uv__iou_fs_done(loop, (uv_fs_t*) (uintptr_t) cqe->user_data, cqe->res);
+  }
+
+  __atomic_store_n(iou->cqhead, tail, __ATOMIC_RELEASE);
+
+  /* If completions overflowed the ring, ask the kernel to move them over.
+   * They are picked up on the next loop iteration to avoid starving other
+   * watchers.
+   */
+  if (__atomic_load_n(iou->sqflags, __ATOMIC_ACQUIRE) &
+      UV__IORING_SQ_CQ_OVERFLOW) {
+    do
+      rc = uv__io_uring_enter(iou->ringfd, 0, 0, UV__IORING_ENTER_GETEVENTS);
+    while (rc == -1 && errno == EINTR);
+  }
+}
+
+
+static struct uv__iou* uv__iou_init(uv_loop_t* loop) {
+  struct uv__io_uring_params params;
+  struct uv__iou* iou;
+  uint32_t required;
+  size_t sqlen;
+  size_t cqlen;
+  size_t maxlen;
+  size_t sqelen;
+  char* sq;
+  char* sqe;
+  uint32_t i;
+  int ringfd;
+
+  sq = MAP_FAILED;
+  sqe = MAP_FAILED;
+  iou = NULL;
+
+  memset(&params, 0, sizeof(params));
+  ringfd = uv__io_uring_setup(UV__IOU_ENTRIES, &params);
+  if (ringfd == -1)
+    return NULL;
+
+  /* Older kernels have known bugs; insist on v5.13 or newer. */
+  required = UV__IORING_FEAT_SINGLE_MMAP |
+             UV__IORING_FEAT_NODROP |
+             UV__IORING_FEAT_RSRC_TAGS;
+  if ((params.features & required) != required)
+    goto fail;
+
+  sqlen = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cqlen = params.cq_off.cqes +
+          params.cq_entries * sizeof(struct uv__io_uring_cqe);
+  maxlen = sqlen < cqlen ? cqlen : sqlen;
+  sqelen = params.sq_entries * sizeof(struct uv__io_uring_sqe);
+
+  sq = mmap(0,
+            maxlen,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            ringfd,
+            0);  /* UV__IORING_OFF_SQ_RING */
+
+  sqe = mmap(0,
+             sqelen,
+             PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE,
+             ringfd,
+             UV__IORING_OFF_SQES);
+
+  if (sq == MAP_FAILED || sqe == MAP_FAILED)
+    goto fail;
+
+  iou = uv__malloc(sizeof(*iou));
+  if (iou == NULL)
+    goto fail;
+
+  iou->sqhead = (uint32_t*) (sq + params.sq_off.head);
+  iou->sqtail = (uint32_t*) (sq + params.sq_off.tail);
+  iou->sqarray = (uint32_t*) (sq + params.sq_off.array);
+  iou->sqflags = (uint32_t*) (sq + params.sq_off.flags);
+  iou->sqmask = *(uint32_t*) (sq + params.sq_off.ring_mask);
+  iou->sqentries = params.sq_entries;
+  iou->cqhead = (uint32_t*) (sq + params.cq_off.head);
+  iou->cqtail = (uint32_t*) (sq + params.cq_off.tail);
+  iou->cqmask = *(uint32_t*) (sq + params.cq_off.ring_mask);
+  iou->cqe = (struct uv__io_uring_cqe*) (sq + params.cq_off.cqes);
+  iou->sqe = (struct uv__io_uring_sqe*) sqe;
+  iou->sq = sq;
+  iou->maxlen = maxlen;
+  iou->sqelen = sqelen;
+  iou->unsubmitted = 0;
+  iou->in_flight = 0;
+  iou->ringfd = ringfd;
+
+  /* Submission queue entries are used in ring order. */
+  for (i = 0; i < iou->sqentries; i++)
+    iou->sqarray[i] = i;
+
+  /* The ring file descriptor polls readable when completions are waiting. */
+  uv__io_init(&iou->watcher, uv__iou_cb, ringfd);
+  uv__io_start(loop, &iou->watcher, POLLIN);
+
+  return iou;
+
+fail:
+  if (sq != MAP_FAILED)
+    munmap(sq, maxlen);
+
+  if (sqe != MAP_FAILED)
+    munmap(sqe, sqelen);
+
+  uv__close(ringfd);
+
+  return NULL;
+}
+
+
+static void uv__iou_delete(uv_loop_t* loop) {
+  struct uv__loop_internal_fields* fields;
+  struct uv__iou* iou;
+
+  fields = uv__get_internal_fields(loop);
+  iou = fields->iou;
+  if (iou == NULL)
+    return;
+
+  uv__io_stop(loop, &iou->watcher, POLLIN);
+  munmap(iou->sq, iou->maxlen);
+  munmap(iou->sqe, iou->sqelen);
+  uv__close(iou->ringfd);
+  uv__free(iou);
+  fields->iou = NULL;
+}
+
+
+static uv_once_t uv__iou_env_once = UV_ONCE_INIT;
+static int uv__iou_env_disabled;
+
+
+static void uv__iou_read_env(void) {
+  const char* val;
+
+  val = getenv("UV_USE_IO_URING");
+  uv__iou_env_disabled = (val != NULL && atoi(val) == 0);
+}
+
+
+/* Returns the loop's io_uring, creating it on first use, or NULL if the
+ * loop's file system requests go through the thread pool.  That is the case
+ * when io_uring is disabled with UV_USE_IO_URING=0, when it couldn't be set
+ * up for this loop, or after the kernel failed to take requests from it.
+ */
+static struct uv__iou* uv__iou_get(uv_loop_t* loop) {
+  struct uv__loop_internal_fields* fields;
+
+  fields = uv__get_internal_fields(loop);
+  if (fields->iou_disabled)
+    return NULL;
+
+  if (fields->iou != NULL)
+    return fields->iou;
+
+  uv_once(&uv__iou_env_once, uv__iou_read_env);
+  if (uv__iou_env_disabled) {
+    fields->iou_disabled = 1;
+    return NULL;
+  }
+
+  fields->iou = uv__iou_init(loop);
+  if (fields->iou == NULL)
+    fields->iou_disabled = 1;
+
+  return fields->iou;
+}
+
+
+/* Takes back the requests that are queued on the ring but that the kernel
+ * hasn't consumed, and runs them on the thread pool instead.
+ */
+static void uv__iou_requeue(uv_loop_t* loop, struct uv__iou* iou) {
+  struct uv__io_uring_sqe* sqe;
+  uv_fs_t* req;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t i;
+
+  head = __atomic_load_n(iou->sqhead, __ATOMIC_ACQUIRE);
+  tail = *iou->sqtail;
+  __atomic_store_n(iou->sqtail, head, __ATOMIC_RELEASE);
+
+  for (i = head; i != tail; i++) {
+    sqe = &iou->sqe[i & iou->sqmask];
+    req = (uv_fs_t*) (uintptr_t) sqe->user_data;
+    iou->in_flight--;
+
+    /* Only the stat requests hold ring-specific state, their statx buffer. */
+    if (sqe->opcode == UV__IORING_OP_STATX) {
+      uv__free(req->ptr);
+      req->ptr = NULL;
+    }
+
+    uv__fs_post(loop, req);
+  }
+
+  iou->unsubmitted = 0;
+}
+
+
+static void uv__iou_flush(uv_loop_t* loop, struct uv__iou* iou) {
+  int rc;
+
+  while (iou->unsubmitted != 0) {
+    rc = uv__io_uring_enter(iou->ringfd, iou->unsubmitted, 0, 0);
+
+    if (rc > 0) {
+      iou->unsubmitted -= rc;
+      continue;
+    }
+
+    if (rc == -1 && errno == EINTR)
+      continue;
+
+    /* EAGAIN and EBUSY mean the kernel is temporarily out of resources or
+     * has a backlog of completions for us; try again later.
+     */
+    if (rc == 0 || errno == EAGAIN || errno == EBUSY)
+      return;
+
+    /* Any other error means the ring is no longer usable.  Requests that are
+     * already in the kernel still complete through uv__iou_cb(); the rest,
+     * and all new ones, go to the thread pool.
+     */
+    uv__get_internal_fields(loop)->iou_disabled = 1;
+    uv__iou_requeue(loop, iou);
+    return;
+  }
+}
+
+
+static struct uv__io_uring_sqe* uv__iou_get_sqe(struct uv__iou* iou,
+                                                uv_loop_t* loop,
+                                                uv_fs_t* req) {
+  struct uv__io_uring_sqe* sqe;
+  uint32_t head;
+  uint32_t tail;
+
+  tail = *iou->sqtail;
+  head = __atomic_load_n(iou->sqhead, __ATOMIC_ACQUIRE);
+
+  if (tail - head >= iou->sqentries) {
+    uv__iou_flush(loop, iou);
+    if (uv__get_internal_fields(loop)->iou_disabled)
+      return NULL;
+    tail = *iou->sqtail;
+    head = __atomic_load_n(iou->sqhead, __ATOMIC_ACQUIRE);
+    if (tail - head >= iou->sqentries)
+      return NULL;  /* Still full, use the thread pool. */
+  }
+
+  sqe = &iou->sqe[tail & iou->sqmask];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->user_data = (uintptr_t) req;
+
+  /* The request never reaches the thread pool.  Make uv_cancel() see it as
+   * a work item that is already executing so it returns UV_EBUSY.
+   */
+  req->work_req.loop = loop;
+  req->work_req.work = NULL;
+  req->work_req.done = NULL;
+  QUEUE_INIT((QUEUE*) &req->reserved[0]);
+
+  return sqe;
+}
+
+
+static void uv__iou_submit(struct uv__iou* iou) {
+  __atomic_store_n(iou->sqtail, *iou->sqtail + 1, __ATOMIC_RELEASE);
+  iou->unsubmitted++;
+  iou->in_flight++;
+}
+
+
+/* Queues an asynchronous file system request on the loop's io_uring.
+ * Returns 1 if the request was queued, or 0 if it should go to the thread
+ * pool instead, either because io_uring is unavailable or because the kernel
+ * can't do the operation asynchronously.  Queued requests are submitted to
+ * the kernel in batches at the start of uv__io_poll() and complete through
+ * uv__iou_cb().
+ */
+int uv__iou_fs_submit(uv_loop_t* loop, uv_fs_t* req) {
+  struct uv__io_uring_sqe* sqe;
+  struct uv__statx* statxbuf;
+  struct uv__iou* iou;
+
+  switch (req->fs_type) {
+  case UV_FS_READ:
+  case UV_FS_WRITE:
+    if (req->nbufs > (unsigned int) uv__getiovmax())
+      return 0;
+    break;
+  case UV_FS_FSYNC:
+  case UV_FS_FDATASYNC:
+  case UV_FS_STAT:
+  case UV_FS_LSTAT:
+  case UV_FS_FSTAT:
+    break;
+  default:
+    return 0;
+  }
+
+  iou = uv__iou_get(loop);
+  if (iou == NULL)
+    return 0;
+
+  statxbuf = NULL;
+  if (req->fs_type == UV_FS_STAT ||
+      req->fs_type == UV_FS_LSTAT ||
+      req->fs_type == UV_FS_FSTAT) {
+    statxbuf = uv__malloc(sizeof(*statxbuf));
+    if (statxbuf == NULL)
+      return 0;
+  }
+
+  sqe = uv__iou_get_sqe(iou, loop, req);
+  if (sqe == NULL) {
+    uv__free(statxbuf);
+    return 0;
+  }
+
+  switch (req->fs_type) {
+  case UV_FS_READ:
+  case UV_FS_WRITE:
+    sqe->opcode = req->fs_type == UV_FS_READ ? UV__IORING_OP_READV
+                                             : UV__IORING_OP_WRITEV;
+    sqe->fd = req->file;
+    sqe->addr = (uintptr_t) req->bufs;
+    sqe->len = req->nbufs;
+    /* An offset of -1 means "use and update the file position". */
+    sqe->u1.off = req->off < 0 ? (uint64_t) -1 : (uint64_t) req->off;
+    break;
+
+  case UV_FS_FSYNC:
+  case UV_FS_FDATASYNC:
+    sqe->opcode = UV__IORING_OP_FSYNC;
+    sqe->fd = req->file;
+    if (req->fs_type == UV_FS_FDATASYNC)
+      sqe->u2.fsync_flags = UV__IORING_FSYNC_DATASYNC;
+    break;
+
+  case UV_FS_STAT:
+  case UV_FS_LSTAT:
+  case UV_FS_FSTAT:
+    sqe->opcode = UV__IORING_OP_STATX;
+    sqe->u1.addr2 = (uintptr_t) statxbuf;
+    sqe->len = UV__STATX_BASIC_STATS;
+    sqe->u2.statx_flags = UV__AT_STATX_SYNC_AS_STAT;
+    if (req->fs_type == UV_FS_FSTAT) {
+      sqe->fd = req->file;
+      sqe->addr = (uintptr_t) "";
+      sqe->u2.statx_flags |= UV__AT_EMPTY_PATH;
+    } else {
+      sqe->fd = AT_FDCWD;
+      sqe->addr = (uintptr_t) req->path;
+      if (req->fs_type == UV_FS_LSTAT)
+        sqe->u2.statx_flags |= UV__AT_SYMLINK_NOFOLLOW;
+    }
+    req->ptr = statxbuf;
+    break;
+
+  default:
+    abort();
+  }
+
+  uv__iou_submit(iou);
+
+  return 1;
+}
+
+
 int uv__io_check_fd(uv_loop_t* loop, int fd) {
   struct uv__epoll_event e;
   int rc;
@@ -182,12 +669,14 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   struct uv__epoll_event events[1024];
   struct uv__epoll_event* pe;
   struct uv__epoll_event e;
+  struct uv__iou* iou;
   int real_timeout;
   QUEUE* q;
   uv__io_t* w;
   sigset_t sigset;
   uint64_t sigmask;
   uint64_t base;
+  uint64_t idle;
   int have_signals;
   int nevents;
   int count;
@@ -196,6 +685,17 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   int op;
   int i;
 
+  /* Hand the file system requests queued since the last iteration over to
+   * the kernel in one go.  If the kernel couldn't take them all, don't
+   * block; poll again soon so they don't get stuck in the ring.
+   */
+  iou = uv__get_internal_fields(loop)->iou;
+  if (iou != NULL) {
+    uv__iou_flush(loop, iou);
+    if (iou->unsubmitted != 0 && timeout != 0)
+      timeout = 1;
+  }
+
   if (loop->nfds == 0) {
     assert(QUEUE_EMPTY(&loop->watcher_queue));
     return;
@@ -259,6 +759,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
       if (pthread_sigmask(SIG_BLOCK, &sigset, NULL))
         abort();
 
+    idle = uv__metrics_idle_begin(loop);
     if (no_epoll_wait != 0 || (sigmask != 0 && no_epoll_pwait == 0)) {
       nfds = uv__epoll_pwait(loop->backend_fd,
                              events,
@@ -275,6 +776,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
       if (nfds == -1 && errno == ENOSYS)
         no_epoll_wait = 1;
     }
+    uv__metrics_idle_end(loop, idle);
 
     if (sigmask != 0 && no_epoll_pwait != 0)
       if (pthread_sigmask(SIG_UNBLOCK, &sigset, NULL))
@@ -28,6 +28,7 @@
 #include <unistd.h>
 
 int uv_loop_init(uv_loop_t* loop) {
+  struct uv__loop_internal_fields* fields;
   void* saved_data;
   int err;
 
@@ -37,9 +38,13 @@ int uv_loop_init(uv_loop_t* loop) {
   memset(loop, 0, sizeof(*loop));
   loop->data = saved_data;
 
+  fields = uv__calloc(1, sizeof(*fields));
+  if (fields == NULL)
+    return UV_ENOMEM;
+  loop->internal_fields = fields;
+
   heap_init((struct heap*) &loop->timer_heap);
   QUEUE_INIT(&loop->wq);
-  QUEUE_INIT(&loop->active_reqs);
   QUEUE_INIT(&loop->idle_handles);
   QUEUE_INIT(&loop->async_handles);
   QUEUE_INIT(&loop->check_handles);
@@ -65,7 +70,7 @@ int uv_loop_init(uv_loop_t* loop) {
 
   err = uv__platform_loop_init(loop);
   if (err)
-    return err;
+    goto fail_platform_init;
 
   err = uv_signal_init(loop, &loop->child_watcher);
   if (err)
@@ -104,6 +109,10 @@ fail_rwlock_init:
 fail_signal_init:
   uv__platform_loop_delete(loop);
 
+fail_platform_init:
+  uv__free(loop->internal_fields);
+  loop->internal_fields = NULL;
+
   return err;
 }
 
@@ -123,6 +132,10 @@ void uv__loop_close(uv_loop_t* loop) {
     loop->backend_fd = -1;
   }
 
+  uv__free(uv__get_internal_fields(loop)->metrics);
+  uv__free(loop->internal_fields);
+  loop->internal_fields = NULL;
+
   uv_mutex_lock(&loop->wq_mutex);
   assert(QUEUE_EMPTY(&loop->wq) && "thread pool work queue not empty!");
   assert(!uv__has_active_reqs(loop));
@@ -147,7 +160,28 @@ void uv__loop_close(uv_loop_t* loop) {
 }
 
 
+int uv_loop_get_metrics(const uv_loop_t* loop, uv_loop_metrics_t* metrics) {
+  if (uv__get_internal_fields(loop)->metrics == NULL)
+    return UV_EINVAL;
+
+  memcpy(metrics, uv__get_internal_fields(loop)->metrics, sizeof(*metrics));
+  return 0;
+}
+
+
 int uv__loop_configure(uv_loop_t* loop, uv_loop_option option, va_list ap) {
+  struct uv__loop_internal_fields* fields;
+
+  if (option == UV_LOOP_METRICS) {
+    fields = uv__get_internal_fields(loop);
+    if (fields->metrics == NULL) {
+      fields->metrics = uv__calloc(1, sizeof(*fields->metrics));
+      if (fields->metrics == NULL)
+        return UV_ENOMEM;
+    }
+    return 0;
+  }
+
   if (option != UV_LOOP_BLOCK_SIGNAL)
     return UV_ENOSYS;
 
@@ -139,6 +139,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   sigset_t set;
   uint64_t base;
   uint64_t diff;
+  uint64_t idle;
   unsigned int nfds;
   unsigned int i;
   int saved_errno;
@@ -193,11 +194,13 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
     if (pset != NULL)
       pthread_sigmask(SIG_BLOCK, pset, NULL);
 
+    idle = uv__metrics_idle_begin(loop);
     err = port_getn(loop->backend_fd,
                     events,
                     ARRAY_SIZE(events),
                     &nfds,
                     timeout == -1 ? NULL : &spec);
+    uv__metrics_idle_end(loop, idle);
 
     if (pset != NULL)
       pthread_sigmask(SIG_UNBLOCK, pset, NULL);
@@ -42,36 +42,62 @@
 
 
 int uv_thread_create(uv_thread_t *tid, void (*entry)(void *arg), void *arg) {
+  uv_thread_options_t params;
+  params.flags = UV_THREAD_NO_FLAGS;
+  return uv_thread_create_ex(tid, &params, entry, arg);
+}
+
+
+int uv_thread_create_ex(uv_thread_t* tid,
+                        const uv_thread_options_t* params,
+                        void (*entry)(void *arg),
+                        void *arg) {
   int err;
   pthread_attr_t* attr;
-#if defined(__APPLE__)
   pthread_attr_t attr_storage;
+  size_t pagesize;
+  size_t stack_size;
+#if defined(__APPLE__)
   struct rlimit lim;
 #endif
 
-  /* On OSX threads other than the main thread are created with a reduced stack
-   * size by default, adjust it to RLIMIT_STACK.
-   */
-#if defined(__APPLE__)
-  if (getrlimit(RLIMIT_STACK, &lim))
-    abort();
+  stack_size = 0;
 
-  attr = &attr_storage;
-  if (pthread_attr_init(attr))
-    abort();
-
-  if (lim.rlim_cur != RLIM_INFINITY) {
+  if (params->flags & UV_THREAD_HAS_STACK_SIZE) {
     /* pthread_attr_setstacksize() expects page-aligned values. */
-    lim.rlim_cur -= lim.rlim_cur % (rlim_t) getpagesize();
+    pagesize = (size_t) getpagesize();
+    stack_size = (params->stack_size + pagesize - 1) &~ (pagesize - 1);
+    if (stack_size < (size_t) PTHREAD_STACK_MIN)
+      stack_size = (size_t) PTHREAD_STACK_MIN;
+  }
+#if defined(__APPLE__)
+  else {
+    /* On OSX threads other than the main thread are created with a reduced
+     * stack size by default, adjust it to RLIMIT_STACK.
+     */
+    if (getrlimit(RLIMIT_STACK, &lim))
+      abort();
+
+    if (lim.rlim_cur != RLIM_INFINITY) {
+      /* pthread_attr_setstacksize() expects page-aligned values. */
+      lim.rlim_cur -= lim.rlim_cur % (rlim_t) getpagesize();
 
-    if (lim.rlim_cur >= PTHREAD_STACK_MIN)
-      if (pthread_attr_setstacksize(attr, lim.rlim_cur))
-        abort();
+      if (lim.rlim_cur >= PTHREAD_STACK_MIN)
+        stack_size = lim.rlim_cur;
+    }
   }
-#else
-  attr = NULL;
 #endif
 
+  attr = NULL;
+  if (stack_size != 0) {
+    attr = &attr_storage;
+    if (pthread_attr_init(attr))
+      abort();
+
+    if (pthread_attr_setstacksize(attr, stack_size))
+      abort();
+  }
+
   err = pthread_create(tid, attr, (void*(*)(void*)) entry, arg);
 
   if (attr != NULL)
@@ -237,7 +237,7 @@ int uv_loop_init(uv_loop_t* loop) {
 
   QUEUE_INIT(&loop->wq);
   QUEUE_INIT(&loop->handle_queue);
-  QUEUE_INIT(&loop->active_reqs);
+  loop->active_reqs.count = 0;
   loop->active_handles = 0;
 
   loop->pending_reqs_tail = NULL;
@@ -327,6 +327,11 @@ int uv__loop_configure(uv_loop_t* loop, uv_loop_option option, va_list ap) {
 }
 
 
+int uv_loop_get_metrics(const uv_loop_t* loop, uv_loop_metrics_t* metrics) {
+  return UV_ENOSYS;
+}
+
+
 int uv_backend_fd(const uv_loop_t* loop) {
   return -1;
 }
@@ -464,7 +469,7 @@ static void uv_poll_ex(uv_loop_t* loop, DWORD timeout) {
 
 static int uv__loop_alive(const uv_loop_t* loop) {
   return loop->active_handles > 0 ||
-         !QUEUE_EMPTY(&loop->active_reqs) ||
+         uv__has_active_reqs(loop) ||
          loop->endgame_handles != NULL;
 }
 
@@ -366,7 +366,8 @@ int uv_getaddrinfo(uv_loop_t* loop,
 
   if (getaddrinfo_cb) {
     uv__work_submit(loop,
-                    &req->work_req,
+                    (uv_req_t*) req,
+                    UV_WORK_DNS,
                     uv__getaddrinfo_work,
                     uv__getaddrinfo_done);
     return 0;
@@ -36,3 +36,42 @@ TEST_IMPL(loop_configure) {
   ASSERT(0 == uv_loop_close(&loop));
   return 0;
 }
+
+
+TEST_IMPL(loop_metrics) {
+  uv_loop_metrics_t metrics;
+  uv_timer_t timer_handle;
+  uv_loop_t loop;
+  uint64_t busy;
+  int i;
+  ASSERT(0 == uv_loop_init(&loop));
+#ifdef _WIN32
+  ASSERT(UV_ENOSYS == uv_loop_get_metrics(&loop, &metrics));
+#else
+  ASSERT(UV_EINVAL == uv_loop_get_metrics(&loop, &metrics));
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_METRICS));
+  ASSERT(0 == uv_loop_get_metrics(&loop, &metrics));
+  ASSERT(0 == metrics.iterations);
+  ASSERT(0 == metrics.idle_time);
+
+  ASSERT(0 == uv_timer_init(&loop, &timer_handle));
+  ASSERT(0 == uv_timer_start(&timer_handle, timer_cb, 50, 0));
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(0 == uv_loop_get_metrics(&loop, &metrics));
+
+  /* Most of the time was spent waiting for the timer. */
+  ASSERT(metrics.iterations >= 1);
+  ASSERT(metrics.idle_time >= 40 * 1000 * 1000);
+  busy = 0;
+  for (i = 0; i < UV_PHASE_MAX; i++)
+    busy += metrics.phase_time[i];
+  ASSERT(busy < metrics.idle_time);
+
+  /* Enabling the option again keeps the counters. */
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_METRICS));
+  ASSERT(0 == uv_loop_get_metrics(&loop, &metrics));
+  ASSERT(metrics.iterations >= 1);
+#endif
+  ASSERT(0 == uv_loop_close(&loop));
+  return 0;
+}
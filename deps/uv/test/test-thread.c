@@ -230,3 +230,41 @@ TEST_IMPL(thread_stack_size) {
   RETURN_SKIP("OSX only test");
 #endif
 }
+
+
+static void thread_check_stack_explicit(void* arg) {
+#if defined(__linux__)
+  pthread_attr_t attr;
+  size_t size;
+
+  ASSERT(0 == pthread_getattr_np(pthread_self(), &attr));
+  ASSERT(0 == pthread_attr_getstacksize(&attr, &size));
+  ASSERT(size == *(size_t*) arg);
+  ASSERT(0 == pthread_attr_destroy(&attr));
+#endif
+}
+
+
+TEST_IMPL(thread_stack_size_explicit) {
+  uv_thread_t thread;
+  uv_thread_options_t options;
+  size_t expected;
+
+  options.flags = UV_THREAD_HAS_STACK_SIZE;
+  options.stack_size = 1024 * 1024;
+  expected = options.stack_size;
+  ASSERT(0 == uv_thread_create_ex(&thread, &options,
+                                  thread_check_stack_explicit, &expected));
+  ASSERT(0 == uv_thread_join(&thread));
+
+#ifndef _WIN32
+  /* Sizes that are not page-aligned are rounded up. */
+  options.stack_size = 1024 * 1024 + 1;
+  expected = 1024 * 1024 + (size_t) getpagesize();
+  ASSERT(0 == uv_thread_create_ex(&thread, &options,
+                                  thread_check_stack_explicit, &expected));
+  ASSERT(0 == uv_thread_join(&thread));
+#endif
+
+  return 0;
+}
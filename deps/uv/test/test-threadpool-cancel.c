@@ -43,9 +43,11 @@ static unsigned done2_cb_called;
 static unsigned timer_cb_called;
 static uv_work_t pause_reqs[4];
 static uv_sem_t pause_sems[ARRAY_SIZE(pause_reqs)];
+static uv_sem_t started_sem;
 
 
 static void work_cb(uv_work_t* req) {
+  uv_sem_post(&started_sem);
   uv_sem_wait(pause_sems + (req - pause_reqs));
 }
 
@@ -64,10 +66,18 @@ static void saturate_threadpool(void) {
   putenv(buf);
 
   loop = uv_default_loop();
+  ASSERT(0 == uv_sem_init(&started_sem, 0));
   for (i = 0; i < ARRAY_SIZE(pause_reqs); i += 1) {
     ASSERT(0 == uv_sem_init(pause_sems + i, 0));
     ASSERT(0 == uv_queue_work(loop, pause_reqs + i, work_cb, done_cb));
   }
+
+  /* Work of other classes can be scheduled ahead of queued uv_queue_work()
+   * requests, so wait until every thread is actually blocked.
+   */
+  for (i = 0; i < ARRAY_SIZE(pause_reqs); i += 1)
+    uv_sem_wait(&started_sem);
+  uv_sem_destroy(&started_sem);
 }
 
 
@@ -240,6 +250,14 @@ TEST_IMPL(threadpool_cancel_fs) {
   unsigned n;
   uv_buf_t iov;
 
+#ifdef __linux__
+  /* This test is about cancelling thread pool work; keep the requests that
+   * would otherwise go to io_uring, where they can't be cancelled, on the
+   * thread pool.
+   */
+  setenv("UV_USE_IO_URING", "0", 1);
+#endif
+
   INIT_CANCEL_INFO(&ci, reqs);
   loop = uv_default_loop();
   saturate_threadpool();
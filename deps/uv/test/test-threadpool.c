@@ -74,3 +74,203 @@ TEST_IMPL(threadpool_queue_work_einval) {
   MAKE_VALGRIND_HAPPY();
   return 0;
 }
+
+
+static uv_mutex_t class_mutex;
+static int class_running;
+static int class_max_running;
+static int class_after_count;
+
+
+static void class_work_cb(uv_work_t* req) {
+  uv_mutex_lock(&class_mutex);
+  class_running++;
+  if (class_running > class_max_running)
+    class_max_running = class_running;
+  uv_mutex_unlock(&class_mutex);
+
+  uv_sleep(20);
+
+  uv_mutex_lock(&class_mutex);
+  class_running--;
+  uv_mutex_unlock(&class_mutex);
+}
+
+
+static void class_after_work_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  class_after_count++;
+}
+
+
+TEST_IMPL(threadpool_queue_work_class_limit) {
+  uv_threadpool_stats_t stats;
+  uv_work_t reqs[4];
+  unsigned int i;
+
+  ASSERT(0 == uv_mutex_init(&class_mutex));
+  ASSERT(0 == uv_threadpool_set_limit(UV_WORK_CPU, 1));
+
+  for (i = 0; i < ARRAY_SIZE(reqs); i++)
+    ASSERT(0 == uv_queue_work_class(uv_default_loop(),
+                                    reqs + i,
+                                    UV_WORK_CPU,
+                                    class_work_cb,
+                                    class_after_work_cb));
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  ASSERT(class_after_count == ARRAY_SIZE(reqs));
+  ASSERT(class_max_running == 1);
+
+  ASSERT(0 == uv_threadpool_get_stats(UV_WORK_CPU, &stats));
+  ASSERT(stats.limit == 1);
+  ASSERT(stats.queued == 0);
+  ASSERT(stats.completed == ARRAY_SIZE(reqs));
+  /* Every request but the first one had to wait for its predecessor. */
+  ASSERT(stats.wait_time > 0);
+  ASSERT(stats.run_time >= ARRAY_SIZE(reqs) * 20 * 1000000ull);
+
+  uv_mutex_destroy(&class_mutex);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+TEST_IMPL(threadpool_queue_work_class_einval) {
+  uv_threadpool_stats_t stats;
+  uv_work_t req;
+
+  ASSERT(UV_EINVAL == uv_queue_work_class(uv_default_loop(),
+                                          &req,
+                                          UV_WORK_CLASS_MAX,
+                                          class_work_cb,
+                                          class_after_work_cb));
+  ASSERT(UV_EINVAL == uv_threadpool_set_limit(UV_WORK_CPU, 0));
+  ASSERT(UV_EINVAL == uv_threadpool_set_limit(UV_WORK_CLASS_MAX, 1));
+  ASSERT(UV_EINVAL == uv_threadpool_get_stats(UV_WORK_CLASS_MAX, &stats));
+  ASSERT(UV_EINVAL == uv_threadpool_get_stats(UV_WORK_CPU, NULL));
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+static uv_sem_t resize_started;
+static uv_sem_t resize_release;
+static unsigned int resize_after_count;
+
+
+static void resize_work_cb(uv_work_t* req) {
+  uv_sem_post(&resize_started);
+  uv_sem_wait(&resize_release);
+}
+
+
+static void resize_after_work_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  resize_after_count++;
+}
+
+
+static void wait_for_pool_size(unsigned int size) {
+  uv_threadpool_info_t info;
+
+  for (;;) {
+    ASSERT(0 == uv_threadpool_get_info(&info));
+    if (info.size == size)
+      break;
+    uv_sleep(1);
+  }
+}
+
+
+TEST_IMPL(threadpool_resize) {
+  uv_threadpool_stats_t stats;
+  uv_threadpool_info_t info;
+  uv_work_t reqs[3];
+  uint64_t histogram_total;
+  unsigned int i;
+
+  ASSERT(0 == uv_sem_init(&resize_started, 0));
+  ASSERT(0 == uv_sem_init(&resize_release, 0));
+
+  /* Surplus threads exit as soon as the maximum drops below the pool size. */
+  ASSERT(0 == uv_threadpool_set_size(1, 1));
+  wait_for_pool_size(1);
+
+  ASSERT(0 == uv_threadpool_set_size(1, 2));
+  ASSERT(0 == uv_threadpool_get_info(&info));
+  ASSERT(info.min_size == 1);
+  ASSERT(info.max_size == 2);
+  ASSERT(info.size == 1);
+
+  /* Occupy the only thread. */
+  ASSERT(0 == uv_queue_work(uv_default_loop(),
+                            reqs + 0,
+                            resize_work_cb,
+                            resize_after_work_cb));
+  uv_sem_wait(&resize_started);
+
+  /* The second request has to wait; once it has been queued for a while,
+   * queueing another request grows the pool and it starts running.
+   */
+  ASSERT(0 == uv_queue_work(uv_default_loop(),
+                            reqs + 1,
+                            resize_work_cb,
+                            resize_after_work_cb));
+  uv_sleep(10);
+  ASSERT(0 == uv_queue_work(uv_default_loop(),
+                            reqs + 2,
+                            resize_work_cb,
+                            resize_after_work_cb));
+  uv_sem_wait(&resize_started);
+
+  ASSERT(0 == uv_threadpool_get_info(&info));
+  ASSERT(info.size == 2);
+  ASSERT(info.idle == 0);
+  ASSERT(info.queued == 1);
+
+  for (i = 0; i < ARRAY_SIZE(reqs); i++)
+    uv_sem_post(&resize_release);
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT(resize_after_count == ARRAY_SIZE(reqs));
+
+  ASSERT(0 == uv_threadpool_get_stats(UV_WORK_USER, &stats));
+  ASSERT(stats.completed == ARRAY_SIZE(reqs));
+  histogram_total = 0;
+  for (i = 0; i < UV_THREADPOOL_HISTOGRAM_SIZE; i++)
+    histogram_total += stats.run_histogram[i];
+  ASSERT(histogram_total == ARRAY_SIZE(reqs));
+  histogram_total = 0;
+  for (i = 0; i < UV_THREADPOOL_HISTOGRAM_SIZE; i++)
+    histogram_total += stats.wait_histogram[i];
+  ASSERT(histogram_total == ARRAY_SIZE(reqs));
+  /* The second request waited at least 10 ms, 2^13 us is about 8 ms. */
+  histogram_total = 0;
+  for (i = 14; i < UV_THREADPOOL_HISTOGRAM_SIZE; i++)
+    histogram_total += stats.wait_histogram[i];
+  ASSERT(histogram_total >= 1);
+
+  ASSERT(0 == uv_threadpool_set_size(1, 1));
+  wait_for_pool_size(1);
+
+  uv_sem_destroy(&resize_started);
+  uv_sem_destroy(&resize_release);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+TEST_IMPL(threadpool_resize_einval) {
+  ASSERT(UV_EINVAL == uv_threadpool_set_size(0, 1));
+  ASSERT(UV_EINVAL == uv_threadpool_set_size(2, 1));
+  ASSERT(UV_EINVAL == uv_threadpool_set_size(1, 129));
+  ASSERT(UV_EINVAL == uv_threadpool_get_info(NULL));
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -657,6 +657,44 @@ Buffer.prototype.includes = function includes(val, byteOffset, encoding) {
 };
 
 
+// A searcher holds a needle along with what is computed from it for the
+// search, so that searching for it in many buffers only does that once.
+function Searcher(needle, encoding) {
+  if (typeof needle === 'string') {
+    needle = Buffer.from(needle, encoding);
+  } else if (needle instanceof Uint8Array) {
+    needle = Buffer.from(needle);
+  } else {
+    throw new TypeError('"needle" argument must be a string or Buffer');
+  }
+  this._needle = needle;
+  this._table = binding.compileSearcher(needle);
+}
+
+
+Searcher.prototype.indexOf = function indexOf(buffer, byteOffset) {
+  if (byteOffset > 0x7fffffff) {
+    byteOffset = 0x7fffffff;
+  } else if (byteOffset < -0x80000000) {
+    byteOffset = -0x80000000;
+  }
+  byteOffset = +byteOffset;  // Coerce to Number.
+  if (isNaN(byteOffset))
+    byteOffset = 0;
+  return binding.indexOfSearcher(buffer, this._needle, this._table, byteOffset);
+};
+
+
+Searcher.prototype.includes = function includes(buffer, byteOffset) {
+  return this.indexOf(buffer, byteOffset) !== -1;
+};
+
+
+Buffer.createSearcher = function createSearcher(needle, encoding) {
+  return new Searcher(needle, encoding);
+};
+
+
 // Usage:
 //    buffer.fill(number[, offset[, end]])
 //    buffer.fill(buffer[, offset[, end]])
@@ -10,6 +10,8 @@ const spawn_sync = process.binding('spawn_sync');
 const Buffer = require('buffer').Buffer;
 const Pipe = process.binding('pipe_wrap').Pipe;
 const child_process = require('internal/child_process');
+const SharedMemoryChannel =
+    require('internal/child_process/shm_channel').SharedMemoryChannel;
 
 const errnoException = util._errnoException;
 const _validateStdio = child_process._validateStdio;
@@ -64,12 +66,15 @@ exports.fork = function(modulePath /*, args, options*/) {
 };
 
 
-exports._forkChild = function(fd) {
+exports._forkChild = function(fd, serializationMode, shmFds) {
   // set process.send()
   var p = new Pipe(true);
   p.open(fd);
   p.unref();
-  const control = setupChannel(process, p);
+  if (shmFds) {
+    process.sharedMemoryChannel = new SharedMemoryChannel(shmFds, false);
+  }
+  const control = setupChannel(process, p, serializationMode);
   process.on('newListener', function onNewListener(name) {
     if (name === 'message' || name === 'disconnect') control.ref();
   });
@@ -393,7 +398,9 @@ var spawn = exports.spawn = function(/*file, args, options*/) {
     envPairs: opts.envPairs,
     stdio: options.stdio,
     uid: options.uid,
-    gid: options.gid
+    gid: options.gid,
+    serialization: options.serialization,
+    sharedMemoryChannel: options.sharedMemoryChannel
   });
 
   return child;
@@ -13,6 +13,9 @@ const QueryReqWrap = cares.QueryReqWrap;
 const isIP = cares.isIP;
 const isLegalPort = internalNet.isLegalPort;
 
+// The DnsCache set with setCache(), or null.
+var cache = null;
+
 
 function errnoException(err, syscall, hostname) {
   // FIXME(bnoordhuis) Remove this backwards compatibility nonsense and pass
@@ -155,6 +158,15 @@ exports.lookup = function lookup(hostname, options, callback) {
     return {};
   }
 
+  if (cache !== null) {
+    const context = { callback, family, hostname };
+    const oncomplete = all ? onlookupall : onlookup;
+    cache.fetch(`lookup:${family}:${hints}:${hostname}`, 'lookup', hostname,
+                (done) => cachedLookup(hostname, family, hints, done),
+                (err, addresses) => oncomplete.call(context, err, addresses));
+    return {};
+  }
+
   var req = new GetAddrInfoReqWrap();
   req.callback = callback;
   req.family = family;
@@ -172,6 +184,20 @@ exports.lookup = function lookup(hostname, options, callback) {
 };
 
 
+// Cached resolutions are shared by all the requests that wait for them, so
+// they do not run in the domain of the one that started them.
+function cachedLookup(hostname, family, hints, done) {
+  var req = new GetAddrInfoReqWrap();
+  req.domain = null;
+  req.oncomplete = function(err, addresses) {
+    done(err, addresses);
+  };
+  var err = cares.getaddrinfo(req, hostname, family, hints);
+  if (err)
+    done(err);
+}
+
+
 function onlookupservice(err, host, service) {
   if (err)
     return this.callback(errnoException(err, 'getnameinfo', this.host));
@@ -239,6 +265,23 @@ function resolver(bindingName) {
     }
 
     callback = makeAsync(callback);
+    if (cache !== null) {
+      const context = {
+        bindingName,
+        callback,
+        hostname: name,
+        ttl: !!(options && options.ttl)
+      };
+      cache.fetch(`${bindingName}:${name}`, bindingName, name,
+                  (done) => cachedQuery(binding, name, done),
+                  (err, result, ttls, age) => {
+                    // The TTLs count down from when the answer was received.
+                    if (ttls && age > 0)
+                      ttls = ttls.map((ttl) => Math.max(ttl - age | 0, 0));
+                    onresolve.call(context, err, result, ttls);
+                  });
+      return {};
+    }
     var req = new QueryReqWrap();
     req.bindingName = bindingName;
     req.callback = callback;
@@ -253,6 +296,18 @@ function resolver(bindingName) {
 }
 
 
+function cachedQuery(binding, name, done) {
+  var req = new QueryReqWrap();
+  req.domain = null;
+  req.oncomplete = function(err, result, extra, ttl) {
+    done(err, result, ttl, extra);
+  };
+  var err = binding(req, name);
+  if (err)
+    done(err);
+}
+
+
 var resolveMap = Object.create(null);
 exports.resolve4 = resolveMap.A = resolver('queryA');
 exports.resolve6 = resolveMap.AAAA = resolver('queryAaaa');
@@ -287,6 +342,25 @@ exports.resolve = function resolve(hostname, type_, callback_) {
 };
 
 
+exports.setCache = function setCache(options) {
+  if (options === null || options === false) {
+    cache = null;
+    return;
+  }
+  if (options === undefined)
+    options = {};
+  else if (typeof options !== 'object')
+    throw new TypeError('"options" argument must be an object');
+  const DnsCache = require('internal/dns_cache');
+  cache = new DnsCache(options);
+};
+
+
+exports.getCacheEntries = function getCacheEntries() {
+  return cache === null ? [] : cache.getEntries();
+};
+
+
 exports.getServers = function getServers() {
   return cares.getServers();
 };
@@ -10,14 +10,12 @@ const pathModule = require('path');
 const binding = process.binding('fs');
 const fs = exports;
 const Buffer = require('buffer').Buffer;
-const Stream = require('stream').Stream;
 const EventEmitter = require('events');
 const FSReqWrap = binding.FSReqWrap;
 const FSEvent = process.binding('fs_event_wrap').FSEvent;
 const internalFS = require('internal/fs');
 const assertEncoding = internalFS.assertEncoding;
 const stringToFlags = internalFS.stringToFlags;
-const SyncWriteStream = internalFS.SyncWriteStream;
 
 Object.defineProperty(exports, 'constants', {
   configurable: false,
@@ -25,8 +23,10 @@ Object.defineProperty(exports, 'constants', {
   value: constants
 });
 
-const Readable = Stream.Readable;
-const Writable = Stream.Writable;
+// The stream modules are only loaded once a file stream is needed, see
+// lazyLoadStreams().
+var Readable;
+var Writable;
 
 const kMinPoolSpace = 128;
 const kMaxLength = require('buffer').kMaxLength;
@@ -195,6 +195,109 @@ fs.Stats.prototype.isSocket = function() {
   return this._checkModeProperty(constants.S_IFSOCK);
 };
 
+// A directory entry as returned by fs.readdir() with the `withFileTypes`
+// option and by fs.walk().  The type comes from the dirent that the
+// platform's readdir(3) already reports, so no stat() call is needed.
+fs.Dirent = function(name, type) {
+  this.name = name;
+  this._type = type;
+};
+
+fs.Dirent.prototype.isDirectory = function() {
+  return this._type === constants.UV_DIRENT_DIR;
+};
+
+fs.Dirent.prototype.isFile = function() {
+  return this._type === constants.UV_DIRENT_FILE;
+};
+
+fs.Dirent.prototype.isBlockDevice = function() {
+  return this._type === constants.UV_DIRENT_BLOCK;
+};
+
+fs.Dirent.prototype.isCharacterDevice = function() {
+  return this._type === constants.UV_DIRENT_CHAR;
+};
+
+fs.Dirent.prototype.isSymbolicLink = function() {
+  return this._type === constants.UV_DIRENT_LINK;
+};
+
+fs.Dirent.prototype.isFIFO = function() {
+  return this._type === constants.UV_DIRENT_FIFO;
+};
+
+fs.Dirent.prototype.isSocket = function() {
+  return this._type === constants.UV_DIRENT_SOCKET;
+};
+
+// Not every file system fills in d_type.  For the entries where it is
+// missing, fall back to the file type reported by lstat().
+function direntTypeFromStats(stats) {
+  if (stats.isFile()) return constants.UV_DIRENT_FILE;
+  if (stats.isDirectory()) return constants.UV_DIRENT_DIR;
+  if (stats.isSymbolicLink()) return constants.UV_DIRENT_LINK;
+  if (stats.isFIFO()) return constants.UV_DIRENT_FIFO;
+  if (stats.isSocket()) return constants.UV_DIRENT_SOCKET;
+  if (stats.isCharacterDevice()) return constants.UV_DIRENT_CHAR;
+  if (stats.isBlockDevice()) return constants.UV_DIRENT_BLOCK;
+  return constants.UV_DIRENT_UNKNOWN;
+}
+
+function direntPath(dir, name) {
+  if (typeof name === 'string' && typeof dir === 'string')
+    return pathModule.join(dir, name);
+  return Buffer.concat([Buffer.from(dir), Buffer.from(pathModule.sep),
+                        Buffer.from(name)]);
+}
+
+function getDirents(dir, result, callback) {
+  const names = result[0];
+  const types = result[1];
+  const dirents = new Array(names.length);
+  var pending = 1;
+  var failed = false;
+
+  function done(err) {
+    if (failed) return;
+    if (err) {
+      failed = true;
+      return callback(err);
+    }
+    if (--pending === 0)
+      callback(null, dirents);
+  }
+
+  for (var i = 0; i < names.length; i++) {
+    dirents[i] = new fs.Dirent(names[i], types[i]);
+    if (types[i] === constants.UV_DIRENT_UNKNOWN) {
+      pending++;
+      fs.lstat(direntPath(dir, names[i]), fillType.bind(null, dirents[i]));
+    }
+  }
+
+  function fillType(dirent, err, stats) {
+    if (!err)
+      dirent._type = direntTypeFromStats(stats);
+    done(err);
+  }
+
+  done(null);
+}
+
+function getDirentsSync(dir, result) {
+  const names = result[0];
+  const types = result[1];
+  const dirents = new Array(names.length);
+  for (var i = 0; i < names.length; i++) {
+    var type = types[i];
+    if (type === constants.UV_DIRENT_UNKNOWN)
+      type = direntTypeFromStats(fs.lstatSync(direntPath(dir, names[i])));
+    dirents[i] = new fs.Dirent(names[i], type);
+  }
+  return dirents;
+}
+
 // Don't allow mode to accidentally be overwritten.
 ['F_OK', 'R_OK', 'W_OK', 'X_OK'].forEach(function(key) {
   Object.defineProperty(fs, key, {
@@ -859,15 +962,201 @@ fs.readdir = function(path, options, callback) {
   callback = makeCallback(typeof options === 'function' ? options : callback);
   options = getOptions(options, {});
   if (!nullCheck(path, callback)) return;
+  const withFileTypes = !!options.withFileTypes;
   var req = new FSReqWrap();
-  req.oncomplete = callback;
-  binding.readdir(pathModule._makeLong(path), options.encoding, req);
+  if (withFileTypes) {
+    req.oncomplete = function(err, result) {
+      if (err) return callback(err);
+      getDirents(path, result, callback);
+    };
+  } else {
+    req.oncomplete = callback;
+  }
+  binding.readdir(pathModule._makeLong(path), options.encoding,
+                  withFileTypes, req);
 };
 
 fs.readdirSync = function(path, options) {
   options = getOptions(options, {});
   nullCheck(path);
-  return binding.readdir(pathModule._makeLong(path), options.encoding);
+  const withFileTypes = !!options.withFileTypes;
+  const result = binding.readdir(pathModule._makeLong(path), options.encoding,
+                                 withFileTypes);
+  return withFileTypes ? getDirentsSync(path, result) : result;
+};
+
+const kWalkBatchSize = 1024;
+const kWalkConcurrency = 4;
+
+function getWalkOptions(options) {
+  options = getOptions(options, {});
+  if (options.encoding === 'buffer')
+    throw new TypeError('"encoding" must not be \'buffer\' for fs.walk()');
+  const depth = options.depth === undefined ? Infinity : options.depth;
+  if (typeof depth !== 'number' || !(depth >= 0))
+    throw new TypeError('"depth" must be a non-negative number');
+  const filter = options.filter;
+  if (filter !== undefined && typeof filter !== 'function')
+    throw new TypeError('"filter" must be a function');
+  const batchSize = options.batchSize === undefined ?
+    kWalkBatchSize : options.batchSize;
+  if (!Number.isInteger(batchSize) || batchSize <= 0)
+    throw new TypeError('"batchSize" must be a positive integer');
+  return {
+    encoding: options.encoding,
+    depth: depth,
+    filter: filter,
+    batchSize: batchSize
+  };
+}
+
+fs.walk = function(path, options) {
+  lazyLoadStreams();
+  return new WalkStream(path, options);
+};
+
+defineLazyStreamClass('WalkStream', WalkStream);
+
+// Walks the directory tree below `path` and emits arrays of at most
+// `batchSize` fs.Dirent objects, with `name` set to the path relative to
+// `path`.  Each directory is read with a single scandir request that also
+// returns the entry types, so there is one round trip to the thread pool per
+// directory rather than one per entry.  Directories are taken depth-first
+// from a stack and only read while the consumer wants more data, with at
+// most kWalkConcurrency of them in flight, so memory use is bounded by the
+// size of a few directories rather than by the size of the tree.
+function WalkStream(path, options) {
+  if (!(this instanceof WalkStream))
+    return new WalkStream(path, options);
+
+  options = getWalkOptions(options);
+  nullCheck(path);
+
+  Readable.call(this, { objectMode: true, highWaterMark: 1 });
+
+  this.path = path.toString();
+  this.batchSize = options.batchSize;
+  this.destroyed = false;
+
+  this._options = options;
+  this._dirs = [{ dir: this.path, prefix: '', depth: 0 }];
+  this._batch = [];
+  this._reading = 0;
+  this._wanted = false;
+}
+
+WalkStream.prototype._read = function(n) {
+  this._wanted = true;
+  this._fill();
+};
+
+WalkStream.prototype._fill = function() {
+  if (this.destroyed)
+    return;
+
+  while (this._wanted && this._reading < kWalkConcurrency &&
+         this._dirs.length > 0) {
+    this._readDir(this._dirs.pop());
+  }
+
+  if (this._reading === 0 && this._dirs.length === 0 && this._batch !== null) {
+    // push() may call _read() again synchronously, so clear the batch first.
+    const batch = this._batch;
+    this._batch = null;
+    if (batch.length > 0)
+      this.push(batch);
+    this.push(null);
+  }
+};
+
+WalkStream.prototype._readDir = function(item) {
+  const options = this._options;
+  var self = this;
+
+  this._reading++;
+  const req = new FSReqWrap();
+  req.oncomplete = function(err, result) {
+    if (err) return ondirents(err);
+    getDirents(item.dir, result, ondirents);
+  };
+  binding.readdir(pathModule._makeLong(item.dir), options.encoding, true, req);
+
+  function ondirents(err, dirents) {
+    if (self.destroyed)
+      return;
+    if (err) {
+      self.destroy();
+      self.emit('error', err);
+      return;
+    }
+
+    const subdirs = [];
+    for (var i = 0; i < dirents.length; i++) {
+      const dirent = dirents[i];
+      const name = dirent.name;
+      dirent.name = item.prefix + name;
+      if (options.filter !== undefined && !options.filter(dirent))
+        continue;
+      self._batch.push(dirent);
+      if (self._batch.length === self.batchSize) {
+        const batch = self._batch;
+        self._batch = [];
+        self._wanted = self.push(batch);
+      }
+      if (item.depth < options.depth && dirent.isDirectory()) {
+        subdirs.push({
+          dir: pathModule.join(item.dir, name),
+          prefix: dirent.name + pathModule.sep,
+          depth: item.depth + 1
+        });
+      }
+    }
+
+    // Push in reverse so that the first subdirectory is read next.
+    for (i = subdirs.length - 1; i >= 0; i--)
+      self._dirs.push(subdirs[i]);
+
+    // Only now, with the subdirectories queued, can the walk be complete.
+    self._reading--;
+    self._fill();
+  }
+};
+
+WalkStream.prototype.destroy = function() {
+  if (this.destroyed)
+    return;
+  this.destroyed = true;
+  this._dirs = [];
+  this._batch = null;
+  process.nextTick(() => this.emit('close'));
+};
+
+fs.walkSync = function(path, options) {
+  options = getWalkOptions(options);
+  nullCheck(path);
+  path = path.toString();
+
+  const entries = [];
+
+  function visit(dir, prefix, depth) {
+    const result = binding.readdir(pathModule._makeLong(dir), options.encoding,
+                                   true);
+    const dirents = getDirentsSync(dir, result);
+    for (var i = 0; i < dirents.length; i++) {
+      const dirent = dirents[i];
+      const name = dirent.name;
+      dirent.name = prefix + name;
+      if (options.filter !== undefined && !options.filter(dirent))
+        continue;
+      entries.push(dirent);
+      if (depth < options.depth && dirent.isDirectory())
+        visit(pathModule.join(dir, name), dirent.name + pathModule.sep,
+              depth + 1);
+    }
+  }
+
+  visit(path, '', 0);
+  return entries;
 };
 
 fs.fstat = function(fd, callback) {
@@ -1707,12 +1996,47 @@ function allocNewPool(poolSize) {
 }
 
 
+function lazyLoadStreams() {
+  if (Readable !== undefined)
+    return;
+  const Stream = require('stream');
+  Readable = Stream.Readable;
+  Writable = Stream.Writable;
+  util.inherits(ReadStream, Readable);
+  util.inherits(WriteStream, Writable);
+  util.inherits(WalkStream, Readable);
+  // There is no shutdown() for files.
+  WriteStream.prototype.destroySoon = WriteStream.prototype.end;
+}
+
+// Accessing one of the stream classes sets up their prototype chain first.
+// Assigning to the property replaces the class like it did before.
+function defineLazyStreamClass(name, ctor) {
+  Object.defineProperty(fs, name, {
+    configurable: true,
+    enumerable: true,
+    get: function() {
+      lazyLoadStreams();
+      return ctor;
+    },
+    set: function(value) {
+      Object.defineProperty(fs, name, {
+        configurable: true,
+        enumerable: true,
+        writable: true,
+        value: value
+      });
+    }
+  });
+}
+
+
 fs.createReadStream = function(path, options) {
+  lazyLoadStreams();
   return new ReadStream(path, options);
 };
 
-util.inherits(ReadStream, Readable);
-fs.ReadStream = ReadStream;
+defineLazyStreamClass('ReadStream', ReadStream);
 
 function ReadStream(path, options) {
   if (!(this instanceof ReadStream))
@@ -1763,7 +2087,7 @@ function ReadStream(path, options) {
   });
 }
 
-fs.FileReadStream = fs.ReadStream; // support the legacy name
+defineLazyStreamClass('FileReadStream', ReadStream); // the legacy name
 
 ReadStream.prototype.open = function() {
   var self = this;
@@ -1876,11 +2200,12 @@ ReadStream.prototype.close = function(cb) {
 
 
 fs.createWriteStream = function(path, options) {
+  lazyLoadStreams();
   return new WriteStream(path, options);
 };
 
-util.inherits(WriteStream, Writable);
-fs.WriteStream = WriteStream;
+defineLazyStreamClass('WriteStream', WriteStream);
+
 function WriteStream(path, options) {
   if (!(this instanceof WriteStream))
     return new WriteStream(path, options);
@@ -1924,7 +2249,7 @@ function WriteStream(path, options) {
   });
 }
 
-fs.FileWriteStream = fs.WriteStream; // support the legacy name
+defineLazyStreamClass('FileWriteStream', WriteStream); // the legacy name
 
 
 WriteStream.prototype.open = function() {
@@ -2016,15 +2341,20 @@ WriteStream.prototype._writev = function(data, cb) {
 WriteStream.prototype.destroy = ReadStream.prototype.destroy;
 WriteStream.prototype.close = ReadStream.prototype.close;
 
-// There is no shutdown() for files.
-WriteStream.prototype.destroySoon = WriteStream.prototype.end;
-
 // SyncWriteStream is internal. DO NOT USE.
 // todo(jasnell): "Docs-only" deprecation for now. This was never documented
 // so there's no documentation to modify. In the future, add a runtime
 // deprecation.
 Object.defineProperty(fs, 'SyncWriteStream', {
   configurable: true,
-  writable: true,
-  value: SyncWriteStream
+  get: function() {
+    return internalFS.SyncWriteStream;
+  },
+  set: function(value) {
+    Object.defineProperty(fs, 'SyncWriteStream', {
+      configurable: true,
+      writable: true,
+      value: value
+    });
+  }
 });
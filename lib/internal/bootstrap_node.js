@@ -38,6 +38,9 @@
 
     _process.setup_hrtime();
     _process.setup_cpuUsage();
+    _process.setup_callbackUsage();
+    _process.setup_threadpool();
+    _process.setup_loopUsage();
     _process.setupConfig(NativeModule._source);
     NativeModule.require('internal/process/warning').setup();
     NativeModule.require('internal/process/next_tick').setup();
@@ -45,13 +48,21 @@
     _process.setupKillAndExit();
     _process.setupSignalHandlers();
 
+    // Only the main thread talks to the parent process over IPC.
+    const isMainThread = process.binding('worker').isMainThread;
+
     // Do not initialize channel in debugger agent, it deletes env variable
     // and the main thread won't see it.
-    if (process.argv[1] !== '--debug-agent')
+    if (process.argv[1] !== '--debug-agent' && isMainThread)
       _process.setupChannel();
 
     _process.setupRawDebug();
 
+    if (process._cpuProfSignal && isMainThread) {
+      const profiler = NativeModule.require('internal/v8_profiler');
+      profiler.setupSignal(process._cpuProfSignal);
+    }
+
     Object.defineProperty(process, 'argv0', {
       enumerable: true,
       configurable: false,
@@ -64,7 +75,11 @@
     // others like the debugger or running --eval arguments. Here we decide
     // which mode we run in.
 
-    if (NativeModule.exists('_third_party_main')) {
+    if (!isMainThread) {
+      // The script to run is sent by the thread that started this one.
+      NativeModule.require('internal/worker').setupChild(evalScript);
+
+    } else if (NativeModule.exists('_third_party_main')) {
       // To allow people to extend Node in different ways, this hook allows
       // one to drop a file lib/_third_party_main.js into the build
       // directory which will be executed instead of Node's normal loading.
@@ -224,13 +239,38 @@
   }
 
   function setupGlobalTimeouts() {
-    const timers = NativeModule.require('timers');
-    global.clearImmediate = timers.clearImmediate;
-    global.clearInterval = timers.clearInterval;
-    global.clearTimeout = timers.clearTimeout;
-    global.setImmediate = timers.setImmediate;
-    global.setInterval = timers.setInterval;
-    global.setTimeout = timers.setTimeout;
+    // timers is only compiled when one of these is first used.
+    const names = ['clearImmediate', 'clearInterval', 'clearTimeout',
+                   'setImmediate', 'setInterval', 'setTimeout'];
+    names.forEach(function(name) {
+      defineLazyGlobal(name, function() {
+        return NativeModule.require('timers')[name];
+      });
+    });
+  }
+
+  // Define global[name] as a getter that calls load() on first access and
+  // then replaces itself with a plain data property, like an assignment to
+  // global[name] would have created.
+  function defineLazyGlobal(name, load) {
+    function define(value) {
+      Object.defineProperty(global, name, {
+        configurable: true,
+        enumerable: true,
+        writable: true,
+        value: value
+      });
+    }
+    Object.defineProperty(global, name, {
+      configurable: true,
+      enumerable: true,
+      get: function() {
+        const value = load();
+        define(value);
+        return value;
+      },
+      set: define
+    });
   }
 
   function setupGlobalConsole() {
@@ -426,6 +466,10 @@
   // node binary, so they can be loaded faster.
 
   const ContextifyScript = process.binding('contextify').ContextifyScript;
+  // V8 code cache for the core modules, produced at build time by
+  // tools/generate_code_cache.js. Empty unless node was configured with
+  // --code-cache-path.
+  const getCodeCache = process.binding('code_cache').get;
   function runInThisContext(code, options) {
     const script = new ContextifyScript(code, options);
     return script.runInThisContext();
@@ -442,6 +486,19 @@
   NativeModule._source = process.binding('natives');
   NativeModule._cache = {};
 
+  // --trace-module-load prints the compile and total load time of each core
+  // module. The native process.hrtime() and process._rawDebug() are used as
+  // the JS versions are only set up by the modules being measured.
+  const traceModuleLoad = !!process._traceModuleLoad;
+  const rawHrtime = process.hrtime;
+  const rawDebug = process._rawDebug;
+  const hrValues = new Uint32Array(3);
+
+  function now() {
+    rawHrtime(hrValues);
+    return (hrValues[0] * 0x100000000 + hrValues[1]) * 1e3 + hrValues[2] / 1e6;
+  }
+
   NativeModule.require = function(id) {
     if (id === 'native_module') {
       return NativeModule;
@@ -459,10 +516,17 @@
     process.moduleLoadList.push(`NativeModule ${id}`);
 
     const nativeModule = new NativeModule(id);
+    const start = traceModuleLoad ? now() : 0;
 
     nativeModule.cache();
     nativeModule.compile();
 
+    if (traceModuleLoad) {
+      rawDebug(`[module-load] ${id}: ` +
+               `compile ${nativeModule.compileTime.toFixed(3)} ms, ` +
+               `total ${(now() - start).toFixed(3)} ms`);
+    }
+
     return nativeModule.exports;
   };
 
@@ -515,11 +579,15 @@
     this.loading = true;
 
     try {
+      const start = traceModuleLoad ? now() : 0;
       const fn = runInThisContext(source, {
         filename: this.filename,
         lineOffset: 0,
-        displayErrors: true
+        displayErrors: true,
+        cachedData: getCodeCache(this.id)
       });
+      if (traceModuleLoad)
+        this.compileTime = now() - start;
       fn(this.exports, NativeModule.require, this, this.filename);
 
       this.loaded = true;
@@ -1,6 +1,5 @@
 'use strict';
 
-const StringDecoder = require('string_decoder').StringDecoder;
 const Buffer = require('buffer').Buffer;
 const EventEmitter = require('events');
 const net = require('net');
@@ -17,6 +16,8 @@ const TTY = process.binding('tty_wrap').TTY;
 const TCP = process.binding('tcp_wrap').TCP;
 const UDP = process.binding('udp_wrap').UDP;
 const SocketList = require('internal/socket_list');
+const channelSerialization = require('internal/child_process/serialization');
+const shmChannel = require('internal/child_process/shm_channel');
 
 const errnoException = util._errnoException;
 const SocketListSend = SocketList.SocketListSend;
@@ -169,6 +170,7 @@ function ChildProcess() {
   this._closesNeeded = 1;
   this._closesGot = 0;
   this.connected = false;
+  this.sharedMemoryChannel = null;
 
   this.signalCode = null;
   this.exitCode = null;
@@ -271,16 +273,35 @@ ChildProcess.prototype.spawn = function(options) {
   // If no `stdio` option was given - use default
   var stdio = options.stdio || 'pipe';
 
+  const serialization = options.serialization || 'json';
+  if (serialization !== 'json' && serialization !== 'advanced') {
+    throw new TypeError('"serialization" must be "json" or "advanced"');
+  }
+
   stdio = _validateStdio(stdio, false);
 
   ipc = stdio.ipc;
   ipcFd = stdio.ipcFd;
   stdio = options.stdio = stdio.stdio;
 
+  var sharedMemoryChannel = null;
+  if (options.sharedMemoryChannel) {
+    if (ipc === undefined)
+      throw new Error('"sharedMemoryChannel" requires an IPC channel');
+    const shm = shmChannel.createSharedMemoryChannel(
+        options.sharedMemoryChannel);
+    sharedMemoryChannel = shm.channel;
+    // The child inherits the file descriptors right after its stdio.
+    const shmFds = shm.fds.map((fd) => stdio.push({ type: 'fd', fd }) - 1);
+    options.envPairs = options.envPairs || [];
+    options.envPairs.push('NODE_SHM_CHANNEL_FDS=' + shmFds.join(','));
+  }
+
   if (ipc !== undefined) {
     // Let child process know about opened IPC channel
     options.envPairs = options.envPairs || [];
     options.envPairs.push('NODE_CHANNEL_FD=' + ipcFd);
+    options.envPairs.push('NODE_CHANNEL_SERIALIZATION_MODE=' + serialization);
   }
 
   this.spawnfile = options.file;
@@ -299,7 +320,10 @@ ChildProcess.prototype.spawn = function(options) {
     // It's kind of silly that the de facto spec for ENOENT (the test suite)
     // mandates that stdio _is_ set up, even if there is no process on the
     // receiving end, but it is what it is.
-    if (err !== uv.UV_ENOENT) return err;
+    if (err !== uv.UV_ENOENT) {
+      if (sharedMemoryChannel !== null) sharedMemoryChannel.close();
+      return err;
+    }
   } else if (err) {
     // Close all opened fds on error
     stdio.forEach(function(stdio) {
@@ -307,6 +331,7 @@ ChildProcess.prototype.spawn = function(options) {
         stdio.handle.close();
       }
     });
+    if (sharedMemoryChannel !== null) sharedMemoryChannel.close();
 
     this._handle.close();
     this._handle = null;
@@ -349,7 +374,10 @@ ChildProcess.prototype.spawn = function(options) {
   });
 
   // Add .send() method and start listening for IPC data
-  if (ipc !== undefined) setupChannel(this, ipc);
+  if (ipc !== undefined) {
+    this.sharedMemoryChannel = sharedMemoryChannel;
+    setupChannel(this, ipc, serialization);
+  }
 
   return err;
 };
@@ -408,7 +436,7 @@ ChildProcess.prototype.unref = function() {
 };
 
 
-function setupChannel(target, channel) {
+function setupChannel(target, channel, serializationMode) {
   target.channel = channel;
 
   // _channel can be deprecated in version 8
@@ -440,21 +468,13 @@ function setupChannel(target, channel) {
     }
   }();
 
-  var decoder = new StringDecoder('utf8');
-  var jsonBuffer = '';
+  const serialization = channelSerialization[serializationMode];
+  serialization.initMessageChannel(channel);
   channel.buffering = false;
   channel.onread = function(nread, pool, recvHandle) {
     // TODO(bnoordhuis) Check that nread > 0.
     if (pool) {
-      jsonBuffer += decoder.write(pool);
-
-      var i, start = 0;
-
-      //Linebreak is used as a message end sign
-      while ((i = jsonBuffer.indexOf('\n', start)) >= 0) {
-        var json = jsonBuffer.slice(start, i);
-        var message = JSON.parse(json);
-
+      const onMessage = (message) => {
         // There will be at most one NODE_HANDLE message in every chunk we
         // read because SCM_RIGHTS messages don't get coalesced. Make sure
         // that we deliver the handle with the right message however.
@@ -462,11 +482,9 @@ function setupChannel(target, channel) {
           handleMessage(target, message, recvHandle);
         else
           handleMessage(target, message, undefined);
-
-        start = i + 1;
-      }
-      jsonBuffer = jsonBuffer.slice(start);
-      this.buffering = jsonBuffer.length !== 0;
+      };
+      this.buffering =
+          serialization.parseChannelMessages(this, pool, onMessage);
 
     } else {
       this.buffering = false;
@@ -631,8 +649,7 @@ function setupChannel(target, channel) {
     var req = new WriteWrap();
     req.async = false;
 
-    var string = JSON.stringify(message) + '\n';
-    var err = channel.writeUtf8String(req, string, handle);
+    var err = serialization.writeChannelMessage(channel, req, message, handle);
 
     if (err === 0) {
       if (handle) {
@@ -716,6 +733,11 @@ function setupChannel(target, channel) {
       fired = true;
 
       channel.close();
+      // The shared memory channel lives as long as the IPC channel.
+      if (target.sharedMemoryChannel) {
+        target.sharedMemoryChannel.close();
+        target.sharedMemoryChannel = null;
+      }
       target.emit('disconnect');
     }
 
@@ -0,0 +1,107 @@
+'use strict';
+
+const Buffer = require('buffer').Buffer;
+const StringDecoder = require('string_decoder').StringDecoder;
+const serdes = process.binding('serdes');
+
+const kStringDecoder = Symbol('stringDecoder');
+const kJSONBuffer = Symbol('jsonBuffer');
+const kChunks = Symbol('chunks');
+const kChunksLength = Symbol('chunksLength');
+const kFrameLength = Symbol('frameLength');
+
+// Every 'advanced' message is prefixed with its length as a big-endian
+// uint32.
+const kHeaderLength = 4;
+
+// The ways messages can be encoded on an IPC channel. Both ends of a
+// channel must use the same one, the parent passes it on to the child in
+// the NODE_CHANNEL_SERIALIZATION_MODE environment variable.
+//
+// parseChannelMessages() calls onMessage() for every complete message in
+// |pool| and returns true if an incomplete message is left in the channel.
+
+// One JSON document per line.
+const json = {
+  initMessageChannel(channel) {
+    channel[kStringDecoder] = new StringDecoder('utf8');
+    channel[kJSONBuffer] = '';
+  },
+
+  parseChannelMessages(channel, pool, onMessage) {
+    const jsonBuffer = channel[kJSONBuffer] +=
+        channel[kStringDecoder].write(pool);
+
+    var i, start = 0;
+
+    //Linebreak is used as a message end sign
+    while ((i = jsonBuffer.indexOf('\n', start)) >= 0) {
+      onMessage(JSON.parse(jsonBuffer.slice(start, i)));
+      start = i + 1;
+    }
+    channel[kJSONBuffer] = jsonBuffer.slice(start);
+    return channel[kJSONBuffer].length !== 0;
+  },
+
+  writeChannelMessage(channel, req, message, handle) {
+    const string = JSON.stringify(message) + '\n';
+    return channel.writeUtf8String(req, string, handle);
+  }
+};
+
+// Length-prefixed frames in the format of the serdes binding, which also
+// copies worker_threads messages. Buffers and typed arrays are sent as
+// binary data, not as JSON arrays of numbers, and messages are read
+// directly from the buffers that come from the pipe. Only a message that
+// spans several reads is copied, once.
+const advanced = {
+  initMessageChannel(channel) {
+    channel[kChunks] = [];
+    channel[kChunksLength] = 0;
+    // The length of the incomplete message in kChunks, including its
+    // header, or 0 if the header is incomplete too.
+    channel[kFrameLength] = 0;
+  },
+
+  parseChannelMessages(channel, pool, onMessage) {
+    var buffer = pool;
+    const chunks = channel[kChunks];
+    if (chunks.length !== 0) {
+      chunks.push(pool);
+      channel[kChunksLength] += pool.length;
+      if (channel[kChunksLength] < channel[kFrameLength])
+        return true;
+      buffer = Buffer.concat(chunks, channel[kChunksLength]);
+      chunks.length = 0;
+      channel[kChunksLength] = 0;
+    }
+
+    var offset = 0;
+    while (buffer.length - offset >= kHeaderLength) {
+      const length = buffer.readUInt32BE(offset, true);
+      const end = offset + kHeaderLength + length;
+      if (end > buffer.length)
+        break;
+      onMessage(serdes.deserialize(buffer, offset + kHeaderLength, length));
+      offset = end;
+    }
+
+    if (offset === buffer.length)
+      return false;
+
+    const rest = offset === 0 ? buffer : buffer.slice(offset);
+    chunks.push(rest);
+    channel[kChunksLength] = rest.length;
+    channel[kFrameLength] = rest.length >= kHeaderLength ?
+        kHeaderLength + rest.readUInt32BE(0, true) : 0;
+    return true;
+  },
+
+  writeChannelMessage(channel, req, message, handle) {
+    const buffer = serdes.serialize(message, kHeaderLength);
+    buffer.writeUInt32BE(buffer.length - kHeaderLength, 0, true);
+    return channel.writeBuffer(req, buffer, handle);
+  }
+};
+
+module.exports = { json, advanced };
@@ -0,0 +1,107 @@
+'use strict';
+
+const EventEmitter = require('events');
+const binding = process.binding('shm_channel_wrap');
+
+// The size of each of the two rings, i.e. the amount of messages that can
+// be in flight in either direction.
+const kDefaultSize = 1024 * 1024;
+
+function onmessage(message) {
+  this.owner.emit('message', message);
+}
+
+// The other process wrote something that is not a message, or the channel
+// could not be polled. Nothing more can be read from it.
+function onerror(err) {
+  const owner = this.owner;
+  owner.close();
+  owner.emit('error', err);
+}
+
+function ondrain() {
+  const owner = this.owner;
+  owner._queued = false;
+  owner._updateRef();
+  owner.emit('drain');
+}
+
+// A message channel between a parent and a child process that passes
+// messages through shared memory instead of the IPC pipe, see
+// src/shm_channel_wrap.cc. Messages are copied like worker_threads
+// messages. Handles can only be sent with the send() method of the IPC
+// channel, which is kept open alongside.
+class SharedMemoryChannel extends EventEmitter {
+  constructor(fds, isParent) {
+    super();
+    this._handle = new binding.ShmChannel(fds, isParent);
+    this._handle.owner = this;
+    this._handle.onmessage = onmessage;
+    this._handle.ondrain = ondrain;
+    this._handle.onerror = onerror;
+    this._messageListeners = 0;
+    this._queued = false;
+    this._updateRef();
+    this.on('newListener', (name) => {
+      if (name === 'message' && ++this._messageListeners === 1)
+        this._updateRef();
+    });
+    this.on('removeListener', (name) => {
+      if (name === 'message' && --this._messageListeners === 0)
+        this._updateRef();
+    });
+  }
+
+  // Like the IPC channel, only keep the event loop alive while someone is
+  // listening for messages or messages are waiting to be sent.
+  _updateRef() {
+    if (this._handle === null)
+      return;
+    if (this._messageListeners > 0 || this._queued)
+      this._handle.ref();
+    else
+      this._handle.unref();
+  }
+
+  // Returns false if the channel is full. The message is then queued and
+  // sent once the other process has caught up, 'drain' is emitted when all
+  // queued messages have been sent.
+  postMessage(message) {
+    if (this._handle === null)
+      throw new Error('Shared memory channel is closed');
+    if (this._handle.postMessage(message))
+      return true;
+    if (!this._queued) {
+      this._queued = true;
+      this._updateRef();
+    }
+    return false;
+  }
+
+  close() {
+    if (this._handle === null)
+      return;
+    this._handle.close();
+    this._handle = null;
+    process.nextTick(() => this.emit('close'));
+  }
+}
+
+// Creates the shared memory and eventfds of a new channel in the parent.
+// The file descriptors are passed on to the child, which opens the other
+// end with new SharedMemoryChannel(fds, false).
+function createSharedMemoryChannel(option) {
+  const size = option === true ? kDefaultSize : option;
+  if (typeof size !== 'number' || size >>> 0 !== size) {
+    throw new TypeError(
+        '"sharedMemoryChannel" must be a boolean or a size in bytes');
+  }
+  const fds = binding.createFds(size);
+  const channel = new SharedMemoryChannel(fds, true);
+  return { channel, fds };
+}
+
+module.exports = {
+  SharedMemoryChannel,
+  createSharedMemoryChannel
+};
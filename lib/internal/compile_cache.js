@@ -0,0 +1,110 @@
+'use strict';
+
+// On-disk V8 code cache for modules loaded through require(), enabled by
+// setting the NODE_COMPILE_CACHE environment variable to a directory.
+//
+// The code cache produced for a module wrapper is stored in a file named
+// after the SHA-256 hash of the wrapper source, in a subdirectory for the
+// V8 version and architecture. Loading the module again passes it back to
+// V8 as cachedData, which skips most of the parsing and compiling.
+
+const fs = require('fs');
+const path = require('path');
+const vm = require('vm');
+const debug = require('util').debuglog('module');
+const threadId = process.binding('worker').threadId;
+// Hash with the binding directly. require('crypto') would load the crypto
+// module and its stream wrappers on the startup path that the cache is meant
+// to speed up.
+const Hash = process.binding('crypto').Hash;
+
+function CompileCache(dir) {
+  this.dir = path.join(path.resolve(dir),
+                       `v8-${process.versions.v8}-${process.arch}`);
+  this.hits = 0;
+  this.misses = 0;
+  this.rejected = 0;
+  this.ready = false;
+}
+
+// Create the cache directory the first time a cache file is written.
+CompileCache.prototype.mkdir = function() {
+  if (this.ready)
+    return true;
+
+  const dirs = [path.dirname(this.dir), this.dir];
+  for (var i = 0; i < dirs.length; i++) {
+    try {
+      fs.mkdirSync(dirs[i]);
+    } catch (e) {
+      if (e.code !== 'EEXIST') {
+        debug('cannot create compile cache directory %s: %s', dirs[i], e);
+        return false;
+      }
+    }
+  }
+  return this.ready = true;
+};
+
+CompileCache.prototype.write = function(cacheFile, data) {
+  if (!this.mkdir())
+    return;
+
+  // Other processes may be reading the same file, write it atomically.
+  // Worker threads share the pid, so the thread id is part of the name, and
+  // 'wx' makes sure that no two writers ever share the file.
+  const tmp = `${cacheFile}.${process.pid}.${threadId}.tmp`;
+  try {
+    fs.writeFileSync(tmp, data, { flag: 'wx' });
+    fs.renameSync(tmp, cacheFile);
+  } catch (e) {
+    debug('cannot write compile cache file %s: %s', cacheFile, e);
+    if (e.code === 'EEXIST')
+      return;
+    try {
+      fs.unlinkSync(tmp);
+    } catch (err) {}
+  }
+};
+
+// Compile |wrapper| like vm.runInThisContext() does, using and updating the
+// code cache.
+CompileCache.prototype.compile = function(wrapper, filename) {
+  const hash = new Hash('sha256');
+  hash.update(wrapper, 'utf8');
+  const cacheFile = path.join(this.dir, hash.digest('hex'));
+
+  var cachedData;
+  try {
+    cachedData = fs.readFileSync(cacheFile);
+  } catch (e) {}
+
+  const options = {
+    filename: filename,
+    lineOffset: 0,
+    displayErrors: true,
+    cachedData: cachedData,
+    produceCachedData: cachedData === undefined
+  };
+  const script = new vm.Script(wrapper, options);
+
+  if (cachedData === undefined) {
+    this.misses++;
+    if (script.cachedDataProduced)
+      this.write(cacheFile, script.cachedData);
+  } else if (script.cachedDataRejected) {
+    // Typically caused by different V8 flags. Remove the file so that the
+    // next process produces a fresh one.
+    this.rejected++;
+    debug('compile cache rejected for %s', filename);
+    try {
+      fs.unlinkSync(cacheFile);
+    } catch (e) {}
+  } else {
+    this.hits++;
+  }
+
+  return script.runInThisContext(options);
+};
+
+module.exports = CompileCache;
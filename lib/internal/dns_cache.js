@@ -0,0 +1,190 @@
+'use strict';
+
+// In-process cache of DNS results, enabled with dns.setCache().
+//
+// Answers to queries expire with their TTL, the smallest one of the records
+// in the answer, which cares_wrap passes along. getaddrinfo() does not report
+// TTLs, so lookups are kept for a fixed time. Failures that mean that a name
+// or record does not exist are cached as well, for a shorter time; other
+// failures are not.
+//
+// An entry that expired less than `staleTtl` seconds ago is still returned,
+// and refreshed in the background. Requests for a name that is being resolved
+// wait for that resolution instead of starting their own. The resolution is
+// not started in the domain or async context of any of them, and each one is
+// answered in its own.
+
+const uv = process.binding('uv');
+const now = process.binding('timer_wrap').Timer.now;
+// Element 0 is the current async context, see src/async-wrap.cc.
+const asyncContext = process.binding('async_wrap').asyncContext;
+
+const kDefaults = {
+  maxTtl: 300,
+  lookupTtl: 30,
+  negativeTtl: 5,
+  staleTtl: 0,
+  maxEntries: 1000
+};
+
+function isNegative(err) {
+  return err === 'ENOTFOUND' || err === 'ENODATA' ||
+         err === uv.UV_EAI_NONAME || err === uv.UV_EAI_NODATA;
+}
+
+function DnsCache(options) {
+  for (const name of Object.keys(kDefaults)) {
+    var value = options[name];
+    if (value === undefined) {
+      value = kDefaults[name];
+    } else if (typeof value !== 'number' || !(value >= 0)) {
+      throw new TypeError(`"${name}" must be a non-negative number`);
+    }
+    this[name] = value;
+  }
+  // Key -> entry, in the order they were last resolved.
+  this.entries = new Map();
+}
+
+// Calls `callback(err, result, extra, age)` with the cached result for `key`,
+// or after `resolve(done)` has called `done(err, result, ttl, extra)`. `age`
+// is the number of seconds since the result was resolved, and `ttl` the
+// number of seconds it can be cached for, if known.
+DnsCache.prototype.fetch = function(key, type, name, resolve, callback) {
+  const t = now();
+  var entry = this.entries.get(key);
+  if (entry !== undefined && entry.updated !== -1) {
+    if (t < entry.expires) {
+      entry.hits++;
+      return deliver(entry, callback, t);
+    }
+    if (t < entry.staleUntil) {
+      entry.staleHits++;
+      deliver(entry, callback, t);
+      if (entry.pending === null)
+        this.refresh(key, entry, resolve);
+      return;
+    }
+  }
+
+  if (entry === undefined) {
+    entry = {
+      type: type,
+      name: name,
+      err: null,
+      result: null,
+      extra: undefined,
+      updated: -1,
+      expires: 0,
+      staleUntil: 0,
+      hits: 0,
+      staleHits: 0,
+      misses: 0,
+      resolutions: 0,
+      pending: null
+    };
+    this.entries.set(key, entry);
+    if (this.entries.size > this.maxEntries)
+      this.entries.delete(this.entries.keys().next().value);
+  }
+  entry.misses++;
+  if (entry.pending !== null)
+    return entry.pending.push(bindToCaller(callback));
+  entry.pending = [bindToCaller(callback)];
+  this.refresh(key, entry, resolve);
+};
+
+DnsCache.prototype.refresh = function(key, entry, resolve) {
+  if (entry.pending === null)
+    entry.pending = [];
+  entry.resolutions++;
+  const context = asyncContext[0];
+  asyncContext[0] = undefined;
+  resolve((err, result, ttl, extra) => {
+    const waiting = entry.pending;
+    entry.pending = null;
+    if (!err || isNegative(err)) {
+      const t = now();
+      if (err)
+        ttl = this.negativeTtl;
+      else if (ttl === undefined)
+        ttl = this.lookupTtl;
+      ttl = Math.min(ttl, this.maxTtl);
+      entry.err = err || null;
+      entry.result = result;
+      entry.extra = extra;
+      entry.updated = t;
+      entry.expires = t + ttl * 1000;
+      entry.staleUntil = entry.expires + this.staleTtl * 1000;
+      // Keep the entries in the order they were resolved, so the ones that
+      // are evicted first are the least recently resolved ones.
+      if (this.entries.get(key) === entry) {
+        this.entries.delete(key);
+        this.entries.set(key, entry);
+      }
+    } else if (entry.updated === -1 && this.entries.get(key) === entry) {
+      this.entries.delete(key);
+    }
+    for (var i = 0; i < waiting.length; i++)
+      waiting[i](err, copy(result), extra, 0);
+  });
+  asyncContext[0] = context;
+};
+
+DnsCache.prototype.getEntries = function() {
+  const t = now();
+  const entries = [];
+  for (const entry of this.entries.values()) {
+    if (entry.updated === -1)
+      continue;
+    entries.push({
+      type: entry.type,
+      name: entry.name,
+      error: typeof entry.err === 'number' ? uv.errname(entry.err) : entry.err,
+      expiresIn: (entry.expires - t) / 1000,
+      hits: entry.hits,
+      staleHits: entry.staleHits,
+      misses: entry.misses,
+      resolutions: entry.resolutions
+    });
+  }
+  return entries;
+};
+
+// Results are copied so that callers can not change what is cached. Records
+// such as MX, SRV and SOA ones are objects, and TXT records are arrays.
+function copy(result) {
+  if (Array.isArray(result))
+    return result.map(copy);
+  if (result !== null && typeof result === 'object') {
+    const record = {};
+    for (const name of Object.keys(result))
+      record[name] = copy(result[name]);
+    return record;
+  }
+  return result;
+}
+
+// Returns a function that calls `callback` in the domain and async context
+// that are current now, for requests that wait for another one's resolution.
+function bindToCaller(callback) {
+  const context = asyncContext[0];
+  const domain = process.domain;
+  return function(err, result, extra, age) {
+    const previous = asyncContext[0];
+    asyncContext[0] = context;
+    if (domain)
+      domain.enter();
+    callback(err, result, extra, age);
+    if (domain)
+      domain.exit();
+    asyncContext[0] = previous;
+  };
+}
+
+function deliver(entry, callback, t) {
+  callback(entry.err, copy(entry.result), entry.extra,
+           (t - entry.updated) / 1000);
+}
+
+module.exports = DnsCache;
@@ -1,7 +1,6 @@
 'use strict';
 
 const Buffer = require('buffer').Buffer;
-const Writable = require('stream').Writable;
 const fs = require('fs');
 const util = require('util');
 const constants = process.binding('constants').fs;
@@ -56,6 +55,10 @@ function stringToFlags(flag) {
 }
 exports.stringToFlags = stringToFlags;
 
+// Loaded together with SyncWriteStream so that requiring fs does not load the
+// stream modules.
+var Writable;
+
 // Temporary hack for process.stdout and process.stderr when piped to files.
 function SyncWriteStream(fd, options) {
   Writable.call(this);
@@ -69,8 +72,6 @@ function SyncWriteStream(fd, options) {
   this.on('end', () => this._destroy());
 }
 
-util.inherits(SyncWriteStream, Writable);
-
 SyncWriteStream.prototype._write = function(chunk, encoding, cb) {
   fs.writeSync(this.fd, chunk, 0, chunk.length);
   cb();
@@ -95,6 +96,15 @@ SyncWriteStream.prototype.destroy = function() {
   return true;
 };
 
-exports.SyncWriteStream = SyncWriteStream;
+Object.defineProperty(exports, 'SyncWriteStream', {
+  enumerable: true,
+  get: function() {
+    if (Writable === undefined) {
+      Writable = require('stream').Writable;
+      util.inherits(SyncWriteStream, Writable);
+    }
+    return SyncWriteStream;
+  }
+});
 
 exports.realpathCacheKey = Symbol('realpathCacheKey');
@@ -9,8 +9,11 @@ function lazyConstants() {
   return _lazyConstants;
 }
 
+exports.setup_callbackUsage = setup_callbackUsage;
 exports.setup_cpuUsage = setup_cpuUsage;
 exports.setup_hrtime = setup_hrtime;
+exports.setup_loopUsage = setup_loopUsage;
+exports.setup_threadpool = setup_threadpool;
 exports.setupConfig = setupConfig;
 exports.setupKillAndExit = setupKillAndExit;
 exports.setupSignalHandlers = setupSignalHandlers;
@@ -74,6 +77,256 @@ function setup_cpuUsage() {
 }
 
 
+// Set up the process.callbackUsage() function.
+function setup_callbackUsage() {
+  var providers = null;
+  var callbackValues = null;
+
+  process.callbackUsage = function callbackUsage() {
+    const binding = process.binding('async_wrap');
+    if (providers === null) {
+      providers = [];
+      for (const name in binding.Providers)
+        providers[binding.Providers[name]] = name;
+      callbackValues = new Float64Array(3 * providers.length);
+    }
+
+    binding.getCallbackStats(callbackValues);
+
+    // Times are reported in nanoseconds, return microseconds like
+    // process.cpuUsage() does.
+    const usage = {};
+    for (var i = 0; i < providers.length; i++) {
+      const count = callbackValues[3 * i];
+      if (count === 0)
+        continue;
+      usage[providers[i]] = {
+        count: count,
+        time: callbackValues[3 * i + 1] / 1e3,
+        max: callbackValues[3 * i + 2] / 1e3
+      };
+    }
+    return usage;
+  };
+}
+
+
+// Set up the process.threadpoolUsage(), process.threadpoolInfo() and
+// process.setThreadpoolSize() functions.
+function setup_threadpool() {
+  const _threadpoolUsage = process.threadpoolUsage;
+  const _threadpoolInfo = process.threadpoolInfo;
+  const _setThreadpoolSize = process.setThreadpoolSize;
+
+  // Keep in sync with uv_work_class_t, UV_THREADPOOL_HISTOGRAM_SIZE and
+  // ThreadpoolUsage() in src/node.cc.
+  const classes = ['fs', 'dns', 'cpu', 'user'];
+  const kHistogramSize = 24;
+  const kFieldsPerClass = 6 + 2 * kHistogramSize;
+  const kMaxThreadpoolSize = 128;
+  const usageValues = new Float64Array(classes.length * kFieldsPerClass);
+  const infoValues = new Float64Array(5);
+
+  process.threadpoolUsage = function threadpoolUsage() {
+    _threadpoolUsage(usageValues);
+
+    const usage = {};
+    for (var i = 0; i < classes.length; i++) {
+      const offset = i * kFieldsPerClass;
+      const histograms = offset + 6;
+      // Wait and run times are reported in nanoseconds, return microseconds
+      // like process.cpuUsage() does.
+      usage[classes[i]] = {
+        limit: usageValues[offset],
+        queued: usageValues[offset + 1],
+        running: usageValues[offset + 2],
+        completed: usageValues[offset + 3],
+        waitTime: usageValues[offset + 4] / 1e3,
+        runTime: usageValues[offset + 5] / 1e3,
+        waitHistogram: Array.from(
+            usageValues.subarray(histograms, histograms + kHistogramSize)),
+        runHistogram: Array.from(
+            usageValues.subarray(histograms + kHistogramSize,
+                                 histograms + 2 * kHistogramSize))
+      };
+    }
+    return usage;
+  };
+
+  process.threadpoolInfo = function threadpoolInfo() {
+    _threadpoolInfo(infoValues);
+    return {
+      min: infoValues[0],
+      max: infoValues[1],
+      size: infoValues[2],
+      active: infoValues[2] - infoValues[3],
+      queued: infoValues[4]
+    };
+  };
+
+  process.setThreadpoolSize = function setThreadpoolSize(min, max) {
+    if (max === undefined)
+      max = min;
+    if (!isValidSize(min))
+      throw new RangeError('"min" must be an integer between 1 and ' +
+                           kMaxThreadpoolSize);
+    if (!isValidSize(max) || max < min)
+      throw new RangeError('"max" must be an integer between "min" and ' +
+                           kMaxThreadpoolSize);
+
+    const err = _setThreadpoolSize(min, max);
+    if (err) {
+      const errnoException = require('util')._errnoException;
+      throw errnoException(err, 'setThreadpoolSize');
+    }
+  };
+
+  function isValidSize(size) {
+    return Number.isInteger(size) && size >= 1 && size <= kMaxThreadpoolSize;
+  }
+}
+
+
+// Set up the process.loopUsage() and process.monitorLoopDelay() functions.
+function setup_loopUsage() {
+  const _loopUsage = process.loopUsage;
+
+  // Keep in sync with uv_loop_phase_t and LoopUsage() in src/node.cc.
+  const phases = ['timers', 'pending', 'prepare', 'poll', 'check', 'close'];
+  const loopValues = new Float64Array(2 + phases.length);
+
+  process.loopUsage = function loopUsage(prevValue) {
+    if (prevValue !== undefined &&
+        (prevValue === null || typeof prevValue !== 'object')) {
+      throw new TypeError('"prevValue" argument must be an object');
+    }
+
+    const errmsg = _loopUsage(loopValues);
+    if (errmsg) {
+      throw new Error('unable to obtain loop usage: ' + errmsg);
+    }
+
+    // Times are reported in nanoseconds, return microseconds like
+    // process.cpuUsage() does.
+    const usage = {
+      iterations: loopValues[0],
+      idle: loopValues[1] / 1e3
+    };
+    for (var i = 0; i < phases.length; i++)
+      usage[phases[i]] = loopValues[2 + i] / 1e3;
+
+    if (prevValue) {
+      for (const key in usage)
+        usage[key] -= prevValue[key] || 0;
+    }
+    return usage;
+  };
+
+  process.monitorLoopDelay = function monitorLoopDelay(options) {
+    if (options !== undefined &&
+        (options === null || typeof options !== 'object')) {
+      throw new TypeError('"options" argument must be an object');
+    }
+    const resolution = options && options.resolution !== undefined ?
+        options.resolution : 10;
+    if (!Number.isInteger(resolution) || resolution <= 0) {
+      throw new RangeError('"resolution" must be a positive integer');
+    }
+    return new LoopDelayMonitor(resolution);
+  };
+}
+
+
+// The delays are recorded by a LoopDelayMonitor handle in src/timer_wrap.cc,
+// into an array of summary fields and histogram buckets that is read here
+// without going to C++ or allocating.
+const kCount = 0;
+const kMin = 1;
+const kMax = 2;
+const kMean = 3;
+const kSquares = 4;
+const kSubBits = 6;
+
+function LoopDelayMonitor(resolution) {
+  const binding = process.binding('timer_wrap').LoopDelayMonitor;
+  this._binding = binding;
+  this._resolution = resolution;
+  this._fields = new Float64Array(binding.kFields + binding.kBuckets);
+  this._handle = null;
+}
+
+LoopDelayMonitor.prototype.enable = function() {
+  if (this._handle !== null)
+    return false;
+  this._handle = new this._binding(this._fields);
+  this._handle.unref();
+  this._handle.start(this._resolution);
+  return true;
+};
+
+LoopDelayMonitor.prototype.disable = function() {
+  if (this._handle === null)
+    return false;
+  this._handle.close();
+  this._handle = null;
+  return true;
+};
+
+LoopDelayMonitor.prototype.reset = function() {
+  this._fields.fill(0);
+};
+
+Object.defineProperties(LoopDelayMonitor.prototype, {
+  count: {
+    get: function() { return this._fields[kCount]; }
+  },
+  min: {
+    get: function() { return this._fields[kMin]; }
+  },
+  max: {
+    get: function() { return this._fields[kMax]; }
+  },
+  mean: {
+    get: function() { return this._fields[kMean]; }
+  },
+  stddev: {
+    get: function() {
+      const count = this._fields[kCount];
+      return count > 0 ? Math.sqrt(this._fields[kSquares] / count) : 0;
+    }
+  }
+});
+
+// Returns the largest delay that the bucket of the sample at the given
+// percentile holds, which is within 1/64 of the sample.
+LoopDelayMonitor.prototype.percentile = function(percentile) {
+  if (typeof percentile !== 'number' || !(percentile > 0 && percentile <= 100))
+    throw new RangeError('"percentile" must be a number in (0, 100]');
+
+  const fields = this._fields;
+  const count = fields[kCount];
+  if (count === 0)
+    return 0;
+
+  const target = Math.max(1, Math.ceil(percentile / 100 * count));
+  const kFields = this._binding.kFields;
+  let seen = 0;
+  for (var i = kFields; i < fields.length; i++) {
+    seen += fields[i];
+    if (seen >= target)
+      return Math.min(bucketHighest(i - kFields), fields[kMax]);
+  }
+  return fields[kMax];
+};
+
+function bucketHighest(bucket) {
+  const shift = (bucket >> kSubBits) - 1;
+  if (shift <= 0)
+    return bucket;
+  const width = Math.pow(2, shift);
+  return (bucket - (shift << kSubBits)) * width + width - 1;
+}
+
 function setup_hrtime() {
   const _hrtime = process.hrtime;
   const hrValues = new Uint32Array(3);
@@ -230,6 +483,16 @@ function setupChannel() {
     // Make sure it's not accidentally inherited by child processes.
     delete process.env.NODE_CHANNEL_FD;
 
+    const serializationMode =
+        process.env.NODE_CHANNEL_SERIALIZATION_MODE || 'json';
+    delete process.env.NODE_CHANNEL_SERIALIZATION_MODE;
+
+    var shmFds;
+    if (process.env.NODE_SHM_CHANNEL_FDS) {
+      shmFds = process.env.NODE_SHM_CHANNEL_FDS.split(',').map(Number);
+      delete process.env.NODE_SHM_CHANNEL_FDS;
+    }
+
     const cp = require('child_process');
 
     // Load tcp_wrap to avoid situation where we might immediately receive
@@ -237,7 +500,7 @@ function setupChannel() {
     // FIXME is this really necessary?
     process.binding('tcp_wrap');
 
-    cp._forkChild(fd);
+    cp._forkChild(fd, serializationMode, shmFds);
     assert(process.send);
   }
 }
@@ -5,6 +5,9 @@ exports.setup = setupNextTick;
 function setupNextTick() {
   const promises = require('internal/process/promises');
   const emitPendingUnhandledRejections = promises.setup(scheduleMicrotasks);
+  // Element 0 is the current async context, see src/async-wrap.cc. Every
+  // callback runs in the context that was current when it was queued.
+  const asyncContext = process.binding('async_wrap').asyncContext;
   var nextTickQueue = [];
   var microtasksScheduled = false;
 
@@ -46,7 +49,9 @@ function setupNextTick() {
 
     nextTickQueue.push({
       callback: runMicrotasksCallback,
-      domain: null
+      domain: null,
+      args: undefined,
+      context: undefined
     });
 
     tickInfo[kLength]++;
@@ -86,12 +91,14 @@ function setupNextTick() {
   // Using domains will cause this to be overridden.
   function _tickCallback() {
     var callback, args, tock;
+    const context = asyncContext[0];
 
     do {
       while (tickInfo[kIndex] < tickInfo[kLength]) {
         tock = nextTickQueue[tickInfo[kIndex]++];
         callback = tock.callback;
         args = tock.args;
+        asyncContext[0] = tock.context;
         // Using separate callback execution functions allows direct
         // callback invocation with small numbers of arguments to avoid the
         // performance hit associated with using `fn.apply()`
@@ -100,6 +107,7 @@ function setupNextTick() {
           tickDone();
       }
       tickDone();
+      asyncContext[0] = context;
       _runMicrotasks();
       emitPendingUnhandledRejections();
     } while (tickInfo[kLength] !== 0);
@@ -107,6 +115,7 @@ function setupNextTick() {
 
   function _tickDomainCallback() {
     var callback, domain, args, tock;
+    const context = asyncContext[0];
 
     do {
       while (tickInfo[kIndex] < tickInfo[kLength]) {
@@ -114,6 +123,7 @@ function setupNextTick() {
         callback = tock.callback;
         domain = tock.domain;
         args = tock.args;
+        asyncContext[0] = tock.context;
         if (domain)
           domain.enter();
         // Using separate callback execution functions allows direct
@@ -126,6 +136,7 @@ function setupNextTick() {
           domain.exit();
       }
       tickDone();
+      asyncContext[0] = context;
       _runMicrotasks();
       emitPendingUnhandledRejections();
     } while (tickInfo[kLength] !== 0);
@@ -148,7 +159,8 @@ function setupNextTick() {
     nextTickQueue.push({
       callback,
       domain: process.domain || null,
-      args
+      args,
+      context: asyncContext[0]
     });
     tickInfo[kLength]++;
   }
@@ -0,0 +1,172 @@
+'use strict';
+
+// On-disk cache of module resolutions, enabled by setting the
+// NODE_MODULE_RESOLUTION_CACHE environment variable to a file name.
+//
+// Every resolved request is stored together with the mtimes of the
+// directories (and package.json files) that were probed while resolving it.
+// Adding, removing or renaming a file changes the mtime of the directory it
+// lives in, so an entry is only reused when none of those have changed. That
+// takes one stat() per directory instead of one per candidate file name.
+
+const fs = require('fs');
+const path = require('path');
+const internalModuleMtime = process.binding('fs').internalModuleMtime;
+const threadId = process.binding('worker').threadId;
+
+// Bump when the layout of the cache file changes.
+const kVersion = 1;
+
+function ResolveCache(filename, options) {
+  this.filename = filename;
+  // Anything that changes the outcome of a resolution other than the file
+  // system, e.g. --preserve-symlinks. A cache written with different options
+  // is discarded.
+  this.options = options;
+  // Request key -> [filename, path1, mtime1, path2, mtime2, ...]
+  this.entries = Object.create(null);
+  // Package directory -> [main, mtime of package.json]
+  this.packages = Object.create(null);
+  // Path -> mtime, each path is only stat()ed once per process.
+  this.mtimes = new Map();
+  // Dependencies of the resolution in progress, or null.
+  this.recording = null;
+  this.dirty = false;
+}
+
+ResolveCache.prototype.load = function() {
+  var data;
+  try {
+    data = JSON.parse(fs.readFileSync(this.filename, 'utf8'));
+  } catch (e) {
+    // A missing or corrupt cache file is not an error, it is rebuilt.
+    return;
+  }
+  if (data === null || typeof data !== 'object' ||
+      data.version !== kVersion || data.options !== this.options ||
+      data.entries === null || typeof data.entries !== 'object' ||
+      data.packages === null || typeof data.packages !== 'object') {
+    return;
+  }
+  Object.assign(this.entries, data.entries);
+  Object.assign(this.packages, data.packages);
+};
+
+ResolveCache.prototype.save = function() {
+  if (!this.dirty)
+    return;
+  this.dirty = false;
+
+  const data = JSON.stringify({
+    version: kVersion,
+    options: this.options,
+    entries: this.entries,
+    packages: this.packages
+  });
+  // Write to a temporary file first so that a concurrently starting process
+  // never reads a partially written cache. Worker threads share the pid, so
+  // the thread id is part of the name, and 'wx' makes sure that no two
+  // writers ever share the file.
+  const tmp = `${this.filename}.${process.pid}.${threadId}.tmp`;
+  try {
+    fs.writeFileSync(tmp, data, { flag: 'wx' });
+    fs.renameSync(tmp, this.filename);
+  } catch (e) {
+    if (e.code === 'EEXIST')
+      return;
+    try {
+      fs.unlinkSync(tmp);
+    } catch (err) {}
+  }
+};
+
+ResolveCache.prototype.mtime = function(filename) {
+  var mtime = this.mtimes.get(filename);
+  if (mtime === undefined) {
+    mtime = internalModuleMtime(path._makeLong(filename));
+    this.mtimes.set(filename, mtime);
+  }
+  return mtime;
+};
+
+ResolveCache.prototype.isValid = function(entry, start) {
+  for (var i = start; i < entry.length; i += 2) {
+    if (this.mtime(entry[i]) !== entry[i + 1])
+      return false;
+  }
+  return true;
+};
+
+ResolveCache.prototype.lookup = function(key) {
+  const entry = this.entries[key];
+  if (entry === undefined)
+    return undefined;
+  if (this.isValid(entry, 1))
+    return entry[0];
+  delete this.entries[key];
+  this.dirty = true;
+  return undefined;
+};
+
+ResolveCache.prototype.lookupPackage = function(dir, jsonPath) {
+  const entry = this.packages[dir];
+  if (entry === undefined)
+    return undefined;
+  if (this.mtime(jsonPath) === entry[1])
+    return entry[0];
+  delete this.packages[dir];
+  this.dirty = true;
+  return undefined;
+};
+
+ResolveCache.prototype.storePackage = function(dir, jsonPath, main) {
+  const mtime = this.mtime(jsonPath);
+  if (mtime < 0)
+    return;
+  this.packages[dir] = [main === undefined ? null : main, mtime];
+  this.dirty = true;
+};
+
+ResolveCache.prototype.startRecording = function() {
+  this.recording = new Map();
+};
+
+// Record that the resolution in progress probed |filename|. The directory it
+// lives in is recorded, as adding or removing |filename| changes the mtime of
+// that directory. If the directory does not exist, the closest ancestor that
+// does is recorded instead.
+ResolveCache.prototype.recordProbe = function(filename) {
+  const recording = this.recording;
+  var dir = path.dirname(filename);
+  while (!recording.has(dir)) {
+    const mtime = this.mtime(dir);
+    recording.set(dir, mtime);
+    if (mtime >= 0)
+      break;
+    const parent = path.dirname(dir);
+    if (parent === dir)
+      break;
+    dir = parent;
+  }
+};
+
+// Record that the resolution in progress depends on the contents of
+// |filename|, e.g. a package.json file.
+ResolveCache.prototype.recordFile = function(filename) {
+  if (!this.recording.has(filename))
+    this.recording.set(filename, this.mtime(filename));
+};
+
+ResolveCache.prototype.stopRecording = function(key, filename) {
+  const recording = this.recording;
+  this.recording = null;
+  if (!filename)
+    return;
+
+  const entry = [filename];
+  recording.forEach((mtime, dep) => entry.push(dep, mtime));
+  this.entries[key] = entry;
+  this.dirty = true;
+};
+
+module.exports = ResolveCache;
@@ -0,0 +1,371 @@
+'use strict';
+
+// Sampling CPU profiler built on the V8 CpuProfiler, which interrupts the
+// main thread every `interval` microseconds to record its stack. The call
+// tree is turned into either a gzipped pprof profile.proto or the collapsed
+// stacks that flame graph tools read.
+//
+// The sampling heap profiler records the stack of about one allocation every
+// `interval` bytes, and reports those of the sampled objects that are still
+// alive as either a tree of plain objects or a pprof profile.
+
+const Buffer = require('buffer').Buffer;
+const binding = process.binding('v8');
+
+const kDefaultInterval = 10000;
+const kDefaultHeapInterval = 512 * 1024;
+const kDefaultStackDepth = 16;
+
+var running = null;
+var heapRunning = null;
+
+function checkOptions(options) {
+  if (options !== undefined &&
+      (options === null || typeof options !== 'object')) {
+    throw new TypeError('"options" argument must be an object');
+  }
+}
+
+function start(options) {
+  checkOptions(options);
+  const interval = options && options.interval !== undefined ?
+      options.interval : kDefaultInterval;
+  if (!Number.isInteger(interval) || interval <= 0 || interval > 0x7fffffff)
+    throw new RangeError('"interval" must be a positive integer');
+  if (running !== null)
+    throw new Error('CPU profile is already running');
+
+  running = { interval: interval, time: Date.now() };
+  process._startProfilerIdleNotifier();
+  binding.startCpuProfile(interval);
+}
+
+function stop(options) {
+  checkOptions(options);
+  const format = options && options.format !== undefined ?
+      options.format : 'pprof';
+  if (format !== 'pprof' && format !== 'collapsed')
+    throw new TypeError('"format" must be "pprof" or "collapsed"');
+  if (running === null)
+    throw new Error('CPU profile is not running');
+
+  const profile = binding.stopCpuProfile();
+  process._stopProfilerIdleNotifier();
+  const started = running;
+  running = null;
+  // V8 has no profile to return when it was not profiling after all.
+  if (profile === undefined)
+    throw new Error('CPU profile could not be collected');
+  profile.interval = started.interval;
+  profile.time = started.time;
+
+  const data = format === 'pprof' ? cpuToPprof(profile) : toCollapsed(profile);
+  if (options && options.file !== undefined)
+    require('fs').writeFileSync(options.file, data);
+  return data;
+}
+
+function startHeap(options) {
+  checkOptions(options);
+  const interval = options && options.interval !== undefined ?
+      options.interval : kDefaultHeapInterval;
+  const stackDepth = options && options.stackDepth !== undefined ?
+      options.stackDepth : kDefaultStackDepth;
+  if (!Number.isSafeInteger(interval) || interval <= 0)
+    throw new RangeError('"interval" must be a positive integer');
+  if (!Number.isInteger(stackDepth) || stackDepth <= 0 ||
+      stackDepth > 0x7fffffff) {
+    throw new RangeError('"stackDepth" must be a positive integer');
+  }
+  if (heapRunning !== null || !binding.startHeapProfile(interval, stackDepth))
+    throw new Error('Heap profile is already running');
+  heapRunning = { interval: interval, time: Date.now() };
+}
+
+function getHeap(options) {
+  checkOptions(options);
+  const format = options && options.format !== undefined ?
+      options.format : 'tree';
+  if (format !== 'tree' && format !== 'pprof')
+    throw new TypeError('"format" must be "tree" or "pprof"');
+  if (heapRunning === null)
+    throw new Error('Heap profile is not running');
+
+  const profile = binding.getHeapProfile();
+  profile.interval = heapRunning.interval;
+  profile.time = heapRunning.time;
+  if (format === 'tree')
+    return toTree(profile);
+  const data = heapToPprof(profile);
+  if (options && options.file !== undefined)
+    require('fs').writeFileSync(options.file, data);
+  return data;
+}
+
+function stopHeap() {
+  if (heapRunning === null)
+    throw new Error('Heap profile is not running');
+  binding.stopHeapProfile();
+  heapRunning = null;
+}
+
+// `file` is either a path or a file descriptor.
+function writeHeapSnapshot(file) {
+  if (typeof file !== 'string') {
+    if (!Number.isInteger(file) || file < 0 || file > 0x7fffffff)
+      throw new TypeError('"file" must be a path or a file descriptor');
+    return binding.writeHeapSnapshot(file);
+  }
+  const fs = require('fs');
+  const fd = fs.openSync(file, 'w');
+  try {
+    return binding.writeHeapSnapshot(fd);
+  } finally {
+    fs.closeSync(fd);
+  }
+}
+
+// Starts the profiler on the first signal and writes the profile to a file in
+// the working directory on the next one.
+function setupSignal(signal) {
+  const signals = process.binding('constants').os.signals;
+  if (!signals.hasOwnProperty(signal)) {
+    process.emitWarning(`--cpu-prof-signal: unknown signal ${signal}`);
+    return;
+  }
+  // Signals that node already uses for something else.
+  var owner = null;
+  if (signal === 'SIGUSR1')
+    owner = 'the debugger';
+  else if (signal === 'SIGUSR2' && process._callbackStats)
+    owner = '--callback-stats';
+  if (owner !== null) {
+    process.emitWarning(`--cpu-prof-signal: ${signal} is used by ${owner}, ` +
+                        'the CPU profiler cannot be started with it');
+    return;
+  }
+  process.on(signal, function() {
+    if (running === null)
+      return start();
+    const file = require('path').resolve(
+        `node-cpu-${process.pid}-${Date.now()}.pb.gz`);
+    stop({ file: file });
+    process._rawDebug(`CPU profile written to ${file}`);
+  });
+}
+
+function frameName(profile, node) {
+  const name = profile.names[node] || '(anonymous)';
+  const url = profile.urls[node];
+  if (!url)
+    return name;
+  return `${name} (${url}:${profile.lines[node]})`;
+}
+
+// One line per stack that was sampled: the frames from the outermost one,
+// separated by semicolons, followed by the number of samples.
+function toCollapsed(profile) {
+  const { parents, hits } = profile;
+  const stacks = new Array(parents.length);
+  var out = '';
+  // The root comes first and is not a frame.
+  stacks[0] = '';
+  for (var i = 1; i < parents.length; i++) {
+    const frame = frameName(profile, i).replace(/;/g, ':');
+    const parent = parents[i];
+    stacks[i] = parent === 0 ? frame : `${stacks[parent]};${frame}`;
+    if (hits[i] > 0)
+      out += `${stacks[i]} ${hits[i]}\n`;
+  }
+  return out;
+}
+
+// The nodes of the flattened tree as nested objects. `totalSize` and
+// `totalCount` include the children.
+function toTree(profile) {
+  const { names, urls, lines, parents, sizes, counts } = profile;
+  const nodes = new Array(parents.length);
+  for (var i = 0; i < parents.length; i++) {
+    nodes[i] = {
+      name: names[i],
+      url: urls[i],
+      line: lines[i],
+      selfSize: sizes[i],
+      selfCount: counts[i],
+      totalSize: sizes[i],
+      totalCount: counts[i],
+      children: []
+    };
+    if (i > 0)
+      nodes[parents[i]].children.push(nodes[i]);
+  }
+  // Children always come after their parent.
+  for (i = parents.length - 1; i > 0; i--) {
+    const parent = nodes[parents[i]];
+    parent.totalSize += nodes[i].totalSize;
+    parent.totalCount += nodes[i].totalCount;
+  }
+  return nodes[0];
+}
+
+// A minimal protocol buffers encoder, enough for profile.proto. Numbers are
+// never negative here.
+function ProtoWriter() {
+  this.bytes = [];
+}
+
+ProtoWriter.prototype.varint = function(n) {
+  while (n >= 0x80) {
+    this.bytes.push((n % 0x80) | 0x80);
+    n = Math.floor(n / 0x80);
+  }
+  this.bytes.push(n);
+};
+
+ProtoWriter.prototype.int = function(field, n) {
+  if (n === 0)
+    return;
+  this.varint(field * 8);
+  this.varint(n);
+};
+
+ProtoWriter.prototype.raw = function(field, bytes) {
+  this.varint(field * 8 + 2);
+  this.varint(bytes.length);
+  for (var i = 0; i < bytes.length; i++)
+    this.bytes.push(bytes[i]);
+};
+
+ProtoWriter.prototype.string = function(field, s) {
+  this.raw(field, Buffer.from(s, 'utf8'));
+};
+
+ProtoWriter.prototype.message = function(field, writer) {
+  this.raw(field, writer.bytes);
+};
+
+ProtoWriter.prototype.packed = function(field, values) {
+  const writer = new ProtoWriter();
+  for (var i = 0; i < values.length; i++)
+    writer.varint(values[i]);
+  this.message(field, writer);
+};
+
+function cpuToPprof(profile) {
+  const periodNanos = profile.interval * 1000;
+  const hits = profile.hits;
+  return toPprof(profile, {
+    sampleTypes: [['samples', 'count'], ['cpu', 'nanoseconds']],
+    values: (i) => hits[i] > 0 && [hits[i], hits[i] * periodNanos],
+    periodType: ['cpu', 'nanoseconds'],
+    period: periodNanos,
+    duration: Math.round((profile.endTime - profile.startTime) * 1000)
+  });
+}
+
+function heapToPprof(profile) {
+  const { counts, sizes } = profile;
+  return toPprof(profile, {
+    sampleTypes: [['objects', 'count'], ['space', 'bytes']],
+    values: (i) => counts[i] > 0 && [counts[i], sizes[i]],
+    periodType: ['space', 'bytes'],
+    period: profile.interval,
+    duration: (Date.now() - profile.time) * 1e6
+  });
+}
+
+// See https://github.com/google/pprof/blob/master/proto/profile.proto.
+// Every node of the call tree becomes a location with the same number, and
+// every distinct function, script and line a function. `desc.values(i)`
+// returns the values of the sample for node `i`, or false when it has none.
+function toPprof(profile, desc) {
+  const { names, urls, lines, parents } = profile;
+  const out = new ProtoWriter();
+
+  const strings = new Map([['', 0]]);
+  function str(s) {
+    var index = strings.get(s);
+    if (index === undefined) {
+      index = strings.size;
+      strings.set(s, index);
+    }
+    return index;
+  }
+
+  function valueType(type, unit) {
+    const writer = new ProtoWriter();
+    writer.int(1, str(type));
+    writer.int(2, str(unit));
+    return writer;
+  }
+
+  // sample_type
+  for (const [type, unit] of desc.sampleTypes)
+    out.message(1, valueType(type, unit));
+
+  // sample
+  for (var i = 1; i < parents.length; i++) {
+    const values = desc.values(i);
+    if (!values)
+      continue;
+    const sample = new ProtoWriter();
+    const stack = [];
+    for (var node = i; node !== 0; node = parents[node])
+      stack.push(node);
+    sample.packed(1, stack);
+    sample.packed(2, values);
+    out.message(2, sample);
+  }
+
+  // location and function
+  const functions = new Map();
+  const functionWriters = [];
+  for (i = 1; i < parents.length; i++) {
+    const name = names[i] || '(anonymous)';
+    const line = Math.max(lines[i], 0);
+    const key = `${name}\0${urls[i]}\0${line}`;
+    var id = functions.get(key);
+    if (id === undefined) {
+      id = functions.size + 1;
+      functions.set(key, id);
+      const fn = new ProtoWriter();
+      fn.int(1, id);
+      fn.int(2, str(name));
+      fn.int(4, str(urls[i]));
+      fn.int(5, line);
+      functionWriters.push(fn);
+    }
+    const lineWriter = new ProtoWriter();
+    lineWriter.int(1, id);
+    lineWriter.int(2, line);
+    const location = new ProtoWriter();
+    location.int(1, i);
+    location.message(4, lineWriter);
+    out.message(4, location);
+  }
+  for (i = 0; i < functionWriters.length; i++)
+    out.message(5, functionWriters[i]);
+
+  // Add the remaining fields before the string table, which they use.
+  const tail = new ProtoWriter();
+  tail.int(9, profile.time * 1e6);
+  tail.int(10, desc.duration);
+  tail.message(11, valueType(desc.periodType[0], desc.periodType[1]));
+  tail.int(12, desc.period);
+
+  for (const s of strings.keys())
+    out.string(6, s);
+
+  const buf = Buffer.from(out.bytes.concat(tail.bytes));
+  return require('zlib').gzipSync(buf);
+}
+
+module.exports = {
+  start,
+  stop,
+  setupSignal,
+  startHeap,
+  getHeap,
+  stopHeap,
+  writeHeapSnapshot
+};
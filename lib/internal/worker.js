@@ -0,0 +1,354 @@
+'use strict';
+
+const EventEmitter = require('events');
+const path = require('path');
+const util = require('util');
+
+const binding = process.binding('worker');
+const serialize = process.binding('serdes').serialize;
+const WorkerImpl = binding.Worker;
+
+const kHandle = Symbol('handle');
+const kPort = Symbol('port');
+
+// Every message between a worker and its parent is an array whose first
+// element is one of these.
+const messageTypes = {
+  LOAD_SCRIPT: 0,
+  UP_AND_RUNNING: 1,
+  USER_MESSAGE: 2,
+  ERROR: 3,
+  STDIO: 4
+};
+
+const errorConstructors = {
+  Error,
+  EvalError,
+  RangeError,
+  ReferenceError,
+  SyntaxError,
+  TypeError,
+  URIError
+};
+
+// Errors are not cloneable as such, their message and stack are not own
+// enumerable properties. Send those explicitly, and fall back to the
+// inspected error if its properties cannot be cloned either.
+function serializeError(error) {
+  if (!(error instanceof Error))
+    return tryCloneable({ value: error }) || { value: util.inspect(error) };
+
+  const serialized = {
+    isError: true,
+    name: String(error.name),
+    message: String(error.message),
+    stack: String(error.stack)
+  };
+  serialized.properties = Object.assign({}, error);
+  if (tryCloneable(serialized))
+    return serialized;
+  serialized.properties = {};
+  return serialized;
+}
+
+function tryCloneable(value) {
+  try {
+    serialize(value);
+    return value;
+  } catch (e) {
+    return null;
+  }
+}
+
+function deserializeError(serialized) {
+  if (!serialized.isError)
+    return serialized.value;
+
+  const Ctor = errorConstructors[serialized.name] || Error;
+  const error = new Ctor(serialized.message);
+  if (error.name !== serialized.name) {
+    Object.defineProperty(error, 'name', {
+      configurable: true,
+      writable: true,
+      value: serialized.name
+    });
+  }
+  Object.defineProperty(error, 'stack', {
+    configurable: true,
+    writable: true,
+    value: serialized.stack
+  });
+  return Object.assign(error, serialized.properties);
+}
+
+
+function Worker(filename, options) {
+  if (!(this instanceof Worker))
+    return new Worker(filename, options);
+
+  EventEmitter.call(this);
+
+  if (typeof filename !== 'string')
+    throw new TypeError('"filename" argument must be a string');
+
+  options = options || {};
+  if (typeof options !== 'object')
+    throw new TypeError('"options" argument must be an object');
+
+  if (!options.eval) {
+    if (!path.isAbsolute(filename) && !/^\.\.?[\\/]/.test(filename)) {
+      throw new TypeError('The worker script filename must be an absolute ' +
+                          'path or a relative path starting with ' +
+                          '\'./\' or \'../\'');
+    }
+    filename = path.resolve(filename);
+  }
+
+  const handle = new WorkerImpl([process.execPath], process.execArgv);
+  handle.owner = this;
+  handle.onexit = onexit;
+
+  const port = handle.messagePort;
+  port.owner = this;
+  port.onmessage = onmessage;
+  // The worker handle keeps the event loop alive while the thread runs.
+  port.unref();
+
+  try {
+    port.postMessage([messageTypes.LOAD_SCRIPT, {
+      filename: filename,
+      doEval: !!options.eval,
+      workerData: options.workerData
+    }]);
+  } catch (e) {
+    port.close();
+    handle.close();
+    throw e;
+  }
+
+  const err = handle.startThread();
+  if (err) {
+    port.close();
+    handle.close();
+    throw util._errnoException(err, 'uv_thread_create');
+  }
+
+  this[kHandle] = handle;
+  this[kPort] = port;
+  this.threadId = handle.threadId;
+}
+util.inherits(Worker, EventEmitter);
+
+Worker.prototype.postMessage = function(value) {
+  if (this[kHandle] === null)
+    return;
+  this[kPort].postMessage([messageTypes.USER_MESSAGE, value]);
+};
+
+Worker.prototype.terminate = function(callback) {
+  if (this[kHandle] === null)
+    return;
+  if (typeof callback === 'function')
+    this.once('exit', (code) => callback(null, code));
+  this[kHandle].terminate();
+};
+
+Worker.prototype.ref = function() {
+  if (this[kHandle] !== null)
+    this[kHandle].ref();
+};
+
+Worker.prototype.unref = function() {
+  if (this[kHandle] !== null)
+    this[kHandle].unref();
+};
+
+function onexit(code) {
+  const worker = this.owner;
+  const port = worker[kPort];
+  // Deliver what the thread sent before it stopped, e.g. its last output.
+  port.drain();
+  port.close();
+  this.close();
+  worker[kHandle] = null;
+  worker[kPort] = null;
+  worker.emit('exit', code);
+}
+
+function onmessage(message) {
+  const worker = this.owner;
+  switch (message[0]) {
+    case messageTypes.UP_AND_RUNNING:
+      return worker.emit('online');
+    case messageTypes.USER_MESSAGE:
+      return worker.emit('message', message[1]);
+    case messageTypes.ERROR:
+      return worker.emit('error', deserializeError(message[1]));
+    case messageTypes.STDIO:
+      return process[message[1]].write(message[2], message[3]);
+  }
+}
+
+
+// The worker thread's end of the channel to its parent.
+function ParentPort(handle) {
+  EventEmitter.call(this);
+  this[kHandle] = handle;
+}
+util.inherits(ParentPort, EventEmitter);
+
+ParentPort.prototype.postMessage = function(value) {
+  this[kHandle].postMessage([messageTypes.USER_MESSAGE, value]);
+};
+
+ParentPort.prototype.ref = function() {
+  this[kHandle].ref();
+};
+
+ParentPort.prototype.unref = function() {
+  this[kHandle].unref();
+};
+
+// Methods that change process-wide state.
+const unsupportedInWorker = [
+  'chdir',
+  'initgroups',
+  'setegid',
+  'seteuid',
+  'setgid',
+  'setgroups',
+  'setThreadpoolSize',
+  'setuid',
+  'umask'
+];
+
+function setupChild(evalScript) {
+  const handle = binding.parentPort;
+  const parentPort = exports.parentPort = new ParentPort(handle);
+  var loaded = false;
+  // Messages that arrive before the script has run, which for eval scripts
+  // is one tick after loading it.
+  var pending = [];
+
+  // Until the script is loaded the port has to keep the thread alive. After
+  // that, only while someone listens for messages.
+  parentPort.on('newListener', (name) => {
+    if (name === 'message' && loaded)
+      handle.ref();
+  });
+  parentPort.on('removeListener', (name) => {
+    if (name === 'message' && loaded &&
+        parentPort.listenerCount('message') === 0) {
+      handle.unref();
+    }
+  });
+
+  handle.onmessage = function(message) {
+    switch (message[0]) {
+      case messageTypes.LOAD_SCRIPT:
+        return loadScript(message[1]);
+      case messageTypes.USER_MESSAGE:
+        if (pending !== null)
+          return pending.push(message[1]);
+        return parentPort.emit('message', message[1]);
+    }
+  };
+
+  function loadScript(data) {
+    loaded = true;
+    exports.workerData = data.workerData;
+    if (parentPort.listenerCount('message') === 0)
+      handle.unref();
+    handle.postMessage([messageTypes.UP_AND_RUNNING]);
+
+    const Module = require('module');
+    if (process._preload_modules)
+      Module._preloadModules(process._preload_modules);
+
+    if (data.doEval) {
+      process._eval = data.filename;
+      process._print_eval = false;
+      evalScript('[worker eval]');
+    } else {
+      process.argv[1] = data.filename;
+      Module.runMain();
+    }
+
+    setImmediate(() => {
+      const messages = pending;
+      pending = null;
+      messages.forEach((value) => parentPort.emit('message', value));
+    });
+  }
+
+  setupStdio(handle);
+
+  unsupportedInWorker.forEach((name) => {
+    if (typeof process[name] !== 'function')
+      return;
+    process[name] = function() {
+      throw new Error(`process.${name}() is not supported in workers`);
+    };
+  });
+
+  // Report uncaught exceptions to the parent instead of printing them, then
+  // stop this thread only.
+  const fatalException = process._fatalException;
+  process._fatalException = function(error) {
+    if (!fatalException(error)) {
+      handle.postMessage([messageTypes.ERROR, serializeError(error)]);
+      process.reallyExit(1);
+    }
+    return true;
+  };
+}
+
+// stdout and stderr are forwarded to the parent, stdin is empty.
+function setupStdio(handle) {
+  const stream = require('stream');
+
+  function createWritable(name) {
+    const writable = new stream.Writable({
+      decodeStrings: false,
+      write(chunk, encoding, callback) {
+        handle.postMessage([messageTypes.STDIO, name, chunk, encoding]);
+        callback();
+      }
+    });
+    writable.destroy = writable.destroySoon = function(er) {
+      er = er || new Error(`process.${name} cannot be closed.`);
+      writable.emit('error', er);
+    };
+    return writable;
+  }
+
+  var stdin, stdout, stderr;
+  Object.defineProperty(process, 'stdout', {
+    configurable: true,
+    enumerable: true,
+    get: () => stdout || (stdout = createWritable('stdout'))
+  });
+  Object.defineProperty(process, 'stderr', {
+    configurable: true,
+    enumerable: true,
+    get: () => stderr || (stderr = createWritable('stderr'))
+  });
+  Object.defineProperty(process, 'stdin', {
+    configurable: true,
+    enumerable: true,
+    get: () => {
+      if (!stdin) {
+        stdin = new stream.Readable({ read() {} });
+        stdin.push(null);
+      }
+      return stdin;
+    }
+  });
+}
+
+exports.Worker = Worker;
+exports.isMainThread = binding.isMainThread;
+exports.threadId = binding.threadId;
+exports.parentPort = null;
+exports.workerData = null;
+exports.setupChild = setupChild;
@@ -4,7 +4,6 @@ const NativeModule = require('native_module');
 const util = require('util');
 const internalModule = require('internal/module');
 const vm = require('vm');
-const assert = require('assert').ok;
 const fs = require('fs');
 const internalFS = require('internal/fs');
 const path = require('path');
@@ -12,6 +11,12 @@ const internalModuleReadFile = process.binding('fs').internalModuleReadFile;
 const internalModuleStat = process.binding('fs').internalModuleStat;
 const preserveSymlinks = !!process.binding('config').preserveSymlinks;
 
+// assert is only loaded when an assertion fails.
+function assert(value, message) {
+  if (!value)
+    require('assert').ok(value, message);
+}
+
 // If obj.hasOwnProperty has been overridden, then calling
 // obj.hasOwnProperty(prop) will break.
 // See: https://github.com/joyent/node/issues/1707
@@ -21,6 +26,8 @@ function hasOwnProperty(obj, prop) {
 
 
 function stat(filename) {
+  if (resolveCache !== null && resolveCache.recording !== null)
+    resolveCache.recordProbe(filename);
   filename = path._makeLong(filename);
   const cache = stat.cache;
   if (cache !== null) {
@@ -58,6 +65,9 @@ Module.wrapper = NativeModule.wrapper;
 Module.wrap = NativeModule.wrap;
 Module._debug = util.debuglog('module');
 
+// Opt-in on-disk cache of resolved filenames, see lib/internal/resolve_cache.js
+var resolveCache = null;
+
 // We use this alias for the preprocessor that filters it out
 const debug = Module._debug;
 
@@ -77,11 +87,20 @@ const debug = Module._debug;
 const packageMainCache = {};
 
 function readPackage(requestPath) {
+  if (resolveCache !== null && resolveCache.recording !== null)
+    resolveCache.recordFile(path.resolve(requestPath, 'package.json'));
+
   if (hasOwnProperty(packageMainCache, requestPath)) {
     return packageMainCache[requestPath];
   }
 
   const jsonPath = path.resolve(requestPath, 'package.json');
+  if (resolveCache !== null) {
+    const main = resolveCache.lookupPackage(requestPath, jsonPath);
+    if (main !== undefined)
+      return packageMainCache[requestPath] = main;
+  }
+
   const json = internalModuleReadFile(path._makeLong(jsonPath));
 
   if (json === undefined) {
@@ -95,6 +114,8 @@ function readPackage(requestPath) {
     e.message = 'Error parsing ' + jsonPath + ': ' + e.message;
     throw e;
   }
+  if (resolveCache !== null)
+    resolveCache.storePackage(requestPath, jsonPath, pkg);
   return pkg;
 }
 
@@ -157,6 +178,33 @@ Module._findPath = function(request, paths, isMain) {
     return Module._pathCache[cacheKey];
   }
 
+  // Relative lookup paths, e.g. with --eval, depend on the working directory
+  // and are not cached across processes.
+  if (resolveCache === null || !paths.every(isAbsoluteOrEmpty))
+    return findPath(request, paths, isMain, cacheKey);
+
+  // The main module may resolve differently with --preserve-symlinks.
+  const persistentKey = isMain ? 'main:' + cacheKey : cacheKey;
+  var filename = resolveCache.lookup(persistentKey);
+  if (filename !== undefined) {
+    Module._pathCache[cacheKey] = filename;
+    return filename;
+  }
+
+  resolveCache.startRecording();
+  try {
+    filename = findPath(request, paths, isMain, cacheKey);
+  } finally {
+    resolveCache.stopRecording(persistentKey, filename);
+  }
+  return filename;
+};
+
+function isAbsoluteOrEmpty(p) {
+  return p === '' || path.isAbsolute(p);
+}
+
+function findPath(request, paths, isMain, cacheKey) {
   var exts;
   const trailingSlash = request.length > 0 &&
                         request.charCodeAt(request.length - 1) === 47/*/*/;
@@ -222,7 +270,7 @@ Module._findPath = function(request, paths, isMain) {
     }
   }
   return false;
-};
+}
 
 // 'node_modules' character codes reversed
 var nmChars = [ 115, 101, 108, 117, 100, 111, 109, 95, 101, 100, 111, 110 ];
@@ -540,11 +588,16 @@ Module.prototype._compile = function(content, filename) {
   // create wrapper function
   var wrapper = Module.wrap(content);
 
-  var compiledWrapper = vm.runInThisContext(wrapper, {
-    filename: filename,
-    lineOffset: 0,
-    displayErrors: true
-  });
+  var compiledWrapper;
+  if (Module._compileCache !== null) {
+    compiledWrapper = Module._compileCache.compile(wrapper, filename);
+  } else {
+    compiledWrapper = vm.runInThisContext(wrapper, {
+      filename: filename,
+      lineOffset: 0,
+      displayErrors: true
+    });
+  }
 
   if (process._debugWaitConnect && process._eval == null) {
     if (!resolvedArgv) {
@@ -657,7 +710,42 @@ Module._preloadModules = function(requests) {
   });
 };
 
+Module._initResolveCache = function() {
+  const filename = process.env.NODE_MODULE_RESOLUTION_CACHE;
+  if (!filename)
+    return;
+
+  const ResolveCache = require('internal/resolve_cache');
+  const options = JSON.stringify({
+    version: process.version,
+    preserveSymlinks: preserveSymlinks,
+    extensions: Object.keys(Module._extensions)
+  });
+  resolveCache = new ResolveCache(path.resolve(filename), options);
+  resolveCache.load();
+  process.on('exit', () => resolveCache.save());
+};
+
+// Opt-in on-disk V8 code cache, see lib/internal/compile_cache.js
+Module._compileCache = null;
+
+Module._initCompileCache = function() {
+  const dir = process.env.NODE_COMPILE_CACHE;
+  if (!dir)
+    return;
+
+  if (!process.versions.openssl) {
+    debug('NODE_COMPILE_CACHE requires crypto support, ignoring');
+    return;
+  }
+
+  const CompileCache = require('internal/compile_cache');
+  Module._compileCache = new CompileCache(dir);
+};
+
 Module._initPaths();
+Module._initResolveCache();
+Module._initCompileCache();
 
 // backwards compatibility
 Module.Module = Module;
@@ -1,6 +1,8 @@
 'use strict';
 
 const TimerWrap = process.binding('timer_wrap').Timer;
+const TimerWheel = process.binding('timer_wrap').TimerWheel;
+const asyncContext = process.binding('async_wrap').asyncContext;
 const L = require('internal/linkedlist');
 const assert = require('assert');
 const util = require('util');
@@ -83,66 +85,107 @@ const TIMEOUT_MAX = 2147483647; // 2^31-1
 // timers within (or creation of a new list).
 // However, these operations combined have shown to be trivial in comparison to
 // other alternative timers architectures.
+//
+// Internal timeouts that do not keep the process open, such as those of
+// sockets, are not kept in these lists. They are pushed back on every bit of
+// I/O and rarely expire, so they live in a hierarchical timing wheel in C++
+// instead (see TimerWheel in src/timer_wrap.cc). A timer is known to the wheel
+// by a number, its `_wheelId`, which is re-armed or cancelled in constant time
+// and without touching any other timer. A single libuv timer runs the wheel
+// and hands every timer that expired by then to wheelOnTimeout() at once.
 
 
-// Object maps containing linked lists of timers, keyed and sorted by their
+// Object map containing linked lists of timers, keyed and sorted by their
 // duration in milliseconds.
 //
-// The difference between these two objects is that the former contains timers
-// that will keep the process open if they are the only thing left, while the
-// latter will not.
-//
 // - key = time in milliseconds
 // - value = linked list
 const refedLists = Object.create(null);
-const unrefedLists = Object.create(null);
+
+// The timer wheel, created on first use, and the timers in it by `_wheelId`.
+// A timer that is not in the wheel has a `_wheelId` of -1 (or none at all),
+// one that has expired but whose callback has not run yet one of -2.
+var wheel = null;
+const wheelTimers = [];
+const freeWheelIds = [];
+const kWheelExpired = -2;
 
 
 // Schedule or re-schedule a timer.
 // The item must have been enroll()'d first.
 const active = exports.active = function(item) {
-  insert(item, false);
+  insert(item);
 };
 
 // Internal APIs that need timeouts should use `_unrefActive()` instead of
 // `active()` so that they do not unnecessarily keep the process open.
 exports._unrefActive = function(item) {
-  insert(item, true);
+  const msecs = item._idleTimeout;
+  if (msecs < 0 || msecs === undefined) return;
+
+  // Take it out of a list if active() was used on it before.
+  if (item._idleNext || item._idlePrev) L.remove(item);
+
+  if (wheel === null) {
+    wheel = new TimerWheel();
+    wheel.unref();
+    wheel[kOnTimeout] = wheelOnTimeout;
+  }
+
+  var id = item._wheelId;
+  if (!(id >= 0)) {
+    id = freeWheelIds.length > 0 ? freeWheelIds.pop() : wheelTimers.length;
+    wheelTimers[id] = item;
+    item._wheelId = id;
+  }
+  item._idleStart = wheel.arm(id, msecs);
 };
 
 
+// Takes a timer out of the wheel, or keeps it from running if it has expired
+// already.
+function cancelWheel(item) {
+  const id = item._wheelId;
+  if (id >= 0) {
+    wheel.cancel(id);
+    wheelTimers[id] = undefined;
+    freeWheelIds.push(id);
+  }
+  item._wheelId = -1;
+}
+
+
 // The underlying logic for scheduling or re-scheduling a timer.
 //
 // Appends a timer onto the end of an existing timers list, or creates a new
 // TimerWrap backed list if one does not already exist for the specified timeout
 // duration.
-function insert(item, unrefed) {
+function insert(item) {
   const msecs = item._idleTimeout;
   if (msecs < 0 || msecs === undefined) return;
 
-  item._idleStart = TimerWrap.now();
+  if (item._wheelId !== undefined) cancelWheel(item);
 
-  const lists = unrefed === true ? unrefedLists : refedLists;
+  item._idleStart = TimerWrap.now();
 
   // Use an existing list if there is one, otherwise we need to make a new one.
-  var list = lists[msecs];
+  var list = refedLists[msecs];
   if (!list) {
     debug('no %d list was found in insert, creating a new one', msecs);
-    lists[msecs] = list = createTimersList(msecs, unrefed);
+    refedLists[msecs] = list = createTimersList(msecs);
   }
 
   L.append(list, item);
   assert(!L.isEmpty(list)); // list is not empty
 }
 
-function createTimersList(msecs, unrefed) {
+function createTimersList(msecs) {
   // Make a new linked list of timers, and create a TimerWrap to schedule
   // processing for the list.
-  const list = new TimersList(msecs, unrefed);
+  const list = new TimersList(msecs);
   L.init(list);
   list._timer._list = list;
 
-  if (unrefed === true) list._timer.unref();
   list._timer.start(msecs);
 
   list._timer[kOnTimeout] = listOnTimeout;
@@ -150,11 +193,10 @@ function createTimersList(msecs, unrefed) {
   return list;
 }
 
-function TimersList(msecs, unrefed) {
+function TimersList(msecs) {
   this._idleNext = null; // Create the list with the linkedlist properties to
   this._idlePrev = null; // prevent any unnecessary hidden class changes.
   this._timer = new TimerWrap();
-  this._unrefed = unrefed;
   this.msecs = msecs;
 }
 
@@ -204,6 +246,7 @@ function listOnTimeout() {
       domain.enter();
     }
 
+    asyncContext[0] = timer._asyncContext;
     tryOnTimeout(timer, list);
 
     if (domain)
@@ -217,12 +260,10 @@ function listOnTimeout() {
   assert(L.isEmpty(list));
   this.close();
 
-  // Either refedLists[msecs] or unrefedLists[msecs] may have been removed and
-  // recreated since the reference to `list` was created. Make sure they're
-  // the same instance of the list before destroying.
-  if (list._unrefed === true && list === unrefedLists[msecs]) {
-    delete unrefedLists[msecs];
-  } else if (list === refedLists[msecs]) {
+  // refedLists[msecs] may have been removed and recreated since the reference
+  // to `list` was created. Make sure they're the same instance of the list
+  // before destroying.
+  if (list === refedLists[msecs]) {
     delete refedLists[msecs];
   }
 }
@@ -256,6 +297,70 @@ function listOnTimeoutNT(list) {
 }
 
 
+// Called by the timer wheel with the ids of all timers that have expired.
+function wheelOnTimeout(ids) {
+  debug('wheel timeout callback, %d expired', ids.length);
+
+  // Mark the whole batch first, callbacks may re-arm or cancel timers of it
+  // that have not run yet. Their ids are released as they come up, so none of
+  // them can be handed out again in the meantime.
+  for (var i = 0; i < ids.length; i++) {
+    const timer = wheelTimers[ids[i]];
+    timer._wheelId = kWheelExpired;
+    timer._idleNext = null;
+    timer._idlePrev = null;
+  }
+
+  runWheelTimeouts(ids, 0);
+}
+
+function runWheelTimeouts(ids, start) {
+  for (var i = start; i < ids.length; i++) {
+    const id = ids[i];
+    const timer = wheelTimers[id];
+    wheelTimers[id] = undefined;
+    freeWheelIds.push(id);
+
+    if (timer._wheelId !== kWheelExpired) continue;
+    timer._wheelId = -1;
+
+    if (!timer._onTimeout) continue;
+
+    var domain = timer.domain;
+    if (domain) {
+      // See listOnTimeout().
+      if (domain._disposed)
+        continue;
+
+      domain.enter();
+    }
+
+    asyncContext[0] = timer._asyncContext;
+    tryOnWheelTimeout(timer, ids, i + 1);
+
+    if (domain)
+      domain.exit();
+  }
+}
+
+// Like tryOnTimeout(), for the timers of one run of the wheel.
+function tryOnWheelTimeout(timer, ids, next) {
+  timer._called = true;
+  var threw = true;
+  try {
+    ontimeout(timer);
+    threw = false;
+  } finally {
+    if (threw) {
+      const domain = process.domain;
+      process.domain = null;
+      process.nextTick(runWheelTimeouts, ids, next);
+      process.domain = domain;
+    }
+  }
+}
+
+
 // A convenience function for re-using TimerWrap handles more easily.
 //
 // This mostly exists to fix https://github.com/nodejs/node/issues/1264.
@@ -285,6 +390,7 @@ const unenroll = exports.unenroll = function(item) {
     debug('unenroll: list empty');
     handle.close();
   }
+  if (item._wheelId !== undefined) cancelWheel(item);
   // if active is called later, then we want to make sure not to insert again
   item._idleTimeout = -1;
 };
@@ -306,6 +412,7 @@ exports.enroll = function(item, msecs) {
   // if this item was already in a list somewhere
   // then we should unenroll it from that
   if (item._idleNext) unenroll(item);
+  if (item._wheelId !== undefined) cancelWheel(item);
 
   // Ensure that msecs fits into signed int32
   if (msecs > TIMEOUT_MAX) {
@@ -313,6 +420,7 @@ exports.enroll = function(item, msecs) {
   }
 
   item._idleTimeout = msecs;
+  item._asyncContext = asyncContext[0];
   L.init(item);
 };
 
@@ -462,12 +570,14 @@ function Timeout(after, callback, args) {
   this._onTimeout = callback;
   this._timerArgs = args;
   this._repeat = null;
+  this._asyncContext = asyncContext[0];
 }
 
 
 function unrefdHandle() {
   // Don't attempt to call the callback if it is not a function.
   if (typeof this.owner._onTimeout === 'function') {
+    asyncContext[0] = this.owner._asyncContext;
     ontimeout(this.owner);
   }
 
@@ -572,6 +682,7 @@ function processImmediate() {
   var immediate = immediateQueue.head;
   var tail = immediateQueue.tail;
   var domain;
+  const context = asyncContext[0];
 
   // Clear the linked list early in case new `setImmediate()` calls occur while
   // immediate callbacks are executed
@@ -587,6 +698,7 @@ function processImmediate() {
       domain.enter();
 
     immediate._callback = immediate._onImmediate;
+    asyncContext[0] = immediate._asyncContext;
 
     // Save next in case `clearImmediate(immediate)` is called from callback
     var next = immediate._idleNext;
@@ -603,6 +715,7 @@ function processImmediate() {
     else
       immediate = next;
   }
+  asyncContext[0] = context;
 
   // Only round-trip to C++ land if we have to. Calling clearImmediate() on an
   // immediate that's in |queue| is okay. Worst case is we make a superfluous
@@ -669,6 +782,7 @@ function Immediate() {
   this._argv = null;
   this._onImmediate = null;
   this.domain = process.domain;
+  this._asyncContext = asyncContext[0];
 }
 
 exports.setImmediate = function(callback, arg1, arg2, arg3) {
@@ -61,6 +61,30 @@ exports.getHeapStatistics = function() {
 
 exports.setFlagsFromString = v8binding.setFlagsFromString;
 
+exports.startCpuProfile = function(options) {
+  require('internal/v8_profiler').start(options);
+};
+
+exports.stopCpuProfile = function(options) {
+  return require('internal/v8_profiler').stop(options);
+};
+
+exports.startHeapProfile = function(options) {
+  require('internal/v8_profiler').startHeap(options);
+};
+
+exports.getHeapProfile = function(options) {
+  return require('internal/v8_profiler').getHeap(options);
+};
+
+exports.stopHeapProfile = function() {
+  require('internal/v8_profiler').stopHeap();
+};
+
+exports.writeHeapSnapshot = function(file) {
+  return require('internal/v8_profiler').writeHeapSnapshot(file);
+};
+
 exports.getHeapSpaceStatistics = function() {
   const heapSpaceStatistics = new Array(kNumberOfHeapSpaces);
   const buffer = heapSpaceStatisticsBuffer;
@@ -79,3 +103,81 @@ exports.getHeapSpaceStatistics = function() {
 
   return heapSpaceStatistics;
 };
+
+// GC events are recorded by C++ into a ring buffer, see env.h.
+const kGCEventsTotal = v8binding.kGCEventsTotal;
+const kGCEventsHeaderLength = v8binding.kGCEventsHeaderLength;
+const kGCEventsCapacity = v8binding.kGCEventsCapacity;
+const kGCEventType = v8binding.kGCEventType;
+const kGCEventFlags = v8binding.kGCEventFlags;
+const kGCEventStart = v8binding.kGCEventStart;
+const kGCEventDuration = v8binding.kGCEventDuration;
+const kGCEventUsedBefore = v8binding.kGCEventUsedBefore;
+const kGCEventUsedAfter = v8binding.kGCEventUsedAfter;
+const kGCEventTotalAfter = v8binding.kGCEventTotalAfter;
+const kGCEventSpaces = v8binding.kGCEventSpaces;
+const kGCEventLength = kGCEventSpaces + kNumberOfHeapSpaces;
+const kGCCallbackFlagForced = 1 << 2;
+
+const gcTypes = {
+  1: 'scavenge',
+  2: 'mark-sweep-compact',
+  4: 'incremental-marking',
+  8: 'weak-callbacks'
+};
+
+var gcEventsBuffer = null;
+var gcEventsRead = 0;
+var gcTracking = false;
+
+exports.startGCTracking = function() {
+  const buffer = v8binding.startGCTracking();
+  if (buffer === undefined)
+    throw new Error('GC tracking is already running');
+  if (gcEventsBuffer === null)
+    gcEventsBuffer = new Float64Array(buffer);
+  // Events from before tracking was last stopped are not returned.
+  gcEventsRead = gcEventsBuffer[kGCEventsTotal];
+  gcTracking = true;
+};
+
+exports.stopGCTracking = function() {
+  if (!gcTracking)
+    throw new Error('GC tracking is not running');
+  v8binding.stopGCTracking();
+  gcTracking = false;
+};
+
+// Returns the events recorded since the last call, or the most recent
+// kGCEventsCapacity of them when there were more. Their `index` counts all
+// events, so a gap means that some were dropped. Events recorded before
+// tracking was stopped can still be taken.
+exports.takeGCEvents = function() {
+  if (gcEventsBuffer === null)
+    throw new Error('GC tracking has not been started');
+  const buffer = gcEventsBuffer;
+  const total = buffer[kGCEventsTotal];
+  const events = [];
+  for (var i = Math.max(gcEventsRead, total - kGCEventsCapacity);
+       i < total;
+       i++) {
+    const offset = kGCEventsHeaderLength + (i % kGCEventsCapacity) *
+                   kGCEventLength;
+    const spaces = {};
+    for (var j = 0; j < kNumberOfHeapSpaces; j++)
+      spaces[kHeapSpaces[j]] = buffer[offset + kGCEventSpaces + j];
+    events.push({
+      index: i,
+      type: gcTypes[buffer[offset + kGCEventType]],
+      forced: (buffer[offset + kGCEventFlags] & kGCCallbackFlagForced) !== 0,
+      startTime: buffer[offset + kGCEventStart] / 1e6,
+      duration: buffer[offset + kGCEventDuration] / 1e6,
+      usedHeapSizeBefore: buffer[offset + kGCEventUsedBefore],
+      usedHeapSizeAfter: buffer[offset + kGCEventUsedAfter],
+      totalHeapSize: buffer[offset + kGCEventTotalAfter],
+      spaces: spaces
+    });
+  }
+  gcEventsRead = total;
+  return events;
+};
@@ -18,6 +18,8 @@
     'node_use_openssl%': 'true',
     'node_shared_openssl%': 'false',
     'node_v8_options%': '',
+    # Defaults to an empty code cache.
+    'node_code_cache_path%': 'src/node_code_cache_stub.cc',
     'node_enable_v8_vtunejit%': 'false',
     'node_core_target_name%': 'node',
     'library_files': [
@@ -73,10 +75,15 @@
       'lib/util.js',
       'lib/v8.js',
       'lib/vm.js',
+      'lib/worker_threads.js',
       'lib/zlib.js',
       'lib/internal/buffer.js',
       'lib/internal/child_process.js',
+      'lib/internal/child_process/serialization.js',
+      'lib/internal/child_process/shm_channel.js',
       'lib/internal/cluster.js',
+      'lib/internal/compile_cache.js',
+      'lib/internal/dns_cache.js',
       'lib/internal/freelist.js',
       'lib/internal/fs.js',
       'lib/internal/linkedlist.js',
@@ -89,11 +96,14 @@
       'lib/internal/process.js',
       'lib/internal/readline.js',
       'lib/internal/repl.js',
+      'lib/internal/resolve_cache.js',
       'lib/internal/socket_list.js',
       'lib/internal/url.js',
       'lib/internal/util.js',
       'lib/internal/v8_prof_polyfill.js',
       'lib/internal/v8_prof_processor.js',
+      'lib/internal/v8_profiler.js',
+      'lib/internal/worker.js',
       'lib/internal/streams/lazy_transform.js',
       'lib/internal/streams/BufferList.js',
       'deps/v8/tools/splaytree.js',
@@ -160,15 +170,19 @@
         'src/node_main.cc',
         'src/node_os.cc',
         'src/node_revert.cc',
+        'src/node_serdes.cc',
         'src/node_url.cc',
         'src/node_util.cc',
         'src/node_v8.cc',
         'src/node_stat_watcher.cc',
         'src/node_watchdog.cc',
+        'src/node_worker.cc',
         'src/node_zlib.cc',
         'src/node_i18n.cc',
         'src/pipe_wrap.cc',
+        'src/shm_channel_wrap.cc',
         'src/signal_wrap.cc',
+        'src/simd.cc',
         'src/spawn_sync.cc',
         'src/string_bytes.cc',
         'src/stream_base.cc',
@@ -179,6 +193,7 @@
         'src/process_wrap.cc',
         'src/udp_wrap.cc',
         'src/uv.cc',
+        '<(node_code_cache_path)',
         # headers to make for a more pleasant IDE experience
         'src/async-wrap.h',
         'src/async-wrap-inl.h',
@@ -198,12 +213,15 @@
         'src/node_http_parser.h',
         'src/node_internals.h',
         'src/node_javascript.h',
+        'src/node_code_cache.h',
         'src/node_mutex.h',
         'src/node_root_certs.h',
         'src/node_version.h',
         'src/node_watchdog.h',
+        'src/node_worker.h',
         'src/node_wrap.h',
         'src/node_revert.h',
+        'src/node_serdes.h',
         'src/node_i18n.h',
         'src/pipe_wrap.h',
         'src/tty_wrap.h',
@@ -211,6 +229,7 @@
         'src/udp_wrap.h',
         'src/req-wrap.h',
         'src/req-wrap-inl.h',
+        'src/simd.h',
         'src/string_bytes.h',
         'src/stream_base.h',
         'src/stream_base-inl.h',
@@ -902,6 +921,7 @@
           'sources': [
             'src/inspector_socket.cc',
             'src/inspector_socket_server.cc',
+            'src/simd.cc',
             'test/cctest/test_inspector_socket.cc',
             'test/cctest/test_inspector_socket_server.cc'
           ],
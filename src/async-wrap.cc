@@ -9,8 +9,14 @@
 #include "v8.h"
 #include "v8-profiler.h"
 
+#include <stdio.h>
+#include <algorithm>
+
+using v8::Array;
+using v8::ArrayBuffer;
 using v8::Boolean;
 using v8::Context;
+using v8::Float64Array;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::HandleScope;
@@ -157,6 +163,78 @@ static void SetupHooks(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+static void GetContext(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  args.GetReturnValue().Set(env->async_context_array()->Get(0));
+}
+
+
+static void SetContext(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  if (!args[0]->IsUndefined())
+    env->set_using_async_context(true);
+  env->async_context_array()->Set(0, args[0]);
+}
+
+
+void AsyncWrap::EnableCallbackStats(Environment* env) {
+  if (env->callback_stats()->empty())
+    env->callback_stats()->resize(PROVIDERS_LENGTH, {0, 0, 0});
+}
+
+
+// Prints the statistics of the callbacks that have run so far to stderr,
+// slowest provider type first.
+void AsyncWrap::PrintCallbackStats(Environment* env) {
+  const std::vector<Environment::CallbackStats>& stats =
+      *env->callback_stats();
+  std::vector<int> order;
+  for (size_t i = 0; i < stats.size(); i++) {
+    if (stats[i].count > 0)
+      order.push_back(static_cast<int>(i));
+  }
+  std::sort(order.begin(), order.end(), [&stats](int a, int b) {
+    return stats[a].time > stats[b].time;
+  });
+
+  fprintf(stderr, "%-24s %12s %14s %12s %12s\n",
+          "provider", "calls", "total (ms)", "mean (us)", "max (us)");
+  for (int i : order) {
+    const Environment::CallbackStats& s = stats[i];
+    fprintf(stderr, "%-24s %12llu %14.3f %12.3f %12.3f\n",
+            provider_names[i],
+            static_cast<unsigned long long>(s.count),  // NOLINT(runtime/int)
+            s.time / 1e6,
+            s.time / 1e3 / s.count,
+            s.max / 1e3);
+  }
+  fflush(stderr);
+}
+
+
+// Fills the Float64Array argument with the count, total time and longest
+// time of the callbacks of each provider type, times in nanoseconds. The
+// first call enables collection.
+static void GetCallbackStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  AsyncWrap::EnableCallbackStats(env);
+
+  CHECK(args[0]->IsFloat64Array());
+  Local<Float64Array> array = args[0].As<Float64Array>();
+  CHECK_EQ(array->Length(), 3 * AsyncWrap::PROVIDERS_LENGTH);
+  Local<ArrayBuffer> ab = array->Buffer();
+  double* fields = static_cast<double*>(ab->GetContents().Data());
+
+  const std::vector<Environment::CallbackStats>& stats =
+      *env->callback_stats();
+  for (size_t i = 0; i < stats.size(); i++) {
+    fields[3 * i] = static_cast<double>(stats[i].count);
+    fields[3 * i + 1] = static_cast<double>(stats[i].time);
+    fields[3 * i + 2] = static_cast<double>(stats[i].max);
+  }
+}
+
+
 void AsyncWrap::Initialize(Local<Object> target,
                            Local<Value> unused,
                            Local<Context> context) {
@@ -167,6 +245,18 @@ void AsyncWrap::Initialize(Local<Object> target,
   env->SetMethod(target, "setupHooks", SetupHooks);
   env->SetMethod(target, "disable", DisableHooksJS);
   env->SetMethod(target, "enable", EnableHooksJS);
+  env->SetMethod(target, "getContext", GetContext);
+  env->SetMethod(target, "setContext", SetContext);
+  env->SetMethod(target, "getCallbackStats", GetCallbackStats);
+
+  // Element 0 holds the current async context. It is shared with lib/ so that
+  // next ticks, timers and immediates can carry it along without calling into
+  // C++. New contexts must be set with setContext(), which is what turns on
+  // the tracking in AsyncWrap.
+  Local<Array> async_context_array = Array::New(isolate, 1);
+  env->set_async_context_array(async_context_array);
+  target->Set(FIXED_ONE_BYTE_STRING(isolate, "asyncContext"),
+              async_context_array);
 
   Local<Object> async_providers = Object::New(isolate);
 #define V(PROVIDER)                                                           \
@@ -237,6 +327,18 @@ AsyncWrap::AsyncWrap(Environment* env,
   // Shift provider value over to prevent id collision.
   persistent().SetWrapperClassId(NODE_ASYNC_ID_OFFSET + provider);
 
+  // Take over the async context of the parent, or of the callback that is
+  // running now if there is none.
+  if (parent != nullptr) {
+    if (!parent->context_.IsEmpty())
+      context_.Reset(env->isolate(), parent->context_);
+  } else if (env->using_async_context()) {
+    HandleScope scope(env->isolate());
+    Local<Value> context = env->async_context_array()->Get(0);
+    if (!context->IsUndefined())
+      context_.Reset(env->isolate(), context);
+  }
+
   Local<Function> init_fn = env->async_hooks_init_function();
 
   // No init callback exists, no reason to go on.
@@ -278,6 +380,8 @@ AsyncWrap::AsyncWrap(Environment* env,
 
 
 AsyncWrap::~AsyncWrap() {
+  context_.Reset();
+
   if (!ran_init_callback())
     return;
 
@@ -332,8 +436,44 @@ Local<Value> AsyncWrap::MakeCallback(const Local<Function> cb,
     }
   }
 
+  // Make the async context of this resource the current one for the duration
+  // of the callback. The next tick queue restores the contexts of its own
+  // callbacks. Until a context is set, the current one is always undefined
+  // and there is nothing to do.
+  Local<Array> async_context_array = env()->async_context_array();
+  Local<Value> previous_async_context;
+  if (env()->using_async_context()) {
+    previous_async_context = async_context_array->Get(0);
+    if (!context_.IsEmpty()) {
+      async_context_array->Set(0,
+                               PersistentToLocal(env()->isolate(), context_));
+    } else if (!previous_async_context->IsUndefined()) {
+      async_context_array->Set(0, Undefined(env()->isolate()));
+    }
+  }
+
+  // Callbacks that are made from within this one count towards both.
+  std::vector<Environment::CallbackStats>* stats = env()->callback_stats();
+  const uint64_t start = stats->empty() ? 0 : uv_hrtime();
+
   Local<Value> ret = cb->Call(context, argc, argv);
 
+  if (start != 0) {
+    const uint64_t time = uv_hrtime() - start;
+    Environment::CallbackStats* s = &(*stats)[provider_type()];
+    s->count++;
+    s->time += time;
+    if (time > s->max)
+      s->max = time;
+  }
+
+  // The callback may have set the first context, in which case the previous
+  // one was undefined.
+  if (!previous_async_context.IsEmpty())
+    async_context_array->Set(0, previous_async_context);
+  else if (env()->using_async_context())
+    async_context_array->Set(0, Undefined(env()->isolate()));
+
   if (ran_init_callback() && !post_fn.IsEmpty()) {
     Local<Value> did_throw = Boolean::New(env()->isolate(), ret.IsEmpty());
     Local<Value> vals[] = { uid, did_throw };
@@ -22,10 +22,12 @@ namespace node {
   V(GETNAMEINFOREQWRAP)                                                       \
   V(HTTPPARSER)                                                               \
   V(JSSTREAM)                                                                 \
+  V(MESSAGEPORT)                                                              \
   V(PIPEWRAP)                                                                 \
   V(PIPECONNECTWRAP)                                                          \
   V(PROCESSWRAP)                                                              \
   V(QUERYWRAP)                                                                \
+  V(SHMCHANNELWRAP)                                                           \
   V(SHUTDOWNWRAP)                                                             \
   V(SIGNALWRAP)                                                               \
   V(STATWATCHER)                                                              \
@@ -36,6 +38,7 @@ namespace node {
   V(TTYWRAP)                                                                  \
   V(UDPWRAP)                                                                  \
   V(UDPSENDWRAP)                                                              \
+  V(WORKER)                                                                   \
   V(WRITEWRAP)                                                                \
   V(ZLIB)
 
@@ -48,6 +51,7 @@ class AsyncWrap : public BaseObject {
     PROVIDER_ ## PROVIDER,
     NODE_ASYNC_PROVIDER_TYPES(V)
 #undef V
+    PROVIDERS_LENGTH,
   };
 
   AsyncWrap(Environment* env,
@@ -63,6 +67,11 @@ class AsyncWrap : public BaseObject {
 
   static void DestroyIdsCb(uv_idle_t* handle);
 
+  // Starts counting the callbacks that MakeCallback() runs for each provider
+  // type and how long they take. Cheap enough to leave on.
+  static void EnableCallbackStats(Environment* env);
+  static void PrintCallbackStats(Environment* env);
+
   inline ProviderType provider_type() const;
 
   inline int64_t get_uid() const;
@@ -89,6 +98,9 @@ class AsyncWrap : public BaseObject {
   // that will be used to call pre/post in MakeCallback.
   uint32_t bits_;
   const int64_t uid_;
+  // The async context of the resource, taken over from the one that caused
+  // it and made current while MakeCallback() runs. Empty if undefined.
+  v8::Persistent<v8::Value> context_;
 };
 
 void LoadAsyncWrapperInfo(Environment* env);
@@ -3,6 +3,7 @@
 
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
+#include "simd.h"
 #include "util.h"
 
 #include <stddef.h>
@@ -92,8 +93,8 @@ size_t base64_decode_fast(char* const dst, const size_t dstlen,
   const size_t available = dstlen < decoded_size ? dstlen : decoded_size;
   const size_t max_i = srclen / 4 * 4;
   const size_t max_k = available / 3 * 3;
-  size_t i = 0;
-  size_t k = 0;
+  size_t k = simd::Base64Decode(dst, max_k, src, max_i);
+  size_t i = k / 3 * 4;
   while (i < max_i && k < max_k) {
     const uint32_t v =
         unbase64(src[i + 0]) << 24 |
@@ -145,8 +146,8 @@ static size_t base64_encode(const char* src,
                               "abcdefghijklmnopqrstuvwxyz"
                               "0123456789+/";
 
-  i = 0;
-  k = 0;
+  i = simd::Base64Encode(src, slen, dst);
+  k = i / 3 * 4;
   n = slen / 3 * 3;
 
   while (i < n) {
@@ -44,6 +44,7 @@ using v8::Local;
 using v8::Null;
 using v8::Object;
 using v8::String;
+using v8::Undefined;
 using v8::Value;
 
 
@@ -280,10 +281,54 @@ static Local<Array> HostentToNames(Environment* env, struct hostent* host) {
 }
 
 
+// Returns the smallest TTL of the records in the answer section of a DNS
+// response, or -1 if there are none or the response is malformed.
+static int AnswerTtl(const unsigned char* buf, int len) {
+  const unsigned char* const end = buf + len;
+  auto skip_name = [end](const unsigned char* p) -> const unsigned char* {
+    while (p < end) {
+      if (*p == 0)
+        return p + 1;
+      if ((*p & 0xc0) == 0xc0)
+        return p + 2;
+      p += *p + 1;
+    }
+    return nullptr;
+  };
+
+  if (len < NS_HFIXEDSZ)
+    return -1;
+  const unsigned int qdcount = (buf[4] << 8) | buf[5];
+  const unsigned int ancount = (buf[6] << 8) | buf[7];
+  const unsigned char* p = buf + NS_HFIXEDSZ;
+  for (unsigned int i = 0; i < qdcount; i++) {
+    p = skip_name(p);
+    if (p == nullptr || end - p < NS_QFIXEDSZ)
+      return -1;
+    p += NS_QFIXEDSZ;
+  }
+
+  int ttl = -1;
+  for (unsigned int i = 0; i < ancount; i++) {
+    p = skip_name(p);
+    if (p == nullptr || end - p < NS_RRFIXEDSZ)
+      return -1;
+    // TYPE, CLASS, TTL and RDLENGTH, all in network byte order.
+    const int rr_ttl = ((p[4] & 0x7f) << 24) | (p[5] << 16) |
+                       (p[6] << 8) | p[7];
+    if (ttl == -1 || rr_ttl < ttl)
+      ttl = rr_ttl;
+    p += NS_RRFIXEDSZ + ((p[8] << 8) | p[9]);
+  }
+  return p <= end ? ttl : -1;
+}
+
+
 class QueryWrap : public AsyncWrap {
  public:
   QueryWrap(Environment* env, Local<Object> req_wrap_obj)
-      : AsyncWrap(env, req_wrap_obj, AsyncWrap::PROVIDER_QUERYWRAP) {
+      : AsyncWrap(env, req_wrap_obj, AsyncWrap::PROVIDER_QUERYWRAP),
+        ttl_(-1) {
     if (env->in_domain())
       req_wrap_obj->Set(env->domain_string(), env->domain_array()->Get(0));
   }
@@ -317,6 +362,7 @@ class QueryWrap : public AsyncWrap {
     if (status != ARES_SUCCESS) {
       wrap->ParseError(status);
     } else {
+      wrap->ttl_ = AnswerTtl(answer_buf, answer_len);
       wrap->Parse(answer_buf, answer_len);
     }
 
@@ -336,6 +382,8 @@ class QueryWrap : public AsyncWrap {
     delete wrap;
   }
 
+  // The smallest TTL of the answer, if known, is passed after |extra|, which
+  // is undefined then if it is not given.
   void CallOnComplete(Local<Value> answer,
                       Local<Value> extra = Local<Value>()) {
     HandleScope handle_scope(env()->isolate());
@@ -343,9 +391,15 @@ class QueryWrap : public AsyncWrap {
     Local<Value> argv[] = {
       Integer::New(env()->isolate(), 0),
       answer,
-      extra
+      extra,
+      Integer::New(env()->isolate(), ttl_)
     };
-    const int argc = arraysize(argv) - extra.IsEmpty();
+    int argc = arraysize(argv);
+    if (ttl_ < 0) {
+      argc = arraysize(argv) - 1 - extra.IsEmpty();
+    } else if (extra.IsEmpty()) {
+      argv[2] = Undefined(env()->isolate());
+    }
     MakeCallback(env()->oncomplete_string(), argc, argv);
   }
 
@@ -366,6 +420,9 @@ class QueryWrap : public AsyncWrap {
   virtual void Parse(struct hostent* host) {
     UNREACHABLE();
   }
+
+ private:
+  int ttl_;
 };
 
 
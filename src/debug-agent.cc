@@ -164,7 +164,8 @@ void Agent::WorkerRun() {
 
     HandleScope handle_scope(isolate);
     IsolateData isolate_data(isolate, &child_loop_,
-                             array_buffer_allocator.zero_fill_field());
+                             array_buffer_allocator.zero_fill_field(),
+                             &array_buffer_allocator);
     Local<Context> context = Context::New(isolate);
 
     Context::Scope context_scope(context);
@@ -25,7 +25,8 @@ namespace node {
 // One byte because our strings are ASCII and we can safely skip V8's UTF-8
 // decoding step.  It's a one-time cost, but why pay it when you don't have to?
 inline IsolateData::IsolateData(v8::Isolate* isolate, uv_loop_t* event_loop,
-                                uint32_t* zero_fill_field)
+                                uint32_t* zero_fill_field,
+                                ArrayBufferAllocator* allocator)
     :
 #define V(PropertyName, StringValue)                                          \
     PropertyName ## _(                                                        \
@@ -49,7 +50,8 @@ inline IsolateData::IsolateData(v8::Isolate* isolate, uv_loop_t* event_loop,
             sizeof(StringValue) - 1).ToLocalChecked()),
     PER_ISOLATE_STRING_PROPERTIES(V)
 #undef V
-    event_loop_(event_loop), zero_fill_field_(zero_fill_field) {}
+    event_loop_(event_loop), zero_fill_field_(zero_fill_field),
+    allocator_(allocator) {}
 
 inline uv_loop_t* IsolateData::event_loop() const {
   return event_loop_;
@@ -59,6 +61,10 @@ inline uint32_t* IsolateData::zero_fill_field() const {
   return zero_fill_field_;
 }
 
+inline ArrayBufferAllocator* IsolateData::allocator() const {
+  return allocator_;
+}
+
 inline Environment::AsyncHooks::AsyncHooks() {
   for (int i = 0; i < kFieldsCount; i++) fields_[i] = 0;
 }
@@ -168,10 +174,14 @@ inline Environment::Environment(IsolateData* isolate_data,
       isolate_data_(isolate_data),
       timer_base_(uv_now(isolate_data->event_loop())),
       using_domains_(false),
+      using_async_context_(false),
+      worker_context_(nullptr),
+      env_vars_(nullptr),
       printed_error_(false),
       trace_sync_io_(false),
       makecallback_cntr_(0),
       async_wrap_uid_(0),
+      gc_tracking_(false),
       debugger_agent_(this),
 #if HAVE_INSPECTOR
       inspector_agent_(this),
@@ -219,6 +229,9 @@ inline Environment::~Environment() {
   delete[] heap_statistics_buffer_;
   delete[] heap_space_statistics_buffer_;
   delete[] http_parser_buffer_;
+
+  StopGCTracking();
+  delete[] gc_events_buffer_;
 }
 
 inline v8::Isolate* Environment::isolate() const {
@@ -296,6 +309,31 @@ inline void Environment::set_using_domains(bool value) {
   using_domains_ = value;
 }
 
+inline bool Environment::using_async_context() const {
+  return using_async_context_;
+}
+
+inline void Environment::set_using_async_context(bool value) {
+  using_async_context_ = value;
+}
+
+inline worker::Worker* Environment::worker_context() const {
+  return worker_context_;
+}
+
+inline void Environment::set_worker_context(worker::Worker* context) {
+  worker_context_ = context;
+}
+
+inline std::map<std::string, std::string>* Environment::env_vars() const {
+  return env_vars_;
+}
+
+inline void Environment::set_env_vars(
+    std::map<std::string, std::string>* vars) {
+  env_vars_ = vars;
+}
+
 inline bool Environment::printed_error() const {
   return printed_error_;
 }
@@ -312,10 +350,35 @@ inline int64_t Environment::get_async_wrap_uid() {
   return ++async_wrap_uid_;
 }
 
+inline std::vector<Environment::CallbackStats>*
+Environment::callback_stats() {
+  return &callback_stats_;
+}
+
 inline std::vector<int64_t>* Environment::destroy_ids_list() {
   return &destroy_ids_list_;
 }
 
+inline void Environment::AdjustExternalMemory(ExternalMemoryCategory category,
+                                              int64_t change_in_bytes) {
+  external_memory_[category] += change_in_bytes;
+  isolate_->AdjustAmountOfExternalAllocatedMemory(change_in_bytes);
+}
+
+inline int64_t Environment::external_memory(
+    ExternalMemoryCategory category) const {
+  return external_memory_[category];
+}
+
+inline double* Environment::gc_events_buffer() const {
+  CHECK_NE(gc_events_buffer_, nullptr);
+  return gc_events_buffer_;
+}
+
+inline size_t Environment::gc_event_length() const {
+  return kGCEventSpaces + isolate_->NumberOfHeapSpaces();
+}
+
 inline uint32_t* Environment::heap_statistics_buffer() const {
   CHECK_NE(heap_statistics_buffer_, nullptr);
   return heap_statistics_buffer_;
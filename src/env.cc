@@ -1,6 +1,7 @@
 #include "env.h"
 #include "env-inl.h"
 #include "async-wrap.h"
+#include "node_mutex.h"
 #include "v8.h"
 #include "v8-profiler.h"
 
@@ -10,13 +11,21 @@
 #include <unistd.h>
 #endif
 
+#include <signal.h>
 #include <stdio.h>
 
+#include <algorithm>
+
 namespace node {
 
 using v8::Context;
 using v8::FunctionTemplate;
+using v8::GCCallbackFlags;
+using v8::GCType;
 using v8::HandleScope;
+using v8::HeapSpaceStatistics;
+using v8::HeapStatistics;
+using v8::Isolate;
 using v8::Local;
 using v8::Message;
 using v8::StackFrame;
@@ -109,6 +118,137 @@ void Environment::StopProfilerIdleNotifier() {
   uv_check_stop(&idle_check_handle_);
 }
 
+void Environment::PrintCallbackStatsOnSignal() {
+#ifdef SIGUSR2
+  uv_signal_init(event_loop(), &callback_stats_signal_);
+  uv_unref(reinterpret_cast<uv_handle_t*>(&callback_stats_signal_));
+  uv_signal_start(&callback_stats_signal_, [](uv_signal_t* handle, int) {
+    Environment* env =
+        ContainerOf(&Environment::callback_stats_signal_, handle);
+    AsyncWrap::PrintCallbackStats(env);
+  }, SIGUSR2);
+
+  RegisterHandleCleanup(
+      reinterpret_cast<uv_handle_t*>(&callback_stats_signal_),
+      [](Environment* env, uv_handle_t* handle, void* arg) {
+        handle->data = env;
+        uv_close(handle, [](uv_handle_t* handle) {
+          static_cast<Environment*>(handle->data)->FinishHandleCleanup(handle);
+        });
+      },
+      nullptr);
+#endif
+}
+
+// GC callbacks are not passed any data, so the Environment is looked up by
+// its isolate among those that track GC.
+static Mutex gc_tracking_mutex;
+static std::vector<Environment*> gc_tracking_envs;
+
+static Environment* GCTrackingEnvironment(Isolate* isolate) {
+  Mutex::ScopedLock scoped_lock(gc_tracking_mutex);
+  for (Environment* env : gc_tracking_envs) {
+    if (env->isolate() == isolate)
+      return env;
+  }
+  return nullptr;
+}
+
+static void GCEventPrologue(Isolate* isolate, GCType, GCCallbackFlags) {
+  Environment* env = GCTrackingEnvironment(isolate);
+  if (env == nullptr)
+    return;
+  double* const buffer = env->gc_events_buffer();
+  const size_t depth = static_cast<size_t>(buffer[Environment::kGCEventsDepth]);
+  buffer[Environment::kGCEventsDepth] = depth + 1;
+  if (depth >= Environment::kGCEventsMaxDepth)
+    return;
+  HeapStatistics s;
+  isolate->GetHeapStatistics(&s);
+  double* const pending = buffer + Environment::kGCEventsPending + 2 * depth;
+  pending[0] = uv_hrtime();
+  pending[1] = s.used_heap_size();
+}
+
+static void GCEventEpilogue(Isolate* isolate,
+                            GCType type,
+                            GCCallbackFlags flags) {
+  const uint64_t now = uv_hrtime();
+  Environment* env = GCTrackingEnvironment(isolate);
+  if (env == nullptr)
+    return;
+  double* const buffer = env->gc_events_buffer();
+  // Collections whose start was not seen, because tracking was started while
+  // they ran or they nested too deeply, are not recorded.
+  const size_t depth = static_cast<size_t>(buffer[Environment::kGCEventsDepth]);
+  if (depth == 0)
+    return;
+  buffer[Environment::kGCEventsDepth] = depth - 1;
+  if (depth > Environment::kGCEventsMaxDepth)
+    return;
+  const double* const pending =
+      buffer + Environment::kGCEventsPending + 2 * (depth - 1);
+
+  const double total = buffer[Environment::kGCEventsTotal];
+  const size_t index = static_cast<size_t>(total) %
+                       Environment::kGCEventsCapacity;
+  double* const event = buffer + Environment::kGCEventsHeaderLength +
+                        index * env->gc_event_length();
+
+  HeapStatistics s;
+  isolate->GetHeapStatistics(&s);
+  event[Environment::kGCEventType] = type;
+  event[Environment::kGCEventFlags] = flags;
+  event[Environment::kGCEventStart] = pending[0];
+  event[Environment::kGCEventDuration] = now - pending[0];
+  event[Environment::kGCEventUsedBefore] = pending[1];
+  event[Environment::kGCEventUsedAfter] = s.used_heap_size();
+  event[Environment::kGCEventTotalAfter] = s.total_heap_size();
+
+  HeapSpaceStatistics space;
+  const size_t spaces = isolate->NumberOfHeapSpaces();
+  for (size_t i = 0; i < spaces; i++) {
+    isolate->GetHeapSpaceStatistics(&space, i);
+    event[Environment::kGCEventSpaces + i] = space.space_used_size();
+  }
+
+  buffer[Environment::kGCEventsTotal] = total + 1;
+}
+
+bool Environment::StartGCTracking() {
+  if (gc_tracking_)
+    return false;
+  if (gc_events_buffer_ == nullptr) {
+    const size_t length =
+        kGCEventsHeaderLength + kGCEventsCapacity * gc_event_length();
+    gc_events_buffer_ = new double[length]();
+  }
+  // A collection that was running when tracking was stopped never ended.
+  gc_events_buffer_[kGCEventsDepth] = 0;
+  {
+    Mutex::ScopedLock scoped_lock(gc_tracking_mutex);
+    gc_tracking_envs.push_back(this);
+  }
+  isolate()->AddGCPrologueCallback(GCEventPrologue);
+  isolate()->AddGCEpilogueCallback(GCEventEpilogue);
+  gc_tracking_ = true;
+  return true;
+}
+
+void Environment::StopGCTracking() {
+  if (!gc_tracking_)
+    return;
+  isolate()->RemoveGCPrologueCallback(GCEventPrologue);
+  isolate()->RemoveGCEpilogueCallback(GCEventEpilogue);
+  {
+    Mutex::ScopedLock scoped_lock(gc_tracking_mutex);
+    gc_tracking_envs.erase(std::find(gc_tracking_envs.begin(),
+                                     gc_tracking_envs.end(),
+                                     this));
+  }
+  gc_tracking_ = false;
+}
+
 void Environment::PrintSyncTrace() const {
   if (!trace_sync_io_)
     return;
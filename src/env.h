@@ -16,6 +16,8 @@
 #include "v8.h"
 
 #include <stdint.h>
+#include <map>
+#include <string>
 #include <vector>
 
 // Caveat emptor: we're going slightly crazy with macros here but the end
@@ -62,6 +64,7 @@ namespace node {
   V(npn_buffer_private_symbol, "node:npnBuffer")                              \
   V(processed_private_symbol, "node:processed")                               \
   V(selected_npn_buffer_private_symbol, "node:selectedNpnBuffer")             \
+  V(shared_array_buffer_data_private_symbol, "node:sharedArrayBufferData")    \
 
 // Strings are per-isolate primitives but Environment proxies them
 // for the sake of convenience.  Strings should be ASCII-only.
@@ -134,6 +137,7 @@ namespace node {
   V(mac_string, "mac")                                                        \
   V(max_buffer_string, "maxBuffer")                                           \
   V(message_string, "message")                                                \
+  V(message_port_string, "messagePort")                                       \
   V(minttl_string, "minttl")                                                  \
   V(model_string, "model")                                                    \
   V(modulus_string, "modulus")                                                \
@@ -147,6 +151,7 @@ namespace node {
   V(oncomplete_string, "oncomplete")                                          \
   V(onconnection_string, "onconnection")                                      \
   V(ondone_string, "ondone")                                                  \
+  V(ondrain_string, "ondrain")                                                \
   V(onerror_string, "onerror")                                                \
   V(onexit_string, "onexit")                                                  \
   V(onhandshakedone_string, "onhandshakedone")                                \
@@ -204,6 +209,7 @@ namespace node {
   V(subjectaltname_string, "subjectaltname")                                  \
   V(sys_string, "sys")                                                        \
   V(syscall_string, "syscall")                                                \
+  V(thread_id_string, "threadId")                                             \
   V(tick_callback_string, "_tickCallback")                                    \
   V(tick_domain_cb_string, "_tickDomainCallback")                             \
   V(ticketkeycallback_string, "onticketkeycallback")                          \
@@ -229,6 +235,7 @@ namespace node {
 
 #define ENVIRONMENT_STRONG_PERSISTENT_PROPERTIES(V)                           \
   V(as_external, v8::External)                                                \
+  V(async_context_array, v8::Array)                                           \
   V(async_hooks_destroy_function, v8::Function)                               \
   V(async_hooks_init_function, v8::Function)                                  \
   V(async_hooks_post_function, v8::Function)                                  \
@@ -242,6 +249,7 @@ namespace node {
   V(fs_stats_constructor_function, v8::Function)                              \
   V(generic_internal_field_template, v8::ObjectTemplate)                      \
   V(jsstream_constructor_template, v8::FunctionTemplate)                      \
+  V(message_port_constructor_function, v8::Function)                          \
   V(module_load_list_array, v8::Array)                                        \
   V(pipe_constructor_template, v8::FunctionTemplate)                          \
   V(process_object, v8::Object)                                               \
@@ -260,6 +268,10 @@ namespace node {
 
 class Environment;
 
+namespace worker {
+class Worker;
+}  // namespace worker
+
 struct node_ares_task {
   Environment* env;
   ares_socket_t sock;
@@ -269,12 +281,17 @@ struct node_ares_task {
 
 RB_HEAD(node_ares_task_list, node_ares_task);
 
+class ArrayBufferAllocator;
+
 class IsolateData {
  public:
   inline IsolateData(v8::Isolate* isolate, uv_loop_t* event_loop,
-                     uint32_t* zero_fill_field = nullptr);
+                     uint32_t* zero_fill_field = nullptr,
+                     ArrayBufferAllocator* allocator = nullptr);
   inline uv_loop_t* event_loop() const;
   inline uint32_t* zero_fill_field() const;
+  // The allocator of the isolate if it is node's own, or nullptr.
+  inline ArrayBufferAllocator* allocator() const;
 
 #define VP(PropertyName, StringValue) V(v8::Private, PropertyName)
 #define VS(PropertyName, StringValue) V(v8::String, PropertyName)
@@ -299,6 +316,7 @@ class IsolateData {
 
   uv_loop_t* const event_loop_;
   uint32_t* const zero_fill_field_;
+  ArrayBufferAllocator* const allocator_;
 
   DISALLOW_COPY_AND_ASSIGN(IsolateData);
 };
@@ -458,12 +476,91 @@ class Environment {
   inline bool using_domains() const;
   inline void set_using_domains(bool value);
 
+  // Whether an async context other than undefined has ever been set. Until
+  // then, AsyncWrap does not touch async_context_array().
+  inline bool using_async_context() const;
+  inline void set_using_async_context(bool value);
+
+  // The Worker that runs this Environment on its own thread, or nullptr for
+  // the main thread.
+  inline worker::Worker* worker_context() const;
+  inline void set_worker_context(worker::Worker* context);
+
+  // The variables behind process.env in a worker thread, which gets a copy
+  // of its parent's so that only the main thread ever reads or changes the
+  // process-wide environment. nullptr for the main thread.
+  inline std::map<std::string, std::string>* env_vars() const;
+  inline void set_env_vars(std::map<std::string, std::string>* vars);
+
   inline bool printed_error() const;
   inline void set_printed_error(bool value);
 
   void PrintSyncTrace() const;
   inline void set_trace_sync_io(bool value);
 
+  // The number of callbacks AsyncWrap::MakeCallback() has run for each
+  // provider type, their total run time and the longest one, in nanoseconds.
+  // Empty until AsyncWrap::EnableCallbackStats() is called.
+  struct CallbackStats {
+    uint64_t count;
+    uint64_t time;
+    uint64_t max;
+  };
+  inline std::vector<CallbackStats>* callback_stats();
+  void PrintCallbackStatsOnSignal();
+
+  // External memory, by the part of node that owns it, as reported by
+  // process.memoryUsage(). ArrayBuffers that are allocated by V8 through the
+  // ArrayBufferAllocator are counted there instead.
+#define EXTERNAL_MEMORY_CATEGORIES(V)                                         \
+  V(kExternalMemoryBuffers, buffers)                                          \
+  V(kExternalMemoryZlib, zlib)                                                \
+  V(kExternalMemoryTLS, tls)                                                  \
+  V(kExternalMemoryStreams, streams)                                          \
+  V(kExternalMemoryHttpParser, httpParser)
+  enum ExternalMemoryCategory {
+#define V(category, _) category,
+    EXTERNAL_MEMORY_CATEGORIES(V)
+#undef V
+    kExternalMemoryCategoryCount
+  };
+  // Counts |change_in_bytes| against |category| and reports it to V8.
+  inline void AdjustExternalMemory(ExternalMemoryCategory category,
+                                   int64_t change_in_bytes);
+  inline int64_t external_memory(ExternalMemoryCategory category) const;
+
+  // While GC tracking is on, every garbage collection is recorded into a ring
+  // of kGCEventsCapacity records that JS reads as a Float64Array. The buffer
+  // starts with a header, the total number of events recorded so far is at
+  // kGCEventsTotal. A record is kGCEventSpaces fields followed by the used
+  // size of each heap space after the collection. Times are in nanoseconds.
+  // Collections can nest, e.g. weak callbacks are processed inside a forced
+  // mark-sweep, so the header also holds a stack of the start time and used
+  // size of up to kGCEventsMaxDepth collections that are still running.
+  static const size_t kGCEventsMaxDepth = 4;
+  enum GCEventsFields {
+    kGCEventsTotal,
+    kGCEventsDepth,
+    kGCEventsPending,
+    kGCEventsHeaderLength = kGCEventsPending + 2 * kGCEventsMaxDepth
+  };
+  enum GCEventFields {
+    kGCEventType,
+    kGCEventFlags,
+    kGCEventStart,
+    kGCEventDuration,
+    kGCEventUsedBefore,
+    kGCEventUsedAfter,
+    kGCEventTotalAfter,
+    kGCEventSpaces
+  };
+  static const size_t kGCEventsCapacity = 1024;
+  // Returns false if tracking was already on.
+  bool StartGCTracking();
+  void StopGCTracking();
+  inline double* gc_events_buffer() const;
+  inline size_t gc_event_length() const;
+
   inline int64_t get_async_wrap_uid();
 
   // List of id's that have been destroyed and need the destroy() cb called.
@@ -565,11 +662,19 @@ class Environment {
   ares_channel cares_channel_;
   node_ares_task_list cares_task_list_;
   bool using_domains_;
+  bool using_async_context_;
+  worker::Worker* worker_context_;
+  std::map<std::string, std::string>* env_vars_;
   bool printed_error_;
   bool trace_sync_io_;
   size_t makecallback_cntr_;
   int64_t async_wrap_uid_;
   std::vector<int64_t> destroy_ids_list_;
+  std::vector<CallbackStats> callback_stats_;
+  uv_signal_t callback_stats_signal_;
+  int64_t external_memory_[kExternalMemoryCategoryCount] = {};
+  bool gc_tracking_;
+  double* gc_events_buffer_ = nullptr;
   debugger::Agent debugger_agent_;
 #if HAVE_INSPECTOR
   inspector::Agent inspector_agent_;
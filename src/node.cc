@@ -7,6 +7,7 @@
 #include "node_version.h"
 #include "node_internals.h"
 #include "node_revert.h"
+#include "node_worker.h"
 
 #if defined HAVE_PERFCTR
 #include "node_counters.h"
@@ -136,6 +137,9 @@ static bool syntax_check_only = false;
 static bool trace_deprecation = false;
 static bool throw_deprecation = false;
 static bool trace_sync_io = false;
+static bool trace_module_load = false;
+static bool callback_stats = false;
+static const char* cpu_prof_signal = nullptr;
 static bool track_heap_objects = false;
 static const char* eval_string = nullptr;
 static unsigned int preload_module_count = 0;
@@ -160,6 +164,9 @@ static node_module* modpending;
 static node_module* modlist_builtin;
 static node_module* modlist_linked;
 static node_module* modlist_addon;
+// Protects modpending and modlist_addon, which process.dlopen() uses on the
+// main thread and on worker threads.
+static Mutex dlib_mutex;
 
 #if defined(NODE_HAVE_I18N_SUPPORT)
 // Path to ICU data (for i18n / Intl)
@@ -984,10 +991,24 @@ Local<Value> WinapiErrnoException(Isolate* isolate,
 
 
 void* ArrayBufferAllocator::Allocate(size_t size) {
-  if (zero_fill_field_ || zero_fill_all_buffers)
-    return node::UncheckedCalloc(size);
-  else
-    return node::UncheckedMalloc(size);
+  if (!zero_fill_field_ && !zero_fill_all_buffers)
+    return AllocateUninitialized(size);
+  void* data = node::UncheckedCalloc(size);
+  if (data != nullptr)
+    allocated_ += size;
+  return data;
+}
+
+void* ArrayBufferAllocator::AllocateUninitialized(size_t size) {
+  void* data = node::UncheckedMalloc(size);
+  if (data != nullptr)
+    allocated_ += size;
+  return data;
+}
+
+void ArrayBufferAllocator::Free(void* data, size_t length) {
+  allocated_ -= length;
+  free(data);
 }
 
 static bool DomainHasErrorHandler(const Environment* env,
@@ -1686,12 +1707,14 @@ static Local<Value> ExecuteString(Environment* env,
       v8::Script::Compile(env->context(), source, &origin);
   if (script.IsEmpty()) {
     ReportException(env, try_catch);
+    worker::Worker::StopAll(env);
     exit(3);
   }
 
   Local<Value> result = script.ToLocalChecked()->Run();
   if (result.IsEmpty()) {
     ReportException(env, try_catch);
+    worker::Worker::StopAll(env);
     exit(4);
   }
 
@@ -2213,7 +2236,14 @@ static void WaitForInspectorDisconnect(Environment* env) {
 
 
 void Exit(const FunctionCallbackInfo<Value>& args) {
-  WaitForInspectorDisconnect(Environment::GetCurrent(args));
+  Environment* env = Environment::GetCurrent(args);
+  // process.exit() in a worker thread only stops that thread.
+  if (env->worker_context() != nullptr)
+    return env->worker_context()->Exit(args[0]->Int32Value());
+  // Worker threads must not be running inside V8 and libuv while atexit
+  // handlers and static destructors run.
+  worker::Worker::StopAll(env);
+  WaitForInspectorDisconnect(env);
   exit(args[0]->Int32Value());
 }
 
@@ -2250,11 +2280,29 @@ void MemoryUsage(const FunctionCallbackInfo<Value>& args) {
       Number::New(env->isolate(),
                   env->isolate()->AdjustAmountOfExternalAllocatedMemory(0));
 
+  // Who owns the external memory, as far as node knows.
+  Local<Object> breakdown = Object::New(env->isolate());
+#define V(category, name)                                                     \
+  breakdown->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                \
+                 Number::New(env->isolate(),                                  \
+                             env->external_memory(Environment::category)));
+  EXTERNAL_MEMORY_CATEGORIES(V)
+#undef V
+  if (ArrayBufferAllocator* allocator = env->isolate_data()->allocator()) {
+    const double buffers =
+        env->external_memory(Environment::kExternalMemoryBuffers) +
+        allocator->allocated();
+    breakdown->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "buffers"),
+                   Number::New(env->isolate(), buffers));
+  }
+
   Local<Object> info = Object::New(env->isolate());
   info->Set(env->rss_string(), Number::New(env->isolate(), rss));
   info->Set(env->heap_total_string(), heap_total);
   info->Set(env->heap_used_string(), heap_used);
   info->Set(env->external_string(), external_mem);
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "externalBreakdown"),
+            breakdown);
 
   args.GetReturnValue().Set(info);
 }
@@ -2327,6 +2375,107 @@ void CPUUsage(const FunctionCallbackInfo<Value>& args) {
   fields[1] = MICROS_PER_SEC * rusage.ru_stime.tv_sec + rusage.ru_stime.tv_usec;
 }
 
+
+// ThreadpoolUsage fills the Float64Array argument with the statistics libuv
+// keeps for each thread pool work class, UV_WORK_CLASS_MAX groups of
+// (limit, queued, running, completed, wait time, run time, wait time
+// histogram, run time histogram). Times are in nanoseconds and converted to
+// microseconds on the JS side.
+void ThreadpoolUsage(const FunctionCallbackInfo<Value>& args) {
+  const size_t kFieldsPerClass = 6 + 2 * UV_THREADPOOL_HISTOGRAM_SIZE;
+
+  CHECK(args[0]->IsFloat64Array());
+  Local<Float64Array> array = args[0].As<Float64Array>();
+  CHECK_EQ(array->Length(), kFieldsPerClass * UV_WORK_CLASS_MAX);
+  Local<ArrayBuffer> ab = array->Buffer();
+  double* fields = static_cast<double*>(ab->GetContents().Data());
+
+  for (int i = 0; i < UV_WORK_CLASS_MAX; i++) {
+    uv_threadpool_stats_t stats;
+    CHECK_EQ(0, uv_threadpool_get_stats(static_cast<uv_work_class_t>(i),
+                                        &stats));
+    double* f = fields + i * kFieldsPerClass;
+    f[0] = stats.limit;
+    f[1] = stats.queued;
+    f[2] = stats.running;
+    f[3] = static_cast<double>(stats.completed);
+    f[4] = static_cast<double>(stats.wait_time);
+    f[5] = static_cast<double>(stats.run_time);
+    f += 6;
+    for (int n = 0; n < UV_THREADPOOL_HISTOGRAM_SIZE; n++) {
+      f[n] = static_cast<double>(stats.wait_histogram[n]);
+      f[n + UV_THREADPOOL_HISTOGRAM_SIZE] =
+          static_cast<double>(stats.run_histogram[n]);
+    }
+  }
+}
+
+
+// ThreadpoolInfo fills the Float64Array argument with the minimum, maximum
+// and current size of the thread pool, the number of idle threads and the
+// number of requests waiting for a thread.
+void ThreadpoolInfo(const FunctionCallbackInfo<Value>& args) {
+  uv_threadpool_info_t info;
+
+  CHECK(args[0]->IsFloat64Array());
+  Local<Float64Array> array = args[0].As<Float64Array>();
+  CHECK_EQ(array->Length(), 5);
+  Local<ArrayBuffer> ab = array->Buffer();
+  double* fields = static_cast<double*>(ab->GetContents().Data());
+
+  CHECK_EQ(0, uv_threadpool_get_info(&info));
+  fields[0] = info.min_size;
+  fields[1] = info.max_size;
+  fields[2] = info.size;
+  fields[3] = info.idle;
+  fields[4] = info.queued;
+}
+
+
+// LoopUsage fills the Float64Array argument with the number of iterations of
+// the event loop, the time it spent waiting for I/O and the time it spent in
+// each of the UV_PHASE_MAX phases of uv_run(). The counters are enabled by
+// the first call. Times are in nanoseconds and converted to microseconds on
+// the JS side. Returns the error message if the platform does not support it.
+void LoopUsage(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  uv_loop_metrics_t metrics;
+
+  int err = uv_loop_get_metrics(env->event_loop(), &metrics);
+  if (err == UV_EINVAL) {
+    err = uv_loop_configure(env->event_loop(), UV_LOOP_METRICS);
+    if (err == 0)
+      err = uv_loop_get_metrics(env->event_loop(), &metrics);
+  }
+  if (err) {
+    Local<String> errmsg = OneByteString(args.GetIsolate(), uv_strerror(err));
+    args.GetReturnValue().Set(errmsg);
+    return;
+  }
+
+  CHECK(args[0]->IsFloat64Array());
+  Local<Float64Array> array = args[0].As<Float64Array>();
+  CHECK_EQ(array->Length(), 2 + UV_PHASE_MAX);
+  Local<ArrayBuffer> ab = array->Buffer();
+  double* fields = static_cast<double*>(ab->GetContents().Data());
+
+  fields[0] = static_cast<double>(metrics.iterations);
+  fields[1] = static_cast<double>(metrics.idle_time);
+  for (int i = 0; i < UV_PHASE_MAX; i++)
+    fields[2 + i] = static_cast<double>(metrics.phase_time[i]);
+}
+
+// SetThreadpoolSize(min, max) resizes the thread pool. Returns a libuv error
+// code, the arguments are validated on the JS side.
+void SetThreadpoolSize(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsUint32());
+  CHECK(args[1]->IsUint32());
+  int err = uv_threadpool_set_size(args[0]->Uint32Value(),
+                                   args[1]->Uint32Value());
+  args.GetReturnValue().Set(err);
+}
+
+
 extern "C" void node_module_register(void* m) {
   struct node_module* mp = reinterpret_cast<struct node_module*>(m);
 
@@ -2380,8 +2529,6 @@ void DLOpen(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   uv_lib_t lib;
 
-  CHECK_EQ(modpending, nullptr);
-
   if (args.Length() != 2) {
     env->ThrowError("process.dlopen takes exactly 2 arguments.");
     return;
@@ -2389,13 +2536,31 @@ void DLOpen(const FunctionCallbackInfo<Value>& args) {
 
   Local<Object> module = args[0]->ToObject(env->isolate());  // Cast
   node::Utf8Value filename(env->isolate(), args[1]);  // Cast
-  const bool is_dlopen_error = uv_dlopen(*filename, &lib);
+  bool is_dlopen_error;
+  bool is_loaded = false;
+  node_module* mp;
 
-  // Objects containing v14 or later modules will have registered themselves
-  // on the pending list.  Activate all of them now.  At present, only one
-  // module per object is supported.
-  node_module* const mp = modpending;
-  modpending = nullptr;
+  {
+    Mutex::ScopedLock scoped_lock(dlib_mutex);
+    CHECK_EQ(modpending, nullptr);
+    is_dlopen_error = uv_dlopen(*filename, &lib);
+
+    // Objects containing v14 or later modules will have registered themselves
+    // on the pending list.  Activate all of them now.  At present, only one
+    // module per object is supported.
+    mp = modpending;
+    modpending = nullptr;
+
+    // An object that is already loaded, e.g. by another thread, does not
+    // register itself again.
+    if (mp == nullptr && !is_dlopen_error) {
+      for (mp = modlist_addon; mp != nullptr; mp = mp->nm_link) {
+        if (mp->nm_dso_handle == lib.handle)
+          break;
+      }
+      is_loaded = mp != nullptr;
+    }
+  }
 
   if (is_dlopen_error) {
     Local<String> errmsg = OneByteString(env->isolate(), uv_dlerror(&lib));
@@ -2436,10 +2601,22 @@ void DLOpen(const FunctionCallbackInfo<Value>& args) {
     env->ThrowError("Built-in module self-registered.");
     return;
   }
+  // Modules that are not context-aware keep their state in globals that
+  // would be shared with the main thread.
+  if (env->worker_context() != nullptr &&
+      mp->nm_context_register_func == nullptr) {
+    uv_dlclose(&lib);
+    env->ThrowError("Module did not self-register as context-aware and "
+                    "cannot be loaded in a worker thread.");
+    return;
+  }
 
-  mp->nm_dso_handle = lib.handle;
-  mp->nm_link = modlist_addon;
-  modlist_addon = mp;
+  if (!is_loaded) {
+    Mutex::ScopedLock scoped_lock(dlib_mutex);
+    mp->nm_dso_handle = lib.handle;
+    mp->nm_link = modlist_addon;
+    modlist_addon = mp;
+  }
 
   Local<String> exports_string = env->exports_string();
   Local<Object> exports = module->Get(exports_string)->ToObject(env->isolate());
@@ -2506,6 +2683,10 @@ void FatalException(Isolate* isolate,
     Local<Value> caught =
         fatal_exception_function->Call(process_object, 1, &error);
 
+    // The handler stopped the worker thread it runs in.
+    if (fatal_try_catch.HasTerminated())
+      return;
+
     if (fatal_try_catch.HasCaught()) {
       // the fatal exception function threw, so we must exit
       ReportException(env, fatal_try_catch);
@@ -2519,11 +2700,14 @@ void FatalException(Isolate* isolate,
   }
 
   if (exit_code) {
+    if (env->worker_context() != nullptr)
+      return env->worker_context()->Exit(exit_code);
 #if HAVE_INSPECTOR
     if (use_inspector) {
       env->inspector_agent()->FatalException(error, message);
     }
 #endif
+    worker::Worker::StopAll(env);
     exit(exit_code);
   }
 }
@@ -2631,6 +2815,10 @@ static void Binding(const FunctionCallbackInfo<Value>& args) {
     exports = Object::New(env->isolate());
     DefineJavaScript(env, exports);
     cache->Set(module, exports);
+  } else if (!strcmp(*module_v, "code_cache")) {
+    exports = Object::New(env->isolate());
+    DefineCodeCache(env, exports);
+    cache->Set(module, exports);
   } else {
     char errmsg[1024];
     snprintf(errmsg,
@@ -2705,12 +2893,28 @@ static void ProcessTitleSetter(Local<Name> property,
 }
 
 
+// Worker threads keep their environment variables in a map of their own, see
+// Environment::env_vars().
+typedef std::map<std::string, std::string> EnvVars;
+
+
 static void EnvGetter(Local<Name> property,
                       const PropertyCallbackInfo<Value>& info) {
   Isolate* isolate = info.GetIsolate();
   if (property->IsSymbol()) {
     return info.GetReturnValue().SetUndefined();
   }
+  if (EnvVars* vars = Environment::GetCurrent(info)->env_vars()) {
+    node::Utf8Value key(isolate, property);
+    auto it = vars->find(*key);
+    if (it != vars->end()) {
+      info.GetReturnValue().Set(String::NewFromUtf8(isolate,
+                                                    it->second.data(),
+                                                    String::kNormalString,
+                                                    it->second.size()));
+    }
+    return;
+  }
 #ifdef __POSIX__
   node::Utf8Value key(isolate, property);
   const char* val = getenv(*key);
@@ -2739,6 +2943,12 @@ static void EnvGetter(Local<Name> property,
 static void EnvSetter(Local<Name> property,
                       Local<Value> value,
                       const PropertyCallbackInfo<Value>& info) {
+  if (EnvVars* vars = Environment::GetCurrent(info)->env_vars()) {
+    node::Utf8Value key(info.GetIsolate(), property);
+    node::Utf8Value val(info.GetIsolate(), value);
+    (*vars)[*key] = *val;
+    return info.GetReturnValue().Set(value);
+  }
 #ifdef __POSIX__
   node::Utf8Value key(info.GetIsolate(), property);
   node::Utf8Value val(info.GetIsolate(), value);
@@ -2760,6 +2970,12 @@ static void EnvSetter(Local<Name> property,
 static void EnvQuery(Local<Name> property,
                      const PropertyCallbackInfo<Integer>& info) {
   int32_t rc = -1;  // Not found unless proven otherwise.
+  if (EnvVars* vars = Environment::GetCurrent(info)->env_vars()) {
+    node::Utf8Value key(info.GetIsolate(), property);
+    if (vars->count(*key) != 0)
+      info.GetReturnValue().Set(0);
+    return;
+  }
 #ifdef __POSIX__
   node::Utf8Value key(info.GetIsolate(), property);
   if (getenv(*key))
@@ -2785,6 +3001,11 @@ static void EnvQuery(Local<Name> property,
 
 static void EnvDeleter(Local<Name> property,
                        const PropertyCallbackInfo<Boolean>& info) {
+  if (EnvVars* vars = Environment::GetCurrent(info)->env_vars()) {
+    node::Utf8Value key(info.GetIsolate(), property);
+    vars->erase(*key);
+    return info.GetReturnValue().Set(true);
+  }
 #ifdef __POSIX__
   node::Utf8Value key(info.GetIsolate(), property);
   unsetenv(*key);
@@ -2808,6 +3029,24 @@ static void EnvEnumerator(const PropertyCallbackInfo<Array>& info) {
   Local<Value> argv[NODE_PUSH_VAL_TO_ARRAY_MAX];
   size_t idx = 0;
 
+  if (EnvVars* vars = env->env_vars()) {
+    Local<Array> envarr = Array::New(isolate);
+    for (const auto& var : *vars) {
+      argv[idx] = String::NewFromUtf8(isolate,
+                                      var.first.data(),
+                                      String::kNormalString,
+                                      var.first.size());
+      if (++idx >= arraysize(argv)) {
+        fn->Call(ctx, envarr, idx, argv).ToLocalChecked();
+        idx = 0;
+      }
+    }
+    if (idx > 0) {
+      fn->Call(ctx, envarr, idx, argv).ToLocalChecked();
+    }
+    return info.GetReturnValue().Set(envarr);
+  }
+
 #ifdef __POSIX__
   int size = 0;
   while (environ[size])
@@ -2871,6 +3110,39 @@ static void EnvEnumerator(const PropertyCallbackInfo<Array>& info) {
 }
 
 
+void CopyEnvVars(Environment* env, EnvVars* vars) {
+  if (env->env_vars() != nullptr) {
+    *vars = *env->env_vars();
+    return;
+  }
+#ifdef __POSIX__
+  for (char** var = environ; *var != nullptr; var++) {
+    const char* s = strchr(*var, '=');
+    if (s != nullptr)
+      vars->emplace(std::string(*var, s - *var), std::string(s + 1));
+  }
+#else  // _WIN32
+  WCHAR* environment = GetEnvironmentStringsW();
+  if (environment == nullptr)
+    return;
+  for (WCHAR* p = environment; *p; p += wcslen(p) + 1) {
+    // Variables that start with '=' are hidden.
+    if (*p == L'=')
+      continue;
+    int size = WideCharToMultiByte(CP_UTF8, 0, p, -1, nullptr, 0,
+                                   nullptr, nullptr);
+    std::string var(size, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, p, -1, &var[0], size, nullptr, nullptr);
+    var.resize(size - 1);  // Without the terminating '\0'.
+    const size_t eq = var.find('=');
+    if (eq != std::string::npos)
+      vars->emplace(var.substr(0, eq), var.substr(eq + 1));
+  }
+  FreeEnvironmentStringsW(environment);
+#endif
+}
+
+
 static Local<Object> GetFeatures(Environment* env) {
   EscapableHandleScope scope(env->isolate());
 
@@ -3204,25 +3476,29 @@ void SetupProcessObject(Environment* env,
                              NeedImmediateCallbackSetter,
                              env->as_external()).FromJust());
 
+  // The options below select the main script. Worker threads get theirs
+  // from the Worker constructor instead.
+  const bool is_main_thread = env->worker_context() == nullptr;
+
   // -e, --eval
-  if (eval_string) {
+  if (eval_string && is_main_thread) {
     READONLY_PROPERTY(process,
                       "_eval",
                       String::NewFromUtf8(env->isolate(), eval_string));
   }
 
   // -p, --print
-  if (print_eval) {
+  if (print_eval && is_main_thread) {
     READONLY_PROPERTY(process, "_print_eval", True(env->isolate()));
   }
 
   // -c, --check
-  if (syntax_check_only) {
+  if (syntax_check_only && is_main_thread) {
     READONLY_PROPERTY(process, "_syntax_check_only", True(env->isolate()));
   }
 
   // -i, --interactive
-  if (force_repl) {
+  if (force_repl && is_main_thread) {
     READONLY_PROPERTY(process, "_forceRepl", True(env->isolate()));
   }
 
@@ -3276,6 +3552,23 @@ void SetupProcessObject(Environment* env,
     READONLY_PROPERTY(process, "traceDeprecation", True(env->isolate()));
   }
 
+  // --trace-module-load
+  if (trace_module_load) {
+    READONLY_PROPERTY(process, "_traceModuleLoad", True(env->isolate()));
+  }
+
+  // --callback-stats
+  if (callback_stats) {
+    READONLY_PROPERTY(process, "_callbackStats", True(env->isolate()));
+  }
+
+  // --cpu-prof-signal
+  if (cpu_prof_signal != nullptr) {
+    READONLY_PROPERTY(process,
+                      "_cpuProfSignal",
+                      OneByteString(env->isolate(), cpu_prof_signal));
+  }
+
   // --debug-brk
   if (debug_wait_connect) {
     READONLY_PROPERTY(process, "_debugWaitConnect", True(env->isolate()));
@@ -3354,6 +3647,10 @@ void SetupProcessObject(Environment* env,
   env->SetMethod(process, "hrtime", Hrtime);
 
   env->SetMethod(process, "cpuUsage", CPUUsage);
+  env->SetMethod(process, "threadpoolUsage", ThreadpoolUsage);
+  env->SetMethod(process, "threadpoolInfo", ThreadpoolInfo);
+  env->SetMethod(process, "setThreadpoolSize", SetThreadpoolSize);
+  env->SetMethod(process, "loopUsage", LoopUsage);
 
   env->SetMethod(process, "dlopen", DLOpen);
 
@@ -3575,6 +3872,12 @@ static void PrintHelp() {
          "  --trace-warnings      show stack traces on process warnings\n"
          "  --trace-sync-io       show stack trace when use of sync IO\n"
          "                        is detected after the first tick\n"
+         "  --trace-module-load   print how long each core module takes to\n"
+         "                        load\n"
+         "  --callback-stats      count callbacks and their run time per\n"
+         "                        async resource type, print on SIGUSR2\n"
+         "  --cpu-prof-signal=sig start and stop the sampling CPU profiler\n"
+         "                        on the signal, e.g. SIGUSR2\n"
          "  --track-heap-objects  track heap object allocations for heap "
          "snapshots\n"
          "  --prof-process        process v8 profiler output generated\n"
@@ -3617,6 +3920,11 @@ static void PrintHelp() {
          "                         (will extend linked-in data)\n"
 #endif
 #endif
+         "NODE_COMPILE_CACHE       directory in which to keep the V8 code\n"
+         "                         cache of loaded modules\n"
+         "NODE_MODULE_RESOLUTION_CACHE\n"
+         "                         path to the persistent module resolution\n"
+         "                         cache file\n"
          "NODE_REPL_HISTORY        path to the persistent REPL history file\n"
          "\n"
          "Documentation can be found at https://nodejs.org/\n");
@@ -3723,6 +4031,12 @@ static void ParseArgs(int* argc,
       trace_deprecation = true;
     } else if (strcmp(arg, "--trace-sync-io") == 0) {
       trace_sync_io = true;
+    } else if (strcmp(arg, "--trace-module-load") == 0) {
+      trace_module_load = true;
+    } else if (strcmp(arg, "--callback-stats") == 0) {
+      callback_stats = true;
+    } else if (strncmp(arg, "--cpu-prof-signal=", 18) == 0) {
+      cpu_prof_signal = arg + 18;
     } else if (strcmp(arg, "--track-heap-objects") == 0) {
       track_heap_objects = true;
     } else if (strcmp(arg, "--throw-deprecation") == 0) {
@@ -4419,6 +4733,11 @@ inline int Start(Isolate* isolate, IsolateData* isolate_data,
   Environment env(isolate_data, context);
   env.Start(argc, argv, exec_argc, exec_argv, v8_is_profiling);
 
+  if (callback_stats) {
+    AsyncWrap::EnableCallbackStats(&env);
+    env.PrintCallbackStatsOnSignal();
+  }
+
   // Start debug agent when argv has --debug
   if (use_debug_agent) {
     const char* path = argc > 1 ? argv[1] : nullptr;
@@ -4463,6 +4782,9 @@ inline int Start(Isolate* isolate, IsolateData* isolate_data,
   const int exit_code = EmitExit(&env);
   RunAtExit(&env);
 
+  // Worker threads that have been unref()ed may still be running.
+  worker::Worker::StopAll(&env);
+
   WaitForInspectorDisconnect(&env);
 #if defined(LEAK_SANITIZER)
   __lsan_do_leak_check();
@@ -4471,19 +4793,16 @@ inline int Start(Isolate* isolate, IsolateData* isolate_data,
   return exit_code;
 }
 
-inline int Start(uv_loop_t* event_loop,
-                 int argc, const char* const* argv,
-                 int exec_argc, const char* const* exec_argv) {
+Isolate* NewIsolate(ArrayBufferAllocator* allocator) {
   Isolate::CreateParams params;
-  ArrayBufferAllocator allocator;
-  params.array_buffer_allocator = &allocator;
+  params.array_buffer_allocator = allocator;
 #ifdef NODE_ENABLE_VTUNE_PROFILING
   params.code_event_handler = vTune::GetVtuneCodeEventHandler();
 #endif
 
   Isolate* const isolate = Isolate::New(params);
   if (isolate == nullptr)
-    return 12;  // Signal internal error.
+    return nullptr;
 
   isolate->AddMessageListener(OnMessage);
   isolate->SetAbortOnUncaughtExceptionCallback(ShouldAbortOnUncaughtException);
@@ -4494,6 +4813,23 @@ inline int Start(uv_loop_t* event_loop,
     isolate->GetHeapProfiler()->StartTrackingHeapObjects(true);
   }
 
+  return isolate;
+}
+
+
+void PumpPlatformMessageLoop(Isolate* isolate) {
+  v8_platform.PumpMessageLoop(isolate);
+}
+
+
+inline int Start(uv_loop_t* event_loop,
+                 int argc, const char* const* argv,
+                 int exec_argc, const char* const* exec_argv) {
+  ArrayBufferAllocator allocator;
+  Isolate* const isolate = NewIsolate(&allocator);
+  if (isolate == nullptr)
+    return 12;  // Signal internal error.
+
   {
     Mutex::ScopedLock scoped_lock(node_isolate_mutex);
     CHECK_EQ(node_isolate, nullptr);
@@ -4505,7 +4841,8 @@ inline int Start(uv_loop_t* event_loop,
     Locker locker(isolate);
     Isolate::Scope isolate_scope(isolate);
     HandleScope handle_scope(isolate);
-    IsolateData isolate_data(isolate, event_loop, allocator.zero_fill_field());
+    IsolateData isolate_data(isolate, event_loop, allocator.zero_fill_field(),
+                             &allocator);
     exit_code = Start(isolate, &isolate_data, argc, argv, exec_argc, exec_argv);
   }
 
@@ -68,20 +68,21 @@ using v8::WeakCallbackInfo;
 class CallbackInfo {
  public:
   static inline void Free(char* data, void* hint);
-  static inline CallbackInfo* New(Isolate* isolate,
+  static inline CallbackInfo* New(Environment* env,
                                   Local<ArrayBuffer> object,
                                   FreeCallback callback,
                                   char* data,
                                   void* hint = 0);
  private:
   static void WeakCallback(const WeakCallbackInfo<CallbackInfo>&);
-  inline void WeakCallback(Isolate* isolate);
-  inline CallbackInfo(Isolate* isolate,
+  inline void WeakCallback();
+  inline CallbackInfo(Environment* env,
                       Local<ArrayBuffer> object,
                       FreeCallback callback,
                       char* data,
                       void* hint);
   ~CallbackInfo();
+  Environment* const env_;
   Persistent<ArrayBuffer> persistent_;
   FreeCallback const callback_;
   char* const data_;
@@ -95,21 +96,22 @@ void CallbackInfo::Free(char* data, void*) {
 }
 
 
-CallbackInfo* CallbackInfo::New(Isolate* isolate,
+CallbackInfo* CallbackInfo::New(Environment* env,
                                 Local<ArrayBuffer> object,
                                 FreeCallback callback,
                                 char* data,
                                 void* hint) {
-  return new CallbackInfo(isolate, object, callback, data, hint);
+  return new CallbackInfo(env, object, callback, data, hint);
 }
 
 
-CallbackInfo::CallbackInfo(Isolate* isolate,
+CallbackInfo::CallbackInfo(Environment* env,
                            Local<ArrayBuffer> object,
                            FreeCallback callback,
                            char* data,
                            void* hint)
-    : persistent_(isolate, object),
+    : env_(env),
+      persistent_(env->isolate(), object),
       callback_(callback),
       data_(data),
       hint_(hint) {
@@ -121,7 +123,8 @@ CallbackInfo::CallbackInfo(Isolate* isolate,
   persistent_.SetWeak(this, WeakCallback, v8::WeakCallbackType::kParameter);
   persistent_.SetWrapperClassId(BUFFER_ID);
   persistent_.MarkIndependent();
-  isolate->AdjustAmountOfExternalAllocatedMemory(sizeof(*this));
+  env_->AdjustExternalMemory(Environment::kExternalMemoryBuffers,
+                             sizeof(*this));
 }
 
 
@@ -133,15 +136,24 @@ CallbackInfo::~CallbackInfo() {
 void CallbackInfo::WeakCallback(
     const WeakCallbackInfo<CallbackInfo>& data) {
   CallbackInfo* self = data.GetParameter();
-  self->WeakCallback(data.GetIsolate());
+  self->WeakCallback();
   delete self;
 }
 
 
-void CallbackInfo::WeakCallback(Isolate* isolate) {
+void CallbackInfo::WeakCallback() {
   callback_(data_, hint_);
   int64_t change_in_bytes = -static_cast<int64_t>(sizeof(*this));
-  isolate->AdjustAmountOfExternalAllocatedMemory(change_in_bytes);
+  env_->AdjustExternalMemory(Environment::kExternalMemoryBuffers,
+                             change_in_bytes);
+}
+
+
+// Memory that node allocated itself and handed over to an ArrayBuffer is
+// freed through the ArrayBufferAllocator, which needs to know about it.
+inline void TrackAdoptedMemory(Environment* env, size_t length) {
+  if (ArrayBufferAllocator* allocator = env->isolate_data()->allocator())
+    allocator->Track(length);
 }
 
 
@@ -279,6 +291,7 @@ MaybeLocal<Object> New(Environment* env, size_t length) {
         data,
         length,
         ArrayBufferCreationMode::kInternalized);
+  TrackAdoptedMemory(env, length);
   Local<Uint8Array> ui = Uint8Array::New(ab, 0, length);
   Maybe<bool> mb =
       ui->SetPrototype(env->context(), env->buffer_prototype_object());
@@ -325,6 +338,7 @@ MaybeLocal<Object> Copy(Environment* env, const char* data, size_t length) {
         new_data,
         length,
         ArrayBufferCreationMode::kInternalized);
+  TrackAdoptedMemory(env, length);
   Local<Uint8Array> ui = Uint8Array::New(ab, 0, length);
   Maybe<bool> mb =
       ui->SetPrototype(env->context(), env->buffer_prototype_object());
@@ -375,7 +389,7 @@ MaybeLocal<Object> New(Environment* env,
   if (!mb.FromMaybe(false))
     return Local<Object>();
 
-  CallbackInfo::New(env->isolate(), ab, callback, data, hint);
+  CallbackInfo::New(env, ab, callback, data, hint);
   return scope.Escape(ui);
 }
 
@@ -403,6 +417,7 @@ MaybeLocal<Object> New(Environment* env, char* data, size_t length) {
                        data,
                        length,
                        ArrayBufferCreationMode::kInternalized);
+  TrackAdoptedMemory(env, length);
   Local<Uint8Array> ui = Uint8Array::New(ab, 0, length);
   Maybe<bool> mb =
       ui->SetPrototype(env->context(), env->buffer_prototype_object());
@@ -1150,6 +1165,70 @@ void IndexOfNumber(const FunctionCallbackInfo<Value>& args) {
                                 : -1);
 }
 
+// compileSearcher(needle) returns the tables for a Boyer-Moore search, which
+// a searcher keeps along with its needle.
+void CompileSearcher(const FunctionCallbackInfo<Value>& args) {
+  typedef stringsearch::StringSearch<uint8_t> Search;
+  Environment* env = Environment::GetCurrent(args);
+  THROW_AND_RETURN_UNLESS_BUFFER(env, args[0]);
+  SPREAD_BUFFER_ARG(args[0], needle);
+
+  Local<Object> tables;
+  if (!New(env, Search::kTablesLength * sizeof(int)).ToLocal(&tables))
+    return;
+  if (needle_length > 0) {
+    Search search(
+        Vector<const uint8_t>(reinterpret_cast<const uint8_t*>(needle_data),
+                              needle_length,
+                              true),
+        reinterpret_cast<int*>(Data(tables)));
+    search.PopulateTables();
+  }
+  args.GetReturnValue().Set(tables);
+}
+
+// indexOfSearcher(buffer, needle, tables, byteOffset) is indexOf() for a
+// needle with tables from compileSearcher().
+void IndexOfSearcher(const FunctionCallbackInfo<Value>& args) {
+  typedef stringsearch::StringSearch<uint8_t> Search;
+  ASSERT(args[3]->IsNumber());
+
+  THROW_AND_RETURN_UNLESS_BUFFER(Environment::GetCurrent(args), args[0]);
+  SPREAD_BUFFER_ARG(args[0], ts_obj);
+  SPREAD_BUFFER_ARG(args[1], needle);
+  SPREAD_BUFFER_ARG(args[2], tables);
+  CHECK_EQ(tables_length, Search::kTablesLength * sizeof(int));
+  CHECK_EQ(reinterpret_cast<uintptr_t>(tables_data) % sizeof(int), 0);
+  int64_t offset_i64 = args[3]->IntegerValue();
+
+  const uint8_t* haystack = reinterpret_cast<const uint8_t*>(ts_obj_data);
+  const size_t haystack_length = ts_obj_length;
+
+  if (needle_length == 0 || haystack_length == 0) {
+    return args.GetReturnValue().Set(-1);
+  }
+
+  int64_t opt_offset = IndexOfOffset(haystack_length, offset_i64, true);
+  if (opt_offset <= -1) {
+    return args.GetReturnValue().Set(-1);
+  }
+  size_t offset = static_cast<size_t>(opt_offset);
+  CHECK_LT(offset, haystack_length);
+  if (needle_length + offset > haystack_length) {
+    return args.GetReturnValue().Set(-1);
+  }
+
+  Vector<const uint8_t> v_haystack(haystack, haystack_length, true);
+  Vector<const uint8_t> v_needle(reinterpret_cast<const uint8_t*>(needle_data),
+                                 needle_length,
+                                 true);
+  Search search(v_needle, reinterpret_cast<int*>(tables_data));
+  const size_t result = search.Search(v_haystack, offset);
+
+  args.GetReturnValue().Set(
+      result == haystack_length ? -1 : static_cast<int>(result));
+}
+
 
 void Swap16(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
@@ -1230,6 +1309,8 @@ void Initialize(Local<Object> target,
   env->SetMethod(target, "indexOfBuffer", IndexOfBuffer);
   env->SetMethod(target, "indexOfNumber", IndexOfNumber);
   env->SetMethod(target, "indexOfString", IndexOfString);
+  env->SetMethod(target, "indexOfSearcher", IndexOfSearcher);
+  env->SetMethod(target, "compileSearcher", CompileSearcher);
 
   env->SetMethod(target, "readDoubleBE", ReadDoubleBE);
   env->SetMethod(target, "readDoubleLE", ReadDoubleLE);
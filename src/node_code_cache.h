@@ -0,0 +1,42 @@
+#ifndef SRC_NODE_CODE_CACHE_H_
+#define SRC_NODE_CODE_CACHE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+
+// V8 code cache for one of the JS sources from node_natives.h. source_length
+// and source_hash identify the source the cache was produced for; a cache for
+// a different source is never handed to V8.
+struct CodeCacheEntry {
+  const char* id;
+  const uint8_t* data;
+  size_t length;
+  size_t source_length;
+  uint32_t source_hash;
+};
+
+// Defined in the file generated by tools/generate_code_cache.js, or in
+// node_code_cache_stub.cc when node is built without a code cache.
+extern const CodeCacheEntry code_cache_entries[];
+extern const size_t code_cache_entry_count;
+
+// FNV-1a hash of a native module's source, computed the same way by
+// tools/generate_code_cache.js.
+inline uint32_t CodeCacheSourceHash(const uint8_t* data, size_t length) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_CODE_CACHE_H_
@@ -0,0 +1,13 @@
+#include "node_code_cache.h"
+
+// Used when node is built without an embedded code cache, see
+// tools/generate_code_cache.js and the --code-cache-path configure option.
+
+namespace node {
+
+const CodeCacheEntry code_cache_entries[] = {
+  { nullptr, nullptr, 0, 0, 0 }
+};
+const size_t code_cache_entry_count = 0;
+
+}  // namespace node
@@ -2507,7 +2507,7 @@ void SSLWrap<Base>::DestroySSL() {
     return;
 
   SSL_free(ssl_);
-  env_->isolate()->AdjustAmountOfExternalAllocatedMemory(-kExternalSize);
+  env_->AdjustExternalMemory(Environment::kExternalMemoryTLS, -kExternalSize);
   ssl_ = nullptr;
 }
 
@@ -5390,10 +5390,11 @@ void PBKDF2(const FunctionCallbackInfo<Value>& args) {
 
     if (env->in_domain())
       obj->Set(env->domain_string(), env->domain_array()->Get(0));
-    uv_queue_work(env->event_loop(),
-                  req->work_req(),
-                  EIO_PBKDF2,
-                  EIO_PBKDF2After);
+    uv_queue_work_class(env->event_loop(),
+                        req->work_req(),
+                        UV_WORK_CPU,
+                        EIO_PBKDF2,
+                        EIO_PBKDF2After);
   } else {
     env->PrintSyncTrace();
     Local<Value> argv[2];
@@ -5550,10 +5551,11 @@ void RandomBytes(const FunctionCallbackInfo<Value>& args) {
 
     if (env->in_domain())
       obj->Set(env->domain_string(), env->domain_array()->Get(0));
-    uv_queue_work(env->event_loop(),
-                  req->work_req(),
-                  RandomBytesWork,
-                  RandomBytesAfter);
+    uv_queue_work_class(env->event_loop(),
+                        req->work_req(),
+                        UV_WORK_CPU,
+                        RandomBytesWork,
+                        RandomBytesAfter);
     args.GetReturnValue().Set(obj);
   } else {
     env->PrintSyncTrace();
@@ -136,7 +136,7 @@ class SecureContext : public BaseObject {
         cert_(nullptr),
         issuer_(nullptr) {
     MakeWeak<SecureContext>(this);
-    env->isolate()->AdjustAmountOfExternalAllocatedMemory(kExternalSize);
+    env->AdjustExternalMemory(Environment::kExternalMemoryTLS, kExternalSize);
   }
 
   void FreeCTXMem() {
@@ -144,7 +144,8 @@ class SecureContext : public BaseObject {
       return;
     }
 
-    env()->isolate()->AdjustAmountOfExternalAllocatedMemory(-kExternalSize);
+    env()->AdjustExternalMemory(Environment::kExternalMemoryTLS,
+                                -kExternalSize);
     SSL_CTX_free(ctx_);
     if (cert_ != nullptr)
       X509_free(cert_);
@@ -176,7 +177,7 @@ class SSLWrap {
         cert_cb_arg_(nullptr),
         cert_cb_running_(false) {
     ssl_ = SSL_new(sc->ctx_);
-    env_->isolate()->AdjustAmountOfExternalAllocatedMemory(kExternalSize);
+    env_->AdjustExternalMemory(Environment::kExternalMemoryTLS, kExternalSize);
     CHECK_NE(ssl_, nullptr);
   }
 
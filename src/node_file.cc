@@ -135,6 +135,121 @@ static inline bool IsInt64(double x) {
   return x == static_cast<double>(static_cast<int64_t>(x));
 }
 
+// Drains a completed scandir request into an array of names and, when
+// |types| is not null, a parallel array of uv_dirent_type_t values.  The
+// entries are pushed into the arrays in batches to keep the number of
+// calls into JS down.  Returns 0 on success or a libuv error code, in
+// which case |msg| may point to a more descriptive error message.
+static int ScanDirEntries(Environment* env,
+                          uv_fs_t* req,
+                          enum encoding encoding,
+                          Local<Value>* names,
+                          Local<Value>* types,
+                          const char** msg) {
+  Local<Array> name_array = Array::New(env->isolate(), 0);
+  Local<Array> type_array = Array::New(env->isolate(), 0);
+  Local<Function> fn = env->push_values_to_array_function();
+  Local<Value> name_v[NODE_PUSH_VAL_TO_ARRAY_MAX];
+  Local<Value> type_v[NODE_PUSH_VAL_TO_ARRAY_MAX];
+  size_t idx = 0;
+
+  for (;;) {
+    uv_dirent_t ent;
+
+    int r = uv_fs_scandir_next(req, &ent);
+    if (r == UV_EOF)
+      break;
+    if (r != 0)
+      return r;
+
+    Local<Value> filename = StringBytes::Encode(env->isolate(),
+                                                ent.name,
+                                                encoding);
+    if (filename.IsEmpty()) {
+      *msg = "Invalid character encoding for filename";
+      return UV_EINVAL;
+    }
+
+    name_v[idx] = filename;
+    if (types != nullptr)
+      type_v[idx] = Integer::New(env->isolate(), ent.type);
+
+    if (++idx >= arraysize(name_v)) {
+      fn->Call(env->context(), name_array, idx, name_v).ToLocalChecked();
+      if (types != nullptr)
+        fn->Call(env->context(), type_array, idx, type_v).ToLocalChecked();
+      idx = 0;
+    }
+  }
+
+  if (idx > 0) {
+    fn->Call(env->context(), name_array, idx, name_v).ToLocalChecked();
+    if (types != nullptr)
+      fn->Call(env->context(), type_array, idx, type_v).ToLocalChecked();
+  }
+
+  *names = name_array;
+  if (types != nullptr)
+    *types = type_array;
+  return 0;
+}
+
+// Returns the result of a scandir call with file types as a two element
+// array of the form [names, types].
+static Local<Value> ScanDirResultWithTypes(Environment* env,
+                                          Local<Value> names,
+                                          Local<Value> types) {
+  Local<Array> result = Array::New(env->isolate(), 2);
+  result->Set(0, names);
+  result->Set(1, types);
+  return result;
+}
+
+static void AfterScanDirWithTypes(uv_fs_t* req) {
+  FSReqWrap* req_wrap = static_cast<FSReqWrap*>(req->data);
+  CHECK_EQ(req_wrap->req(), req);
+  req_wrap->ReleaseEarly();  // Free memory that's no longer used now.
+
+  Environment* env = req_wrap->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  int argc = 1;
+  Local<Value> argv[2];
+
+  if (req->result < 0) {
+    argv[0] = UVException(env->isolate(),
+                          req->result,
+                          req_wrap->syscall(),
+                          nullptr,
+                          req->path,
+                          req_wrap->data());
+  } else {
+    Local<Value> names;
+    Local<Value> types;
+    const char* msg = nullptr;
+    int r = ScanDirEntries(env, req, req_wrap->encoding_, &names, &types,
+                           &msg);
+    if (r != 0) {
+      argv[0] = UVException(env->isolate(),
+                            r,
+                            req_wrap->syscall(),
+                            msg,
+                            req->path,
+                            req_wrap->data());
+    } else {
+      argv[0] = Null(env->isolate());
+      argv[1] = ScanDirResultWithTypes(env, names, types);
+      argc = 2;
+    }
+  }
+
+  req_wrap->MakeCallback(env->oncomplete_string(), argc, argv);
+
+  uv_fs_req_cleanup(req_wrap->req());
+  req_wrap->Dispose();
+}
+
 static void After(uv_fs_t *req) {
   FSReqWrap* req_wrap = static_cast<FSReqWrap*>(req->data);
   CHECK_EQ(req_wrap->req(), req);
@@ -263,52 +378,19 @@ static void After(uv_fs_t *req) {
 
       case UV_FS_SCANDIR:
         {
-          int r;
-          Local<Array> names = Array::New(env->isolate(), 0);
-          Local<Function> fn = env->push_values_to_array_function();
-          Local<Value> name_argv[NODE_PUSH_VAL_TO_ARRAY_MAX];
-          size_t name_idx = 0;
-
-          for (int i = 0; ; i++) {
-            uv_dirent_t ent;
-
-            r = uv_fs_scandir_next(req, &ent);
-            if (r == UV_EOF)
-              break;
-            if (r != 0) {
-              argv[0] = UVException(r,
-                                    nullptr,
-                                    req_wrap->syscall(),
-                                    static_cast<const char*>(req->path));
-              break;
-            }
-
-            Local<Value> filename = StringBytes::Encode(env->isolate(),
-                                                        ent.name,
-                                                        req_wrap->encoding_);
-            if (filename.IsEmpty()) {
-              argv[0] = UVException(env->isolate(),
-                                    UV_EINVAL,
-                                    req_wrap->syscall(),
-                                    "Invalid character encoding for filename",
-                                    req->path,
-                                    req_wrap->data());
-              break;
-            }
-            name_argv[name_idx++] = filename;
-
-            if (name_idx >= arraysize(name_argv)) {
-              fn->Call(env->context(), names, name_idx, name_argv)
-                  .ToLocalChecked();
-              name_idx = 0;
-            }
-          }
-
-          if (name_idx > 0) {
-            fn->Call(env->context(), names, name_idx, name_argv)
-                .ToLocalChecked();
+          Local<Value> names;
+          const char* msg = nullptr;
+          int r = ScanDirEntries(env, req, req_wrap->encoding_, &names,
+                                 nullptr, &msg);
+          if (r != 0) {
+            argv[0] = UVException(env->isolate(),
+                                  r,
+                                  req_wrap->syscall(),
+                                  msg,
+                                  req->path,
+                                  req_wrap->data());
+            break;
           }
-
           argv[1] = names;
         }
         break;
@@ -337,7 +419,7 @@ class fs_req_wrap {
 };
 
 
-#define ASYNC_DEST_CALL(func, request, dest, encoding, ...)                   \
+#define ASYNC_DEST_CALL_WITH_CB(func, request, dest, encoding, after, ...)    \
   Environment* env = Environment::GetCurrent(args);                           \
   CHECK(request->IsObject());                                                 \
   FSReqWrap* req_wrap = FSReqWrap::New(env, request.As<Object>(),             \
@@ -345,18 +427,21 @@ class fs_req_wrap {
   int err = uv_fs_ ## func(env->event_loop(),                                 \
                            req_wrap->req(),                                   \
                            __VA_ARGS__,                                       \
-                           After);                                            \
+                           after);                                            \
   req_wrap->Dispatched();                                                     \
   if (err < 0) {                                                              \
     uv_fs_t* uv_req = req_wrap->req();                                        \
     uv_req->result = err;                                                     \
     uv_req->path = nullptr;                                                   \
-    After(uv_req);                                                            \
+    after(uv_req);                                                            \
     req_wrap = nullptr;                                                       \
   } else {                                                                    \
     args.GetReturnValue().Set(req_wrap->persistent());                        \
   }
 
+#define ASYNC_DEST_CALL(func, request, dest, encoding, ...)                   \
+  ASYNC_DEST_CALL_WITH_CB(func, request, dest, encoding, After, __VA_ARGS__)  \
+
 #define ASYNC_CALL(func, req, encoding, ...)                                  \
   ASYNC_DEST_CALL(func, req, nullptr, encoding, __VA_ARGS__)                  \
 
@@ -603,6 +688,25 @@ static void InternalModuleStat(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(rc);
 }
 
+// Used by the module resolution cache in lib/internal/resolve_cache.js.
+// Returns the mtime of |path| in milliseconds, or a negative errno.
+static void InternalModuleMtime(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  node::Utf8Value path(env->isolate(), args[0]);
+
+  uv_fs_t req;
+  double mtime = uv_fs_stat(env->event_loop(), &req, *path, nullptr);
+  if (mtime == 0) {
+    const uv_stat_t* const s = static_cast<const uv_stat_t*>(req.ptr);
+    mtime = s->st_mtim.tv_sec * 1e3 + s->st_mtim.tv_nsec / 1e6;
+  }
+  uv_fs_req_cleanup(&req);
+
+  args.GetReturnValue().Set(mtime);
+}
+
 static void Stat(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -920,6 +1024,11 @@ static void RealPath(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// readdir(path, encoding, withTypes[, req])
+//
+// When withTypes is true the result is [names, types], where types holds
+// the uv_dirent_type_t of each entry as reported by scandir.  That saves
+// callers that need to tell files from directories an lstat() per entry.
 static void ReadDir(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -932,56 +1041,35 @@ static void ReadDir(const FunctionCallbackInfo<Value>& args) {
   ASSERT_PATH(path)
 
   const enum encoding encoding = ParseEncoding(env->isolate(), args[1], UTF8);
+  const bool with_types = args[2]->IsTrue();
 
   Local<Value> callback = Null(env->isolate());
-  if (argc == 3)
-    callback = args[2];
+  if (argc == 4)
+    callback = args[3];
 
   if (callback->IsObject()) {
-    ASYNC_CALL(scandir, callback, encoding, *path, 0 /*flags*/)
+    if (with_types) {
+      ASYNC_DEST_CALL_WITH_CB(scandir, callback, nullptr, encoding,
+                              AfterScanDirWithTypes, *path, 0 /*flags*/)
+    } else {
+      ASYNC_CALL(scandir, callback, encoding, *path, 0 /*flags*/)
+    }
   } else {
     SYNC_CALL(scandir, *path, *path, 0 /*flags*/)
 
     CHECK_GE(SYNC_REQ.result, 0);
-    int r;
-    Local<Array> names = Array::New(env->isolate(), 0);
-    Local<Function> fn = env->push_values_to_array_function();
-    Local<Value> name_v[NODE_PUSH_VAL_TO_ARRAY_MAX];
-    size_t name_idx = 0;
-
-    for (int i = 0; ; i++) {
-      uv_dirent_t ent;
-
-      r = uv_fs_scandir_next(&SYNC_REQ, &ent);
-      if (r == UV_EOF)
-        break;
-      if (r != 0)
-        return env->ThrowUVException(r, "readdir", "", *path);
-
-      Local<Value> filename = StringBytes::Encode(env->isolate(),
-                                                  ent.name,
-                                                  encoding);
-      if (filename.IsEmpty()) {
-        return env->ThrowUVException(UV_EINVAL,
-                                     "readdir",
-                                     "Invalid character encoding for filename",
-                                     *path);
-      }
-
-      name_v[name_idx++] = filename;
-
-      if (name_idx >= arraysize(name_v)) {
-        fn->Call(env->context(), names, name_idx, name_v)
-            .ToLocalChecked();
-        name_idx = 0;
-      }
-    }
-
-    if (name_idx > 0) {
-      fn->Call(env->context(), names, name_idx, name_v).ToLocalChecked();
-    }
-
-    args.GetReturnValue().Set(names);
+    Local<Value> names;
+    Local<Value> types;
+    const char* msg = nullptr;
+    int r = ScanDirEntries(env, &SYNC_REQ, encoding, &names,
+                           with_types ? &types : nullptr, &msg);
+    if (r != 0)
+      return env->ThrowUVException(r, "readdir", msg ? msg : "", *path);
+
+    if (with_types)
+      args.GetReturnValue().Set(ScanDirResultWithTypes(env, names, types));
+    else
+      args.GetReturnValue().Set(names);
   }
 }
 
@@ -1464,6 +1552,7 @@ void InitFs(Local<Object> target,
   env->SetMethod(target, "readdir", ReadDir);
   env->SetMethod(target, "internalModuleReadFile", InternalModuleReadFile);
   env->SetMethod(target, "internalModuleStat", InternalModuleStat);
+  env->SetMethod(target, "internalModuleMtime", InternalModuleMtime);
   env->SetMethod(target, "stat", Stat);
   env->SetMethod(target, "lstat", LStat);
   env->SetMethod(target, "fstat", FStat);
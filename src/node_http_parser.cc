@@ -72,6 +72,7 @@ const uint32_t kOnExecute = 4;
 // helper class for the Parser
 struct StringPtr {
   StringPtr() {
+    env_ = nullptr;
     on_heap_ = false;
     Reset();
   }
@@ -91,6 +92,7 @@ struct StringPtr {
       memcpy(s, str_, size_);
       str_ = s;
       on_heap_ = true;
+      AdjustExternalMemory(size_);
     }
   }
 
@@ -99,6 +101,7 @@ struct StringPtr {
     if (on_heap_) {
       delete[] str_;
       on_heap_ = false;
+      AdjustExternalMemory(-static_cast<int64_t>(size_));
     }
 
     str_ = nullptr;
@@ -116,10 +119,13 @@ struct StringPtr {
       memcpy(s, str_, size_);
       memcpy(s + size_, str, size);
 
-      if (on_heap_)
+      if (on_heap_) {
         delete[] str_;
-      else
+        AdjustExternalMemory(size);
+      } else {
         on_heap_ = true;
+        AdjustExternalMemory(size_ + size);
+      }
 
       str_ = s;
     }
@@ -127,6 +133,14 @@ struct StringPtr {
   }
 
 
+  void AdjustExternalMemory(int64_t change_in_bytes) {
+    if (env_ != nullptr) {
+      env_->AdjustExternalMemory(Environment::kExternalMemoryHttpParser,
+                                 change_in_bytes);
+    }
+  }
+
+
   Local<String> ToString(Environment* env) const {
     if (str_)
       return OneByteString(env->isolate(), str_, size_);
@@ -135,6 +149,8 @@ struct StringPtr {
   }
 
 
+  // Copies on the heap are counted as external memory of this Environment.
+  Environment* env_;
   const char* str_;
   bool on_heap_;
   size_t size_;
@@ -149,12 +165,22 @@ class Parser : public AsyncWrap {
         current_buffer_data_(nullptr) {
     Wrap(object(), this);
     Init(type);
+    for (StringPtr& field : fields_)
+      field.env_ = env;
+    for (StringPtr& value : values_)
+      value.env_ = env;
+    url_.env_ = env;
+    status_message_.env_ = env;
+    env->AdjustExternalMemory(Environment::kExternalMemoryHttpParser,
+                              sizeof(*this));
   }
 
 
   ~Parser() override {
     ClearWrap(object());
     persistent().Reset();
+    env()->AdjustExternalMemory(Environment::kExternalMemoryHttpParser,
+                                -static_cast<int64_t>(sizeof(*this)));
   }
 
 
@@ -544,8 +570,11 @@ class Parser : public AsyncWrap {
     Parser* parser = static_cast<Parser*>(ctx);
     Environment* env = parser->env();
 
-    if (env->http_parser_buffer() == nullptr)
+    if (env->http_parser_buffer() == nullptr) {
       env->set_http_parser_buffer(new char[kAllocBufferSize]);
+      env->AdjustExternalMemory(Environment::kExternalMemoryHttpParser,
+                                kAllocBufferSize);
+    }
 
     buf->base = env->http_parser_buffer();
     buf->len = kAllocBufferSize;
@@ -12,6 +12,10 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include <atomic>
+#include <map>
+#include <string>
+
 struct sockaddr;
 
 // Variation on NODE_DEFINE_CONSTANT that sets a String value.
@@ -168,14 +172,32 @@ class ArrayBufferAllocator : public v8::ArrayBuffer::Allocator {
   inline uint32_t* zero_fill_field() { return &zero_fill_field_; }
 
   virtual void* Allocate(size_t size);  // Defined in src/node.cc
-  virtual void* AllocateUninitialized(size_t size)
-    { return node::UncheckedMalloc(size); }
-  virtual void Free(void* data, size_t) { free(data); }
+  virtual void* AllocateUninitialized(size_t size);
+  virtual void Free(void* data, size_t length);
+
+  // The size of the backing stores of live ArrayBuffers. Memory that node
+  // allocates itself and hands over to V8, which then frees it through this
+  // allocator, is added with Track(). Backing stores are freed on V8's
+  // background threads too.
+  inline int64_t allocated() const { return allocated_; }
+  inline void Track(int64_t change_in_bytes) { allocated_ += change_in_bytes; }
 
  private:
   uint32_t zero_fill_field_ = 1;  // Boolean but exposed as uint32 to JS land.
+  std::atomic<int64_t> allocated_{0};
 };
 
+// Creates an isolate that is set up the way node expects, e.g. with the
+// uncaught exception handlers installed. Returns nullptr on failure.
+v8::Isolate* NewIsolate(ArrayBufferAllocator* allocator);
+
+// Runs the tasks the V8 platform has queued for |isolate| on its thread.
+void PumpPlatformMessageLoop(v8::Isolate* isolate);
+
+// Copies the variables that process.env holds in |env| into |vars|, for a
+// worker thread started from it.
+void CopyEnvVars(Environment* env, std::map<std::string, std::string>* vars);
+
 // Clear any domain and/or uncaughtException handlers to force the error's
 // propagation and shutdown the process. Use this to force the process to exit
 // by clearing all callbacks that could handle the error.
@@ -1,15 +1,22 @@
 #include "node.h"
+#include "node_code_cache.h"
 #include "node_natives.h"
 #include "v8.h"
 #include "env.h"
 #include "env-inl.h"
 
+#include <string.h>
+
 namespace node {
 
+using v8::ArrayBuffer;
+using v8::FunctionCallbackInfo;
 using v8::Local;
 using v8::NewStringType;
 using v8::Object;
 using v8::String;
+using v8::Uint8Array;
+using v8::Value;
 
 // id##_data is defined in node_natives.h.
 #define V(id)                                                                 \
@@ -48,4 +55,51 @@ void DefineJavaScript(Environment* env, Local<Object> target) {
 #undef V
 }
 
+static void GetCodeCache(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  node::Utf8Value module_id(env->isolate(), args[0]);
+
+  const CodeCacheEntry* entry = nullptr;
+  for (size_t i = 0; i < code_cache_entry_count; i++) {
+    if (strcmp(code_cache_entries[i].id, *module_id) == 0) {
+      entry = &code_cache_entries[i];
+      break;
+    }
+  }
+  if (entry == nullptr)
+    return;
+
+  const uint8_t* source = nullptr;
+  size_t source_length = 0;
+#define V(id)                                                                 \
+  if (source == nullptr &&                                                    \
+      sizeof(id##_name) == module_id.length() &&                              \
+      memcmp(id##_name, *module_id, module_id.length()) == 0) {               \
+    source = id##_data;                                                       \
+    source_length = sizeof(id##_data);                                        \
+  }
+  NODE_NATIVES_MAP(V)
+#undef V
+
+  // The cache must have been produced from this very source, V8 itself only
+  // compares the length.
+  if (source == nullptr ||
+      source_length != entry->source_length ||
+      CodeCacheSourceHash(source, source_length) != entry->source_hash) {
+    return;
+  }
+
+  // The data lives in read-only memory, so JS gets a copy that it is free
+  // to write to.
+  Local<ArrayBuffer> ab = ArrayBuffer::New(env->isolate(), entry->length);
+  memcpy(ab->GetContents().Data(), entry->data, entry->length);
+  args.GetReturnValue().Set(Uint8Array::New(ab, 0, entry->length));
+}
+
+void DefineCodeCache(Environment* env, Local<Object> target) {
+  env->SetMethod(target, "get", GetCodeCache);
+}
+
 }  // namespace node
@@ -10,6 +10,7 @@ namespace node {
 
 void DefineJavaScript(Environment* env, v8::Local<v8::Object> target);
 v8::Local<v8::String> MainSource(Environment* env);
+void DefineCodeCache(Environment* env, v8::Local<v8::Object> target);
 
 }  // namespace node
 
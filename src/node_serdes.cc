@@ -0,0 +1,1053 @@
+#include "node_serdes.h"
+#include "node.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <string.h>
+
+#define SHARED_ARRAY_BUFFER_ID 0x5AB0
+
+namespace node {
+namespace serdes {
+
+using v8::Array;
+using v8::ArrayBuffer;
+using v8::ArrayBufferCreationMode;
+using v8::ArrayBufferView;
+using v8::Context;
+using v8::DataView;
+using v8::Date;
+using v8::External;
+using v8::Float32Array;
+using v8::Float64Array;
+using v8::FunctionCallbackInfo;
+using v8::Int16Array;
+using v8::Int32Array;
+using v8::Int8Array;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Map;
+using v8::MaybeLocal;
+using v8::Name;
+using v8::Number;
+using v8::Object;
+using v8::Persistent;
+using v8::PersistentHandleVisitor;
+using v8::RegExp;
+using v8::Set;
+using v8::SharedArrayBuffer;
+using v8::String;
+using v8::Uint16Array;
+using v8::Uint32Array;
+using v8::Uint8Array;
+using v8::Uint8ClampedArray;
+using v8::Value;
+using v8::WeakCallbackInfo;
+
+// Bump when the format changes in an incompatible way.
+static const uint8_t kVersion = 1;
+
+// Nesting deeper than this is reported as an error rather than risking a
+// stack overflow.
+static const unsigned kMaxDepth = 1000;
+
+enum Tag : uint8_t {
+  kUndefined = '_',
+  kNull = '0',
+  kTrue = 'T',
+  kFalse = 'F',
+  kInt32 = 'I',
+  kDouble = 'N',
+  kOneByteString = '"',
+  kTwoByteString = 'c',
+  kObject = 'o',
+  kArray = 'A',
+  kDate = 'D',
+  kRegExp = 'R',
+  kMap = ';',
+  kSet = '\'',
+  kArrayBuffer = 'B',
+  kSharedArrayBuffer = 'u',
+  kArrayBufferView = 'V',
+  kSharedArrayBufferView = 'v',
+  kObjectReference = '^'
+};
+
+enum ViewType : uint8_t {
+  kBufferView,  // A Uint8Array with Buffer.prototype.
+  kUint8ArrayView,
+  kUint8ClampedArrayView,
+  kInt8ArrayView,
+  kUint16ArrayView,
+  kInt16ArrayView,
+  kUint32ArrayView,
+  kInt32ArrayView,
+  kFloat32ArrayView,
+  kFloat64ArrayView,
+  kDataViewView
+};
+
+
+// Keeps a SharedArrayBufferData alive for as long as one SharedArrayBuffer
+// object in one isolate refers to it.
+class SharedArrayBufferRef {
+ public:
+  SharedArrayBufferRef(Environment* env,
+                       Local<SharedArrayBuffer> buffer,
+                       std::shared_ptr<SharedArrayBufferData> data)
+      : persistent_(env->isolate(), buffer),
+        data_(data) {
+    buffer->SetPrivate(env->context(),
+                       env->shared_array_buffer_data_private_symbol(),
+                       External::New(env->isolate(), this)).FromJust();
+    persistent_.SetWeak(this, WeakCallback, v8::WeakCallbackType::kParameter);
+    persistent_.SetWrapperClassId(SHARED_ARRAY_BUFFER_ID);
+    persistent_.MarkIndependent();
+  }
+
+  ~SharedArrayBufferRef() {
+    persistent_.Reset();
+  }
+
+  std::shared_ptr<SharedArrayBufferData> data() const { return data_; }
+
+  static void WeakCallback(
+      const WeakCallbackInfo<SharedArrayBufferRef>& info) {
+    delete info.GetParameter();
+  }
+
+  static SharedArrayBufferRef* FromObject(Environment* env,
+                                          Local<Object> object) {
+    Local<Value> ref;
+    if (!object->GetPrivate(env->context(),
+                            env->shared_array_buffer_data_private_symbol())
+             .ToLocal(&ref) || !ref->IsExternal()) {
+      return nullptr;
+    }
+    return static_cast<SharedArrayBufferRef*>(ref.As<External>()->Value());
+  }
+
+ private:
+  Persistent<SharedArrayBuffer> persistent_;
+  std::shared_ptr<SharedArrayBufferData> data_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedArrayBufferRef);
+};
+
+
+SharedArrayBufferData::SharedArrayBufferData(void* data, size_t length)
+    : data_(data), length_(length) {
+}
+
+
+SharedArrayBufferData::~SharedArrayBufferData() {
+  // Allocated by node::ArrayBufferAllocator.
+  free(data_);
+}
+
+
+std::shared_ptr<SharedArrayBufferData>
+SharedArrayBufferData::ForSharedArrayBuffer(Environment* env,
+                                            Local<SharedArrayBuffer> buffer) {
+  SharedArrayBufferRef* ref = SharedArrayBufferRef::FromObject(env, buffer);
+  if (ref != nullptr)
+    return ref->data();
+
+  if (buffer->IsExternal())
+    return nullptr;
+
+  SharedArrayBuffer::Contents contents = buffer->Externalize();
+  // The memory is freed by SharedArrayBufferData from now on.
+  if (ArrayBufferAllocator* allocator = env->isolate_data()->allocator())
+    allocator->Track(-static_cast<int64_t>(contents.ByteLength()));
+  std::shared_ptr<SharedArrayBufferData> data(
+      new SharedArrayBufferData(contents.Data(), contents.ByteLength()));
+  new SharedArrayBufferRef(env, buffer, data);
+  return data;
+}
+
+
+Local<SharedArrayBuffer> SharedArrayBufferData::GetSharedArrayBuffer(
+    Environment* env) {
+  Local<SharedArrayBuffer> buffer =
+      SharedArrayBuffer::New(env->isolate(),
+                             data_,
+                             length_,
+                             ArrayBufferCreationMode::kExternalized);
+  new SharedArrayBufferRef(env, buffer, shared_from_this());
+  return buffer;
+}
+
+
+void SharedArrayBufferData::ReleaseAll(Environment* env) {
+  // The visitor is passed a copy of each handle, not the Persistent inside
+  // SharedArrayBufferRef, so collect the objects and look the refs up.
+  class Visitor : public PersistentHandleVisitor {
+   public:
+    explicit Visitor(Isolate* isolate) : isolate(isolate) {}
+    void VisitPersistentHandle(Persistent<Value>* value,
+                               uint16_t class_id) override {
+      if (class_id == SHARED_ARRAY_BUFFER_ID)
+        objects.push_back(Local<Value>::New(isolate, *value).As<Object>());
+    }
+    Isolate* const isolate;
+    std::vector<Local<Object>> objects;
+  } visitor(env->isolate());
+
+  HandleScope handle_scope(env->isolate());
+  env->isolate()->VisitHandlesWithClassIds(&visitor);
+  for (Local<Object> object : visitor.objects)
+    delete SharedArrayBufferRef::FromObject(env, object);
+}
+
+
+Serializer::Serializer(Environment* env,
+                       SharedArrayBufferList* shared_array_buffers,
+                       size_t header_length)
+    : env_(env),
+      context_(env->context()),
+      shared_array_buffers_(shared_array_buffers),
+      data_(nullptr),
+      length_(0),
+      capacity_(0),
+      depth_(0) {
+  Grow(header_length + 1);
+  memset(data_, 0, header_length);
+  length_ = header_length;
+  WriteByte(kVersion);
+}
+
+
+Serializer::~Serializer() {
+  free(data_);
+}
+
+
+char* Serializer::Release(size_t* length) {
+  char* data = data_;
+  *length = length_;
+  data_ = nullptr;
+  length_ = capacity_ = 0;
+  return data;
+}
+
+
+inline void Serializer::Grow(size_t bytes) {
+  if (capacity_ - length_ >= bytes)
+    return;
+  size_t capacity = capacity_ == 0 ? 64 : capacity_ * 2;
+  while (capacity - length_ < bytes)
+    capacity *= 2;
+  data_ = Realloc(data_, capacity);
+  capacity_ = capacity;
+}
+
+
+inline void Serializer::WriteByte(uint8_t byte) {
+  Grow(1);
+  data_[length_++] = byte;
+}
+
+
+inline void Serializer::WriteVarint(uint64_t value) {
+  // Seven bits per byte, least significant group first, the high bit is set
+  // on every byte but the last.
+  Grow(10);
+  do {
+    uint8_t byte = value & 0x7f;
+    value >>= 7;
+    if (value != 0)
+      byte |= 0x80;
+    data_[length_++] = byte;
+  } while (value != 0);
+}
+
+
+inline void Serializer::WriteRawBytes(const void* data, size_t length) {
+  Grow(length);
+  memcpy(data_ + length_, data, length);
+  length_ += length;
+}
+
+
+void Serializer::WriteDouble(double value) {
+  WriteRawBytes(&value, sizeof(value));
+}
+
+
+void Serializer::WriteString(Local<String> string) {
+  const int length = string->Length();
+  if (string->IsOneByte()) {
+    WriteByte(kOneByteString);
+    WriteVarint(length);
+    Grow(length);
+    string->WriteOneByte(reinterpret_cast<uint8_t*>(data_ + length_),
+                         0,
+                         length,
+                         String::NO_NULL_TERMINATION);
+    length_ += length;
+  } else {
+    MaybeStackBuffer<uint16_t> chars(length);
+    string->Write(*chars, 0, length, String::NO_NULL_TERMINATION);
+    WriteByte(kTwoByteString);
+    WriteVarint(length);
+    WriteRawBytes(*chars, length * sizeof(uint16_t));
+  }
+}
+
+
+bool Serializer::ThrowDataCloneError(Local<Value> value) {
+  Isolate* isolate = env_->isolate();
+  Local<String> what;
+  if (value->IsObject()) {
+    what = String::Concat(FIXED_ONE_BYTE_STRING(isolate, "#<"),
+                          value.As<Object>()->GetConstructorName());
+    what = String::Concat(what, FIXED_ONE_BYTE_STRING(isolate, ">"));
+  } else {
+    what = value->TypeOf(isolate);
+  }
+  Local<String> message =
+      String::Concat(what, FIXED_ONE_BYTE_STRING(isolate,
+                                                 " could not be cloned."));
+  isolate->ThrowException(v8::Exception::TypeError(message));
+  return false;
+}
+
+
+bool Serializer::WriteValue(Local<Value> value) {
+  if (value->IsUndefined()) {
+    WriteByte(kUndefined);
+  } else if (value->IsNull()) {
+    WriteByte(kNull);
+  } else if (value->IsTrue()) {
+    WriteByte(kTrue);
+  } else if (value->IsFalse()) {
+    WriteByte(kFalse);
+  } else if (value->IsInt32()) {
+    // ZigZag encoding keeps small negative numbers small.
+    const int32_t n = value.As<Integer>()->Value();
+    WriteByte(kInt32);
+    WriteVarint((static_cast<uint32_t>(n) << 1) ^ (n >> 31));
+  } else if (value->IsNumber()) {
+    WriteByte(kDouble);
+    WriteDouble(value.As<Number>()->Value());
+  } else if (value->IsString()) {
+    WriteString(value.As<String>());
+  } else if (value->IsObject()) {
+    if (++depth_ > kMaxDepth) {
+      env_->ThrowRangeError("Object graph is too deeply nested to be cloned.");
+      return false;
+    }
+    const bool ok = WriteObject(value.As<Object>());
+    depth_--;
+    return ok;
+  } else {
+    // Symbols.
+    return ThrowDataCloneError(value);
+  }
+  return true;
+}
+
+
+bool Serializer::WriteSharedArrayBuffer(Local<SharedArrayBuffer> buffer,
+                                        uint32_t* index) {
+  if (shared_array_buffers_ == nullptr)
+    return ThrowDataCloneError(buffer);
+
+  std::shared_ptr<SharedArrayBufferData> data =
+      SharedArrayBufferData::ForSharedArrayBuffer(env_, buffer);
+  if (!data)
+    return ThrowDataCloneError(buffer);
+
+  for (size_t i = 0; i < shared_array_buffers_->size(); i++) {
+    if ((*shared_array_buffers_)[i] == data) {
+      *index = i;
+      return true;
+    }
+  }
+  *index = shared_array_buffers_->size();
+  shared_array_buffers_->push_back(data);
+  return true;
+}
+
+
+bool Serializer::WriteArrayBufferView(Local<ArrayBufferView> view) {
+  ViewType type;
+  if (view->IsUint8Array()) {
+    Local<Value> proto = view->GetPrototype();
+    type = proto->StrictEquals(env_->buffer_prototype_object()) ?
+        kBufferView : kUint8ArrayView;
+  } else if (view->IsUint8ClampedArray()) {
+    type = kUint8ClampedArrayView;
+  } else if (view->IsInt8Array()) {
+    type = kInt8ArrayView;
+  } else if (view->IsUint16Array()) {
+    type = kUint16ArrayView;
+  } else if (view->IsInt16Array()) {
+    type = kInt16ArrayView;
+  } else if (view->IsUint32Array()) {
+    type = kUint32ArrayView;
+  } else if (view->IsInt32Array()) {
+    type = kInt32ArrayView;
+  } else if (view->IsFloat32Array()) {
+    type = kFloat32ArrayView;
+  } else if (view->IsFloat64Array()) {
+    type = kFloat64ArrayView;
+  } else if (view->IsDataView()) {
+    type = kDataViewView;
+  } else {
+    return ThrowDataCloneError(view);
+  }
+
+  const size_t offset = view->ByteOffset();
+  const size_t length = view->ByteLength();
+  Local<Value> buffer = view->Buffer();
+
+  if (buffer->IsSharedArrayBuffer()) {
+    // Views of shared memory stay views of the same memory.
+    uint32_t index;
+    if (!WriteSharedArrayBuffer(buffer.As<SharedArrayBuffer>(), &index))
+      return false;
+    WriteByte(kSharedArrayBufferView);
+    WriteByte(type);
+    WriteVarint(index);
+    WriteVarint(offset);
+    WriteVarint(length);
+    return true;
+  }
+
+  // Only the bytes that are visible through the view are copied.
+  WriteByte(kArrayBufferView);
+  WriteByte(type);
+  WriteVarint(length);
+  Grow(length);
+  view->CopyContents(data_ + length_, length);
+  length_ += length;
+  return true;
+}
+
+
+bool Serializer::WriteProperties(Local<Object> object) {
+  Local<Array> keys;
+  if (!object->GetOwnPropertyNames(context_).ToLocal(&keys))
+    return false;
+
+  const uint32_t count = keys->Length();
+  WriteVarint(count);
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> key;
+    Local<Value> value;
+    if (!keys->Get(context_, i).ToLocal(&key) ||
+        !object->Get(context_, key).ToLocal(&value)) {
+      return false;
+    }
+    // Array indices are numbers, all other keys are strings.
+    if (key->IsNumber()) {
+      WriteByte(kInt32);
+      WriteVarint(key->Uint32Value(context_).FromJust() << 1);
+    } else {
+      WriteString(key.As<String>());
+    }
+    if (!WriteValue(value))
+      return false;
+  }
+  return true;
+}
+
+
+bool Serializer::WriteObject(Local<Object> object) {
+  // Objects seen before are written as a reference to their first
+  // occurrence.
+  const int hash = object->GetIdentityHash();
+  auto range = object_ids_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (objects_[it->second] == object) {
+      WriteByte(kObjectReference);
+      WriteVarint(it->second);
+      return true;
+    }
+  }
+  object_ids_.insert(std::make_pair(hash, objects_.size()));
+  objects_.push_back(object);
+
+  if (object->IsArrayBufferView())
+    return WriteArrayBufferView(object.As<ArrayBufferView>());
+
+  if (object->IsArray()) {
+    Local<Array> array = object.As<Array>();
+    const uint32_t length = array->Length();
+    WriteByte(kArray);
+    WriteVarint(length);
+    for (uint32_t i = 0; i < length; i++) {
+      Local<Value> element;
+      if (!array->Get(context_, i).ToLocal(&element) || !WriteValue(element))
+        return false;
+    }
+    return true;
+  }
+
+  if (object->IsDate()) {
+    WriteByte(kDate);
+    WriteDouble(object.As<Date>()->ValueOf());
+    return true;
+  }
+
+  if (object->IsRegExp()) {
+    Local<RegExp> regexp = object.As<RegExp>();
+    WriteByte(kRegExp);
+    WriteString(regexp->GetSource());
+    WriteVarint(regexp->GetFlags());
+    return true;
+  }
+
+  if (object->IsMap() || object->IsSet()) {
+    // Maps flatten into [key1, value1, key2, value2, ...].
+    Local<Array> entries = object->IsMap() ? object.As<Map>()->AsArray() :
+                                             object.As<Set>()->AsArray();
+    const uint32_t length = entries->Length();
+    WriteByte(object->IsMap() ? kMap : kSet);
+    WriteVarint(length);
+    for (uint32_t i = 0; i < length; i++) {
+      Local<Value> entry;
+      if (!entries->Get(context_, i).ToLocal(&entry) || !WriteValue(entry))
+        return false;
+    }
+    return true;
+  }
+
+  if (object->IsArrayBuffer()) {
+    ArrayBuffer::Contents contents = object.As<ArrayBuffer>()->GetContents();
+    WriteByte(kArrayBuffer);
+    WriteVarint(contents.ByteLength());
+    WriteRawBytes(contents.Data(), contents.ByteLength());
+    return true;
+  }
+
+  if (object->IsSharedArrayBuffer()) {
+    uint32_t index;
+    if (!WriteSharedArrayBuffer(object.As<SharedArrayBuffer>(), &index))
+      return false;
+    WriteByte(kSharedArrayBuffer);
+    WriteVarint(index);
+    return true;
+  }
+
+  // Functions, promises, proxies and objects that wrap native state have no
+  // meaningful copy.
+  if (object->IsFunction() || object->IsPromise() || object->IsProxy() ||
+      object->IsWeakMap() || object->IsWeakSet() ||
+      object->InternalFieldCount() > 0) {
+    return ThrowDataCloneError(object);
+  }
+
+  WriteByte(kObject);
+  return WriteProperties(object);
+}
+
+
+Deserializer::Deserializer(Environment* env,
+                           const char* data,
+                           size_t length,
+                           const SharedArrayBufferList* shared_array_buffers)
+    : env_(env),
+      context_(env->context()),
+      data_(data),
+      length_(length),
+      position_(0),
+      depth_(0),
+      shared_array_buffers_(shared_array_buffers) {
+}
+
+
+inline bool Deserializer::ReadByte(uint8_t* byte) {
+  if (position_ >= length_)
+    return false;
+  *byte = data_[position_++];
+  return true;
+}
+
+
+inline bool Deserializer::ReadVarint(uint64_t* value) {
+  uint64_t result = 0;
+  unsigned shift = 0;
+  uint8_t byte;
+  do {
+    if (shift >= 64 || !ReadByte(&byte))
+      return false;
+    result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  *value = result;
+  return true;
+}
+
+
+inline bool Deserializer::ReadUint32(uint32_t* value) {
+  uint64_t result;
+  if (!ReadVarint(&result) || result > 0xffffffff)
+    return false;
+  *value = static_cast<uint32_t>(result);
+  return true;
+}
+
+
+inline bool Deserializer::ReadRawBytes(size_t length, const char** data) {
+  if (length > length_ - position_)
+    return false;
+  *data = data_ + position_;
+  position_ += length;
+  return true;
+}
+
+
+bool Deserializer::ReadDouble(double* value) {
+  const char* data;
+  if (!ReadRawBytes(sizeof(*value), &data))
+    return false;
+  memcpy(value, data, sizeof(*value));
+  return true;
+}
+
+
+MaybeLocal<Value> Deserializer::ThrowMalformed() {
+  env_->ThrowError("Unable to deserialize cloned data.");
+  return MaybeLocal<Value>();
+}
+
+
+uint32_t Deserializer::AddObject(Local<Value> object) {
+  objects_.push_back(object);
+  return objects_.size() - 1;
+}
+
+
+MaybeLocal<Value> Deserializer::ReadValue() {
+  uint8_t version;
+  if (!ReadByte(&version) || version != kVersion)
+    return ThrowMalformed();
+  Local<Value> value;
+  if (!ReadNext().ToLocal(&value))
+    return MaybeLocal<Value>();
+  if (position_ != length_)
+    return ThrowMalformed();
+  return value;
+}
+
+
+MaybeLocal<Value> Deserializer::ReadString(uint8_t tag) {
+  uint32_t length;
+  const char* chars;
+  if (!ReadUint32(&length) || length > String::kMaxLength)
+    return ThrowMalformed();
+
+  if (tag == kOneByteString) {
+    if (!ReadRawBytes(length, &chars))
+      return ThrowMalformed();
+    return String::NewFromOneByte(env_->isolate(),
+                                  reinterpret_cast<const uint8_t*>(chars),
+                                  v8::NewStringType::kNormal,
+                                  length).FromMaybe(Local<String>());
+  }
+
+  if (!ReadRawBytes(length * sizeof(uint16_t), &chars))
+    return ThrowMalformed();
+  // The data is not necessarily aligned.
+  MaybeStackBuffer<uint16_t> aligned(length);
+  memcpy(*aligned, chars, length * sizeof(uint16_t));
+  return String::NewFromTwoByte(env_->isolate(),
+                                *aligned,
+                                v8::NewStringType::kNormal,
+                                length).FromMaybe(Local<String>());
+}
+
+
+MaybeLocal<Value> Deserializer::ReadObject() {
+  Local<Object> object = Object::New(env_->isolate());
+  AddObject(object);
+
+  uint32_t count;
+  if (!ReadUint32(&count))
+    return ThrowMalformed();
+  for (uint32_t i = 0; i < count; i++) {
+    uint8_t tag;
+    Local<Value> key;
+    Local<Value> value;
+    if (!ReadByte(&tag))
+      return ThrowMalformed();
+    if (tag == kInt32) {
+      uint32_t index;
+      if (!ReadUint32(&index))
+        return ThrowMalformed();
+      if (!ReadNext().ToLocal(&value) ||
+          object->CreateDataProperty(context_, index >> 1, value).IsNothing())
+        return MaybeLocal<Value>();
+      continue;
+    }
+    if (tag != kOneByteString && tag != kTwoByteString)
+      return ThrowMalformed();
+    // CreateDataProperty() rather than Set() so that setters on
+    // Object.prototype, e.g. __proto__, are not invoked.
+    if (!ReadString(tag).ToLocal(&key) ||
+        !ReadNext().ToLocal(&value) ||
+        object->CreateDataProperty(context_, key.As<Name>(), value)
+            .IsNothing()) {
+      return MaybeLocal<Value>();
+    }
+  }
+  return object;
+}
+
+
+MaybeLocal<Value> Deserializer::ReadArray() {
+  uint32_t length;
+  // Every element takes at least one byte.
+  if (!ReadUint32(&length) || length > length_ - position_)
+    return ThrowMalformed();
+  Local<Array> array = Array::New(env_->isolate(), length);
+  AddObject(array);
+  for (uint32_t i = 0; i < length; i++) {
+    Local<Value> element;
+    if (!ReadNext().ToLocal(&element) ||
+        array->CreateDataProperty(context_, i, element).IsNothing())
+      return MaybeLocal<Value>();
+  }
+  return array;
+}
+
+
+MaybeLocal<Value> Deserializer::ReadMap() {
+  uint32_t length;
+  if (!ReadUint32(&length) || length % 2 != 0)
+    return ThrowMalformed();
+  Local<Map> map = Map::New(env_->isolate());
+  AddObject(map);
+  for (uint32_t i = 0; i < length; i += 2) {
+    Local<Value> key;
+    Local<Value> value;
+    if (!ReadNext().ToLocal(&key) || !ReadNext().ToLocal(&value) ||
+        map->Set(context_, key, value).IsEmpty())
+      return MaybeLocal<Value>();
+  }
+  return map;
+}
+
+
+MaybeLocal<Value> Deserializer::ReadSet() {
+  uint32_t length;
+  if (!ReadUint32(&length))
+    return ThrowMalformed();
+  Local<Set> set = Set::New(env_->isolate());
+  AddObject(set);
+  for (uint32_t i = 0; i < length; i++) {
+    Local<Value> value;
+    if (!ReadNext().ToLocal(&value) || set->Add(context_, value).IsEmpty())
+      return MaybeLocal<Value>();
+  }
+  return set;
+}
+
+
+template <typename T, typename B>
+static Local<Value> NewTypedArray(Local<B> buffer,
+                                  size_t offset,
+                                  size_t length) {
+  return T::New(buffer, offset, length / sizeof(typename T::value_type));
+}
+
+
+template <typename B>
+static MaybeLocal<Value> NewView(uint8_t type,
+                                 Local<B> buffer,
+                                 size_t offset,
+                                 size_t length) {
+  size_t element_size;
+  switch (type) {
+    case kUint16ArrayView:
+    case kInt16ArrayView:
+      element_size = 2;
+      break;
+    case kUint32ArrayView:
+    case kInt32ArrayView:
+    case kFloat32ArrayView:
+      element_size = 4;
+      break;
+    case kFloat64ArrayView:
+      element_size = 8;
+      break;
+    default:
+      element_size = 1;
+  }
+  if (length % element_size != 0 || offset % element_size != 0)
+    return MaybeLocal<Value>();
+
+  const size_t count = length / element_size;
+  switch (type) {
+    case kUint8ArrayView:
+      return Uint8Array::New(buffer, offset, count);
+    case kUint8ClampedArrayView:
+      return Uint8ClampedArray::New(buffer, offset, count);
+    case kInt8ArrayView:
+      return Int8Array::New(buffer, offset, count);
+    case kUint16ArrayView:
+      return Uint16Array::New(buffer, offset, count);
+    case kInt16ArrayView:
+      return Int16Array::New(buffer, offset, count);
+    case kUint32ArrayView:
+      return Uint32Array::New(buffer, offset, count);
+    case kInt32ArrayView:
+      return Int32Array::New(buffer, offset, count);
+    case kFloat32ArrayView:
+      return Float32Array::New(buffer, offset, count);
+    case kFloat64ArrayView:
+      return Float64Array::New(buffer, offset, count);
+    case kDataViewView:
+      return DataView::New(buffer, offset, count);
+  }
+  return MaybeLocal<Value>();
+}
+
+
+// Views and the SharedArrayBuffer itself may appear in the same message, they
+// have to share one object.
+bool Deserializer::ReadSharedArrayBuffer(Local<SharedArrayBuffer>* buffer) {
+  uint32_t index;
+  if (!ReadUint32(&index) || shared_array_buffers_ == nullptr ||
+      index >= shared_array_buffers_->size()) {
+    return false;
+  }
+  if (shared_array_buffer_objects_.size() <= index)
+    shared_array_buffer_objects_.resize(index + 1);
+  Local<SharedArrayBuffer>& object = shared_array_buffer_objects_[index];
+  if (object.IsEmpty())
+    object = (*shared_array_buffers_)[index]->GetSharedArrayBuffer(env_);
+  *buffer = object;
+  return true;
+}
+
+
+MaybeLocal<Value> Deserializer::ReadArrayBufferView(bool shared) {
+  uint8_t type;
+  if (!ReadByte(&type) || type > kDataViewView)
+    return ThrowMalformed();
+
+  Local<Value> view;
+  if (shared) {
+    Local<SharedArrayBuffer> buffer;
+    uint64_t offset;
+    uint64_t length;
+    if (!ReadSharedArrayBuffer(&buffer) ||
+        !ReadVarint(&offset) || !ReadVarint(&length)) {
+      return ThrowMalformed();
+    }
+    if (offset > buffer->ByteLength() ||
+        length > buffer->ByteLength() - offset ||
+        !NewView(type == kBufferView ?
+                     static_cast<uint8_t>(kUint8ArrayView) : type,
+                 buffer, offset, length).ToLocal(&view)) {
+      return ThrowMalformed();
+    }
+    if (type == kBufferView) {
+      view.As<Object>()->SetPrototype(context_,
+                                      env_->buffer_prototype_object())
+          .FromJust();
+    }
+    AddObject(view);
+    return view;
+  }
+
+  uint64_t length;
+  const char* data;
+  if (!ReadVarint(&length) || !ReadRawBytes(length, &data))
+    return ThrowMalformed();
+
+  if (type == kBufferView) {
+    Local<Object> buffer;
+    if (!Buffer::Copy(env_, data, length).ToLocal(&buffer))
+      return MaybeLocal<Value>();
+    AddObject(buffer);
+    return buffer;
+  }
+
+  Local<ArrayBuffer> buffer = ArrayBuffer::New(env_->isolate(), length);
+  if (length > 0)
+    memcpy(buffer->GetContents().Data(), data, length);
+  if (!NewView(type, buffer, 0, length).ToLocal(&view))
+    return ThrowMalformed();
+  AddObject(view);
+  return view;
+}
+
+
+MaybeLocal<Value> Deserializer::ReadNext() {
+  Isolate* isolate = env_->isolate();
+  uint8_t tag;
+  if (!ReadByte(&tag))
+    return ThrowMalformed();
+
+  switch (tag) {
+    case kUndefined:
+      return v8::Undefined(isolate);
+    case kNull:
+      return v8::Null(isolate);
+    case kTrue:
+      return v8::True(isolate);
+    case kFalse:
+      return v8::False(isolate);
+    case kInt32: {
+      uint32_t n;
+      if (!ReadUint32(&n))
+        return ThrowMalformed();
+      return Integer::New(isolate,
+                          static_cast<int32_t>((n >> 1) ^ -(n & 1)));
+    }
+    case kDouble: {
+      double n;
+      if (!ReadDouble(&n))
+        return ThrowMalformed();
+      return Number::New(isolate, n);
+    }
+    case kOneByteString:
+    case kTwoByteString:
+      return ReadString(tag);
+    case kObjectReference: {
+      uint32_t id;
+      if (!ReadUint32(&id) || id >= objects_.size())
+        return ThrowMalformed();
+      return objects_[id];
+    }
+    case kDate: {
+      double time;
+      if (!ReadDouble(&time))
+        return ThrowMalformed();
+      Local<Value> date;
+      if (!Date::New(context_, time).ToLocal(&date))
+        return MaybeLocal<Value>();
+      AddObject(date);
+      return date;
+    }
+    case kRegExp: {
+      uint8_t string_tag;
+      Local<Value> source;
+      uint32_t flags;
+      if (!ReadByte(&string_tag) ||
+          (string_tag != kOneByteString && string_tag != kTwoByteString))
+        return ThrowMalformed();
+      if (!ReadString(string_tag).ToLocal(&source))
+        return MaybeLocal<Value>();
+      if (!ReadUint32(&flags))
+        return ThrowMalformed();
+      Local<Value> regexp;
+      if (!RegExp::New(context_,
+                       source.As<String>(),
+                       static_cast<RegExp::Flags>(flags)).ToLocal(&regexp))
+        return MaybeLocal<Value>();
+      AddObject(regexp);
+      return regexp;
+    }
+    case kArrayBuffer: {
+      uint64_t length;
+      const char* data;
+      if (!ReadVarint(&length) || !ReadRawBytes(length, &data))
+        return ThrowMalformed();
+      Local<ArrayBuffer> buffer = ArrayBuffer::New(isolate, length);
+      if (length > 0)
+        memcpy(buffer->GetContents().Data(), data, length);
+      AddObject(buffer);
+      return buffer;
+    }
+    case kSharedArrayBuffer: {
+      Local<SharedArrayBuffer> buffer;
+      if (!ReadSharedArrayBuffer(&buffer))
+        return ThrowMalformed();
+      AddObject(buffer);
+      return buffer;
+    }
+    case kArrayBufferView:
+    case kSharedArrayBufferView:
+      return ReadArrayBufferView(tag == kSharedArrayBufferView);
+  }
+
+  // The remaining tags are containers.
+  if (++depth_ > kMaxDepth)
+    return ThrowMalformed();
+  MaybeLocal<Value> result;
+  switch (tag) {
+    case kObject:
+      result = ReadObject();
+      break;
+    case kArray:
+      result = ReadArray();
+      break;
+    case kMap:
+      result = ReadMap();
+      break;
+    case kSet:
+      result = ReadSet();
+      break;
+    default:
+      result = ThrowMalformed();
+  }
+  depth_--;
+  return result;
+}
+
+
+// serialize(value[, headerLength]) leaves |headerLength| zeroed bytes in
+// front of the serialized value.
+static void Serialize(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  const size_t header_length =
+      args[1]->IsUint32() ? args[1]->Uint32Value() : 0;
+  Serializer serializer(env, nullptr, header_length);
+  if (!serializer.WriteValue(args[0]))
+    return;
+  size_t length;
+  char* data = serializer.Release(&length);
+  Local<Object> buffer;
+  if (Buffer::New(env, data, length).ToLocal(&buffer))
+    args.GetReturnValue().Set(buffer);
+}
+
+
+// deserialize(buffer[, offset[, length]]) reads the value in place, without
+// copying |buffer| first.
+static void Deserialize(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  THROW_AND_RETURN_UNLESS_BUFFER(env, args[0]);
+  SPREAD_BUFFER_ARG(args[0], buffer);
+
+  size_t offset = 0;
+  size_t length = buffer_length;
+  if (args[1]->IsNumber())
+    offset = args[1]->Uint32Value();
+  if (args[2]->IsNumber())
+    length = args[2]->Uint32Value();
+  if (!Buffer::IsWithinBounds(offset, length, buffer_length))
+    return env->ThrowRangeError("Index out of range");
+
+  Deserializer deserializer(env, buffer_data + offset, length);
+  Local<Value> value;
+  if (deserializer.ReadValue().ToLocal(&value))
+    args.GetReturnValue().Set(value);
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  env->SetMethod(target, "serialize", Serialize);
+  env->SetMethod(target, "deserialize", Deserialize);
+}
+
+}  // namespace serdes
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(serdes, node::serdes::Initialize)
@@ -0,0 +1,156 @@
+#ifndef SRC_NODE_SERDES_H_
+#define SRC_NODE_SERDES_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "env.h"
+#include "v8.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace node {
+namespace serdes {
+
+// Backing store of a SharedArrayBuffer that is shared between isolates. The
+// memory is freed once no isolate has a SharedArrayBuffer object for it.
+class SharedArrayBufferData
+    : public std::enable_shared_from_this<SharedArrayBufferData> {
+ public:
+  ~SharedArrayBufferData();
+
+  // Returns the backing store of |buffer|, taking it over from V8 if this is
+  // the first time |buffer| is shared. Returns nullptr if the backing store
+  // has been externalized by someone else.
+  static std::shared_ptr<SharedArrayBufferData> ForSharedArrayBuffer(
+      Environment* env, v8::Local<v8::SharedArrayBuffer> buffer);
+
+  // Creates a SharedArrayBuffer in |env| that uses this backing store.
+  v8::Local<v8::SharedArrayBuffer> GetSharedArrayBuffer(Environment* env);
+
+  // Drops the references held by the SharedArrayBuffer objects of |env|'s
+  // isolate. Must be called before disposing of an isolate, weak callbacks
+  // are not run then.
+  static void ReleaseAll(Environment* env);
+
+ private:
+  SharedArrayBufferData(void* data, size_t length);
+
+  void* const data_;
+  const size_t length_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedArrayBufferData);
+};
+
+typedef std::vector<std::shared_ptr<SharedArrayBufferData>>
+    SharedArrayBufferList;
+
+// Serializes JS values into a compact binary format, following the rules of
+// the HTML structured clone algorithm: primitives, plain objects, arrays,
+// Date, RegExp, Map, Set, ArrayBuffer and typed arrays (including Buffer)
+// are copied, object identity and cycles are preserved, and anything else,
+// e.g. functions, symbols and native objects, makes WriteValue() throw.
+//
+// SharedArrayBuffers can only be serialized when |shared_array_buffers| is
+// not nullptr. They are not copied but added to that list instead, and the
+// Deserializer given the same list creates SharedArrayBuffers that refer to
+// the same memory.
+//
+// The first |header_length| bytes of the data are left for the caller, e.g.
+// to prefix it with its length without copying it.
+class Serializer {
+ public:
+  Serializer(Environment* env,
+             SharedArrayBufferList* shared_array_buffers = nullptr,
+             size_t header_length = 0);
+  ~Serializer();
+
+  // Appends |value|. Returns false and schedules an exception if |value|
+  // cannot be serialized.
+  bool WriteValue(v8::Local<v8::Value> value);
+
+  // Hands over the malloc()ed serialized data.
+  char* Release(size_t* length);
+
+ private:
+  inline void Grow(size_t bytes);
+  inline void WriteByte(uint8_t byte);
+  inline void WriteVarint(uint64_t value);
+  inline void WriteRawBytes(const void* data, size_t length);
+  void WriteDouble(double value);
+  void WriteString(v8::Local<v8::String> string);
+  bool WriteObject(v8::Local<v8::Object> object);
+  bool WriteProperties(v8::Local<v8::Object> object);
+  bool WriteArrayBufferView(v8::Local<v8::ArrayBufferView> view);
+  bool WriteSharedArrayBuffer(v8::Local<v8::SharedArrayBuffer> buffer,
+                              uint32_t* index);
+  bool ThrowDataCloneError(v8::Local<v8::Value> value);
+
+  Environment* const env_;
+  v8::Local<v8::Context> context_;
+  SharedArrayBufferList* const shared_array_buffers_;
+  char* data_;
+  size_t length_;
+  size_t capacity_;
+  unsigned depth_;
+  // Objects written so far, looked up by identity hash, so that repeated
+  // and cyclic references are written as back references.
+  std::vector<v8::Local<v8::Object>> objects_;
+  std::unordered_multimap<int, uint32_t> object_ids_;
+
+  DISALLOW_COPY_AND_ASSIGN(Serializer);
+};
+
+// Reads a value written by Serializer. |data| must stay valid for the
+// lifetime of the Deserializer, it is not copied.
+class Deserializer {
+ public:
+  Deserializer(Environment* env,
+               const char* data,
+               size_t length,
+               const SharedArrayBufferList* shared_array_buffers = nullptr);
+
+  // Returns an empty handle and schedules an exception if the data is
+  // malformed or does not contain exactly one value.
+  v8::MaybeLocal<v8::Value> ReadValue();
+
+ private:
+  inline bool ReadByte(uint8_t* byte);
+  inline bool ReadVarint(uint64_t* value);
+  inline bool ReadUint32(uint32_t* value);
+  inline bool ReadRawBytes(size_t length, const char** data);
+  bool ReadDouble(double* value);
+  v8::MaybeLocal<v8::Value> ReadNext();
+  v8::MaybeLocal<v8::Value> ReadString(uint8_t tag);
+  v8::MaybeLocal<v8::Value> ReadObject();
+  v8::MaybeLocal<v8::Value> ReadArray();
+  v8::MaybeLocal<v8::Value> ReadMap();
+  v8::MaybeLocal<v8::Value> ReadSet();
+  v8::MaybeLocal<v8::Value> ReadArrayBufferView(bool shared);
+  bool ReadSharedArrayBuffer(v8::Local<v8::SharedArrayBuffer>* buffer);
+  uint32_t AddObject(v8::Local<v8::Value> object);
+  v8::MaybeLocal<v8::Value> ThrowMalformed();
+
+  Environment* const env_;
+  v8::Local<v8::Context> context_;
+  const char* const data_;
+  const size_t length_;
+  size_t position_;
+  unsigned depth_;
+  const SharedArrayBufferList* const shared_array_buffers_;
+  std::vector<v8::Local<v8::Value>> objects_;
+  // One object per entry of |shared_array_buffers_|, created on first use.
+  std::vector<v8::Local<v8::SharedArrayBuffer>> shared_array_buffer_objects_;
+
+  DISALLOW_COPY_AND_ASSIGN(Deserializer);
+};
+
+}  // namespace serdes
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_SERDES_H_
@@ -4,19 +4,38 @@
 #include "util.h"
 #include "util-inl.h"
 #include "v8.h"
+#include "v8-profiler.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <poll.h>
+#endif
 
 namespace node {
 
 using v8::Array;
 using v8::ArrayBuffer;
+using v8::AllocationProfile;
 using v8::Context;
+using v8::CpuProfile;
+using v8::CpuProfileNode;
+using v8::CpuProfiler;
 using v8::FunctionCallbackInfo;
+using v8::HeapProfiler;
+using v8::HeapSnapshot;
 using v8::HeapSpaceStatistics;
 using v8::HeapStatistics;
+using v8::Integer;
 using v8::Isolate;
 using v8::Local;
 using v8::NewStringType;
+using v8::Number;
 using v8::Object;
+using v8::OutputStream;
 using v8::String;
 using v8::Uint32;
 using v8::V8;
@@ -94,6 +113,240 @@ void SetFlagsFromString(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// The sampling CPU profiler of lib/internal/v8_profiler.js. Only one profile
+// is recorded at a time, under a title of its own so that it does not get in
+// the way of the inspector's.
+#define CPU_PROFILE_TITLE "node:sampling"
+
+void StartCpuProfile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsUint32());
+  CpuProfiler* profiler = env->isolate()->GetCpuProfiler();
+  profiler->SetSamplingInterval(args[0]->Uint32Value());
+  profiler->StartProfiling(
+      FIXED_ONE_BYTE_STRING(env->isolate(), CPU_PROFILE_TITLE), false);
+}
+
+
+// Stops the profiler and returns its call tree flattened into arrays, in
+// depth-first order so that a node always comes after its parent: the
+// function name, script, line, parent index and number of samples of each
+// node. The root has parent -1.
+void StopCpuProfile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  CpuProfile* profile = isolate->GetCpuProfiler()->StopProfiling(
+      FIXED_ONE_BYTE_STRING(isolate, CPU_PROFILE_TITLE));
+  if (profile == nullptr)
+    return;
+
+  Local<Array> names = Array::New(isolate);
+  Local<Array> urls = Array::New(isolate);
+  Local<Array> lines = Array::New(isolate);
+  Local<Array> parents = Array::New(isolate);
+  Local<Array> hits = Array::New(isolate);
+
+  std::vector<std::pair<const CpuProfileNode*, int>> stack;
+  stack.emplace_back(profile->GetTopDownRoot(), -1);
+  uint32_t index = 0;
+  while (!stack.empty()) {
+    const CpuProfileNode* node = stack.back().first;
+    const int parent = stack.back().second;
+    stack.pop_back();
+
+    names->Set(index, node->GetFunctionName());
+    urls->Set(index, node->GetScriptResourceName());
+    lines->Set(index, Integer::New(isolate, node->GetLineNumber()));
+    parents->Set(index, Integer::New(isolate, parent));
+    hits->Set(index, Integer::NewFromUnsigned(isolate, node->GetHitCount()));
+
+    for (int i = node->GetChildrenCount() - 1; i >= 0; i--)
+      stack.emplace_back(node->GetChild(i), index);
+    index++;
+  }
+
+  Local<Object> result = Object::New(isolate);
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "names"), names);
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "urls"), urls);
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "lines"), lines);
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "parents"), parents);
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "hits"), hits);
+  // Timestamps are in microseconds.
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "startTime"),
+              Number::New(isolate, static_cast<double>(
+                  profile->GetStartTime())));
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "endTime"),
+              Number::New(isolate, static_cast<double>(
+                  profile->GetEndTime())));
+  profile->Delete();
+
+  args.GetReturnValue().Set(result);
+}
+
+#undef CPU_PROFILE_TITLE
+
+
+// Returns the buffer that GC events are recorded into, or undefined if
+// tracking is already on.
+void StartGCTracking(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  if (!env->StartGCTracking())
+    return;
+  const size_t length = Environment::kGCEventsHeaderLength +
+                        Environment::kGCEventsCapacity * env->gc_event_length();
+  args.GetReturnValue().Set(ArrayBuffer::New(env->isolate(),
+                                             env->gc_events_buffer(),
+                                             length * sizeof(double)));
+}
+
+
+void StopGCTracking(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  env->StopGCTracking();
+}
+
+
+void StartHeapProfile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsNumber());
+  CHECK(args[1]->IsUint32());
+  const bool started =
+      env->isolate()->GetHeapProfiler()->StartSamplingHeapProfiler(
+          static_cast<uint64_t>(args[0]->NumberValue()),
+          args[1]->Uint32Value());
+  args.GetReturnValue().Set(started);
+}
+
+
+void StopHeapProfile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  env->isolate()->GetHeapProfiler()->StopSamplingHeapProfiler();
+}
+
+
+// Returns the allocations sampled by the heap profiler that are still alive,
+// as a call tree flattened the same way as by StopCpuProfile(), with the
+// number and total size of the sampled objects each node allocated.
+void GetHeapProfile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  std::unique_ptr<AllocationProfile> profile(
+      isolate->GetHeapProfiler()->GetAllocationProfile());
+  if (!profile)
+    return;
+
+  Local<Array> names = Array::New(isolate);
+  Local<Array> urls = Array::New(isolate);
+  Local<Array> lines = Array::New(isolate);
+  Local<Array> parents = Array::New(isolate);
+  Local<Array> counts = Array::New(isolate);
+  Local<Array> sizes = Array::New(isolate);
+
+  std::vector<std::pair<const AllocationProfile::Node*, int>> stack;
+  stack.emplace_back(profile->GetRootNode(), -1);
+  uint32_t index = 0;
+  while (!stack.empty()) {
+    const AllocationProfile::Node* node = stack.back().first;
+    const int parent = stack.back().second;
+    stack.pop_back();
+
+    double count = 0;
+    double size = 0;
+    for (const AllocationProfile::Allocation& allocation : node->allocations) {
+      count += allocation.count;
+      size += static_cast<double>(allocation.size) * allocation.count;
+    }
+
+    names->Set(index, node->name);
+    urls->Set(index, node->script_name);
+    lines->Set(index, Integer::New(isolate, node->line_number));
+    parents->Set(index, Integer::New(isolate, parent));
+    counts->Set(index, Number::New(isolate, count));
+    sizes->Set(index, Number::New(isolate, size));
+
+    for (auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+      stack.emplace_back(*it, index);
+    index++;
+  }
+
+  Local<Object> result = Object::New(isolate);
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "names"), names);
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "urls"), urls);
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "lines"), lines);
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "parents"), parents);
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "counts"), counts);
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "sizes"), sizes);
+  args.GetReturnValue().Set(result);
+}
+
+
+// Writes the chunks of a serialized heap snapshot to a file descriptor as V8
+// produces them, so that only the snapshot itself is held in memory and not
+// its JSON as well.
+class FileOutputStream : public OutputStream {
+ public:
+  FileOutputStream(uv_loop_t* loop, int fd)
+      : loop_(loop), fd_(fd), written_(0), err_(0) {}
+
+  int GetChunkSize() override { return 64 * 1024; }
+
+  void EndOfStream() override {}
+
+  WriteResult WriteAsciiChunk(char* data, int size) override {
+    while (size > 0) {
+      uv_fs_t req;
+      uv_buf_t buf = uv_buf_init(data, size);
+      const int n = uv_fs_write(loop_, &req, fd_, &buf, 1, -1, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (n == UV_EINTR)
+        continue;
+#ifndef _WIN32
+      // |fd_| may be non-blocking, e.g. a pipe to another process. The
+      // snapshot cannot be suspended, so wait until the fd takes more data.
+      if (n == UV_EAGAIN) {
+        struct pollfd pfd = { fd_, POLLOUT, 0 };
+        while (poll(&pfd, 1, -1) == -1 && errno == EINTR) {}
+        continue;
+      }
+#endif
+      if (n < 0) {
+        err_ = n;
+        return kAbort;
+      }
+      data += n;
+      size -= n;
+      written_ += n;
+    }
+    return kContinue;
+  }
+
+  double written() const { return written_; }
+  int error() const { return err_; }
+
+ private:
+  uv_loop_t* const loop_;
+  const int fd_;
+  double written_;
+  int err_;
+};
+
+
+void WriteHeapSnapshot(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsInt32());
+  FileOutputStream stream(env->event_loop(), args[0]->Int32Value());
+
+  const HeapSnapshot* snapshot =
+      env->isolate()->GetHeapProfiler()->TakeHeapSnapshot();
+  snapshot->Serialize(&stream, HeapSnapshot::kJSON);
+  const_cast<HeapSnapshot*>(snapshot)->Delete();
+
+  if (stream.error() != 0)
+    return env->ThrowUVException(stream.error(), "write");
+  args.GetReturnValue().Set(stream.written());
+}
+
+
 void InitializeV8Bindings(Local<Object> target,
                           Local<Value> unused,
                           Local<Context> context) {
@@ -170,6 +423,29 @@ void InitializeV8Bindings(Local<Object> target,
 #undef V
 
   env->SetMethod(target, "setFlagsFromString", SetFlagsFromString);
+  env->SetMethod(target, "startCpuProfile", StartCpuProfile);
+  env->SetMethod(target, "stopCpuProfile", StopCpuProfile);
+  env->SetMethod(target, "startGCTracking", StartGCTracking);
+  env->SetMethod(target, "stopGCTracking", StopGCTracking);
+#define V(name)                                                               \
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                   \
+              Uint32::NewFromUnsigned(env->isolate(), Environment::name));
+  V(kGCEventsTotal)
+  V(kGCEventsHeaderLength)
+  V(kGCEventsCapacity)
+  V(kGCEventType)
+  V(kGCEventFlags)
+  V(kGCEventStart)
+  V(kGCEventDuration)
+  V(kGCEventUsedBefore)
+  V(kGCEventUsedAfter)
+  V(kGCEventTotalAfter)
+  V(kGCEventSpaces)
+#undef V
+  env->SetMethod(target, "startHeapProfile", StartHeapProfile);
+  env->SetMethod(target, "stopHeapProfile", StopHeapProfile);
+  env->SetMethod(target, "getHeapProfile", GetHeapProfile);
+  env->SetMethod(target, "writeHeapSnapshot", WriteHeapSnapshot);
 }
 
 }  // namespace node
@@ -0,0 +1,537 @@
+#include "node_worker.h"
+#include "node.h"
+#include "node_internals.h"
+#include "node_serdes.h"
+#include "async-wrap.h"
+#include "async-wrap-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "handle_wrap.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <utility>
+
+namespace node {
+namespace worker {
+
+using v8::Array;
+using v8::Boolean;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Locker;
+using v8::Number;
+using v8::Object;
+using v8::SealHandleScope;
+using v8::TryCatch;
+using v8::Value;
+
+static Mutex next_thread_id_mutex;
+static uint64_t next_thread_id = 1;
+
+
+MessagePortData::MessagePortData() : async_(nullptr), closed_(false) {
+}
+
+
+MessagePortData::~MessagePortData() {
+  for (Message* message : queue_)
+    delete message;
+}
+
+
+void MessagePortData::AddMessage(Message* message) {
+  Mutex::ScopedLock scoped_lock(mutex_);
+  if (closed_) {
+    delete message;
+    return;
+  }
+  queue_.push_back(message);
+  if (async_ != nullptr)
+    uv_async_send(async_);
+}
+
+
+void MessagePortData::SetAsync(uv_async_t* async) {
+  Mutex::ScopedLock scoped_lock(mutex_);
+  async_ = async;
+  // Messages may have been posted before the receiving port existed.
+  if (!queue_.empty())
+    uv_async_send(async_);
+}
+
+
+void MessagePortData::Close() {
+  Mutex::ScopedLock scoped_lock(mutex_);
+  async_ = nullptr;
+  closed_ = true;
+}
+
+
+void MessagePortData::TakeMessages(std::deque<Message*>* messages) {
+  Mutex::ScopedLock scoped_lock(mutex_);
+  messages->swap(queue_);
+}
+
+
+MessagePort::MessagePort(Environment* env,
+                         Local<Object> object,
+                         std::shared_ptr<MessagePortData> receiving,
+                         std::shared_ptr<MessagePortData> sending)
+    : HandleWrap(env,
+                 object,
+                 reinterpret_cast<uv_handle_t*>(&async_),
+                 AsyncWrap::PROVIDER_MESSAGEPORT),
+      receiving_(receiving),
+      sending_(sending) {
+  int r = uv_async_init(env->event_loop(), &async_, OnMessage);
+  CHECK_EQ(r, 0);
+  receiving_->SetAsync(&async_);
+}
+
+
+MessagePort* MessagePort::New(Environment* env,
+                              std::shared_ptr<MessagePortData> receiving,
+                              std::shared_ptr<MessagePortData> sending) {
+  Local<Object> object =
+      env->message_port_constructor_function()
+          ->NewInstance(env->context()).ToLocalChecked();
+  return new MessagePort(env, object, receiving, sending);
+}
+
+
+void MessagePort::Close(Local<Value> close_callback) {
+  receiving_->Close();
+  HandleWrap::Close(close_callback);
+}
+
+
+void MessagePort::Drain() {
+  Environment* env = this->env();
+  Isolate* isolate = env->isolate();
+  HandleScope handle_scope(isolate);
+  Context::Scope context_scope(env->context());
+
+  std::deque<Message*> messages;
+  receiving_->TakeMessages(&messages);
+
+  while (!messages.empty()) {
+    std::unique_ptr<Message> message(messages.front());
+    messages.pop_front();
+
+    // A previous onmessage callback may have closed the port or stopped the
+    // thread.
+    if (!IsAlive(this) || isolate->IsExecutionTerminating())
+      continue;
+
+    HandleScope message_scope(isolate);
+    Local<Value> payload;
+    {
+      TryCatch try_catch(isolate);
+      serdes::Deserializer deserializer(env,
+                                        message->data,
+                                        message->length,
+                                        &message->shared_array_buffers);
+      if (!deserializer.ReadValue().ToLocal(&payload)) {
+        if (try_catch.HasCaught() && !try_catch.HasTerminated())
+          FatalException(isolate, try_catch);
+        continue;
+      }
+    }
+    MakeCallback(env->onmessage_string(), 1, &payload);
+  }
+}
+
+
+void MessagePort::OnMessage(uv_async_t* handle) {
+  MessagePort* port = ContainerOf(&MessagePort::async_, handle);
+  port->Drain();
+}
+
+
+void MessagePort::PostMessage(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  MessagePort* port;
+  ASSIGN_OR_RETURN_UNWRAP(&port, args.Holder());
+
+  if (!IsAlive(port))
+    return env->ThrowError("MessagePort is closed");
+
+  serdes::SharedArrayBufferList shared_array_buffers;
+  serdes::Serializer serializer(env, &shared_array_buffers);
+  if (!serializer.WriteValue(args[0]))
+    return;
+
+  size_t length;
+  char* data = serializer.Release(&length);
+  Message* message = new Message(data, length);
+  message->shared_array_buffers = std::move(shared_array_buffers);
+  port->sending_->AddMessage(message);
+}
+
+
+void MessagePort::Drain(const FunctionCallbackInfo<Value>& args) {
+  MessagePort* port;
+  ASSIGN_OR_RETURN_UNWRAP(&port, args.Holder());
+  if (IsAlive(port))
+    port->Drain();
+}
+
+
+Worker::Worker(Environment* env,
+               Local<Object> object,
+               std::vector<std::string>&& argv,
+               std::vector<std::string>&& exec_argv,
+               std::map<std::string, std::string>&& env_vars)
+    : HandleWrap(env,
+                 object,
+                 reinterpret_cast<uv_handle_t*>(&thread_stopped_async_),
+                 AsyncWrap::PROVIDER_WORKER),
+      thread_joined_(true),
+      thread_id_([]() {
+        Mutex::ScopedLock scoped_lock(next_thread_id_mutex);
+        return next_thread_id++;
+      }()),
+      argv_(std::move(argv)),
+      exec_argv_(std::move(exec_argv)),
+      env_vars_(std::move(env_vars)),
+      child_port_data_(std::make_shared<MessagePortData>()),
+      parent_port_data_(std::make_shared<MessagePortData>()),
+      isolate_(nullptr),
+      stop_async_(nullptr),
+      stopped_(false),
+      exit_code_(0) {
+  int r = uv_async_init(env->event_loop(),
+                        &thread_stopped_async_,
+                        OnThreadStopped);
+  CHECK_EQ(r, 0);
+
+  MessagePort* port = MessagePort::New(env,
+                                       parent_port_data_,
+                                       child_port_data_);
+  object->Set(env->message_port_string(), port->object());
+  object->Set(env->thread_id_string(),
+              Number::New(env->isolate(), static_cast<double>(thread_id_)));
+}
+
+
+Worker::~Worker() {
+  CHECK(thread_joined_);
+}
+
+
+bool Worker::is_stopped() {
+  Mutex::ScopedLock scoped_lock(mutex_);
+  return stopped_;
+}
+
+
+void Worker::Run(uintptr_t stack_limit) {
+  ArrayBufferAllocator allocator;
+  Isolate* isolate = NewIsolate(&allocator);
+  CHECK_NE(isolate, nullptr);
+  CHECK_EQ(uv_loop_init(&loop_), 0);
+
+  uv_async_t* stop_async = new uv_async_t;
+  CHECK_EQ(uv_async_init(&loop_, stop_async, [](uv_async_t* handle) {
+    uv_stop(handle->loop);
+  }), 0);
+  uv_unref(reinterpret_cast<uv_handle_t*>(stop_async));
+
+  {
+    Mutex::ScopedLock scoped_lock(mutex_);
+    isolate_ = isolate;
+    stop_async_ = stop_async;
+    // terminate() was called before the isolate existed.
+    if (stopped_)
+      isolate->TerminateExecution();
+  }
+
+  {
+    Locker locker(isolate);
+    Isolate::Scope isolate_scope(isolate);
+    // Taking the lock for the first time resets the limit, so set it here.
+    isolate->SetStackLimit(stack_limit);
+    HandleScope handle_scope(isolate);
+    IsolateData isolate_data(isolate, &loop_, allocator.zero_fill_field(),
+                             &allocator);
+    Local<Context> context = Context::New(isolate);
+    Context::Scope context_scope(context);
+
+    Environment* env = new Environment(&isolate_data, context);
+    env->set_worker_context(this);
+    env->set_env_vars(&env_vars_);
+    {
+      std::vector<const char*> argv;
+      std::vector<const char*> exec_argv;
+      for (const std::string& arg : argv_)
+        argv.push_back(arg.c_str());
+      for (const std::string& arg : exec_argv_)
+        exec_argv.push_back(arg.c_str());
+      env->Start(argv.size(), argv.data(),
+                 exec_argv.size(), exec_argv.data(),
+                 false);
+    }
+
+    if (!is_stopped()) {
+      Environment::AsyncCallbackScope callback_scope(env);
+      LoadEnvironment(env);
+    }
+
+    if (!is_stopped()) {
+      SealHandleScope seal(isolate);
+      bool more;
+      do {
+        PumpPlatformMessageLoop(isolate);
+        more = uv_run(&loop_, UV_RUN_ONCE);
+        if (is_stopped())
+          break;
+
+        if (more == false) {
+          PumpPlatformMessageLoop(isolate);
+          EmitBeforeExit(env);
+
+          more = uv_loop_alive(&loop_);
+          if (uv_run(&loop_, UV_RUN_NOWAIT) != 0)
+            more = true;
+        }
+      } while (more == true && !is_stopped());
+    }
+
+    if (!is_stopped()) {
+      const int exit_code = EmitExit(env);
+      Mutex::ScopedLock scoped_lock(mutex_);
+      if (!stopped_)
+        exit_code_ = exit_code;
+    }
+
+    {
+      Mutex::ScopedLock scoped_lock(mutex_);
+      stopped_ = true;
+      stop_async_ = nullptr;
+    }
+    uv_close(reinterpret_cast<uv_handle_t*>(stop_async), [](uv_handle_t* h) {
+      delete reinterpret_cast<uv_async_t*>(h);
+    });
+
+    // Close everything that is still open, including worker threads started
+    // from this one, and wait for pending requests to finish.
+    isolate->CancelTerminateExecution();
+    for (HandleWrap* wrap : *env->handle_wrap_queue())
+      wrap->Close();
+    // The Environment destructor leaves this one open, the main thread exits
+    // with it still on the loop.
+    uv_close(reinterpret_cast<uv_handle_t*>(env->destroy_ids_idle_handle()),
+             nullptr);
+    uv_walk(&loop_, [](uv_handle_t* handle, void* arg) {
+      uv_unref(handle);
+    }, nullptr);
+    uv_run(&loop_, UV_RUN_DEFAULT);
+
+    serdes::SharedArrayBufferData::ReleaseAll(env);
+    delete env;
+
+    uv_walk(&loop_, [](uv_handle_t* handle, void* arg) {
+      if (!uv_is_closing(handle))
+        uv_close(handle, nullptr);
+    }, nullptr);
+    uv_run(&loop_, UV_RUN_DEFAULT);
+  }
+
+  {
+    Mutex::ScopedLock scoped_lock(mutex_);
+    isolate_ = nullptr;
+  }
+  isolate->Dispose();
+  CHECK_EQ(uv_loop_close(&loop_), 0);
+
+  // The parent may still post messages until it sees the thread stop.
+  child_port_data_->Close();
+  uv_async_send(&thread_stopped_async_);
+}
+
+
+void Worker::Exit(int code) {
+  Mutex::ScopedLock scoped_lock(mutex_);
+  if (!stopped_) {
+    stopped_ = true;
+    exit_code_ = code;
+  }
+  uv_stop(&loop_);
+  isolate_->TerminateExecution();
+}
+
+
+void Worker::Stop() {
+  Mutex::ScopedLock scoped_lock(mutex_);
+  if (stopped_)
+    return;
+  stopped_ = true;
+  exit_code_ = 1;
+  if (isolate_ != nullptr)
+    isolate_->TerminateExecution();
+  if (stop_async_ != nullptr)
+    uv_async_send(stop_async_);
+}
+
+
+void Worker::JoinThread() {
+  if (thread_joined_)
+    return;
+  CHECK_EQ(uv_thread_join(&tid_), 0);
+  thread_joined_ = true;
+}
+
+
+void Worker::Close(Local<Value> close_callback) {
+  Stop();
+  JoinThread();
+  HandleWrap::Close(close_callback);
+}
+
+
+void Worker::StopAll(Environment* env) {
+  for (HandleWrap* wrap : *env->handle_wrap_queue()) {
+    if (wrap->provider_type() == AsyncWrap::PROVIDER_WORKER)
+      wrap->Close();
+  }
+}
+
+
+void Worker::OnThreadStopped(uv_async_t* handle) {
+  Worker* w = ContainerOf(&Worker::thread_stopped_async_, handle);
+  w->JoinThread();
+
+  Environment* env = w->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+  Local<Value> code = Integer::New(env->isolate(), w->exit_code_);
+  w->MakeCallback(env->onexit_string(), 1, &code);
+}
+
+
+MessagePort* Worker::CreateParentPort(Environment* env) {
+  return MessagePort::New(env, child_port_data_, parent_port_data_);
+}
+
+
+static void ToStringVector(Local<Value> value,
+                           std::vector<std::string>* strings) {
+  if (!value->IsArray())
+    return;
+  Local<Array> array = value.As<Array>();
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    node::Utf8Value arg(array->GetIsolate(), array->Get(i));
+    strings->push_back(*arg);
+  }
+}
+
+
+// new Worker(argv, execArgv)
+void Worker::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  Environment* env = Environment::GetCurrent(args);
+
+  std::vector<std::string> argv;
+  std::vector<std::string> exec_argv;
+  ToStringVector(args[0], &argv);
+  ToStringVector(args[1], &exec_argv);
+  CHECK(!argv.empty());
+
+  // Read on this thread, which owns the variables that are copied.
+  std::map<std::string, std::string> env_vars;
+  CopyEnvVars(env, &env_vars);
+
+  new Worker(env, args.This(), std::move(argv), std::move(exec_argv),
+             std::move(env_vars));
+}
+
+
+void Worker::StartThread(const FunctionCallbackInfo<Value>& args) {
+  Worker* w;
+  ASSIGN_OR_RETURN_UNWRAP(&w, args.Holder());
+  CHECK(IsAlive(w));
+  CHECK(w->thread_joined_);
+
+  uv_thread_options_t thread_options;
+  thread_options.flags = UV_THREAD_HAS_STACK_SIZE;
+  thread_options.stack_size = kStackSize;
+  int err = uv_thread_create_ex(&w->tid_, &thread_options, [](void* arg) {
+    // The stack grows down from about here.
+    uintptr_t stack_top = reinterpret_cast<uintptr_t>(&arg);
+    static_cast<Worker*>(arg)->Run(
+        stack_top - (kStackSize - kStackBufferSize));
+  }, static_cast<void*>(w));
+  if (err == 0)
+    w->thread_joined_ = false;
+  args.GetReturnValue().Set(err);
+}
+
+
+void Worker::Terminate(const FunctionCallbackInfo<Value>& args) {
+  Worker* w;
+  ASSIGN_OR_RETURN_UNWRAP(&w, args.Holder());
+  w->Stop();
+}
+
+
+static void MessagePortConstructor(const FunctionCallbackInfo<Value>& args) {
+  // Only instantiated through MessagePort::New().
+  CHECK(args.IsConstructCall());
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  Local<FunctionTemplate> worker = env->NewFunctionTemplate(Worker::New);
+  worker->InstanceTemplate()->SetInternalFieldCount(1);
+  worker->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "Worker"));
+  env->SetProtoMethod(worker, "startThread", Worker::StartThread);
+  env->SetProtoMethod(worker, "terminate", Worker::Terminate);
+  env->SetProtoMethod(worker, "close", HandleWrap::Close);
+  env->SetProtoMethod(worker, "ref", HandleWrap::Ref);
+  env->SetProtoMethod(worker, "unref", HandleWrap::Unref);
+  env->SetProtoMethod(worker, "hasRef", HandleWrap::HasRef);
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Worker"),
+              worker->GetFunction());
+
+  Local<FunctionTemplate> port =
+      env->NewFunctionTemplate(MessagePortConstructor);
+  port->InstanceTemplate()->SetInternalFieldCount(1);
+  port->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "MessagePort"));
+  env->SetProtoMethod(port, "postMessage", MessagePort::PostMessage);
+  env->SetProtoMethod(port, "drain", MessagePort::Drain);
+  env->SetProtoMethod(port, "close", HandleWrap::Close);
+  env->SetProtoMethod(port, "ref", HandleWrap::Ref);
+  env->SetProtoMethod(port, "unref", HandleWrap::Unref);
+  env->SetProtoMethod(port, "hasRef", HandleWrap::HasRef);
+  env->set_message_port_constructor_function(port->GetFunction());
+
+  Worker* worker_context = env->worker_context();
+  const uint64_t thread_id =
+      worker_context == nullptr ? 0 : worker_context->thread_id();
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "isMainThread"),
+              Boolean::New(env->isolate(), worker_context == nullptr));
+  target->Set(env->thread_id_string(),
+              Number::New(env->isolate(), static_cast<double>(thread_id)));
+  if (worker_context != nullptr) {
+    MessagePort* parent_port = worker_context->CreateParentPort(env);
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "parentPort"),
+                parent_port->object());
+  }
+}
+
+}  // namespace worker
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(worker, node::worker::Initialize)
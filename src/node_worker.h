@@ -0,0 +1,170 @@
+#ifndef SRC_NODE_WORKER_H_
+#define SRC_NODE_WORKER_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "handle_wrap.h"
+#include "node_internals.h"
+#include "node_mutex.h"
+#include "node_serdes.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace node {
+namespace worker {
+
+// A serialized message on its way to another thread.
+struct Message {
+  Message(char* data, size_t length)
+      : data(data), length(length) {}
+  ~Message() { free(data); }
+
+  char* data;
+  size_t length;
+  serdes::SharedArrayBufferList shared_array_buffers;
+};
+
+// The receiving end of a message channel. It outlives the MessagePort that
+// drains it, so that the other thread can keep posting to it (messages are
+// dropped once it is closed) and messages can be posted before the
+// receiving MessagePort exists.
+class MessagePortData {
+ public:
+  MessagePortData();
+  ~MessagePortData();
+
+  // Takes ownership of |message|. Called from the sending thread.
+  void AddMessage(Message* message);
+
+  // Called from the receiving thread.
+  void SetAsync(uv_async_t* async);
+  void Close();
+  void TakeMessages(std::deque<Message*>* messages);
+
+ private:
+  Mutex mutex_;
+  std::deque<Message*> queue_;
+  uv_async_t* async_;
+  bool closed_;
+
+  DISALLOW_COPY_AND_ASSIGN(MessagePortData);
+};
+
+// One end of the channel between a Worker and its parent thread. Received
+// messages are passed to the object's onmessage function.
+class MessagePort : public HandleWrap {
+ public:
+  static MessagePort* New(Environment* env,
+                          std::shared_ptr<MessagePortData> receiving,
+                          std::shared_ptr<MessagePortData> sending);
+
+  // Dispatches all pending messages to JS.
+  void Drain();
+
+  // Stops accepting messages before closing the handle.
+  void Close(
+      v8::Local<v8::Value> close_callback = v8::Local<v8::Value>()) override;
+
+  size_t self_size() const override { return sizeof(*this); }
+
+  static void PostMessage(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Drain(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+ private:
+  MessagePort(Environment* env,
+              v8::Local<v8::Object> object,
+              std::shared_ptr<MessagePortData> receiving,
+              std::shared_ptr<MessagePortData> sending);
+
+  static void OnMessage(uv_async_t* handle);
+
+  uv_async_t async_;
+  std::shared_ptr<MessagePortData> receiving_;
+  std::shared_ptr<MessagePortData> sending_;
+};
+
+// A Node.js instance with its own isolate and event loop, running on its
+// own thread. The Worker object lives on the parent thread; its handle fires
+// when the thread has finished.
+class Worker : public HandleWrap {
+ public:
+  ~Worker() override;
+
+  // Called on the worker thread by process.exit() and when an exception is
+  // not handled. Stops the thread as soon as control returns to the event
+  // loop.
+  void Exit(int code);
+
+  // Creates the worker thread's end of the message channel.
+  MessagePort* CreateParentPort(Environment* env);
+
+  // Stops the thread and waits for it to finish before closing the handle.
+  void Close(
+      v8::Local<v8::Value> close_callback = v8::Local<v8::Value>()) override;
+
+  // Stops the worker threads started from |env|, including those that have
+  // been unref()ed.
+  static void StopAll(Environment* env);
+
+  inline uint64_t thread_id() const { return thread_id_; }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void StartThread(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Terminate(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+ private:
+  Worker(Environment* env,
+         v8::Local<v8::Object> object,
+         std::vector<std::string>&& argv,
+         std::vector<std::string>&& exec_argv,
+         std::map<std::string, std::string>&& env_vars);
+
+  void Run(uintptr_t stack_limit);
+  void Stop();
+  bool is_stopped();
+  void JoinThread();
+  static void OnThreadStopped(uv_async_t* handle);
+
+  // Worker threads get a stack of this size. V8 is told to stop short of its
+  // end by kStackBufferSize, which leaves room for native code that runs
+  // without stack checks, e.g. when a stack overflow error is reported.
+  static constexpr size_t kStackSize = 4 * 1024 * 1024;
+  static constexpr size_t kStackBufferSize = 192 * 1024;
+
+  uv_async_t thread_stopped_async_;
+  uv_thread_t tid_;
+  bool thread_joined_;
+  const uint64_t thread_id_;
+  std::vector<std::string> argv_;
+  std::vector<std::string> exec_argv_;
+  // The worker's process.env, copied from its parent's.
+  std::map<std::string, std::string> env_vars_;
+
+  // Messages to the worker thread, and to its parent.
+  std::shared_ptr<MessagePortData> child_port_data_;
+  std::shared_ptr<MessagePortData> parent_port_data_;
+
+  // Protects the fields below, which are also accessed from the parent
+  // thread to terminate the worker.
+  Mutex mutex_;
+  uv_loop_t loop_;
+  v8::Isolate* isolate_;
+  uv_async_t* stop_async_;
+  bool stopped_;
+  int exit_code_;
+};
+
+}  // namespace worker
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_WORKER_H_
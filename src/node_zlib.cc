@@ -89,12 +89,14 @@ class ZCtx : public AsyncWrap {
     if (mode_ == DEFLATE || mode_ == GZIP || mode_ == DEFLATERAW) {
       (void)deflateEnd(&strm_);
       int64_t change_in_bytes = -static_cast<int64_t>(kDeflateContextSize);
-      env()->isolate()->AdjustAmountOfExternalAllocatedMemory(change_in_bytes);
+      env()->AdjustExternalMemory(Environment::kExternalMemoryZlib,
+                                  change_in_bytes);
     } else if (mode_ == INFLATE || mode_ == GUNZIP || mode_ == INFLATERAW ||
                mode_ == UNZIP) {
       (void)inflateEnd(&strm_);
       int64_t change_in_bytes = -static_cast<int64_t>(kInflateContextSize);
-      env()->isolate()->AdjustAmountOfExternalAllocatedMemory(change_in_bytes);
+      env()->AdjustExternalMemory(Environment::kExternalMemoryZlib,
+                                  change_in_bytes);
     }
     mode_ = NONE;
 
@@ -187,10 +189,11 @@ class ZCtx : public AsyncWrap {
     }
 
     // async version
-    uv_queue_work(ctx->env()->event_loop(),
-                  work_req,
-                  ZCtx::Process,
-                  ZCtx::After);
+    uv_queue_work_class(ctx->env()->event_loop(),
+                        work_req,
+                        UV_WORK_CPU,
+                        ZCtx::Process,
+                        ZCtx::After);
 
     args.GetReturnValue().Set(ctx->object());
   }
@@ -515,16 +518,16 @@ class ZCtx : public AsyncWrap {
                                  ctx->windowBits_,
                                  ctx->memLevel_,
                                  ctx->strategy_);
-        ctx->env()->isolate()
-            ->AdjustAmountOfExternalAllocatedMemory(kDeflateContextSize);
+        ctx->env()->AdjustExternalMemory(Environment::kExternalMemoryZlib,
+                                         kDeflateContextSize);
         break;
       case INFLATE:
       case GUNZIP:
       case INFLATERAW:
       case UNZIP:
         ctx->err_ = inflateInit2(&ctx->strm_, ctx->windowBits_);
-        ctx->env()->isolate()
-            ->AdjustAmountOfExternalAllocatedMemory(kInflateContextSize);
+        ctx->env()->AdjustExternalMemory(Environment::kExternalMemoryZlib,
+                                         kInflateContextSize);
         break;
       default:
         CHECK(0 && "wtf?");
@@ -0,0 +1,578 @@
+#include "async-wrap.h"
+#include "async-wrap-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "handle_wrap.h"
+#include "node_internals.h"
+#include "node_serdes.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <atomic>
+#include <deque>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace node {
+
+using v8::Array;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Object;
+using v8::TryCatch;
+using v8::Value;
+
+// A message channel between two processes, made of two single-producer,
+// single-consumer rings in a shared memory mapping, one per direction.
+// Messages are serialized with the serdes binding and copied into the ring
+// once, then deserialized by the other process directly from the mapping.
+//
+// Each process polls an eventfd of its own and writes to the other's to
+// wake it up. Wakeups are only sent when the reader has gone to sleep, i.e.
+// has emptied the ring and returned to the event loop, so a burst of
+// messages costs a single system call on either side. The writer is woken
+// up the same way when it found the ring full and the reader has made room.
+//
+// The parent creates the mapping and the eventfds with createFds() and
+// passes the file descriptors to the child, which opens the other end.
+class ShmChannelWrap : public HandleWrap {
+ public:
+  static void Initialize(Local<Object> target,
+                         Local<Value> unused,
+                         Local<Context> context);
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  // The file descriptors that make up a channel, in the order createFds()
+  // returns them.
+  enum { kMemoryFd, kParentEventFd, kChildEventFd, kFdCount };
+
+  static const uint32_t kMagic = 0x6e736863;  // 'nshc'
+  // Marks the unused space at the end of a ring, the next message starts
+  // at the beginning.
+  static const uint32_t kWrapMarker = 0xffffffff;
+  static const uint32_t kMinCapacity = 4096;
+  static const uint32_t kMaxCapacity = 1u << 30;
+
+  // The positions are free running counters, the offset into the ring is
+  // the position modulo the capacity, which is a power of two. Fields that
+  // are written by different processes live on different cache lines.
+  struct RingHeader {
+    std::atomic<uint32_t> write_position;
+    char padding1[60];
+    std::atomic<uint32_t> read_position;
+    char padding2[60];
+    // Set by the reader before it goes to sleep.
+    std::atomic<uint32_t> reader_sleeping;
+    // Set by the writer when it found the ring full.
+    std::atomic<uint32_t> writer_waiting;
+    char padding3[56];
+  };
+
+  // Followed by the data of the parent's ring and of the child's ring.
+  struct ChannelHeader {
+    uint32_t magic;
+    uint32_t capacity;
+    char padding[56];
+    RingHeader rings[2];
+  };
+
+  struct Ring {
+    RingHeader* header;
+    char* data;
+  };
+
+  static_assert(ATOMIC_INT_LOCK_FREE == 2,
+                "shared memory channels need lock-free atomics");
+
+  static void New(const FunctionCallbackInfo<Value>& args);
+  static void CreateFds(const FunctionCallbackInfo<Value>& args);
+  static void PostMessage(const FunctionCallbackInfo<Value>& args);
+  static void GetPendingMessages(const FunctionCallbackInfo<Value>& args);
+
+  ShmChannelWrap(Environment* env,
+                 Local<Object> object,
+                 void* mapping,
+                 size_t mapping_length,
+                 const int* fds,
+                 bool is_parent);
+  ~ShmChannelWrap() override;
+
+  static size_t MappingLength(uint32_t capacity) {
+    return sizeof(ChannelHeader) + 2 * static_cast<size_t>(capacity);
+  }
+
+  // Returns false if the message does not fit into the ring right now.
+  bool TryWrite(const char* data, size_t length);
+  bool Write(const char* data, size_t length);
+  void FlushPendingMessages();
+  // Dispatches all messages in the incoming ring to JS.
+  void Drain();
+  void Wake();
+  // Stops reading from the channel and passes |error| to onerror, which
+  // closes it.
+  void OnError(Local<Value> error);
+
+  static void OnPoll(uv_poll_t* handle, int status, int events);
+
+  uv_poll_t handle_;
+  void* mapping_;
+  size_t mapping_length_;
+  uint32_t capacity_;
+  Ring incoming_;
+  Ring outgoing_;
+  int fds_[kFdCount];
+  int own_event_fd_;
+  int peer_event_fd_;
+  // Messages that did not fit into the outgoing ring, written as soon as the
+  // other process makes room.
+  std::deque<std::pair<char*, size_t>> pending_;
+};
+
+
+static inline uint32_t RoundUp(uint32_t value, uint32_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+
+ShmChannelWrap::ShmChannelWrap(Environment* env,
+                               Local<Object> object,
+                               void* mapping,
+                               size_t mapping_length,
+                               const int* fds,
+                               bool is_parent)
+    : HandleWrap(env,
+                 object,
+                 reinterpret_cast<uv_handle_t*>(&handle_),
+                 AsyncWrap::PROVIDER_SHMCHANNELWRAP),
+      mapping_(mapping),
+      mapping_length_(mapping_length) {
+  ChannelHeader* header = static_cast<ChannelHeader*>(mapping);
+  char* data = static_cast<char*>(mapping) + sizeof(*header);
+  capacity_ = header->capacity;
+
+  // The parent writes to the first ring and reads from the second.
+  Ring parent_ring = { &header->rings[0], data };
+  Ring child_ring = { &header->rings[1], data + capacity_ };
+  outgoing_ = is_parent ? parent_ring : child_ring;
+  incoming_ = is_parent ? child_ring : parent_ring;
+
+  for (int i = 0; i < kFdCount; i++)
+    fds_[i] = fds[i];
+  own_event_fd_ = fds[is_parent ? kParentEventFd : kChildEventFd];
+  peer_event_fd_ = fds[is_parent ? kChildEventFd : kParentEventFd];
+
+  int r = uv_poll_init(env->event_loop(), &handle_, own_event_fd_);
+  CHECK_EQ(r, 0);
+  r = uv_poll_start(&handle_, UV_READABLE, OnPoll);
+  CHECK_EQ(r, 0);
+}
+
+
+ShmChannelWrap::~ShmChannelWrap() {
+  for (auto& message : pending_)
+    free(message.first);
+#ifdef __linux__
+  munmap(mapping_, mapping_length_);
+  for (int fd : fds_)
+    close(fd);
+#endif
+}
+
+
+void ShmChannelWrap::Initialize(Local<Object> target,
+                                Local<Value> unused,
+                                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  Local<FunctionTemplate> constructor = env->NewFunctionTemplate(New);
+  constructor->InstanceTemplate()->SetInternalFieldCount(1);
+  constructor->SetClassName(
+      FIXED_ONE_BYTE_STRING(env->isolate(), "ShmChannel"));
+
+  env->SetProtoMethod(constructor, "close", HandleWrap::Close);
+  env->SetProtoMethod(constructor, "ref", HandleWrap::Ref);
+  env->SetProtoMethod(constructor, "unref", HandleWrap::Unref);
+  env->SetProtoMethod(constructor, "hasRef", HandleWrap::HasRef);
+  env->SetProtoMethod(constructor, "postMessage", PostMessage);
+  env->SetProtoMethod(constructor, "getPendingMessages", GetPendingMessages);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "ShmChannel"),
+              constructor->GetFunction());
+  env->SetMethod(target, "createFds", CreateFds);
+}
+
+
+// createFds(capacity) creates the shared memory and the eventfds of a new
+// channel whose rings hold |capacity| bytes each, rounded up to a power of
+// two. Returns [memoryFd, parentEventFd, childEventFd].
+void ShmChannelWrap::CreateFds(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsUint32());
+  uint32_t requested = args[0]->Uint32Value(env->context()).FromJust();
+  if (requested > kMaxCapacity)
+    return env->ThrowRangeError("Shared memory channel size is too large");
+
+  uint32_t capacity = kMinCapacity;
+  while (capacity < requested)
+    capacity <<= 1;
+
+#if defined(__linux__) && defined(__NR_memfd_create)
+  const size_t length = MappingLength(capacity);
+  int fds[kFdCount] = { -1, -1, -1 };
+  const char* syscall_name = "memfd_create";
+  int err = 0;
+  void* mapping = MAP_FAILED;
+
+  fds[kMemoryFd] = syscall(__NR_memfd_create, "node-shm-channel",
+                           1 /* MFD_CLOEXEC */);
+  if (fds[kMemoryFd] == -1)
+    goto fail;
+
+  syscall_name = "ftruncate";
+  if (ftruncate(fds[kMemoryFd], length) == -1)
+    goto fail;
+
+  syscall_name = "mmap";
+  mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED,
+                 fds[kMemoryFd], 0);
+  if (mapping == MAP_FAILED)
+    goto fail;
+
+  syscall_name = "eventfd";
+  fds[kParentEventFd] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (fds[kParentEventFd] == -1)
+    goto fail;
+  fds[kChildEventFd] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (fds[kChildEventFd] == -1)
+    goto fail;
+
+  {
+    // The memory is zero-filled. Both readers start out asleep so that the
+    // first message wakes them up.
+    ChannelHeader* header = static_cast<ChannelHeader*>(mapping);
+    header->capacity = capacity;
+    header->rings[0].reader_sleeping.store(1);
+    header->rings[1].reader_sleeping.store(1);
+    header->magic = kMagic;
+    munmap(mapping, length);
+
+    Local<Array> result = Array::New(env->isolate(), kFdCount);
+    for (int i = 0; i < kFdCount; i++)
+      result->Set(i, Integer::New(env->isolate(), fds[i]));
+    return args.GetReturnValue().Set(result);
+  }
+
+ fail:
+  err = -errno;
+  if (mapping != MAP_FAILED)
+    munmap(mapping, length);
+  for (int fd : fds) {
+    if (fd != -1)
+      close(fd);
+  }
+  env->ThrowUVException(err, syscall_name);
+#else
+  env->ThrowUVException(UV_ENOSYS, "memfd_create");
+#endif
+}
+
+
+// new ShmChannel(fds, isParent) maps the channel created by createFds() and
+// starts polling for messages. The object takes ownership of |fds|.
+void ShmChannelWrap::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsArray());
+  Local<Array> fds_array = args[0].As<Array>();
+  CHECK_EQ(fds_array->Length(), static_cast<uint32_t>(kFdCount));
+  int fds[kFdCount];
+  for (int i = 0; i < kFdCount; i++) {
+    Local<Value> fd = fds_array->Get(env->context(), i).ToLocalChecked();
+    CHECK(fd->IsInt32());
+    fds[i] = fd.As<Integer>()->Value();
+  }
+  const bool is_parent = args[1]->IsTrue();
+
+#ifdef __linux__
+  // The child inherits the file descriptors without the close-on-exec flag,
+  // do not pass them on to its own children.
+  for (int fd : fds) {
+    int flags = fcntl(fd, F_GETFD);
+    if (flags == -1 || fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1)
+      return env->ThrowUVException(-errno, "fcntl");
+  }
+
+  struct stat s;
+  if (fstat(fds[kMemoryFd], &s) == -1)
+    return env->ThrowUVException(-errno, "fstat");
+  if (static_cast<size_t>(s.st_size) < sizeof(ChannelHeader))
+    return env->ThrowUVException(UV_EINVAL, "mmap");
+
+  void* mapping = mmap(nullptr, s.st_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fds[kMemoryFd], 0);
+  if (mapping == MAP_FAILED)
+    return env->ThrowUVException(-errno, "mmap");
+
+  // Do not trust the other process with the bounds of the mapping.
+  const ChannelHeader* header = static_cast<ChannelHeader*>(mapping);
+  const uint32_t capacity = header->capacity;
+  if (header->magic != kMagic ||
+      capacity < kMinCapacity ||
+      capacity > kMaxCapacity ||
+      (capacity & (capacity - 1)) != 0 ||
+      MappingLength(capacity) != static_cast<size_t>(s.st_size)) {
+    munmap(mapping, s.st_size);
+    return env->ThrowUVException(UV_EINVAL, "mmap");
+  }
+
+  new ShmChannelWrap(env, args.This(), mapping, s.st_size, fds, is_parent);
+#else
+  env->ThrowUVException(UV_ENOSYS, "mmap");
+#endif
+}
+
+
+bool ShmChannelWrap::TryWrite(const char* data, size_t length) {
+  RingHeader* ring = outgoing_.header;
+  const uint32_t record = RoundUp(sizeof(uint32_t) + length, 8);
+  uint32_t position = ring->write_position.load(std::memory_order_relaxed);
+  const uint32_t used = position - ring->read_position.load();
+  uint32_t offset = position & (capacity_ - 1);
+  const uint32_t contiguous = capacity_ - offset;
+  const uint32_t needed = record > contiguous ? contiguous + record : record;
+  if (capacity_ - used < needed)
+    return false;
+
+  if (record > contiguous) {
+    const uint32_t marker = kWrapMarker;
+    memcpy(outgoing_.data + offset, &marker, sizeof(marker));
+    position += contiguous;
+    offset = 0;
+  }
+
+  const uint32_t length32 = length;
+  memcpy(outgoing_.data + offset, &length32, sizeof(length32));
+  memcpy(outgoing_.data + offset + sizeof(length32), data, length);
+  ring->write_position.store(position + record);
+
+  if (ring->reader_sleeping.load() != 0 &&
+      ring->reader_sleeping.exchange(0) != 0) {
+    Wake();
+  }
+  return true;
+}
+
+
+bool ShmChannelWrap::Write(const char* data, size_t length) {
+  if (TryWrite(data, length))
+    return true;
+  // Ask the reader to wake us up once it has made room. It may have done so
+  // before it saw the flag, so check again.
+  outgoing_.header->writer_waiting.store(1);
+  return TryWrite(data, length);
+}
+
+
+void ShmChannelWrap::FlushPendingMessages() {
+  while (!pending_.empty()) {
+    std::pair<char*, size_t> message = pending_.front();
+    if (!Write(message.first, message.second))
+      return;
+    free(message.first);
+    pending_.pop_front();
+  }
+}
+
+
+void ShmChannelWrap::Wake() {
+#ifdef __linux__
+  uint64_t value = 1;
+  ssize_t r;
+  do {
+    r = write(peer_event_fd_, &value, sizeof(value));
+  } while (r == -1 && errno == EINTR);
+  // EAGAIN means the counter is saturated, i.e. the other process has a
+  // wakeup pending anyway.
+#endif
+}
+
+
+void ShmChannelWrap::Drain() {
+  Environment* env = this->env();
+  Isolate* isolate = env->isolate();
+  HandleScope handle_scope(isolate);
+  Context::Scope context_scope(env->context());
+
+  RingHeader* ring = incoming_.header;
+  for (;;) {
+    uint32_t position = ring->read_position.load(std::memory_order_relaxed);
+    const uint32_t end = ring->write_position.load();
+    while (position != end) {
+      // The other process may be buggy or hostile. Records are 8 byte
+      // aligned, so a length always fits into the rest of the ring.
+      if (end - position > capacity_ || position % 8 != 0)
+        return OnError(UVException(isolate, UV_EPROTO, "read"));
+      const uint32_t offset = position & (capacity_ - 1);
+      uint32_t length;
+      memcpy(&length, incoming_.data + offset, sizeof(length));
+      if (length == kWrapMarker) {
+        position += capacity_ - offset;
+        continue;
+      }
+      if (length > capacity_ - offset - sizeof(length))
+        return OnError(UVException(isolate, UV_EPROTO, "read"));
+
+      HandleScope message_scope(isolate);
+      Local<Value> payload;
+      Local<Value> exception;
+      bool ok;
+      {
+        TryCatch try_catch(isolate);
+        serdes::Deserializer deserializer(
+            env, incoming_.data + offset + sizeof(length), length);
+        ok = deserializer.ReadValue().ToLocal(&payload);
+        if (!ok) {
+          if (try_catch.HasTerminated())
+            return;
+          exception = try_catch.Exception();
+        }
+      }
+
+      // The message has been copied out of the ring, let the writer reuse
+      // its space before running JS, which may take a while.
+      position += RoundUp(sizeof(length) + length, 8);
+      ring->read_position.store(position);
+      // Wait until half of the ring is free before waking up the writer, so
+      // that it can write a batch of messages rather than a single one. Any
+      // message fits then.
+      if (ring->writer_waiting.load() != 0 &&
+          end - position <= capacity_ / 2 &&
+          ring->writer_waiting.exchange(0) != 0) {
+        Wake();
+      }
+
+      // Messages that do not deserialize were not written by postMessage().
+      if (!ok) {
+        if (exception.IsEmpty())
+          exception = UVException(isolate, UV_EPROTO, "read");
+        return OnError(exception);
+      }
+
+      MakeCallback(env->onmessage_string(), 1, &payload);
+
+      // The callback may have closed the channel.
+      if (!IsAlive(this) || isolate->IsExecutionTerminating())
+        return;
+    }
+
+    ring->read_position.store(position);
+    ring->reader_sleeping.store(1);
+    // Messages written before the writer saw the flag do not wake us up.
+    if (ring->write_position.load() == position)
+      return;
+    ring->reader_sleeping.store(0);
+  }
+}
+
+
+void ShmChannelWrap::OnError(Local<Value> error) {
+  uv_poll_stop(&handle_);
+  MakeCallback(env()->onerror_string(), 1, &error);
+}
+
+
+void ShmChannelWrap::OnPoll(uv_poll_t* handle, int status, int events) {
+  ShmChannelWrap* wrap = ContainerOf(&ShmChannelWrap::handle_, handle);
+  if (status < 0) {
+    Environment* env = wrap->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    return wrap->OnError(UVException(env->isolate(), status, "poll"));
+  }
+#ifdef __linux__
+  uint64_t value;
+  ssize_t r;
+  do {
+    r = read(wrap->own_event_fd_, &value, sizeof(value));
+  } while (r == -1 && errno == EINTR);
+#endif
+  if (!wrap->pending_.empty()) {
+    wrap->FlushPendingMessages();
+    if (wrap->pending_.empty()) {
+      Environment* env = wrap->env();
+      HandleScope handle_scope(env->isolate());
+      Context::Scope context_scope(env->context());
+      wrap->MakeCallback(env->ondrain_string(), 0, nullptr);
+      if (!IsAlive(wrap))
+        return;
+    }
+  }
+  wrap->Drain();
+}
+
+
+// postMessage(value) serializes |value| and writes it to the outgoing ring.
+// Returns false if the ring is full, the message is then queued and written
+// once the other process has read enough of the ring, and ondrain is called
+// when the queue is empty again.
+void ShmChannelWrap::PostMessage(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  ShmChannelWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+
+  if (!IsAlive(wrap))
+    return env->ThrowError("Shared memory channel is closed");
+
+  serdes::Serializer serializer(env);
+  if (!serializer.WriteValue(args[0]))
+    return;
+
+  size_t length;
+  char* data = serializer.Release(&length);
+  // A message can always be written once the ring is empty, no matter where
+  // the write position is, if it takes up at most half of it.
+  if (RoundUp(sizeof(uint32_t) + length, 8) > wrap->capacity_ / 2) {
+    free(data);
+    return env->ThrowRangeError(
+        "Message is too large for the shared memory channel");
+  }
+
+  if (wrap->pending_.empty() && wrap->Write(data, length)) {
+    free(data);
+    return args.GetReturnValue().Set(true);
+  }
+  wrap->pending_.emplace_back(data, length);
+  args.GetReturnValue().Set(false);
+}
+
+
+void ShmChannelWrap::GetPendingMessages(
+    const FunctionCallbackInfo<Value>& args) {
+  ShmChannelWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+  args.GetReturnValue().Set(static_cast<uint32_t>(wrap->pending_.size()));
+}
+
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(shm_channel_wrap,
+                                  node::ShmChannelWrap::Initialize)
@@ -0,0 +1,718 @@
+#include "simd.h"
+
+#include <string.h>
+
+// The kernels are compiled for their instruction set with target attributes,
+// so that the rest of node does not require it. Compilers that do not support
+// those for intrinsics get the scalar loops only.
+#if (defined(__x86_64__) || defined(__i386__)) &&                             \
+    (defined(__clang__) || __GNUC__ > 4 ||                                    \
+     (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define NODE_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace node {
+namespace simd {
+
+namespace {
+
+size_t AsciiPrefixWords(const char* src, size_t len) {
+  const uint64_t mask = 0x8080808080808080ull;
+  size_t i = 0;
+  while (i + sizeof(mask) <= len) {
+    uint64_t word;
+    memcpy(&word, src + i, sizeof(word));
+    if (word & mask)
+      break;
+    i += sizeof(word);
+  }
+  return i;
+}
+
+}  // anonymous namespace
+
+#ifdef NODE_SIMD_X86
+
+namespace {
+
+#define SSSE3 __attribute__((target("ssse3")))
+#define AVX2 __attribute__((target("avx2")))
+
+enum Level { kScalar, kSSSE3, kAVX2 };
+
+Level DetectLevel() {
+  __builtin_cpu_init();
+  // Also checks that the OS saves the AVX registers.
+  if (__builtin_cpu_supports("avx2"))
+    return kAVX2;
+  if (__builtin_cpu_supports("ssse3"))
+    return kSSSE3;
+  return kScalar;
+}
+
+inline Level CpuLevel() {
+  static const Level level = DetectLevel();
+  return level;
+}
+
+
+SSSE3 inline __m128i Load16(const char* p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+// Characters above 0xff saturate to 0x00 or 0xff, neither of which is valid
+// base64 or hex, so that the scalar loop decides what to do with them.
+SSSE3 inline __m128i Load16(const uint16_t* p) {
+  const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 8));
+  return _mm_packus_epi16(lo, hi);
+}
+
+AVX2 inline __m256i Load32(const char* p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+AVX2 inline __m256i Load32(const uint16_t* p) {
+  const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  const __m256i hi =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 16));
+  // packus works within 128-bit lanes, put the quarters back in order.
+  return _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xd8);
+}
+
+
+//// Base 64 ////
+
+// The encoder follows "Faster Base64 Encoding and Decoding Using AVX2
+// Instructions" by Wojciech Muła and Daniel Lemire.
+
+// Spreads three bytes over each 32-bit lane so that every byte of the lane
+// can be given one of the 6-bit indices.
+SSSE3 inline __m128i Base64Indices(__m128i in) {
+  in = _mm_shuffle_epi8(in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4,
+                                          7, 6, 8, 7, 10, 9, 11, 10));
+  const __m128i ac = _mm_mulhi_epu16(
+      _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)),
+      _mm_set1_epi32(0x04000040));
+  const __m128i bd = _mm_mullo_epi16(
+      _mm_and_si128(in, _mm_set1_epi32(0x003f03f0)),
+      _mm_set1_epi32(0x01000010));
+  return _mm_or_si128(ac, bd);
+}
+
+// Adds the offset of the range an index falls in to turn it into its
+// character.
+SSSE3 inline __m128i Base64Chars(__m128i indices) {
+  __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+  range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+  const __m128i offsets = _mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+      '/' - 63, 'A', 0, 0);
+  return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+}
+
+AVX2 inline __m256i Base64Indices(__m256i in) {
+  in = _mm256_shuffle_epi8(in, _mm256_setr_epi8(
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+  const __m256i ac = _mm256_mulhi_epu16(
+      _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)),
+      _mm256_set1_epi32(0x04000040));
+  const __m256i bd = _mm256_mullo_epi16(
+      _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)),
+      _mm256_set1_epi32(0x01000010));
+  return _mm256_or_si256(ac, bd);
+}
+
+AVX2 inline __m256i Base64Chars(__m256i indices) {
+  __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+  const __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+  range =
+      _mm256_or_si256(range, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+  const __m256i offsets = _mm256_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+      '/' - 63, 'A', 0, 0,
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+      '/' - 63, 'A', 0, 0);
+  return _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices);
+}
+
+// Reads 16 bytes to encode 12.
+SSSE3 size_t Base64EncodeSSSE3(const char* src, size_t slen, char* dst) {
+  size_t i = 0;
+  size_t k = 0;
+  while (i + 16 <= slen) {
+    const __m128i chars = Base64Chars(Base64Indices(Load16(src + i)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k), chars);
+    i += 12;
+    k += 16;
+  }
+  return i;
+}
+
+// Reads 28 bytes to encode 24, 12 in each lane.
+AVX2 size_t Base64EncodeAVX2(const char* src, size_t slen, char* dst) {
+  size_t i = 0;
+  size_t k = 0;
+  while (i + 28 <= slen) {
+    const __m256i in = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(Load16(src + i)), Load16(src + i + 12), 1);
+    const __m256i chars = Base64Chars(Base64Indices(in));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + k), chars);
+    i += 24;
+    k += 32;
+  }
+  return i;
+}
+
+// Sets |values| to the 6-bit values of the characters in |c|. Returns false
+// if any of them is not in the standard or the url-safe alphabet. Bytes
+// above 0x7f are negative and fall outside of all of the ranges.
+SSSE3 inline bool Base64Values(__m128i c, __m128i* values) {
+  const __m128i upper =
+      _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('A' - 1)),
+                    _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), c));
+  const __m128i lower =
+      _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('a' - 1)),
+                    _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), c));
+  const __m128i digit =
+      _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                    _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), c));
+  const __m128i plus = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('+')),
+                                    _mm_cmpeq_epi8(c, _mm_set1_epi8('-')));
+  const __m128i slash = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('/')),
+                                     _mm_cmpeq_epi8(c, _mm_set1_epi8('_')));
+  const __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower),
+                                     _mm_or_si128(_mm_or_si128(digit, plus),
+                                                  slash));
+  if (_mm_movemask_epi8(valid) != 0xffff)
+    return false;
+
+  __m128i v = _mm_and_si128(upper, _mm_sub_epi8(c, _mm_set1_epi8('A')));
+  v = _mm_or_si128(
+      v, _mm_and_si128(lower, _mm_sub_epi8(c, _mm_set1_epi8('a' - 26))));
+  v = _mm_or_si128(
+      v, _mm_and_si128(digit, _mm_add_epi8(c, _mm_set1_epi8(52 - '0'))));
+  v = _mm_or_si128(v, _mm_and_si128(plus, _mm_set1_epi8(62)));
+  v = _mm_or_si128(v, _mm_and_si128(slash, _mm_set1_epi8(63)));
+  *values = v;
+  return true;
+}
+
+// Joins the four 6-bit values in each 32-bit lane into three bytes, which
+// end up in the first 12 bytes.
+SSSE3 inline __m128i Base64Pack(__m128i values) {
+  const __m128i pairs =
+      _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+  const __m128i triples = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+  return _mm_shuffle_epi8(triples, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9,
+                                                 8, 14, 13, 12, -1, -1, -1,
+                                                 -1));
+}
+
+AVX2 inline bool Base64Values(__m256i c, __m256i* values) {
+  const __m256i upper =
+      _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('A' - 1)),
+                       _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), c));
+  const __m256i lower =
+      _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('a' - 1)),
+                       _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), c));
+  const __m256i digit =
+      _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)),
+                       _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+  const __m256i plus =
+      _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('+')),
+                      _mm256_cmpeq_epi8(c, _mm256_set1_epi8('-')));
+  const __m256i slash =
+      _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('/')),
+                      _mm256_cmpeq_epi8(c, _mm256_set1_epi8('_')));
+  const __m256i valid =
+      _mm256_or_si256(_mm256_or_si256(upper, lower),
+                      _mm256_or_si256(_mm256_or_si256(digit, plus), slash));
+  if (_mm256_movemask_epi8(valid) != -1)
+    return false;
+
+  __m256i v =
+      _mm256_and_si256(upper, _mm256_sub_epi8(c, _mm256_set1_epi8('A')));
+  v = _mm256_or_si256(v, _mm256_and_si256(
+      lower, _mm256_sub_epi8(c, _mm256_set1_epi8('a' - 26))));
+  v = _mm256_or_si256(v, _mm256_and_si256(
+      digit, _mm256_add_epi8(c, _mm256_set1_epi8(52 - '0'))));
+  v = _mm256_or_si256(v, _mm256_and_si256(plus, _mm256_set1_epi8(62)));
+  v = _mm256_or_si256(v, _mm256_and_si256(slash, _mm256_set1_epi8(63)));
+  *values = v;
+  return true;
+}
+
+// Like the SSSE3 version, but the 24 bytes are moved to the start of the
+// vector.
+AVX2 inline __m256i Base64Pack(__m256i values) {
+  const __m256i pairs =
+      _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+  const __m256i triples =
+      _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+  const __m256i lanes = _mm256_shuffle_epi8(triples, _mm256_setr_epi8(
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+  return _mm256_permutevar8x32_epi32(lanes,
+                                     _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+}
+
+// Only the decoded bytes are stored, |dst| may be a slice of a larger buffer
+// and the scalar loop might not get as far.
+template <typename T>
+SSSE3 size_t Base64DecodeSSSE3(char* dst, size_t dlen,
+                               const T* src, size_t slen) {
+  size_t i = 0;
+  size_t k = 0;
+  while (i + 16 <= slen && k + 12 <= dlen) {
+    __m128i values;
+    if (!Base64Values(Load16(src + i), &values))
+      break;
+    const __m128i bytes = Base64Pack(values);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + k), bytes);
+    const uint32_t tail = _mm_cvtsi128_si32(_mm_srli_si128(bytes, 8));
+    memcpy(dst + k + 8, &tail, sizeof(tail));
+    i += 16;
+    k += 12;
+  }
+  return k;
+}
+
+template <typename T>
+AVX2 size_t Base64DecodeAVX2(char* dst, size_t dlen,
+                             const T* src, size_t slen) {
+  size_t i = 0;
+  size_t k = 0;
+  while (i + 32 <= slen && k + 24 <= dlen) {
+    __m256i values;
+    if (!Base64Values(Load32(src + i), &values))
+      break;
+    const __m256i bytes = Base64Pack(values);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k),
+                     _mm256_castsi256_si128(bytes));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + k + 16),
+                     _mm256_extracti128_si256(bytes, 1));
+    i += 32;
+    k += 24;
+  }
+  return k;
+}
+
+template <typename T>
+size_t Base64DecodeImpl(char* dst, size_t dlen, const T* src, size_t slen) {
+  if (slen < 16)
+    return 0;
+  const Level level = CpuLevel();
+  size_t k = 0;
+  if (level >= kAVX2)
+    k = Base64DecodeAVX2(dst, dlen, src, slen);
+  if (level >= kSSSE3) {
+    const size_t i = k / 3 * 4;
+    k += Base64DecodeSSSE3(dst + k, dlen - k, src + i, slen - i);
+  }
+  return k;
+}
+
+
+//// Hex ////
+
+SSSE3 inline __m128i HexDigits(__m128i nibbles) {
+  const __m128i digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                       '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+  return _mm_shuffle_epi8(digits, nibbles);
+}
+
+SSSE3 size_t HexEncodeSSSE3(const char* src, size_t slen, char* dst) {
+  const __m128i mask = _mm_set1_epi8(0x0f);
+  size_t i = 0;
+  while (i + 16 <= slen) {
+    const __m128i in = Load16(src + i);
+    const __m128i hi = HexDigits(_mm_and_si128(_mm_srli_epi16(in, 4), mask));
+    const __m128i lo = HexDigits(_mm_and_si128(in, mask));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i),
+                     _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i + 16),
+                     _mm_unpackhi_epi8(hi, lo));
+    i += 16;
+  }
+  return i;
+}
+
+AVX2 inline __m256i HexDigits(__m256i nibbles) {
+  const __m256i digits = _mm256_setr_epi8(
+      '0', '1', '2', '3', '4', '5', '6', '7',
+      '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+      '0', '1', '2', '3', '4', '5', '6', '7',
+      '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+  return _mm256_shuffle_epi8(digits, nibbles);
+}
+
+AVX2 size_t HexEncodeAVX2(const char* src, size_t slen, char* dst) {
+  const __m256i mask = _mm256_set1_epi8(0x0f);
+  size_t i = 0;
+  while (i + 32 <= slen) {
+    const __m256i in = Load32(src + i);
+    const __m256i hi =
+        HexDigits(_mm256_and_si256(_mm256_srli_epi16(in, 4), mask));
+    const __m256i lo = HexDigits(_mm256_and_si256(in, mask));
+    // unpack works within 128-bit lanes too.
+    const __m256i a = _mm256_unpacklo_epi8(hi, lo);
+    const __m256i b = _mm256_unpackhi_epi8(hi, lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i),
+                        _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i + 32),
+                        _mm256_permute2x128_si256(a, b, 0x31));
+    i += 32;
+  }
+  return i;
+}
+
+// Sets |values| to the values of the hex digits in |c|, or returns false if
+// there is anything else in it.
+SSSE3 inline bool HexValues(__m128i c, __m128i* values) {
+  const __m128i digit =
+      _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                    _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), c));
+  const __m128i lc = _mm_or_si128(c, _mm_set1_epi8(0x20));
+  const __m128i letter =
+      _mm_and_si128(_mm_cmpgt_epi8(lc, _mm_set1_epi8('a' - 1)),
+                    _mm_cmpgt_epi8(_mm_set1_epi8('f' + 1), lc));
+  if (_mm_movemask_epi8(_mm_or_si128(digit, letter)) != 0xffff)
+    return false;
+  *values = _mm_or_si128(
+      _mm_and_si128(digit, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+      _mm_and_si128(letter, _mm_sub_epi8(lc, _mm_set1_epi8('a' - 10))));
+  return true;
+}
+
+AVX2 inline bool HexValues(__m256i c, __m256i* values) {
+  const __m256i digit =
+      _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)),
+                       _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+  const __m256i lc = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+  const __m256i letter =
+      _mm256_and_si256(_mm256_cmpgt_epi8(lc, _mm256_set1_epi8('a' - 1)),
+                       _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lc));
+  if (_mm256_movemask_epi8(_mm256_or_si256(digit, letter)) != -1)
+    return false;
+  *values = _mm256_or_si256(
+      _mm256_and_si256(digit, _mm256_sub_epi8(c, _mm256_set1_epi8('0'))),
+      _mm256_and_si256(letter,
+                       _mm256_sub_epi8(lc, _mm256_set1_epi8('a' - 10))));
+  return true;
+}
+
+// Reads 32 characters to write 16 bytes.
+template <typename T>
+SSSE3 size_t HexDecodeSSSE3(char* dst, size_t dlen,
+                            const T* src, size_t slen) {
+  const __m128i weights = _mm_set1_epi16(0x0110);
+  size_t k = 0;
+  while (2 * k + 32 <= slen && k + 16 <= dlen) {
+    __m128i a;
+    __m128i b;
+    if (!HexValues(Load16(src + 2 * k), &a) ||
+        !HexValues(Load16(src + 2 * k + 16), &b)) {
+      break;
+    }
+    const __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(a, weights),
+                                           _mm_maddubs_epi16(b, weights));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k), bytes);
+    k += 16;
+  }
+  return k;
+}
+
+template <typename T>
+AVX2 size_t HexDecodeAVX2(char* dst, size_t dlen,
+                          const T* src, size_t slen) {
+  const __m256i weights = _mm256_set1_epi16(0x0110);
+  size_t k = 0;
+  while (2 * k + 64 <= slen && k + 32 <= dlen) {
+    __m256i a;
+    __m256i b;
+    if (!HexValues(Load32(src + 2 * k), &a) ||
+        !HexValues(Load32(src + 2 * k + 32), &b)) {
+      break;
+    }
+    const __m256i bytes = _mm256_packus_epi16(
+        _mm256_maddubs_epi16(a, weights), _mm256_maddubs_epi16(b, weights));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + k),
+                        _mm256_permute4x64_epi64(bytes, 0xd8));
+    k += 32;
+  }
+  return k;
+}
+
+template <typename T>
+size_t HexDecodeImpl(char* dst, size_t dlen, const T* src, size_t slen) {
+  if (slen < 32)
+    return 0;
+  const Level level = CpuLevel();
+  size_t k = 0;
+  if (level >= kAVX2)
+    k = HexDecodeAVX2(dst, dlen, src, slen);
+  if (level >= kSSSE3)
+    k += HexDecodeSSSE3(dst + k, dlen - k, src + 2 * k, slen - 2 * k);
+  return k;
+}
+
+
+//// ASCII ////
+
+SSSE3 size_t AsciiPrefixSSSE3(const char* src, size_t len) {
+  size_t i = 0;
+  while (i + 16 <= len && _mm_movemask_epi8(Load16(src + i)) == 0)
+    i += 16;
+  return i;
+}
+
+AVX2 size_t AsciiPrefixAVX2(const char* src, size_t len) {
+  size_t i = 0;
+  while (i + 64 <= len) {
+    const __m256i bytes = _mm256_or_si256(Load32(src + i),
+                                          Load32(src + i + 32));
+    if (_mm256_movemask_epi8(bytes) != 0)
+      break;
+    i += 64;
+  }
+  while (i + 32 <= len && _mm256_movemask_epi8(Load32(src + i)) == 0)
+    i += 32;
+  return i;
+}
+
+SSSE3 size_t StripHighBitSSSE3(const char* src, char* dst, size_t len) {
+  const __m128i mask = _mm_set1_epi8(0x7f);
+  size_t i = 0;
+  while (i + 16 <= len) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_and_si128(Load16(src + i), mask));
+    i += 16;
+  }
+  return i;
+}
+
+AVX2 size_t StripHighBitAVX2(const char* src, char* dst, size_t len) {
+  const __m256i mask = _mm256_set1_epi8(0x7f);
+  size_t i = 0;
+  while (i + 32 <= len) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                        _mm256_and_si256(Load32(src + i), mask));
+    i += 32;
+  }
+  return i;
+}
+
+// Returns the first of the positions in |mask|, relative to |p|, at which
+// the needle matches, or -1. The first and last bytes already do.
+inline int FirstMatch(uint32_t mask,
+                      const char* p,
+                      const char* needle,
+                      size_t needle_length) {
+  while (mask != 0) {
+    const int bit = __builtin_ctz(mask);
+    // Not memcmp(), a call would make the loops around this keep their
+    // vectors on the stack.
+    size_t j = 1;
+    while (j < needle_length - 1 && p[bit + j] == needle[j])
+      j++;
+    if (j >= needle_length - 1)
+      return bit;
+    mask &= mask - 1;
+  }
+  return -1;
+}
+
+SSSE3 size_t FindSSSE3(const char* src,
+                       size_t len,
+                       const char* needle,
+                       size_t needle_length) {
+  const __m128i first = _mm_set1_epi8(needle[0]);
+  const __m128i last = _mm_set1_epi8(needle[needle_length - 1]);
+  size_t i = 0;
+  while (i + needle_length - 1 + 16 <= len) {
+    const __m128i candidates = _mm_and_si128(
+        _mm_cmpeq_epi8(Load16(src + i), first),
+        _mm_cmpeq_epi8(Load16(src + i + needle_length - 1), last));
+    const int bit = FirstMatch(_mm_movemask_epi8(candidates),
+                               src + i, needle, needle_length);
+    if (bit >= 0)
+      return i + bit;
+    i += 16;
+  }
+  return i;
+}
+
+AVX2 size_t FindAVX2(const char* src,
+                     size_t len,
+                     const char* needle,
+                     size_t needle_length) {
+  const __m256i first = _mm256_set1_epi8(needle[0]);
+  const __m256i last = _mm256_set1_epi8(needle[needle_length - 1]);
+  size_t i = 0;
+  // Two vectors at a time, most of them have no candidates at all.
+  while (i + needle_length - 1 + 64 <= len) {
+    const char* p = src + i;
+    const char* q = src + i + needle_length - 1;
+    const __m256i lo = _mm256_and_si256(_mm256_cmpeq_epi8(Load32(p), first),
+                                        _mm256_cmpeq_epi8(Load32(q), last));
+    const __m256i hi =
+        _mm256_and_si256(_mm256_cmpeq_epi8(Load32(p + 32), first),
+                         _mm256_cmpeq_epi8(Load32(q + 32), last));
+    if (!_mm256_testz_si256(_mm256_or_si256(lo, hi),
+                            _mm256_or_si256(lo, hi))) {
+      int bit = FirstMatch(_mm256_movemask_epi8(lo), p, needle, needle_length);
+      if (bit >= 0)
+        return i + bit;
+      bit = FirstMatch(_mm256_movemask_epi8(hi), p + 32, needle, needle_length);
+      if (bit >= 0)
+        return i + 32 + bit;
+    }
+    i += 64;
+  }
+  while (i + needle_length - 1 + 32 <= len) {
+    const __m256i candidates = _mm256_and_si256(
+        _mm256_cmpeq_epi8(Load32(src + i), first),
+        _mm256_cmpeq_epi8(Load32(src + i + needle_length - 1), last));
+    const int bit = FirstMatch(_mm256_movemask_epi8(candidates),
+                               src + i, needle, needle_length);
+    if (bit >= 0)
+      return i + bit;
+    i += 32;
+  }
+  return i + FindSSSE3(src + i, len - i, needle, needle_length);
+}
+
+#undef SSSE3
+#undef AVX2
+
+}  // anonymous namespace
+
+
+size_t Base64Encode(const char* src, size_t slen, char* dst) {
+  if (slen < 16)
+    return 0;
+  const Level level = CpuLevel();
+  size_t i = 0;
+  if (level >= kAVX2)
+    i = Base64EncodeAVX2(src, slen, dst);
+  if (level >= kSSSE3)
+    i += Base64EncodeSSSE3(src + i, slen - i, dst + i / 3 * 4);
+  return i;
+}
+
+size_t Base64Decode(char* dst, size_t dlen, const char* src, size_t slen) {
+  return Base64DecodeImpl(dst, dlen, src, slen);
+}
+
+size_t Base64Decode(char* dst, size_t dlen, const uint16_t* src, size_t slen) {
+  return Base64DecodeImpl(dst, dlen, src, slen);
+}
+
+size_t HexEncode(const char* src, size_t slen, char* dst) {
+  if (slen < 16)
+    return 0;
+  const Level level = CpuLevel();
+  size_t i = 0;
+  if (level >= kAVX2)
+    i = HexEncodeAVX2(src, slen, dst);
+  if (level >= kSSSE3)
+    i += HexEncodeSSSE3(src + i, slen - i, dst + 2 * i);
+  return i;
+}
+
+size_t HexDecode(char* dst, size_t dlen, const char* src, size_t slen) {
+  return HexDecodeImpl(dst, dlen, src, slen);
+}
+
+size_t HexDecode(char* dst, size_t dlen, const uint16_t* src, size_t slen) {
+  return HexDecodeImpl(dst, dlen, src, slen);
+}
+
+size_t AsciiPrefix(const char* src, size_t len) {
+  const Level level = len < 16 ? kScalar : CpuLevel();
+  size_t i = 0;
+  if (level >= kAVX2)
+    i = AsciiPrefixAVX2(src, len);
+  if (level >= kSSSE3)
+    i += AsciiPrefixSSSE3(src + i, len - i);
+  return i + AsciiPrefixWords(src + i, len - i);
+}
+
+size_t StripHighBit(const char* src, char* dst, size_t len) {
+  if (len < 16)
+    return 0;
+  const Level level = CpuLevel();
+  size_t i = 0;
+  if (level >= kAVX2)
+    i = StripHighBitAVX2(src, dst, len);
+  if (level >= kSSSE3)
+    i += StripHighBitSSSE3(src + i, dst + i, len - i);
+  return i;
+}
+
+size_t Find(const char* haystack,
+            size_t haystack_length,
+            const char* needle,
+            size_t needle_length) {
+  if (needle_length < 2 || haystack_length < needle_length - 1 + 16)
+    return 0;
+  const Level level = CpuLevel();
+  if (level >= kAVX2)
+    return FindAVX2(haystack, haystack_length, needle, needle_length);
+  if (level >= kSSSE3)
+    return FindSSSE3(haystack, haystack_length, needle, needle_length);
+  return 0;
+}
+
+#else  // !NODE_SIMD_X86
+
+size_t Base64Encode(const char* src, size_t slen, char* dst) {
+  return 0;
+}
+
+size_t Base64Decode(char* dst, size_t dlen, const char* src, size_t slen) {
+  return 0;
+}
+
+size_t Base64Decode(char* dst, size_t dlen, const uint16_t* src, size_t slen) {
+  return 0;
+}
+
+size_t HexEncode(const char* src, size_t slen, char* dst) {
+  return 0;
+}
+
+size_t HexDecode(char* dst, size_t dlen, const char* src, size_t slen) {
+  return 0;
+}
+
+size_t HexDecode(char* dst, size_t dlen, const uint16_t* src, size_t slen) {
+  return 0;
+}
+
+size_t AsciiPrefix(const char* src, size_t len) {
+  return AsciiPrefixWords(src, len);
+}
+
+size_t StripHighBit(const char* src, char* dst, size_t len) {
+  return 0;
+}
+
+size_t Find(const char* haystack,
+            size_t haystack_length,
+            const char* needle,
+            size_t needle_length) {
+  return 0;
+}
+
+#endif  // NODE_SIMD_X86
+
+}  // namespace simd
+}  // namespace node
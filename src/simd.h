@@ -0,0 +1,64 @@
+#ifndef SRC_SIMD_H_
+#define SRC_SIMD_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+namespace simd {
+
+// Vectorized kernels for the loops in base64.h and string_bytes.cc. The
+// instruction set is picked at runtime, AVX2 or SSSE3 on x86. A kernel only
+// handles the part of its input that fills whole vectors and returns how far
+// it got, the caller finishes the rest with its scalar loop. That loop does
+// all of the work on other CPUs, where the kernels return 0.
+
+// Encodes groups of three bytes of |src| as base64 into |dst|, which has
+// room for base64_encoded_size(slen) characters. Returns the number of bytes
+// that were encoded, a multiple of 3.
+size_t Base64Encode(const char* src, size_t slen, char* dst);
+
+// Decodes groups of four characters of |src|, of the standard or the
+// url-safe alphabet, into at most |dlen| bytes of |dst|. Stops in front of
+// anything else, such as padding or whitespace, which the scalar loop then
+// deals with. Returns the number of bytes written, a multiple of 3, for which
+// four characters were read for every three bytes.
+size_t Base64Decode(char* dst, size_t dlen, const char* src, size_t slen);
+size_t Base64Decode(char* dst, size_t dlen, const uint16_t* src, size_t slen);
+
+// Encodes bytes of |src| as two lowercase hex digits each into |dst|, which
+// has room for 2 * slen characters. Returns the number of bytes encoded.
+size_t HexEncode(const char* src, size_t slen, char* dst);
+
+// Decodes pairs of hex digits of |src| into at most |dlen| bytes of |dst|.
+// Stops in front of a block with any other character. Returns the number of
+// bytes written, for which two characters were read each.
+size_t HexDecode(char* dst, size_t dlen, const char* src, size_t slen);
+size_t HexDecode(char* dst, size_t dlen, const uint16_t* src, size_t slen);
+
+// Returns the length of a prefix of |src| that only contains ASCII. It ends
+// in front of the first block of bytes with one above 0x7f, there may be
+// more ASCII after it. Uses words of memory on other CPUs.
+size_t AsciiPrefix(const char* src, size_t len);
+
+// Copies bytes of |src| to |dst| with the high bit cleared. Returns the
+// number of bytes copied.
+size_t StripHighBit(const char* src, char* dst, size_t len);
+
+// Looks for |needle|, of at least two bytes, in |haystack|. Compares its
+// first and last byte with a vector of positions at once and the rest only
+// where both match. Returns the position of the first match, or one in front
+// of which there is none and from which the caller has to search on.
+size_t Find(const char* haystack,
+            size_t haystack_length,
+            const char* needle,
+            size_t needle_length);
+
+}  // namespace simd
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_SIMD_H_
@@ -145,12 +145,16 @@ WriteWrap* WriteWrap::New(Environment* env,
                           size_t extra) {
   size_t storage_size = ROUND_UP(sizeof(WriteWrap), kAlignSize) + extra;
   char* storage = new char[storage_size];
+  env->AdjustExternalMemory(Environment::kExternalMemoryStreams, storage_size);
 
   return new(storage) WriteWrap(env, obj, wrap, cb, storage_size);
 }
 
 
 void WriteWrap::Dispose() {
+  const int64_t change_in_bytes = -static_cast<int64_t>(storage_size_);
+  env()->AdjustExternalMemory(Environment::kExternalMemoryStreams,
+                              change_in_bytes);
   this->~WriteWrap();
   delete[] reinterpret_cast<char*>(this);
 }
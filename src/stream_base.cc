@@ -198,26 +198,48 @@ int StreamBase::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
   Local<Object> req_wrap_obj = args[0].As<Object>();
   const char* data = Buffer::Data(args[1]);
   size_t length = Buffer::Length(args[1]);
+  uv_handle_t* send_handle = nullptr;
+  Local<Object> send_handle_obj;
+  if (IsIPCPipe() && args[2]->IsObject()) {
+    HandleWrap* wrap;
+    send_handle_obj = args[2].As<Object>();
+    ASSIGN_OR_RETURN_UNWRAP(&wrap, send_handle_obj, UV_EINVAL);
+    send_handle = wrap->GetHandle();
+  }
 
   WriteWrap* req_wrap;
   uv_buf_t buf;
   buf.base = const_cast<char*>(data);
   buf.len = length;
 
-  // Try writing immediately without allocation
   uv_buf_t* bufs = &buf;
   size_t count = 1;
-  int err = DoTryWrite(&bufs, &count);
-  if (err != 0)
-    goto done;
-  if (count == 0)
-    goto done;
-  CHECK_EQ(count, 1);
+  int err;
+
+  // Try writing immediately without allocation, unless a handle has to be
+  // sent along with the data.
+  if (send_handle == nullptr) {
+    err = DoTryWrite(&bufs, &count);
+    if (err != 0)
+      goto done;
+    if (count == 0)
+      goto done;
+    CHECK_EQ(count, 1);
+  }
 
   // Allocate, or write rest
   req_wrap = WriteWrap::New(env, req_wrap_obj, this, AfterWrite);
 
-  err = DoWrite(req_wrap, bufs, count, nullptr);
+  if (send_handle != nullptr) {
+    // Reference StreamWrap instance to prevent it from being garbage
+    // collected before `AfterWrite` is called.
+    req_wrap_obj->Set(env->handle_string(), send_handle_obj);
+  }
+
+  err = DoWrite(req_wrap,
+                bufs,
+                count,
+                reinterpret_cast<uv_stream_t*>(send_handle));
   req_wrap_obj->Set(env->async(), True(env->isolate()));
   req_wrap_obj->Set(env->buffer_string(), args[1]);
 
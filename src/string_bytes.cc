@@ -170,8 +170,8 @@ size_t hex_decode(char* buf,
                   size_t len,
                   const TypeName* src,
                   const size_t srcLen) {
-  size_t i;
-  for (i = 0; i < len && i * 2 + 1 < srcLen; ++i) {
+  size_t i = simd::HexDecode(buf, len, src, srcLen);
+  for (; i < len && i * 2 + 1 < srcLen; ++i) {
     unsigned a = unhex(src[i * 2 + 0]);
     unsigned b = unhex(src[i * 2 + 1]);
     if (!~a || !~b)
@@ -257,6 +257,72 @@ size_t StringBytes::WriteUCS2(char* buf,
 }
 
 
+// base64 and hex strings are ASCII, which V8 keeps in one-byte strings.
+// Copying those as they are is cheaper than widening them with String::Value,
+// and lets the decoders work on chars.
+class OneByteValue : public MaybeStackBuffer<char> {
+ public:
+  explicit OneByteValue(Local<String> str) : MaybeStackBuffer(str->Length()) {
+    str->WriteOneByte(reinterpret_cast<uint8_t*>(out()),
+                      0,
+                      length(),
+                      String::NO_NULL_TERMINATION);
+  }
+};
+
+
+// Returns the number of ASCII characters at the start of |src|. Text that
+// is not mostly ASCII has short runs of it, look at a few bytes one by one
+// before starting on vectors.
+static size_t ascii_length(const char* src, size_t len) {
+  const size_t head = len < 8 ? len : 8;
+  size_t i = 0;
+  while (i < head) {
+    if (src[i] & 0x80)
+      return i;
+    i++;
+  }
+  i += simd::AsciiPrefix(src + i, len - i);
+  while (i < len && !(src[i] & 0x80))
+    i++;
+  return i;
+}
+
+
+// V8's WriteUtf8() encodes one character at a time. One-byte strings are
+// mostly ASCII, which is the same in UTF-8, so write them as Latin-1 and
+// check that instead. Anything else is left to WriteUtf8(), encoding Latin-1
+// here is not faster than that.
+static size_t write_one_byte_utf8(char* buf,
+                                  size_t buflen,
+                                  Local<String> str,
+                                  int flags,
+                                  int* chars_written) {
+  const size_t length = str->Length();
+  const size_t n = length < buflen ? length : buflen;
+  if (n == 0) {
+    if (chars_written != nullptr)
+      *chars_written = 0;
+    return 0;
+  }
+  // WriteUtf8() writes at least n - 1 bytes, keep the last one that it might
+  // not write to as it was.
+  const char last = buf[n - 1];
+  str->WriteOneByte(reinterpret_cast<uint8_t*>(buf), 0, n, flags);
+  if (ascii_length(buf, n) == n) {
+    if (chars_written != nullptr)
+      *chars_written = n;
+    return n;
+  }
+
+  const size_t nbytes =
+      str->WriteUtf8(buf, buflen, chars_written, flags);
+  if (nbytes < n)
+    buf[n - 1] = last;
+  return nbytes;
+}
+
+
 size_t StringBytes::Write(Isolate* isolate,
                           char* buf,
                           size_t buflen,
@@ -294,7 +360,10 @@ size_t StringBytes::Write(Isolate* isolate,
 
     case BUFFER:
     case UTF8:
-      nbytes = str->WriteUtf8(buf, buflen, chars_written, flags);
+      if (str->IsOneByte())
+        nbytes = write_one_byte_utf8(buf, buflen, str, flags, chars_written);
+      else
+        nbytes = str->WriteUtf8(buf, buflen, chars_written, flags);
       break;
 
     case UCS2: {
@@ -322,6 +391,9 @@ size_t StringBytes::Write(Isolate* isolate,
     case BASE64:
       if (is_extern) {
         nbytes = base64_decode(buf, buflen, data, external_nbytes);
+      } else if (str->IsOneByte()) {
+        OneByteValue value(str);
+        nbytes = base64_decode(buf, buflen, *value, value.length());
       } else {
         String::Value value(str);
         nbytes = base64_decode(buf, buflen, *value, value.length());
@@ -334,6 +406,9 @@ size_t StringBytes::Write(Isolate* isolate,
     case HEX:
       if (is_extern) {
         nbytes = hex_decode(buf, buflen, data, external_nbytes);
+      } else if (str->IsOneByte()) {
+        OneByteValue value(str);
+        nbytes = hex_decode(buf, buflen, *value, value.length());
       } else {
         String::Value value(str);
         nbytes = hex_decode(buf, buflen, *value, value.length());
@@ -476,44 +551,8 @@ static bool contains_non_ascii_slow(const char* buf, size_t len) {
 
 
 static bool contains_non_ascii(const char* src, size_t len) {
-  if (len < 16) {
-    return contains_non_ascii_slow(src, len);
-  }
-
-  const unsigned bytes_per_word = sizeof(uintptr_t);
-  const unsigned align_mask = bytes_per_word - 1;
-  const unsigned unaligned = reinterpret_cast<uintptr_t>(src) & align_mask;
-
-  if (unaligned > 0) {
-    const unsigned n = bytes_per_word - unaligned;
-    if (contains_non_ascii_slow(src, n))
-      return true;
-    src += n;
-    len -= n;
-  }
-
-
-#if defined(_WIN64) || defined(_LP64)
-  const uintptr_t mask = 0x8080808080808080ll;
-#else
-  const uintptr_t mask = 0x80808080l;
-#endif
-
-  const uintptr_t* srcw = reinterpret_cast<const uintptr_t*>(src);
-
-  for (size_t i = 0, n = len / bytes_per_word; i < n; ++i) {
-    if (srcw[i] & mask)
-      return true;
-  }
-
-  const unsigned remainder = len & align_mask;
-  if (remainder > 0) {
-    const size_t offset = len - remainder;
-    if (contains_non_ascii_slow(src + offset, remainder))
-      return true;
-  }
-
-  return false;
+  const size_t ascii = simd::AsciiPrefix(src, len);
+  return contains_non_ascii_slow(src + ascii, len - ascii);
 }
 
 
@@ -525,6 +564,11 @@ static void force_ascii_slow(const char* src, char* dst, size_t len) {
 
 
 static void force_ascii(const char* src, char* dst, size_t len) {
+  const size_t done = simd::StripHighBit(src, dst, len);
+  src += done;
+  dst += done;
+  len -= done;
+
   if (len < 16) {
     force_ascii_slow(src, dst, len);
     return;
@@ -569,13 +613,168 @@ static void force_ascii(const char* src, char* dst, size_t len) {
 }
 
 
+// Returns the length of the UTF-8 sequence that starts with a non-ASCII
+// byte at |src|, or 0 if it is malformed: cut short, overlong, a surrogate
+// or above U+10FFFF.
+static size_t utf8_sequence_length(const uint8_t* src, size_t len) {
+  const uint8_t c = src[0];
+  if (c < 0xc2 || c > 0xf4)
+    return 0;
+  if (c < 0xe0)
+    return len >= 2 && (src[1] & 0xc0) == 0x80 ? 2 : 0;
+  if (len < 3 || (src[2] & 0xc0) != 0x80)
+    return 0;
+  if (c < 0xf0) {
+    const uint8_t min = c == 0xe0 ? 0xa0 : 0x80;
+    const uint8_t max = c == 0xed ? 0x9f : 0xbf;
+    return src[1] >= min && src[1] <= max ? 3 : 0;
+  }
+  if (len < 4 || (src[3] & 0xc0) != 0x80)
+    return 0;
+  const uint8_t min = c == 0xf0 ? 0x90 : 0x80;
+  const uint8_t max = c == 0xf4 ? 0x8f : 0xbf;
+  return src[1] >= min && src[1] <= max ? 4 : 0;
+}
+
+
+// Counts the UTF-16 code units that |src| decodes to, and whether they all
+// are Latin-1. Returns false if |src| is not valid UTF-8.
+static bool measure_utf8(const char* src,
+                         size_t len,
+                         size_t* units,
+                         bool* one_byte) {
+  const uint8_t* const s = reinterpret_cast<const uint8_t*>(src);
+  size_t i = 0;
+  size_t n = 0;
+  bool latin1 = true;
+  while (i < len) {
+    if (s[i] < 0x80) {
+      const size_t ascii = ascii_length(src + i, len - i);
+      i += ascii;
+      n += ascii;
+      continue;
+    }
+    const size_t length = utf8_sequence_length(s + i, len - i);
+    if (length == 0)
+      return false;
+    latin1 = latin1 && s[i] <= 0xc3;
+    n += length == 4 ? 2 : 1;
+    i += length;
+  }
+  *units = n;
+  *one_byte = latin1;
+  return true;
+}
+
+
+// Decodes valid UTF-8 into UTF-16 code units, or Latin-1 if measure_utf8()
+// said that they all fit.
+template <typename TypeName>
+static void decode_utf8(const char* src, size_t len, TypeName* dst) {
+  const uint8_t* const s = reinterpret_cast<const uint8_t*>(src);
+  size_t i = 0;
+  size_t k = 0;
+  while (i < len) {
+    const uint32_t c = s[i];
+    if (c < 0x80) {
+      const size_t ascii = ascii_length(src + i, len - i);
+      for (size_t j = 0; j < ascii; j++)
+        dst[k + j] = s[i + j];
+      i += ascii;
+      k += ascii;
+    } else if (c < 0xe0) {
+      dst[k++] = static_cast<TypeName>((c & 0x1f) << 6 | (s[i + 1] & 0x3f));
+      i += 2;
+    } else if (c < 0xf0) {
+      dst[k++] = static_cast<TypeName>((c & 0x0f) << 12 |
+                                       (s[i + 1] & 0x3f) << 6 |
+                                       (s[i + 2] & 0x3f));
+      i += 3;
+    } else {
+      const uint32_t code_point = ((c & 0x07) << 18 |
+                                   (s[i + 1] & 0x3f) << 12 |
+                                   (s[i + 2] & 0x3f) << 6 |
+                                   (s[i + 3] & 0x3f)) - 0x10000;
+      dst[k++] = static_cast<TypeName>(0xd800 + (code_point >> 10));
+      dst[k++] = static_cast<TypeName>(0xdc00 + (code_point & 0x3ff));
+      i += 4;
+    }
+  }
+}
+
+
+static Local<String> new_string(Isolate* isolate,
+                                const char* data,
+                                size_t length) {
+  return OneByteString(isolate, data, length);
+}
+
+
+static Local<String> new_string(Isolate* isolate,
+                                const uint16_t* data,
+                                size_t length) {
+  return String::NewFromTwoByte(isolate,
+                                data,
+                                String::kNormalString,
+                                length);
+}
+
+
+template <typename ExternType, typename TypeName>
+static Local<String> new_utf8_string(Isolate* isolate,
+                                     const char* src,
+                                     size_t len,
+                                     size_t units) {
+  if (units < EXTERN_APEX) {
+    MaybeStackBuffer<TypeName> dst(units);
+    decode_utf8(src, len, *dst);
+    return new_string(isolate, *dst, units);
+  }
+
+  TypeName* dst = node::UncheckedMalloc<TypeName>(units);
+  if (dst == nullptr) {
+    return Local<String>();
+  }
+  decode_utf8(src, len, dst);
+  return ExternType::New(isolate, dst, units);
+}
+
+
+// V8's NewFromUtf8() decodes one character at a time and creates a two-byte
+// string for anything that is not ASCII. Copy ASCII as it is and decode
+// valid UTF-8 here, an ASCII run at a time and into a one-byte string where
+// it fits. Malformed input is left to V8, which knows how to replace it.
+static Local<String> decode_utf8_string(Isolate* isolate,
+                                        const char* buf,
+                                        size_t buflen) {
+  size_t units;
+  bool one_byte;
+  if (!measure_utf8(buf, buflen, &units, &one_byte))
+    return String::NewFromUtf8(isolate, buf, String::kNormalString, buflen);
+
+  // Every non-ASCII character takes up more bytes than code units.
+  if (units == buflen) {
+    if (buflen < EXTERN_APEX)
+      return OneByteString(isolate, buf, buflen);
+    return ExternOneByteString::NewFromCopy(isolate, buf, buflen);
+  }
+
+  if (one_byte)
+    return new_utf8_string<ExternOneByteString, char>(isolate, buf, buflen,
+                                                      units);
+  return new_utf8_string<ExternTwoByteString, uint16_t>(isolate, buf, buflen,
+                                                        units);
+}
+
+
 static size_t hex_encode(const char* src, size_t slen, char* dst, size_t dlen) {
   // We know how much we'll write, just make sure that there's space.
   CHECK(dlen >= slen * 2 &&
       "not enough space provided for hex encode");
 
   dlen = slen * 2;
-  for (uint32_t i = 0, k = 0; k < dlen; i += 1, k += 2) {
+  const size_t done = simd::HexEncode(src, slen, dst);
+  for (size_t i = done, k = 2 * done; k < dlen; i += 1, k += 2) {
     static const char hex[] = "0123456789abcdef";
     uint8_t val = static_cast<uint8_t>(src[i]);
     dst[k + 0] = hex[val >> 4];
@@ -629,10 +828,7 @@ Local<Value> StringBytes::Encode(Isolate* isolate,
       break;
 
     case UTF8:
-      val = String::NewFromUtf8(isolate,
-                                buf,
-                                String::kNormalString,
-                                buflen);
+      val = decode_utf8_string(isolate, buf, buflen);
       break;
 
     case LATIN1:
@@ -3,9 +3,9 @@
 namespace node {
 namespace stringsearch {
 
-int StringSearchBase::kBadCharShiftTable[kUC16AlphabetSize];
-int StringSearchBase::kGoodSuffixShiftTable[kBMMaxShift + 1];
-int StringSearchBase::kSuffixTable[kBMMaxShift + 1];
+thread_local int StringSearchBase::kBadCharShiftTable[kUC16AlphabetSize];
+thread_local int StringSearchBase::kGoodSuffixShiftTable[kBMMaxShift + 1];
+thread_local int StringSearchBase::kSuffixTable[kBMMaxShift + 1];
 
 }  // namespace stringsearch
 }  // namespace node
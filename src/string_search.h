@@ -8,6 +8,7 @@
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
 #include "node.h"
+#include "simd.h"
 #include <string.h>
 
 namespace node {
@@ -23,6 +24,10 @@ T Max(T a, T b) {
 
 static const uint32_t kMaxOneByteCharCodeU = 0xff;
 
+// One-byte patterns up to this length are searched for with simd::Find(),
+// longer ones skip ahead by more than a vector at a time.
+static const size_t kVectorMaxPatternLength = 32;
+
 template <typename T>
 class Vector {
  public:
@@ -84,26 +89,37 @@ class StringSearchBase {
   // to compensate for the algorithmic overhead compared to simple brute force.
   static const int kBMMinPatternLength = 8;
 
+  // The tables below are shared by all searches that do not bring their own
+  // tables. They are per thread, since worker threads search concurrently.
+
   // Store for the BoyerMoore(Horspool) bad char shift table.
-  static int kBadCharShiftTable[kUC16AlphabetSize];
+  static thread_local int kBadCharShiftTable[kUC16AlphabetSize];
   // Store for the BoyerMoore good suffix shift table.
-  static int kGoodSuffixShiftTable[kBMMaxShift + 1];
+  static thread_local int kGoodSuffixShiftTable[kBMMaxShift + 1];
   // Table used temporarily while building the BoyerMoore good suffix
   // shift table.
-  static int kSuffixTable[kBMMaxShift + 1];
+  static thread_local int kSuffixTable[kBMMaxShift + 1];
 };
 
 template <typename Char>
 class StringSearch : private StringSearchBase {
  public:
+  // Length of the tables for a Boyer-Moore search, in ints.
+  static const size_t kTablesLength = kUC16AlphabetSize + 2 * (kBMMaxShift + 1);
+
   explicit StringSearch(Vector<const Char> pattern)
-      : pattern_(pattern), start_(0) {
+      : pattern_(pattern), tables_(nullptr), start_(0) {
     if (pattern.length() >= kBMMaxShift) {
       start_ = pattern.length() - kBMMaxShift;
     }
 
     size_t pattern_length = pattern_.length();
     CHECK_GT(pattern_length, 0);
+    if (sizeof(Char) == 1 && pattern.forward() && pattern_length > 1 &&
+        pattern_length <= kVectorMaxPatternLength) {
+      strategy_ = &VectorSearch;
+      return;
+    }
     if (pattern_length < kBMMinPatternLength) {
       if (pattern_length == 1) {
         strategy_ = &SingleCharSearch;
@@ -115,10 +131,25 @@ class StringSearch : private StringSearchBase {
     strategy_ = &InitialSearch;
   }
 
+  // Keeps the tables for a Boyer-Moore search in |tables|, of kTablesLength
+  // ints, instead of sharing them with other searches. They are built once
+  // with PopulateTables() and then used by any number of searches for the
+  // same pattern.
+  StringSearch(Vector<const Char> pattern, int* tables)
+      : StringSearch(pattern) {
+    tables_ = tables;
+  }
+
   size_t Search(Vector<const Char> subject, size_t index) {
     return strategy_(this, subject, index);
   }
 
+  void PopulateTables() {
+    CHECK_NE(tables_, nullptr);
+    PopulateBoyerMooreHorspoolTable();
+    PopulateBoyerMooreTable();
+  }
+
   static inline int AlphabetSize() {
     if (sizeof(Char) == 1) {
       // Latin1 needle.
@@ -151,6 +182,10 @@ class StringSearch : private StringSearchBase {
                               Vector<const Char> subject,
                               size_t start_index);
 
+  static size_t VectorSearch(StringSearch<Char>* search,
+                             Vector<const Char> subject,
+                             size_t start_index);
+
   static size_t BoyerMooreHorspoolSearch(
       StringSearch<Char>* search,
       Vector<const Char> subject,
@@ -177,12 +212,16 @@ class StringSearch : private StringSearchBase {
   // Store for the BoyerMoore(Horspool) bad char shift table.
   // Return a table covering the last kBMMaxShift+1 positions of
   // pattern.
-  int* bad_char_table() { return kBadCharShiftTable; }
+  int* bad_char_table() {
+    return tables_ != nullptr ? tables_ : kBadCharShiftTable;
+  }
 
   // Store for the BoyerMoore good suffix shift table.
   int* good_suffix_shift_table() {
     // Return biased pointer that maps the range  [start_..pattern_.length()
     // to the kGoodSuffixShiftTable array.
+    if (tables_ != nullptr)
+      return tables_ + kUC16AlphabetSize - start_;
     return kGoodSuffixShiftTable - start_;
   }
 
@@ -191,6 +230,8 @@ class StringSearch : private StringSearchBase {
   int* suffix_table() {
     // Return biased pointer that maps the range  [start_..pattern_.length()
     // to the kSuffixTable array.
+    if (tables_ != nullptr)
+      return tables_ + kUC16AlphabetSize + kBMMaxShift + 1 - start_;
     return kSuffixTable - start_;
   }
 
@@ -198,6 +239,8 @@ class StringSearch : private StringSearchBase {
   Vector<const Char> pattern_;
   // Pointer to implementation of the search.
   SearchFunction strategy_;
+  // Tables of this search only, or nullptr for the shared ones.
+  int* tables_;
   // Cache value of Max(0, pattern_length() - kBMMaxShift)
   size_t start_;
 };
@@ -358,6 +401,69 @@ size_t StringSearch<Char>::LinearSearch(
   return subject.length();
 }
 
+//---------------------------------------------------------------------
+// Vectorized search for short one-byte patterns
+//---------------------------------------------------------------------
+
+// memchr() for the first character is hard to beat while that character is
+// rare in the subject. Where it finds too many candidates that do not match,
+// simd::Find() takes over for a stretch of the subject. The strategy that
+// would have been picked for the pattern otherwise does the rest of the work
+// on CPUs without the vector instructions.
+template <typename Char>
+size_t StringSearch<Char>::VectorSearch(
+    StringSearch<Char>* search,
+    Vector<const Char> subject,
+    size_t index) {
+  Vector<const Char> pattern = search->pattern_;
+  CHECK_EQ(sizeof(Char), 1);
+  ASSERT(subject.forward());
+  const char* const start = reinterpret_cast<const char*>(subject.start());
+  const size_t subject_length = subject.length();
+  const size_t pattern_length = pattern.length();
+  const size_t n = subject_length - pattern_length;
+  // A candidate costs about as much as this many bytes of simd::Find().
+  const int64_t kCandidateCost = 256;
+  const int64_t kInitialBadness = -4 * kCandidateCost;
+  // How much of the subject simd::Find() looks at before memchr() is given
+  // another chance.
+  const size_t kVectorStretch = 4096;
+  int64_t badness = kInitialBadness;
+  while (index <= n) {
+    if (badness > 0) {
+      size_t end = index + kVectorStretch + pattern_length - 1;
+      if (end > subject_length)
+        end = subject_length;
+      const size_t skipped = simd::Find(start + index,
+                                        end - index,
+                                        reinterpret_cast<const char*>(
+                                            pattern.start()),
+                                        pattern_length);
+      if (skipped == 0)
+        break;
+      // Continue with memchr(), which checks for a match at |index| first.
+      index += skipped;
+      badness = kInitialBadness;
+      continue;
+    }
+    const size_t candidate = FindFirstCharacter(pattern, subject, index);
+    if (candidate == subject_length)
+      return subject_length;
+    size_t j = 1;
+    while (j < pattern_length && pattern[j] == subject[candidate + j])
+      j++;
+    if (j == pattern_length)
+      return candidate;
+    badness += kCandidateCost - (candidate - index);
+    index = candidate + 1;
+  }
+  if (index > n)
+    return subject_length;
+  if (pattern_length < kBMMinPatternLength)
+    return LinearSearch(search, subject, index);
+  return InitialSearch(search, subject, index);
+}
+
 //---------------------------------------------------------------------
 // Boyer-Moore string search
 //---------------------------------------------------------------------
@@ -530,7 +636,9 @@ size_t StringSearch<Char>::BoyerMooreHorspoolSearch(
     // compared to reading each character exactly once.
     badness += (pattern_length - j) - last_char_shift;
     if (badness > 0) {
-      search->PopulateBoyerMooreTable();
+      // Tables of this search only have been populated up front.
+      if (search->tables_ == nullptr)
+        search->PopulateBoyerMooreTable();
       search->strategy_ = &BoyerMooreSearch;
       return BoyerMooreSearch(search, subject, index);
     }
@@ -604,7 +712,8 @@ size_t StringSearch<Char>::InitialSearch(
       }
       badness += j;
     } else {
-      search->PopulateBoyerMooreHorspoolTable();
+      if (search->tables_ == nullptr)
+        search->PopulateBoyerMooreHorspoolTable();
       search->strategy_ = &BoyerMooreHorspoolSearch;
       return BoyerMooreHorspoolSearch(search, subject, i);
     }
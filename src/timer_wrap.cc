@@ -7,20 +7,35 @@
 #include "util-inl.h"
 
 #include <stdint.h>
+#include <string.h>
+#include <vector>
 
 namespace node {
 
+using v8::ArrayBuffer;
 using v8::Context;
+using v8::Float64Array;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
 using v8::Object;
+using v8::Uint32Array;
 using v8::Value;
 
 const uint32_t kOnTimeout = 0;
 
+static void ReturnNow(const FunctionCallbackInfo<Value>& args, uint64_t now) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(now >= env->timer_base());
+  now -= env->timer_base();
+  if (now <= 0xfffffff)
+    args.GetReturnValue().Set(static_cast<uint32_t>(now));
+  else
+    args.GetReturnValue().Set(static_cast<double>(now));
+}
+
 class TimerWrap : public HandleWrap {
  public:
   static void Initialize(Local<Object> target,
@@ -98,19 +113,443 @@ class TimerWrap : public HandleWrap {
   static void Now(const FunctionCallbackInfo<Value>& args) {
     Environment* env = Environment::GetCurrent(args);
     uv_update_time(env->event_loop());
-    uint64_t now = uv_now(env->event_loop());
-    CHECK(now >= env->timer_base());
-    now -= env->timer_base();
-    if (now <= 0xfffffff)
-      args.GetReturnValue().Set(static_cast<uint32_t>(now));
+    ReturnNow(args, uv_now(env->event_loop()));
+  }
+
+  uv_timer_t handle_;
+};
+
+
+// A hierarchical timing wheel for timers that are re-armed far more often
+// than they expire, like the idle timeouts of sockets. Entries are numbered
+// by JS and kept in doubly linked lists, one per slot of the wheel, so that
+// arming and cancelling them is constant-time. The first level has a slot for
+// each of the next 256 milliseconds, each further level has 64 slots that are
+// 64 times as wide and that are spread over the level below as time reaches
+// them, in the manner of the classic BSD and Linux kernel timer wheels.
+//
+// A single libuv timer runs the wheel. Everything that has expired by the
+// time it fires is passed to JS in one Uint32Array of entry numbers.
+class TimerWheel : public HandleWrap {
+ public:
+  static void Initialize(Environment* env, Local<Object> target) {
+    Local<FunctionTemplate> constructor = env->NewFunctionTemplate(New);
+    constructor->InstanceTemplate()->SetInternalFieldCount(1);
+    constructor->SetClassName(
+        FIXED_ONE_BYTE_STRING(env->isolate(), "TimerWheel"));
+
+    env->SetProtoMethod(constructor, "close", HandleWrap::Close);
+    env->SetProtoMethod(constructor, "ref", HandleWrap::Ref);
+    env->SetProtoMethod(constructor, "unref", HandleWrap::Unref);
+    env->SetProtoMethod(constructor, "hasRef", HandleWrap::HasRef);
+
+    env->SetProtoMethod(constructor, "arm", Arm);
+    env->SetProtoMethod(constructor, "cancel", Cancel);
+
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "TimerWheel"),
+                constructor->GetFunction());
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  static const int kLevels = 5;
+  static const int kFirstBits = 8;
+  static const int kBits = 6;
+  static const uint32_t kFirstMask = (1 << kFirstBits) - 1;
+  static const uint32_t kMask = (1 << kBits) - 1;
+  static const int kSlots = (1 << kFirstBits) + (kLevels - 1) * (1 << kBits);
+  static const uint32_t kNone = static_cast<uint32_t>(-1);
+
+  struct Entry {
+    uint64_t expiry;
+    uint32_t prev;
+    uint32_t next;
+    uint32_t slot;  // kNone while the entry is not in the wheel.
+  };
+
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.IsConstructCall());
+    Environment* env = Environment::GetCurrent(args);
+    new TimerWheel(env, args.This());
+  }
+
+  TimerWheel(Environment* env, Local<Object> object)
+      : HandleWrap(env,
+                   object,
+                   reinterpret_cast<uv_handle_t*>(&handle_),
+                   AsyncWrap::PROVIDER_TIMERWRAP),
+        current_(uv_now(env->event_loop())),
+        due_(0),
+        count_(0) {
+    int r = uv_timer_init(env->event_loop(), &handle_);
+    CHECK_EQ(r, 0);
+    for (int i = 0; i < kSlots; i++)
+      slots_[i] = kNone;
+    for (int i = 0; i < kLevels; i++)
+      level_count_[i] = 0;
+  }
+
+  // Bits of the time that the levels below |level| cover.
+  static inline int Shift(int level) {
+    return level == 0 ? 0 : kFirstBits + (level - 1) * kBits;
+  }
+
+  // arm(id, msecs) (re)starts entry |id| to expire |msecs| from now. Returns
+  // the current time like Timer.now() does.
+  static void Arm(const FunctionCallbackInfo<Value>& args) {
+    TimerWheel* wheel = Unwrap<TimerWheel>(args.Holder());
+    CHECK(HandleWrap::IsAlive(wheel));
+    CHECK(args[0]->IsUint32());
+    const uint32_t id = args[0]->Uint32Value();
+    const int64_t msecs = args[1]->IntegerValue();
+    CHECK_GE(msecs, 0);
+
+    uv_loop_t* loop = wheel->env()->event_loop();
+    uv_update_time(loop);
+    const uint64_t now = uv_now(loop);
+
+    if (id >= wheel->entries_.size()) {
+      Entry empty = { 0, kNone, kNone, kNone };
+      wheel->entries_.resize(id + 1, empty);
+    }
+    wheel->Unlink(id);
+    // Nothing is left for the libuv timer to catch the wheel up on.
+    if (wheel->count_ == 0 && now > wheel->current_)
+      wheel->current_ = now;
+    const uint64_t expiry = now + msecs;
+    wheel->Link(id, expiry);
+    if (wheel->due_ == 0 || expiry < wheel->due_)
+      wheel->Schedule(expiry, now);
+
+    ReturnNow(args, now);
+  }
+
+  // cancel(id) takes entry |id| out of the wheel if it is in it.
+  static void Cancel(const FunctionCallbackInfo<Value>& args) {
+    TimerWheel* wheel = Unwrap<TimerWheel>(args.Holder());
+    CHECK(HandleWrap::IsAlive(wheel));
+    CHECK(args[0]->IsUint32());
+    const uint32_t id = args[0]->Uint32Value();
+    if (id < wheel->entries_.size())
+      wheel->Unlink(id);
+    // The libuv timer is left running, it stops once the wheel is empty.
+  }
+
+  void Link(uint32_t id, uint64_t expiry) {
+    Entry* entry = &entries_[id];
+    entry->expiry = expiry;
+    // Anything overdue goes to the slot that is processed next.
+    const uint64_t at = expiry < current_ ? current_ : expiry;
+    const uint64_t delta = at - current_;
+    int level = 0;
+    while (level < kLevels - 1 && delta >> Shift(level + 1) != 0)
+      level++;
+    uint32_t slot;
+    if (level == 0) {
+      slot = at & kFirstMask;
+    } else {
+      uint64_t capped = at;
+      if (delta >> (Shift(level) + kBits) != 0)
+        capped = current_ + (uint64_t(1) << (Shift(level) + kBits)) - 1;
+      slot = (1 << kFirstBits) + (level - 1) * (1 << kBits) +
+             ((capped >> Shift(level)) & kMask);
+    }
+    entry->slot = slot;
+    entry->prev = kNone;
+    entry->next = slots_[slot];
+    if (entry->next != kNone)
+      entries_[entry->next].prev = id;
+    slots_[slot] = id;
+    level_count_[level]++;
+    count_++;
+  }
+
+  void Unlink(uint32_t id) {
+    Entry* entry = &entries_[id];
+    if (entry->slot == kNone)
+      return;
+    if (entry->prev != kNone)
+      entries_[entry->prev].next = entry->next;
     else
-      args.GetReturnValue().Set(static_cast<double>(now));
+      slots_[entry->slot] = entry->next;
+    if (entry->next != kNone)
+      entries_[entry->next].prev = entry->prev;
+    level_count_[LevelOf(entry->slot)]--;
+    count_--;
+    entry->slot = kNone;
+  }
+
+  static inline int LevelOf(uint32_t slot) {
+    if (slot < (1 << kFirstBits))
+      return 0;
+    return 1 + ((slot - (1 << kFirstBits)) >> kBits);
+  }
+
+  // Entries are linked in front of a slot, this reverses them back into the
+  // order they were armed in.
+  uint32_t TakeSlot(uint32_t slot) {
+    uint32_t id = slots_[slot];
+    uint32_t list = kNone;
+    while (id != kNone) {
+      const uint32_t next = entries_[id].next;
+      level_count_[LevelOf(slot)]--;
+      count_--;
+      entries_[id].slot = kNone;
+      entries_[id].next = list;
+      list = id;
+      id = next;
+    }
+    slots_[slot] = kNone;
+    return list;
+  }
+
+  // Spreads the slot of |level| that current_ has reached over the levels
+  // below, after doing the same for the level above if its slot is due too.
+  void Cascade(int level) {
+    const uint32_t index = (current_ >> Shift(level)) & kMask;
+    uint32_t id =
+        TakeSlot((1 << kFirstBits) + (level - 1) * (1 << kBits) + index);
+    while (id != kNone) {
+      const uint32_t next = entries_[id].next;
+      Link(id, entries_[id].expiry);
+      id = next;
+    }
+    if (index == 0 && level + 1 < kLevels)
+      Cascade(level + 1);
+  }
+
+  // Moves current_ past |now|, adding the entries that expire on the way to
+  // |expired|.
+  void Advance(uint64_t now, std::vector<uint32_t>* expired) {
+    while (current_ <= now) {
+      const uint32_t index = current_ & kFirstMask;
+      if (index == 0)
+        Cascade(1);
+      for (uint32_t id = TakeSlot(index); id != kNone; id = entries_[id].next)
+        expired->push_back(id);
+
+      // Skip ahead over the times for which the lower levels are empty.
+      uint64_t next = current_ + 1;
+      for (int level = 0;
+           level < kLevels - 1 && level_count_[level] == 0;
+           level++) {
+        next = (current_ | ((uint64_t(1) << Shift(level + 1)) - 1)) + 1;
+      }
+      current_ = next > now + 1 ? now + 1 : next;
+    }
+  }
+
+  // Returns the earliest time at which the wheel has work, which for the
+  // upper levels is when their next occupied slot is spread out.
+  uint64_t NextDue() const {
+    uint64_t due = 0;
+    bool found = false;
+    for (uint64_t t = current_; t < current_ + (1 << kFirstBits); t++) {
+      if (slots_[t & kFirstMask] != kNone) {
+        due = t;
+        found = true;
+        break;
+      }
+    }
+    for (int level = 1; level < kLevels; level++) {
+      if (level_count_[level] == 0)
+        continue;
+      const uint64_t base = current_ >> Shift(level);
+      // The current slot is only due if current_ is where it starts.
+      const uint64_t first = (base << Shift(level)) == current_ ? 0 : 1;
+      for (uint64_t i = first; i < first + (1 << kBits); i++) {
+        const uint32_t slot = (1 << kFirstBits) + (level - 1) * (1 << kBits) +
+                              ((base + i) & kMask);
+        if (slots_[slot] != kNone) {
+          const uint64_t t = (base + i) << Shift(level);
+          if (!found || t < due) {
+            due = t;
+            found = true;
+          }
+          break;
+        }
+      }
+    }
+    CHECK(found);
+    return due;
+  }
+
+  void Schedule(uint64_t due, uint64_t now) {
+    due_ = due;
+    int err = uv_timer_start(&handle_, OnTimeout, due > now ? due - now : 0, 0);
+    CHECK_EQ(err, 0);
+  }
+
+  static void OnTimeout(uv_timer_t* handle) {
+    TimerWheel* wheel = ContainerOf(&TimerWheel::handle_, handle);
+    Environment* env = wheel->env();
+    const uint64_t now = uv_now(env->event_loop());
+
+    std::vector<uint32_t> expired;
+    wheel->Advance(now, &expired);
+    wheel->due_ = 0;
+    if (wheel->count_ > 0)
+      wheel->Schedule(wheel->NextDue(), now);
+    if (expired.empty())
+      return;
+
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    const size_t size = expired.size() * sizeof(expired[0]);
+    Local<ArrayBuffer> ab = ArrayBuffer::New(env->isolate(), size);
+    memcpy(ab->GetContents().Data(), expired.data(), size);
+    Local<Value> argv[] = { Uint32Array::New(ab, 0, expired.size()) };
+    wheel->MakeCallback(kOnTimeout, arraysize(argv), argv);
+  }
+
+  uv_timer_t handle_;
+  std::vector<Entry> entries_;
+  uint32_t slots_[kSlots];
+  uint32_t level_count_[kLevels];
+  uint64_t current_;  // The next millisecond that has not been processed.
+  uint64_t due_;      // When the libuv timer fires, 0 if it is stopped.
+  uint32_t count_;
+};
+
+
+// Measures how late the event loop gets around to a repeating timer, which
+// is how long callbacks keep it from returning to I/O. The delays are
+// recorded in nanoseconds into a Float64Array that is shared with JS: a few
+// summary fields followed by the counts of a log-linear histogram in the
+// manner of HdrHistogram, with 64 buckets for each power of two, which keeps
+// the error of its percentiles below 1.6%.
+class LoopDelayMonitor : public HandleWrap {
+ public:
+  static void Initialize(Environment* env, Local<Object> target) {
+    Local<FunctionTemplate> constructor = env->NewFunctionTemplate(New);
+    constructor->InstanceTemplate()->SetInternalFieldCount(1);
+    constructor->SetClassName(
+        FIXED_ONE_BYTE_STRING(env->isolate(), "LoopDelayMonitor"));
+    constructor->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kFields"),
+                     Integer::New(env->isolate(), kFields));
+    constructor->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kBuckets"),
+                     Integer::New(env->isolate(), kBuckets));
+
+    env->SetProtoMethod(constructor, "close", HandleWrap::Close);
+    env->SetProtoMethod(constructor, "ref", HandleWrap::Ref);
+    env->SetProtoMethod(constructor, "unref", HandleWrap::Unref);
+    env->SetProtoMethod(constructor, "hasRef", HandleWrap::HasRef);
+
+    env->SetProtoMethod(constructor, "start", Start);
+    env->SetProtoMethod(constructor, "stop", Stop);
+
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "LoopDelayMonitor"),
+                constructor->GetFunction());
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  // Keep in sync with lib/internal/process.js.
+  enum Fields { kCount, kMin, kMax, kMean, kSquares, kFields };
+  static const int kSubBits = 6;
+  static const int kBuckets = 59 << kSubBits;
+
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.IsConstructCall());
+    CHECK(args[0]->IsFloat64Array());
+    Local<Float64Array> array = args[0].As<Float64Array>();
+    CHECK_EQ(array->Length(), kFields + kBuckets);
+    Environment* env = Environment::GetCurrent(args);
+    new LoopDelayMonitor(env, args.This(), array);
+  }
+
+  LoopDelayMonitor(Environment* env,
+                   Local<Object> object,
+                   Local<Float64Array> array)
+      : HandleWrap(env,
+                   object,
+                   reinterpret_cast<uv_handle_t*>(&handle_),
+                   AsyncWrap::PROVIDER_TIMERWRAP),
+        array_(env->isolate(), array),
+        resolution_(0),
+        prev_(0) {
+    fields_ = reinterpret_cast<double*>(
+        static_cast<char*>(array->Buffer()->GetContents().Data()) +
+        array->ByteOffset());
+    int r = uv_timer_init(env->event_loop(), &handle_);
+    CHECK_EQ(r, 0);
+  }
+
+  ~LoopDelayMonitor() override {
+    array_.Reset();
+  }
+
+  static void Start(const FunctionCallbackInfo<Value>& args) {
+    LoopDelayMonitor* monitor = Unwrap<LoopDelayMonitor>(args.Holder());
+    CHECK(HandleWrap::IsAlive(monitor));
+    int64_t resolution = args[0]->IntegerValue();
+    CHECK_GT(resolution, 0);
+    monitor->resolution_ = resolution * 1000 * 1000;
+    monitor->prev_ = uv_hrtime();
+    int err = uv_timer_start(&monitor->handle_, OnTimeout,
+                             resolution, resolution);
+    args.GetReturnValue().Set(err);
+  }
+
+  static void Stop(const FunctionCallbackInfo<Value>& args) {
+    LoopDelayMonitor* monitor = Unwrap<LoopDelayMonitor>(args.Holder());
+    CHECK(HandleWrap::IsAlive(monitor));
+    int err = uv_timer_stop(&monitor->handle_);
+    args.GetReturnValue().Set(err);
+  }
+
+  static int Bucket(uint64_t value) {
+    int shift = 0;
+    while ((value >> shift) >= (2u << kSubBits))
+      shift++;
+    return (shift << kSubBits) + static_cast<int>(value >> shift);
+  }
+
+  // The timer is due `resolution_` after it last ran, anything beyond that
+  // is delay. It can run slightly early as libuv only keeps milliseconds.
+  static void OnTimeout(uv_timer_t* handle) {
+    LoopDelayMonitor* monitor =
+        ContainerOf(&LoopDelayMonitor::handle_, handle);
+    const uint64_t now = uv_hrtime();
+    const uint64_t elapsed = now - monitor->prev_;
+    const uint64_t delay =
+        elapsed > monitor->resolution_ ? elapsed - monitor->resolution_ : 0;
+    monitor->prev_ = now;
+
+    double* fields = monitor->fields_;
+    const double value = static_cast<double>(delay);
+    const double count = ++fields[kCount];
+    if (count == 1 || value < fields[kMin])
+      fields[kMin] = value;
+    if (value > fields[kMax])
+      fields[kMax] = value;
+    // Welford's method, as the plain sum of squares of nanoseconds loses
+    // precision quickly.
+    const double diff = value - fields[kMean];
+    fields[kMean] += diff / count;
+    fields[kSquares] += diff * (value - fields[kMean]);
+    fields[kFields + Bucket(delay)]++;
   }
 
   uv_timer_t handle_;
+  v8::Persistent<Float64Array> array_;
+  double* fields_;
+  uint64_t resolution_;  // In nanoseconds.
+  uint64_t prev_;
 };
 
 
+static void Initialize(Local<Object> target,
+                       Local<Value> unused,
+                       Local<Context> context) {
+  TimerWrap::Initialize(target, unused, context);
+  TimerWheel::Initialize(Environment::GetCurrent(context), target);
+  LoopDelayMonitor::Initialize(Environment::GetCurrent(context), target);
+}
+
+
 }  // namespace node
 
-NODE_MODULE_CONTEXT_AWARE_BUILTIN(timer_wrap, node::TimerWrap::Initialize)
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(timer_wrap, node::Initialize)
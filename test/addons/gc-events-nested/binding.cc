@@ -0,0 +1,38 @@
+#include <node.h>
+#include <v8.h>
+
+#include <assert.h>
+
+// Second pass weak callbacks are processed as a weak-callbacks collection.
+// A forced mark-sweep runs them before it ends, so the two are nested.
+
+static v8::Persistent<v8::Object> weak;
+static int second_pass_calls;
+
+static void SecondPass(const v8::WeakCallbackInfo<void>& data) {
+  second_pass_calls++;
+}
+
+static void FirstPass(const v8::WeakCallbackInfo<void>& data) {
+  weak.Reset();
+  data.SetSecondPassCallback(SecondPass);
+}
+
+void MakeWeak(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  assert(weak.IsEmpty());
+  v8::HandleScope scope(isolate);
+  weak.Reset(isolate, v8::Object::New(isolate));
+  weak.SetWeak<void>(nullptr, FirstPass, v8::WeakCallbackType::kParameter);
+}
+
+void SecondPassCalls(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  args.GetReturnValue().Set(second_pass_calls);
+}
+
+void init(v8::Local<v8::Object> exports) {
+  NODE_SET_METHOD(exports, "makeWeak", MakeWeak);
+  NODE_SET_METHOD(exports, "secondPassCalls", SecondPassCalls);
+}
+
+NODE_MODULE(binding, init)
@@ -0,0 +1,26 @@
+'use strict';
+// Flags: --expose-gc
+
+const common = require('../../common');
+const assert = require('assert');
+const v8 = require('v8');
+const binding = require(`./build/${common.buildType}/binding`);
+
+v8.startGCTracking();
+binding.makeWeak();
+global.gc();
+assert.strictEqual(binding.secondPassCalls(), 1);
+const events = v8.takeGCEvents();
+v8.stopGCTracking();
+
+// The weak callbacks end first and are recorded before the mark-sweep that
+// they ran in, which keeps its own start time and used size.
+assert.strictEqual(events.length, 2);
+const inner = events[0];
+const outer = events[1];
+assert.strictEqual(inner.type, 'weak-callbacks');
+assert.strictEqual(outer.type, 'mark-sweep-compact');
+assert.strictEqual(outer.forced, true);
+assert(outer.startTime < inner.startTime);
+assert(outer.startTime + outer.duration >= inner.startTime + inner.duration);
+assert(outer.usedHeapSizeAfter < outer.usedHeapSizeBefore);
@@ -0,0 +1,19 @@
+#include <node.h>
+#include <v8.h>
+
+namespace {
+
+void Method(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  args.GetReturnValue().Set(v8::String::NewFromUtf8(isolate, "world"));
+}
+
+inline void Initialize(v8::Local<v8::Object> exports,
+                       v8::Local<v8::Value> module,
+                       v8::Local<v8::Context> context) {
+  NODE_SET_METHOD(exports, "hello", Method);
+}
+
+}  // anonymous namespace
+
+NODE_MODULE_CONTEXT_AWARE(binding, Initialize)
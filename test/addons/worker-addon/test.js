@@ -0,0 +1,39 @@
+'use strict';
+const common = require('../../common');
+const assert = require('assert');
+const path = require('path');
+const worker = require('worker_threads');
+
+const contextAware = path.join(__dirname, 'build', common.buildType,
+                               'binding');
+// hello-world registers itself with NODE_MODULE().
+const contextUnaware = path.join(__dirname, '..', 'hello-world', 'build',
+                                 common.buildType, 'binding');
+
+// Context-aware addons can be loaded in workers, other addons cannot.
+if (worker.isMainThread) {
+  const w = new worker.Worker(__filename);
+  w.on('message', common.mustCall((message) => {
+    assert.deepStrictEqual(message, {
+      hello: 'world',
+      error: 'Module did not self-register as context-aware and cannot be ' +
+             'loaded in a worker thread.'
+    });
+  }));
+  w.on('exit', common.mustCall((code) => {
+    assert.strictEqual(code, 0);
+    assert.strictEqual(require(contextAware).hello(), 'world');
+    assert.strictEqual(require(contextUnaware).hello(), 'world');
+  }));
+} else {
+  let error;
+  try {
+    require(contextUnaware);
+  } catch (err) {
+    error = err.message;
+  }
+  worker.parentPort.postMessage({
+    hello: require(contextAware).hello(),
+    error
+  });
+}
@@ -16,6 +16,7 @@ const tls = require('tls');
 const zlib = require('zlib');
 const ChildProcess = require('child_process').ChildProcess;
 const StreamWrap = require('_stream_wrap').StreamWrap;
+const Worker = require('worker_threads').Worker;
 const HTTPParser = process.binding('http_parser').HTTPParser;
 const async_wrap = process.binding('async_wrap');
 const pkeys = Object.keys(async_wrap.Providers);
@@ -115,6 +116,15 @@ new ChildProcess();
 
 new HTTPParser(HTTPParser.REQUEST);
 
+new Worker('', { eval: true });
+
+if (common.isLinux) {
+  const ShmChannel = process.binding('shm_channel_wrap');
+  new ShmChannel.ShmChannel(ShmChannel.createFds(0), true).close();
+} else {
+  keyList = keyList.filter((e) => e !== 'SHMCHANNELWRAP');
+}
+
 process.on('exit', function() {
   if (keyList.length !== 0) {
     process._rawDebug('Not all keys have been used:');
@@ -0,0 +1,85 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const net = require('net');
+const spawnSync = require('child_process').spawnSync;
+const async_wrap = process.binding('async_wrap');
+
+// The async context is carried from where an asynchronous operation is
+// started to its callbacks, without any hooks being set up.
+
+function withContext(context, fn) {
+  async_wrap.setContext(context);
+  fn();
+  async_wrap.setContext(undefined);
+}
+
+function expectContext(context) {
+  return common.mustCall(function() {
+    assert.strictEqual(async_wrap.getContext(), context);
+  });
+}
+
+assert.strictEqual(async_wrap.getContext(), undefined);
+
+const a = { name: 'a' };
+const b = { name: 'b' };
+
+withContext(a, function() {
+  fs.stat(__filename, common.mustCall(function() {
+    assert.strictEqual(async_wrap.getContext(), a);
+
+    // Operations started from a callback take its context along, unless it
+    // is changed, which only lasts until the callback returns.
+    process.nextTick(expectContext(a));
+    async_wrap.setContext(b);
+    fs.stat(__filename, expectContext(b));
+    setTimeout(expectContext(b), 1);
+  }));
+  process.nextTick(expectContext(a));
+  setImmediate(expectContext(a));
+  setTimeout(expectContext(a), 1);
+  setTimeout(expectContext(a), 1).unref();
+});
+
+withContext(b, function() {
+  process.nextTick(expectContext(b));
+  setImmediate(expectContext(b));
+  // Timers of the same duration keep their own contexts.
+  setTimeout(expectContext(b), 1);
+});
+
+fs.stat(__filename, expectContext(undefined));
+setImmediate(expectContext(undefined));
+setTimeout(expectContext(undefined), 1);
+
+// Connections take over the context of their server.
+const server = { name: 'server' };
+const client = { name: 'client' };
+withContext(server, function() {
+  net.createServer(common.mustCall(function(socket) {
+    assert.strictEqual(async_wrap.getContext(), server);
+    socket.on('end', expectContext(server));
+    socket.end();
+    this.close(expectContext(server));
+  })).listen(0, common.mustCall(function() {
+    const port = this.address().port;
+    withContext(client, function() {
+      const socket = net.connect(port, expectContext(client));
+      socket.on('end', expectContext(client));
+      socket.resume();
+    });
+  }));
+});
+
+// The first context ever set also only lasts until the callback that set it
+// returns.
+const child = spawnSync(process.execPath, ['-e', `
+  const async_wrap = process.binding('async_wrap');
+  require('fs').access(process.execPath, () => async_wrap.setContext('first'));
+  process.on('exit', () => console.log(async_wrap.getContext()));
+`]);
+assert.strictEqual(child.stderr.toString(), '');
+assert.strictEqual(child.stdout.toString(), 'undefined\n');
@@ -0,0 +1,62 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const spawnSync = require('child_process').spawnSync;
+
+common.refreshTmpDir();
+
+// Core modules that are not needed to run an empty script must not be loaded
+// by the bootstrap code.
+const mainFile = path.join(common.tmpDir, 'main.js');
+fs.writeFileSync(mainFile, `
+  const loaded = process.moduleLoadList.slice();
+  const before = Object.getOwnPropertyDescriptor(global, 'setTimeout');
+  const timeout = setTimeout;
+  const after = Object.getOwnPropertyDescriptor(global, 'setTimeout');
+  global.setImmediate = 42;
+  console.log(JSON.stringify({
+    loaded: loaded,
+    lazy: typeof before.get === 'function' && after.value === timeout &&
+          after.writable && after.enumerable && after.configurable,
+    timers: timeout === require('timers').setTimeout,
+    assigned: setImmediate === 42 &&
+              Object.getOwnPropertyDescriptor(global, 'setImmediate').writable
+  }));
+`);
+
+const child = spawnSync(process.execPath, [mainFile]);
+assert.strictEqual(child.status, 0, child.stderr.toString());
+const result = JSON.parse(child.stdout.toString());
+
+['timers', 'stream', 'assert'].forEach((id) => {
+  assert.strictEqual(result.loaded.indexOf(`NativeModule ${id}`), -1,
+                     `${id} loaded during bootstrap`);
+});
+assert.ok(result.lazy);
+assert.ok(result.timers);
+assert.ok(result.assigned);
+
+// The file stream classes still inherit from the stream classes.
+const stream = require('stream');
+assert.ok(fs.ReadStream.prototype instanceof stream.Readable);
+assert.ok(fs.WriteStream.prototype instanceof stream.Writable);
+assert.strictEqual(fs.ReadStream.super_, stream.Readable);
+assert.strictEqual(fs.FileReadStream, fs.ReadStream);
+assert.strictEqual(fs.FileWriteStream, fs.WriteStream);
+assert.strictEqual(typeof fs.WriteStream.prototype.destroySoon, 'function');
+
+// --trace-module-load reports each core module once it is loaded.
+const traced = spawnSync(process.execPath, ['--trace-module-load', mainFile]);
+assert.strictEqual(traced.status, 0, traced.stderr.toString());
+const lines = traced.stderr.toString().trim().split('\n');
+const re = /^\[module-load\] ([\w/]+): compile [\d.]+ ms, total [\d.]+ ms$/;
+const ids = lines.map((line) => {
+  const m = re.exec(line);
+  assert.ok(m, `unexpected output: ${line}`);
+  return m[1];
+});
+['events', 'module', 'fs', 'timers'].forEach((id) => {
+  assert.notStrictEqual(ids.indexOf(id), -1, `${id} not traced`);
+});
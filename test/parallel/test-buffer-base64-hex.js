@@ -0,0 +1,80 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+
+// base64 and hex are encoded and decoded in vectors of up to 64 characters
+// where the CPU supports it, and byte by byte around those. Check lengths
+// that cover all of the ways in which these can be mixed.
+
+const alphabet =
+    'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/';
+
+function base64(buf) {
+  let s = '';
+  for (let i = 0; i < buf.length; i += 3) {
+    const n = buf[i] << 16 | buf[i + 1] << 8 | buf[i + 2];
+    s += alphabet[n >> 18 & 63] + alphabet[n >> 12 & 63];
+    s += i + 1 < buf.length ? alphabet[n >> 6 & 63] : '=';
+    s += i + 2 < buf.length ? alphabet[n & 63] : '=';
+  }
+  return s;
+}
+
+function hex(buf) {
+  let s = '';
+  for (let i = 0; i < buf.length; i++)
+    s += (buf[i] < 16 ? '0' : '') + buf[i].toString(16);
+  return s;
+}
+
+const data = Buffer.allocUnsafe(256 + 3);
+for (let i = 0; i < data.length; i++)
+  data[i] = (i * 151 + 17) & 0xff;
+
+for (let length = 0; length <= 256; length++) {
+  // Unaligned input too.
+  const buf = data.slice(length % 4, length % 4 + length);
+  const b64 = base64(buf);
+  const h = hex(buf);
+
+  assert.strictEqual(buf.toString('base64'), b64);
+  assert.deepStrictEqual(Buffer.from(b64, 'base64'), buf);
+  const urlSafe = b64.replace(/\+/g, '-').replace(/\//g, '_');
+  assert.deepStrictEqual(Buffer.from(urlSafe, 'base64'), buf);
+
+  assert.strictEqual(buf.toString('hex'), h);
+  assert.deepStrictEqual(Buffer.from(h, 'hex'), buf);
+  assert.deepStrictEqual(Buffer.from(h.toUpperCase(), 'hex'), buf);
+
+  // Two-byte strings.
+  assert.deepStrictEqual(Buffer.from(b64 + '☃', 'base64'), buf);
+  assert.deepStrictEqual(Buffer.from('☃' + b64, 'base64'), buf);
+
+  if (length === 0)
+    continue;
+
+  // Whitespace and other characters that are not in the alphabet are
+  // skipped wherever they are.
+  const middle = b64.length >> 1;
+  const spaced = b64.slice(0, middle) + ' \n☃' + b64.slice(middle);
+  assert.deepStrictEqual(Buffer.from(spaced, 'base64'), buf);
+
+  // hex stops at the first invalid pair.
+  const half = length >> 1;
+  const invalid = h.slice(0, 2 * half) + 'zz' + h.slice(2 * half);
+  if (half > 0)
+    assert.deepStrictEqual(Buffer.from(invalid, 'hex'), buf.slice(0, half));
+
+  // Nothing past the written bytes is touched when the target is too short.
+  const target = Buffer.alloc(length + 2, 0xaa);
+  const written = target.write(b64, 1, length - 1, 'base64');
+  assert.strictEqual(written, length - 1);
+  assert.deepStrictEqual(target.slice(1, length), buf.slice(0, length - 1));
+  assert.strictEqual(target[length], 0xaa);
+  assert.strictEqual(target[length + 1], 0xaa);
+
+  target.fill(0xaa);
+  assert.strictEqual(target.write(h, 1, length - 1, 'hex'), length - 1);
+  assert.deepStrictEqual(target.slice(1, length), buf.slice(0, length - 1));
+  assert.strictEqual(target[length], 0xaa);
+}
@@ -0,0 +1,97 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+
+// Short needles are looked for in vectors of the haystack where the CPU
+// supports it. Compare indexOf() and searchers with a plain JS search for
+// needles and haystacks of lengths around the vector sizes.
+
+function naiveIndexOf(haystack, needle, offset) {
+  for (let i = offset; i + needle.length <= haystack.length; i++) {
+    let j = 0;
+    while (j < needle.length && haystack[i + j] === needle[j])
+      j++;
+    if (j === needle.length)
+      return i;
+  }
+  return -1;
+}
+
+let seed = 1;
+function random(n) {
+  seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+  return seed % n;
+}
+
+// Few different bytes, so that there are many partial matches.
+function randomBuffer(length) {
+  const buf = Buffer.allocUnsafe(length);
+  for (let i = 0; i < length; i++)
+    buf[i] = 0x61 + random(3);
+  return buf;
+}
+
+for (let needleLength = 2; needleLength <= 40; needleLength++) {
+  const needle = randomBuffer(needleLength);
+  const searcher = Buffer.createSearcher(needle);
+  for (let i = 0; i < 20; i++) {
+    const haystack = randomBuffer(random(200));
+    if (haystack.length >= needleLength && random(2) === 0) {
+      needle.copy(haystack, random(haystack.length - needleLength + 1));
+    }
+    const offset = random(4) === 0 ? random(haystack.length + 1) : 0;
+    const expected = naiveIndexOf(haystack, needle, offset);
+    assert.strictEqual(haystack.indexOf(needle, offset), expected);
+    assert.strictEqual(searcher.indexOf(haystack, offset), expected);
+    assert.strictEqual(searcher.includes(haystack, offset), expected !== -1);
+  }
+}
+
+// Matches at every position of a long haystack.
+{
+  const needle = Buffer.from('\r\n--boundary');
+  const searcher = Buffer.createSearcher(needle);
+  const haystack = Buffer.alloc(300, 'x');
+  for (let i = 0; i + needle.length <= haystack.length; i++) {
+    haystack.fill('x');
+    needle.copy(haystack, i);
+    assert.strictEqual(haystack.indexOf(needle), i);
+    assert.strictEqual(haystack.indexOf('\r\n--boundary'), i);
+    assert.strictEqual(searcher.indexOf(haystack), i);
+    assert.strictEqual(searcher.indexOf(haystack, i + 1), -1);
+  }
+}
+
+// Needles are strings in any encoding or buffers, which are copied.
+{
+  const haystack = Buffer.from('this is a buffer');
+  assert.strictEqual(Buffer.createSearcher('is').indexOf(haystack), 2);
+  assert.strictEqual(Buffer.createSearcher('6973', 'hex').indexOf(haystack),
+                     2);
+  const needle = Buffer.from('buffer');
+  const searcher = Buffer.createSearcher(needle);
+  needle.fill('x');
+  assert.strictEqual(searcher.indexOf(haystack), 10);
+  assert.strictEqual(
+      Buffer.createSearcher(new Uint8Array([0x61, 0x20])).indexOf(haystack),
+      8);
+
+  // Offsets are interpreted like those of indexOf().
+  assert.strictEqual(searcher.indexOf(haystack, -6), 10);
+  assert.strictEqual(searcher.indexOf(haystack, -5), -1);
+  assert.strictEqual(searcher.indexOf(haystack, -100), 10);
+  assert.strictEqual(searcher.indexOf(haystack, 100), -1);
+  assert.strictEqual(searcher.indexOf(haystack, 'foo'), 10);
+  assert.strictEqual(searcher.indexOf(haystack, NaN), 10);
+
+  assert.strictEqual(Buffer.createSearcher('').indexOf(haystack), -1);
+  assert.strictEqual(searcher.indexOf(Buffer.alloc(0)), -1);
+  assert.strictEqual(searcher.includes(haystack), true);
+  assert.strictEqual(searcher.includes(haystack, 11), false);
+}
+
+assert.throws(() => Buffer.createSearcher(42),
+              /^TypeError: "needle" argument must be a string or Buffer$/);
+assert.throws(() => Buffer.createSearcher('abc', 'nope'), TypeError);
+assert.throws(() => Buffer.createSearcher('abc').indexOf('abc'),
+              /^TypeError: argument should be a Buffer$/);
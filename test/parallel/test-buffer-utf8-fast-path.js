@@ -0,0 +1,80 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+
+// UTF-8 is decoded and one-byte strings are encoded in node, scanning for
+// ASCII in vectors where the CPU supports it. Compare them with a plain JS
+// implementation at lengths around the vector sizes.
+
+function encode(str) {
+  const bytes = [];
+  for (let i = 0; i < str.length; i++) {
+    let c = str.charCodeAt(i);
+    if (c >= 0xd800 && c <= 0xdbff && i + 1 < str.length) {
+      c = 0x10000 + ((c - 0xd800) << 10) + (str.charCodeAt(++i) - 0xdc00);
+    }
+    if (c < 0x80) {
+      bytes.push(c);
+    } else if (c < 0x800) {
+      bytes.push(0xc0 | c >> 6, 0x80 | c & 0x3f);
+    } else if (c < 0x10000) {
+      bytes.push(0xe0 | c >> 12, 0x80 | c >> 6 & 0x3f, 0x80 | c & 0x3f);
+    } else {
+      bytes.push(0xf0 | c >> 18, 0x80 | c >> 12 & 0x3f,
+                 0x80 | c >> 6 & 0x3f, 0x80 | c & 0x3f);
+    }
+  }
+  return Buffer.from(bytes);
+}
+
+function makeString(length, other, every) {
+  let s = '';
+  for (let i = 0; i < length; i++)
+    s += i % every === every - 1 ? other : String.fromCharCode(32 + i % 95);
+  return s;
+}
+
+const others = ['é', 'ÿ', 'Ā', '中', '😀'];
+
+for (let length = 0; length <= 130; length++) {
+  for (const other of others) {
+    for (const every of [1, 3, 64, 1000]) {
+      const str = makeString(length, other, every);
+      const bytes = encode(str);
+
+      assert.deepStrictEqual(Buffer.from(str), bytes);
+      assert.strictEqual(Buffer.byteLength(str), bytes.length);
+      assert.strictEqual(bytes.toString(), str);
+      // Unaligned.
+      const shifted = Buffer.concat([Buffer.from('x'), bytes]);
+      assert.strictEqual(shifted.toString('utf8', 1), str);
+    }
+  }
+}
+
+// Partial writes stop in front of a character that does not fit, and
+// nothing past the written bytes is touched.
+for (const str of ['aaaé', 'éééé', 'aéaé', 'abcd']) {
+  const bytes = encode(str);
+  for (let size = 0; size <= bytes.length; size++) {
+    const target = Buffer.alloc(bytes.length + 1, 0xaa);
+    const written = target.write(str, 0, size);
+    assert.ok(written <= size);
+    assert.ok(written >= size - 1);
+    assert.deepStrictEqual(target.slice(0, written), bytes.slice(0, written));
+    for (let i = written; i < target.length; i++)
+      assert.strictEqual(target[i], 0xaa);
+  }
+}
+
+// Malformed input is replaced the same way as before.
+const malformed = [
+  [[0x61, 0x80, 0x62], 'a�b'],
+  [[0xc0, 0x80], '��'],
+  [[0xe0, 0x80, 0x80], '���'],
+  [[0xed, 0xa0, 0x80], '���'],
+  [[0xf4, 0x90, 0x80, 0x80], '����'],
+  [[0x61, 0xc3], 'a�']
+];
+for (const [bytes, expected] of malformed)
+  assert.strictEqual(Buffer.from(bytes).toString(), expected);
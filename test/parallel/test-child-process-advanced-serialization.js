@@ -0,0 +1,90 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const child_process = require('child_process');
+const net = require('net');
+
+if (process.argv[2] === 'child') {
+  process.on('message', (message, handle) => {
+    if (handle)
+      handle.end(message);
+    else
+      process.send(message);
+  });
+  return;
+}
+
+assert.throws(() => {
+  child_process.fork(__filename, ['child'], { serialization: 'xml' });
+}, /^TypeError: "serialization" must be "json" or "advanced"$/);
+
+const child = child_process.fork(__filename, ['child'], {
+  serialization: 'advanced'
+});
+
+assert.throws(() => child.send(() => {}), TypeError);
+
+// Every message is echoed back by the child.
+const cyclic = { a: 1 };
+cyclic.self = cyclic;
+// Spans many reads from the pipe.
+const large = Buffer.alloc(1024 * 1024, 'x');
+
+const checks = [
+  [{ buffer: Buffer.from('binary'), uint16: new Uint16Array([1, 65535]) },
+   (message) => {
+     assert(Buffer.isBuffer(message.buffer));
+     assert.strictEqual(message.buffer.toString(), 'binary');
+     assert(message.uint16 instanceof Uint16Array);
+     assert.deepStrictEqual(Array.from(message.uint16), [1, 65535]);
+   }],
+  [{ date: new Date(12345), map: new Map([['k', new Set([NaN])]]) },
+   (message) => {
+     assert.strictEqual(message.date.getTime(), 12345);
+     assert(Number.isNaN(Array.from(message.map.get('k'))[0]));
+   }],
+  [[undefined, -0, Infinity, 'two-byte ☃'],
+   (message) => {
+     assert.strictEqual(message.length, 4);
+     assert.strictEqual(message[0], undefined);
+     assert(Object.is(message[1], -0));
+     assert.strictEqual(message[2], Infinity);
+     assert.strictEqual(message[3], 'two-byte ☃');
+   }],
+  [cyclic,
+   (message) => {
+     assert.strictEqual(message.a, 1);
+     assert.strictEqual(message.self, message);
+   }],
+  [large,
+   (message) => {
+     assert(Buffer.isBuffer(message));
+     assert(message.equals(large));
+     sendHandle();
+   }]
+];
+
+checks.forEach((check) => child.send(check[0]));
+
+let received = 0;
+child.on('message', common.mustCall((message) => {
+  checks[received++][1](message);
+}, checks.length));
+
+// Handles are sent along with advanced messages too.
+function sendHandle() {
+  const server = net.createServer(common.mustCall((socket) => {
+    child.send('handled by child', socket);
+  }));
+  server.listen(0, common.mustCall(() => {
+    const client = net.connect(server.address().port);
+    let data = '';
+    client.setEncoding('utf8');
+    client.on('data', (chunk) => data += chunk);
+    client.on('end', common.mustCall(() => {
+      assert.strictEqual(data, 'handled by child');
+      server.close();
+      child.disconnect();
+    }));
+  }));
+}
@@ -0,0 +1,47 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const child_process = require('child_process');
+const fs = require('fs');
+
+if (!common.isLinux) {
+  common.skip('shared memory channels are only supported on Linux');
+  return;
+}
+
+// The layout of the mapping, see src/shm_channel_wrap.cc. The child writes
+// to the second ring.
+const kCapacity = 4096;
+const kWritePosition = 64 + 192;
+const kChildRingData = 64 + 2 * 192 + kCapacity;
+
+if (process.argv[2] === 'child') {
+  // The memory fd follows the IPC channel's.
+  const memoryFd = 4;
+  assert.strictEqual(fs.fstatSync(memoryFd).size, kChildRingData + kCapacity);
+  // A record that claims to be larger than the ring. Posting a message then
+  // publishes it, and wakes up the parent.
+  const length = Buffer.alloc(4);
+  length.writeUInt32LE(0x7fffffff, 0);
+  fs.writeSync(memoryFd, length, 0, 4, kChildRingData);
+  const position = Buffer.alloc(4);
+  position.writeUInt32LE(8, 0);
+  fs.writeSync(memoryFd, position, 0, 4, kWritePosition);
+  process.sharedMemoryChannel.postMessage('after');
+  return;
+}
+
+const child = child_process.fork(__filename, ['child'], {
+  sharedMemoryChannel: kCapacity
+});
+const channel = child.sharedMemoryChannel;
+channel.on('message', common.fail);
+channel.on('error', common.mustCall((err) => {
+  assert.strictEqual(err.code, 'EPROTO');
+  assert.strictEqual(err.syscall, 'read');
+}));
+channel.on('close', common.mustCall(() => {
+  assert.throws(() => channel.postMessage(1),
+                /^Error: Shared memory channel is closed$/);
+}));
+child.on('exit', common.mustCall((code) => assert.strictEqual(code, 0)));
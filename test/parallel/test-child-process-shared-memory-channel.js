@@ -0,0 +1,70 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const child_process = require('child_process');
+
+if (!common.isLinux) {
+  common.skip('shared memory channels are only supported on Linux');
+  return;
+}
+
+if (process.argv[2] === 'child') {
+  const channel = process.sharedMemoryChannel;
+  channel.on('message', (message) => channel.postMessage(message));
+  return;
+}
+
+assert.throws(() => {
+  child_process.fork(__filename, ['child'], { sharedMemoryChannel: 'yes' });
+}, /^TypeError: "sharedMemoryChannel" must be a boolean or a size in bytes$/);
+
+assert.throws(() => {
+  child_process.spawn(process.execPath, [__filename, 'child'], {
+    sharedMemoryChannel: true
+  });
+}, /^Error: "sharedMemoryChannel" requires an IPC channel$/);
+
+assert.strictEqual(process.sharedMemoryChannel, undefined);
+assert.strictEqual(new child_process.ChildProcess().sharedMemoryChannel, null);
+
+// A small buffer, so that it fills up and wraps around many times.
+const child = child_process.fork(__filename, ['child'], {
+  sharedMemoryChannel: 4096
+});
+const channel = child.sharedMemoryChannel;
+
+const tooLarge =
+    /^RangeError: Message is too large for the shared memory channel$/;
+assert.throws(() => channel.postMessage(Buffer.alloc(2048)), tooLarge);
+assert.throws(() => channel.postMessage(() => {}), TypeError);
+
+const count = 5000;
+let full = false;
+for (let i = 0; i < count; i++) {
+  const message = { i, data: Buffer.alloc(i % 500, i % 256) };
+  if (i % 100 === 0)
+    message.map = new Map([[i, 'two-byte ☃']]);
+  if (!channel.postMessage(message))
+    full = true;
+}
+assert(full);
+channel.on('drain', common.mustCall(() => {}));
+
+// Every message is echoed back, in order.
+let received = 0;
+channel.on('message', common.mustCall((message) => {
+  const i = received++;
+  assert.strictEqual(message.i, i);
+  assert(message.data.equals(Buffer.alloc(i % 500, i % 256)));
+  if (i % 100 === 0)
+    assert.strictEqual(message.map.get(i), 'two-byte ☃');
+  if (received === count)
+    child.disconnect();
+}, count));
+
+channel.on('close', common.mustCall(() => {
+  assert.strictEqual(child.sharedMemoryChannel, null);
+  assert.throws(() => channel.postMessage(1),
+                /^Error: Shared memory channel is closed$/);
+}));
+child.on('exit', common.mustCall((code) => assert.strictEqual(code, 0)));
@@ -0,0 +1,33 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const cluster = require('cluster');
+const http = require('http');
+
+if (cluster.isMaster) {
+  cluster.setupMaster({ serialization: 'advanced' });
+  const worker = cluster.fork();
+
+  worker.on('message', common.mustCall((message) => {
+    assert(Buffer.isBuffer(message.buffer));
+    assert.strictEqual(message.buffer.toString(), 'from worker');
+    assert(message.set instanceof Set);
+    assert(message.set.has(worker.id));
+
+    // Connections are handed to the worker over the same channel.
+    http.get({ port: message.port }, common.mustCall((res) => {
+      res.resume();
+      res.on('end', common.mustCall(() => worker.kill()));
+    }));
+  }));
+  worker.on('exit', common.mustCall(() => {}));
+} else {
+  const server = http.createServer((req, res) => res.end('ok'));
+  server.listen(0, common.mustCall(() => {
+    process.send({
+      buffer: Buffer.from('from worker'),
+      set: new Set([cluster.worker.id]),
+      port: server.address().port
+    });
+  }));
+}
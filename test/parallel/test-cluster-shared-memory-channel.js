@@ -0,0 +1,38 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const cluster = require('cluster');
+const net = require('net');
+
+if (!common.isLinux) {
+  common.skip('shared memory channels are only supported on Linux');
+  return;
+}
+
+if (cluster.isMaster) {
+  cluster.setupMaster({ sharedMemoryChannel: true });
+  const worker = cluster.fork();
+  const channel = worker.process.sharedMemoryChannel;
+
+  channel.on('message', common.mustCall((message) => {
+    assert.strictEqual(message.id, worker.id);
+    assert.strictEqual(message.ping, 'pong');
+    // Connections are still handed to the worker over the IPC channel.
+    net.connect(message.port).on('end', common.mustCall(() => {
+      worker.disconnect();
+    })).resume();
+  }));
+  worker.on('listening', common.mustCall((address) => {
+    channel.postMessage({ ping: 'ping', port: address.port });
+  }));
+  worker.on('exit', common.mustCall((code) => assert.strictEqual(code, 0)));
+} else {
+  net.createServer((socket) => socket.end()).listen(0);
+  process.sharedMemoryChannel.on('message', common.mustCall((message) => {
+    process.sharedMemoryChannel.postMessage({
+      id: cluster.worker.id,
+      ping: 'pong',
+      port: message.port
+    });
+  }));
+}
@@ -0,0 +1,22 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+
+// The code cache for the core modules is only embedded when node was
+// configured with --code-cache-path. Either way, the binding must only
+// return Uint8Arrays and nothing for unknown modules.
+const getCodeCache = process.binding('code_cache').get;
+
+assert.strictEqual(getCodeCache('does_not_exist'), undefined);
+assert.strictEqual(getCodeCache('internal/bootstrap_node'), undefined);
+
+const cache = getCodeCache('fs');
+if (cache !== undefined) {
+  assert(cache instanceof Uint8Array);
+  assert(cache.length > 0);
+
+  // Each call returns a copy that can be written to.
+  const copy = Buffer.from(cache);
+  cache.fill(0);
+  assert.deepStrictEqual(Buffer.from(getCodeCache('fs')), copy);
+}
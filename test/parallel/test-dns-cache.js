@@ -0,0 +1,191 @@
+// Flags: --expose-internals
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const dns = require('dns');
+const domain = require('domain');
+const async_wrap = process.binding('async_wrap');
+const DnsCache = require('internal/dns_cache');
+
+assert.deepStrictEqual(dns.getCacheEntries(), []);
+assert.throws(() => dns.setCache(1), TypeError);
+assert.throws(() => dns.setCache({ maxTtl: -1 }), TypeError);
+assert.throws(() => dns.setCache({ staleTtl: '1' }), TypeError);
+
+// A resolver that counts its calls and answers when told to.
+function fakeResolver(err, result, ttl) {
+  const resolver = (done) => {
+    resolver.calls++;
+    resolver.done = () => done(err, result, ttl);
+  };
+  resolver.calls = 0;
+  return resolver;
+}
+
+// Concurrent requests wait for a single resolution, and later ones are served
+// from the cache. Results are copies.
+{
+  const cache = new DnsCache({});
+  const resolve = fakeResolver(null, ['1.2.3.4'], 60);
+  let answered = 0;
+  const check = common.mustCall((err, result, extra, age) => {
+    assert.strictEqual(err, null);
+    assert.deepStrictEqual(result, ['1.2.3.4']);
+    assert.strictEqual(age, 0);
+    result.push('5.6.7.8');
+    answered++;
+  }, 2);
+  cache.fetch('a', 'queryA', 'a.test', resolve, check);
+  cache.fetch('a', 'queryA', 'a.test', resolve, check);
+  assert.strictEqual(resolve.calls, 1);
+  resolve.done();
+  assert.strictEqual(answered, 2);
+
+  cache.fetch('a', 'queryA', 'a.test', resolve, common.mustCall((err, res) => {
+    assert.deepStrictEqual(res, ['1.2.3.4']);
+  }));
+  assert.strictEqual(resolve.calls, 1);
+
+  const entries = cache.getEntries();
+  assert.strictEqual(entries.length, 1);
+  const entry = entries[0];
+  assert.strictEqual(entry.type, 'queryA');
+  assert.strictEqual(entry.name, 'a.test');
+  assert.strictEqual(entry.error, null);
+  assert(entry.expiresIn > 59 && entry.expiresIn <= 60, `${entry.expiresIn}`);
+  assert.strictEqual(entry.hits, 1);
+  assert.strictEqual(entry.misses, 2);
+  assert.strictEqual(entry.resolutions, 1);
+}
+
+// TTLs are capped, and lookups without a TTL use `lookupTtl`.
+{
+  const cache = new DnsCache({ maxTtl: 10, lookupTtl: 2 });
+  const resolve = fakeResolver(null, ['1.2.3.4'], 3600);
+  cache.fetch('a', 'queryA', 'a.test', resolve, common.mustCall(() => {}));
+  resolve.done();
+  const lookup = fakeResolver(null, ['1.2.3.4']);
+  cache.fetch('l', 'lookup', 'a.test', lookup, common.mustCall(() => {}));
+  lookup.done();
+  const entries = cache.getEntries();
+  assert(entries[0].expiresIn > 9 && entries[0].expiresIn <= 10);
+  assert(entries[1].expiresIn > 1 && entries[1].expiresIn <= 2);
+}
+
+// Names that do not exist are cached; other failures are not.
+{
+  const cache = new DnsCache({ negativeTtl: 1 });
+  const missing = fakeResolver('ENOTFOUND');
+  cache.fetch('m', 'queryA', 'missing.test', missing, common.mustCall((err) => {
+    assert.strictEqual(err, 'ENOTFOUND');
+  }));
+  missing.done();
+  cache.fetch('m', 'queryA', 'missing.test', missing, common.mustCall((err) => {
+    assert.strictEqual(err, 'ENOTFOUND');
+  }));
+  assert.strictEqual(missing.calls, 1);
+  assert.strictEqual(cache.getEntries()[0].error, 'ENOTFOUND');
+
+  const refused = fakeResolver('ECONNREFUSED');
+  cache.fetch('r', 'queryA', 'r.test', refused, common.mustCall(() => {}));
+  refused.done();
+  assert.strictEqual(cache.getEntries().length, 1);
+  cache.fetch('r', 'queryA', 'r.test', refused, () => {});
+  assert.strictEqual(refused.calls, 2);
+}
+
+// Expired results are served while they are stale, and refreshed once.
+{
+  const cache = new DnsCache({ staleTtl: 60 });
+  const resolve = fakeResolver(null, ['1.2.3.4'], 0);
+  cache.fetch('a', 'queryA', 'a.test', resolve, common.mustCall(() => {}));
+  resolve.done();
+  const stale = common.mustCall((err, result) => {
+    assert.deepStrictEqual(result, ['1.2.3.4']);
+  }, 2);
+  cache.fetch('a', 'queryA', 'a.test', resolve, stale);
+  cache.fetch('a', 'queryA', 'a.test', resolve, stale);
+  assert.strictEqual(resolve.calls, 2);
+  assert.strictEqual(cache.getEntries()[0].staleHits, 2);
+}
+
+// The least recently resolved entries are dropped first.
+{
+  const cache = new DnsCache({ maxEntries: 2 });
+  for (const name of ['a', 'b', 'c']) {
+    const resolve = fakeResolver(null, [name], 60);
+    cache.fetch(name, 'queryA', name, resolve, common.mustCall(() => {}));
+    resolve.done();
+  }
+  assert.deepStrictEqual(cache.getEntries().map((e) => e.name), ['b', 'c']);
+}
+
+// Records are copied too.
+{
+  const cache = new DnsCache({});
+  const mx = [{ priority: 10, exchange: 'mx.test' }];
+  const resolve = fakeResolver(null, mx, 60);
+  cache.fetch('mx', 'queryMx', 'a.test', resolve, common.mustCall((e, r) => {
+    r[0].exchange = 'changed.test';
+  }));
+  resolve.done();
+  cache.fetch('mx', 'queryMx', 'a.test', resolve, common.mustCall((e, r) => {
+    assert.deepStrictEqual(r, [{ priority: 10, exchange: 'mx.test' }]);
+  }));
+  assert.strictEqual(mx[0].exchange, 'mx.test');
+
+  const txt = [['a', 'b']];
+  const resolveTxt = fakeResolver(null, txt, 60);
+  cache.fetch('txt', 'queryTxt', 'a.test', resolveTxt, common.mustCall(
+    (err, result) => result[0].push('c')));
+  resolveTxt.done();
+  assert.deepStrictEqual(txt, [['a', 'b']]);
+}
+
+// Requests that wait for a resolution are answered in their own domain and
+// async context, and the resolution is started in neither.
+{
+  const cache = new DnsCache({});
+  const resolve = (done) => {
+    assert.strictEqual(async_wrap.getContext(), undefined);
+    resolve.done = done;
+  };
+  const callers = [{ name: 'a' }, { name: 'b' }].map((context) => {
+    const d = domain.create();
+    d.run(() => {
+      async_wrap.setContext(context);
+      cache.fetch('a', 'queryA', 'a.test', resolve, common.mustCall(() => {
+        assert.strictEqual(async_wrap.getContext(), context);
+        assert.strictEqual(process.domain, d);
+      }));
+      assert.strictEqual(async_wrap.getContext(), context);
+      async_wrap.setContext(undefined);
+    });
+    return d;
+  });
+  assert.notStrictEqual(callers[0], callers[1]);
+  resolve.done(null, ['1.2.3.4'], 60);
+  assert.strictEqual(async_wrap.getContext(), undefined);
+  assert.strictEqual(process.domain, undefined);
+}
+
+// dns.lookup() goes through the cache once it is enabled.
+dns.setCache();
+dns.lookup('localhost', 4, common.mustCall((err, address, family) => {
+  assert.ifError(err);
+  assert.strictEqual(family, 4);
+  dns.lookup('localhost', 4, common.mustCall((err, cached, family) => {
+    assert.ifError(err);
+    assert.strictEqual(cached, address);
+    assert.strictEqual(family, 4);
+    const entries = dns.getCacheEntries();
+    assert.strictEqual(entries.length, 1);
+    assert.strictEqual(entries[0].type, 'lookup');
+    assert.strictEqual(entries[0].name, 'localhost');
+    assert.strictEqual(entries[0].hits, 1);
+    assert.strictEqual(entries[0].resolutions, 1);
+
+    dns.setCache(null);
+    assert.deepStrictEqual(dns.getCacheEntries(), []);
+  }));
+}));
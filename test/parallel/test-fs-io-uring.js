@@ -0,0 +1,106 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const spawnSync = require('child_process').spawnSync;
+
+// On Linux, the file system requests below go through io_uring when the
+// kernel supports it, and through the thread pool with UV_USE_IO_URING=0.
+// Both must give the same results.
+if (process.argv[2] === 'child') {
+  const file = process.argv[3];
+  const results = [];
+  const fd = fs.openSync(file, 'w+');
+  const data = Buffer.from('0123456789abcdef');
+
+  fs.write(fd, data, 0, data.length, 4, common.mustCall((err, written) => {
+    assert.ifError(err);
+    results.push(written);
+    fs.fsync(fd, common.mustCall((err) => {
+      assert.ifError(err);
+      fs.fdatasync(fd, common.mustCall((err) => {
+        assert.ifError(err);
+        readBack();
+      }));
+    }));
+  }));
+
+  function readBack() {
+    const buf = Buffer.alloc(8);
+    fs.read(fd, buf, 0, 8, 10, common.mustCall((err, bytesRead) => {
+      assert.ifError(err);
+      results.push(buf.toString('latin1', 0, bytesRead));
+      // A null position reads from, and advances, the current file position.
+      fs.read(fd, buf, 0, 4, null, common.mustCall((err, bytesRead) => {
+        assert.ifError(err);
+        results.push(buf.toString('latin1', 0, bytesRead));
+        stat();
+      }));
+    }));
+  }
+
+  function stat() {
+    fs.fstat(fd, common.mustCall((err, fstats) => {
+      assert.ifError(err);
+      fs.stat(file, common.mustCall((err, stats) => {
+        assert.ifError(err);
+        fs.lstat(file, common.mustCall((err, lstats) => {
+          assert.ifError(err);
+          for (const s of [fstats, stats, lstats])
+            results.push([s.size, s.ino, s.mode, s.isFile()]);
+          fs.stat(path.join(file, 'missing'), common.mustCall((err) => {
+            results.push(err.code);
+            fs.closeSync(fd);
+            console.log(JSON.stringify(results));
+          }));
+        }));
+      }));
+    }));
+  }
+  return;
+}
+
+common.refreshTmpDir();
+
+function run(env, name) {
+  const file = path.join(common.tmpDir, name);
+  const child = spawnSync(process.execPath, [__filename, 'child', file],
+                          { env: Object.assign({}, process.env, env) });
+  assert.strictEqual(child.status, 0, child.stderr.toString());
+  const results = JSON.parse(child.stdout);
+  const stats = fs.statSync(file);
+  // Only the inode differs between the two files.
+  for (const s of results.slice(3, 6)) {
+    assert.strictEqual(s[1], stats.ino);
+    s[1] = 0;
+  }
+  return results;
+}
+
+const ring = run({}, 'ring');
+const pool = run({ UV_USE_IO_URING: '0' }, 'pool');
+assert.deepStrictEqual(ring, pool);
+assert.deepStrictEqual(pool.slice(0, 3), [16, '6789abcd', '\0\0\0\0']);
+assert.deepStrictEqual(pool[3], [20, 0, pool[3][2], true]);
+assert.strictEqual(pool[6], 'ENOTDIR');
+
+// Each worker thread has its own loop, and with it its own io_uring. Requests
+// from several loops at once must all complete.
+const Worker = require('worker_threads').Worker;
+const size = fs.statSync(__filename).size;
+for (let i = 0; i < 4; i++) {
+  new Worker(`
+    const fs = require('fs');
+    const parentPort = require('worker_threads').parentPort;
+    const sizes = [];
+    for (let i = 0; i < 100; i++) {
+      fs.stat(${JSON.stringify(__filename)}, (err, stats) => {
+        if (err) throw err;
+        if (sizes.push(stats.size) === 100) parentPort.postMessage(sizes);
+      });
+    }
+  `, { eval: true }).on('message', common.mustCall((sizes) => {
+    assert.deepStrictEqual(sizes, new Array(100).fill(size));
+  }));
+}
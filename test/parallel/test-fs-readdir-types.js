@@ -0,0 +1,72 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+const readdirDir = common.tmpDir;
+const files = ['empty', 'files', 'for', 'just', 'testing'];
+const dirs = ['dir1', 'dir2'];
+
+// Make sure tmp directory is clean
+common.refreshTmpDir();
+
+// Create the necessary files and directories
+files.forEach(function(currentFile) {
+  fs.closeSync(fs.openSync(path.join(readdirDir, currentFile), 'w'));
+});
+dirs.forEach(function(currentDir) {
+  fs.mkdirSync(path.join(readdirDir, currentDir));
+});
+
+function assertDirents(dirents) {
+  assert.strictEqual(dirents.length, files.length + dirs.length);
+  dirents.forEach(function(dirent) {
+    assert(dirent instanceof fs.Dirent);
+    const isDir = dirs.indexOf(dirent.name) !== -1;
+    assert(isDir || files.indexOf(dirent.name) !== -1);
+    assert.strictEqual(dirent.isDirectory(), isDir);
+    assert.strictEqual(dirent.isFile(), !isDir);
+    assert.strictEqual(dirent.isSymbolicLink(), false);
+    assert.strictEqual(dirent.isFIFO(), false);
+    assert.strictEqual(dirent.isSocket(), false);
+    assert.strictEqual(dirent.isBlockDevice(), false);
+    assert.strictEqual(dirent.isCharacterDevice(), false);
+  });
+}
+
+// Plain readdir is unaffected
+assert.deepStrictEqual(fs.readdirSync(readdirDir).sort(),
+                       dirs.concat(files).sort());
+
+// Check the readdir Sync version
+assertDirents(fs.readdirSync(readdirDir, { withFileTypes: true }));
+
+// Check the readdir async version
+fs.readdir(readdirDir, {
+  withFileTypes: true
+}, common.mustCall(function(err, dirents) {
+  assert.ifError(err);
+  assertDirents(dirents);
+}));
+
+// Buffer encoding is passed through to the names
+const buffers = fs.readdirSync(readdirDir, {
+  encoding: 'buffer',
+  withFileTypes: true
+});
+buffers.forEach(function(dirent) {
+  assert(Buffer.isBuffer(dirent.name));
+});
+
+// readdir() with file types on a file should fail with ENOTDIR
+assert.throws(function() {
+  fs.readdirSync(__filename, { withFileTypes: true });
+}, /Error: ENOTDIR: not a directory/);
+
+fs.readdir(__filename, {
+  withFileTypes: true
+}, common.mustCall(function(e) {
+  assert.strictEqual(e.code, 'ENOTDIR');
+}));
@@ -0,0 +1,119 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+const root = common.tmpDir;
+
+common.refreshTmpDir();
+
+// root/
+//   a
+//   b/
+//     c
+//     d/
+//       e
+//   skip/
+//     f
+fs.writeFileSync(path.join(root, 'a'), '');
+fs.mkdirSync(path.join(root, 'b'));
+fs.writeFileSync(path.join(root, 'b', 'c'), '');
+fs.mkdirSync(path.join(root, 'b', 'd'));
+fs.writeFileSync(path.join(root, 'b', 'd', 'e'), '');
+fs.mkdirSync(path.join(root, 'skip'));
+fs.writeFileSync(path.join(root, 'skip', 'f'), '');
+
+const all = ['a', 'b', 'b/c', 'b/d', 'b/d/e', 'skip', 'skip/f']
+  .map((name) => path.normalize(name));
+const dirs = ['b', 'b/d', 'skip'].map((name) => path.normalize(name));
+
+function names(entries) {
+  entries.forEach(function(dirent) {
+    assert(dirent instanceof fs.Dirent);
+    assert.strictEqual(dirent.isDirectory(), dirs.indexOf(dirent.name) !== -1);
+  });
+  return entries.map((dirent) => dirent.name).sort();
+}
+
+function noSkip(dirent) {
+  return dirent.name !== 'skip';
+}
+
+assert.deepStrictEqual(names(fs.walkSync(root)), all);
+assert.deepStrictEqual(names(fs.walkSync(root, { depth: 0 })),
+                       ['a', 'b', 'skip']);
+assert.deepStrictEqual(names(fs.walkSync(root, { depth: 1 })),
+                       all.filter((name) => name !== path.normalize('b/d/e')));
+assert.deepStrictEqual(names(fs.walkSync(root, { filter: noSkip })),
+                       all.filter((name) => !name.startsWith('skip')));
+
+function walk(options, callback) {
+  const batchSize = options.batchSize || 1024;
+  const entries = [];
+  fs.walk(root, options)
+    .on('data', function(batch) {
+      assert(Array.isArray(batch));
+      assert(batch.length > 0 && batch.length <= batchSize);
+      entries.push.apply(entries, batch);
+    })
+    .on('end', common.mustCall(() => callback(entries)));
+}
+
+walk({}, function(entries) {
+  assert.deepStrictEqual(names(entries), all);
+});
+
+walk({ depth: 0 }, function(entries) {
+  assert.deepStrictEqual(names(entries), ['a', 'b', 'skip']);
+});
+
+walk({ filter: noSkip }, function(entries) {
+  assert.deepStrictEqual(names(entries),
+                         all.filter((name) => !name.startsWith('skip')));
+});
+
+walk({ batchSize: 2 }, function(entries) {
+  assert.deepStrictEqual(names(entries), all);
+});
+
+// Directories are only read while the consumer wants more entries.
+{
+  const stream = fs.walk(root, { batchSize: 1 });
+  assert(stream instanceof fs.WalkStream);
+  stream.once('readable', common.mustCall(function() {
+    assert.strictEqual(stream.read().length, 1);
+    setImmediate(common.mustCall(function() {
+      assert(stream._dirs.length > 0);
+      stream.destroy();
+    }));
+  }));
+  stream.on('close', common.mustCall(() => {}));
+  stream.on('end', common.fail);
+}
+
+// Errors
+assert.throws(function() {
+  fs.walkSync(__filename);
+}, /Error: ENOTDIR: not a directory/);
+
+fs.walk(__filename).on('error', common.mustCall(function(err) {
+  assert.strictEqual(err.code, 'ENOTDIR');
+})).resume();
+
+assert.throws(function() {
+  fs.walkSync(root, { depth: -1 });
+}, /^TypeError: "depth" must be a non-negative number$/);
+
+assert.throws(function() {
+  fs.walkSync(root, { filter: 'skip' });
+}, /^TypeError: "filter" must be a function$/);
+
+assert.throws(function() {
+  fs.walk(root, { batchSize: 0 });
+}, /^TypeError: "batchSize" must be a positive integer$/);
+
+assert.throws(function() {
+  fs.walkSync(root, { encoding: 'buffer' });
+}, /^TypeError: "encoding" must not be 'buffer' for fs.walk\(\)$/);
@@ -0,0 +1,71 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+const zlib = require('zlib');
+const HTTPParser = process.binding('http_parser').HTTPParser;
+
+function breakdown() {
+  return process.memoryUsage().externalBreakdown;
+}
+
+const initial = breakdown();
+assert.deepStrictEqual(Object.keys(initial),
+                       ['buffers', 'zlib', 'tls', 'streams', 'httpParser']);
+for (const category of Object.keys(initial))
+  assert(initial[category] >= 0, category);
+
+// Buffers, whether allocated by V8 or by node.
+{
+  const before = breakdown().buffers;
+  const buffers = [Buffer.alloc(8 << 20), Buffer.allocUnsafeSlow(8 << 20),
+                   new ArrayBuffer(8 << 20)];
+  assert(breakdown().buffers - before >= 24 << 20);
+  assert.strictEqual(buffers.length, 3);
+}
+
+// zlib contexts are freed when the stream is closed.
+{
+  const before = breakdown().zlib;
+  const gzip = zlib.createGzip();
+  const during = breakdown().zlib;
+  assert(during > before);
+  gzip.close();
+  assert.strictEqual(breakdown().zlib, before);
+}
+
+// HTTP parsers.
+{
+  const before = breakdown().httpParser;
+  const parser = new HTTPParser(HTTPParser.REQUEST);
+  assert(breakdown().httpParser > before);
+  assert(parser);
+}
+
+if (common.hasCrypto) {
+  const tls = require('tls');
+  const before = breakdown().tls;
+  const context = tls.createSecureContext();
+  assert(breakdown().tls > before);
+  assert(context);
+}
+
+// Data that is queued to be written to a socket that is not read from.
+{
+  const server = net.createServer(common.mustCall(function(socket) {
+    socket.pause();
+  }));
+  server.listen(0, common.mustCall(function() {
+    const before = breakdown().streams;
+    const client = net.connect(this.address().port, common.mustCall(() => {
+      client.write('x'.repeat(32 << 20));
+      assert(breakdown().streams - before > 1 << 20);
+      // Pending writes are cancelled before the socket is closed.
+      client.on('close', common.mustCall(() => {
+        assert.strictEqual(breakdown().streams, before);
+        server.close();
+      }));
+      client.destroy();
+    }));
+  }));
+}
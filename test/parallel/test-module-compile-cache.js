@@ -0,0 +1,85 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const spawnSync = require('child_process').spawnSync;
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+
+common.refreshTmpDir();
+
+const cacheDir = path.join(common.tmpDir, 'compile-cache');
+const v8Dir = path.join(cacheDir, `v8-${process.versions.v8}-${process.arch}`);
+const mainFile = path.join(common.tmpDir, 'main.js');
+const depFile = path.join(common.tmpDir, 'dep.js');
+
+fs.writeFileSync(depFile, 'module.exports = function dep() { return 42; };');
+fs.writeFileSync(mainFile, `
+  const assert = require('assert');
+  assert.strictEqual(require('./dep')(), 42);
+  const cache = require('module')._compileCache;
+  console.log(JSON.stringify({
+    hits: cache.hits,
+    misses: cache.misses,
+    rejected: cache.rejected
+  }));
+`);
+
+function run() {
+  const env = Object.assign({}, process.env, { NODE_COMPILE_CACHE: cacheDir });
+  const child = spawnSync(process.execPath, [mainFile], { env: env });
+  assert.strictEqual(child.status, 0, child.stderr.toString());
+  return JSON.parse(child.stdout.toString());
+}
+
+// The first run compiles both modules and fills the cache.
+assert.deepStrictEqual(run(), { hits: 0, misses: 2, rejected: 0 });
+assert.strictEqual(fs.readdirSync(v8Dir).length, 2);
+
+// The second run uses it.
+assert.deepStrictEqual(run(), { hits: 2, misses: 0, rejected: 0 });
+
+// Changing a module's source uses a different cache file.
+fs.writeFileSync(depFile, 'module.exports = () => 42;');
+assert.deepStrictEqual(run(), { hits: 1, misses: 1, rejected: 0 });
+assert.strictEqual(fs.readdirSync(v8Dir).length, 3);
+
+// Corrupt cache files are rejected and removed.
+fs.readdirSync(v8Dir).forEach((name) => {
+  fs.writeFileSync(path.join(v8Dir, name), 'garbage');
+});
+assert.deepStrictEqual(run(), { hits: 0, misses: 0, rejected: 2 });
+assert.strictEqual(fs.readdirSync(v8Dir).length, 1);
+
+// Cache files are named after the SHA-256 hash of the module wrapper, and
+// computing it does not load the crypto module. Worker threads share the pid
+// of the process, but write their cache files through temporary files of
+// their own.
+const threadsFile = path.join(common.tmpDir, 'threads.js');
+const sharedFile = path.join(common.tmpDir, 'shared.js');
+fs.writeFileSync(sharedFile, 'module.exports = "shared";');
+fs.writeFileSync(threadsFile, `
+  const threads = require('worker_threads');
+  if (threads.isMainThread) {
+    for (let i = 0; i < 4; i++)
+      new threads.Worker(__filename);
+    console.log(process.moduleLoadList.includes('NativeModule crypto'));
+  } else {
+    require('./shared');
+  }
+`);
+const child = spawnSync(process.execPath, [threadsFile], {
+  env: Object.assign({}, process.env, { NODE_COMPILE_CACHE: cacheDir })
+});
+assert.strictEqual(child.status, 0, child.stderr.toString());
+assert.strictEqual(child.stdout.toString(), 'false\n');
+const hash = require('crypto').createHash('sha256')
+  .update(require('module').wrap(fs.readFileSync(sharedFile, 'utf8')))
+  .digest('hex');
+assert(fs.readdirSync(v8Dir).includes(hash));
+assert.deepStrictEqual(
+  fs.readdirSync(v8Dir).filter((name) => name.endsWith('.tmp')), []);
@@ -0,0 +1,103 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const spawnSync = require('child_process').spawnSync;
+
+common.refreshTmpDir();
+
+const cacheFile = path.join(common.tmpDir, 'resolution-cache.json');
+const appDir = path.join(common.tmpDir, 'app');
+const pkgDir = path.join(appDir, 'node_modules', 'foo');
+const mainFile = path.join(appDir, 'main.js');
+
+fs.mkdirSync(appDir);
+fs.mkdirSync(path.join(appDir, 'node_modules'));
+fs.mkdirSync(pkgDir);
+fs.writeFileSync(path.join(pkgDir, 'package.json'), '{"main":"a.js"}');
+fs.writeFileSync(path.join(pkgDir, 'a.js'), '');
+fs.writeFileSync(path.join(pkgDir, 'b.js'), '');
+fs.writeFileSync(mainFile, 'console.log(require.resolve("foo"));');
+
+function resolveFoo() {
+  const env = Object.assign({}, process.env, {
+    NODE_MODULE_RESOLUTION_CACHE: cacheFile
+  });
+  const child = spawnSync(process.execPath, [mainFile], { env: env });
+  assert.strictEqual(child.status, 0, child.stderr.toString());
+  return child.stdout.toString().trim();
+}
+
+function readCache() {
+  return JSON.parse(fs.readFileSync(cacheFile, 'utf8'));
+}
+
+function findEntry(cache) {
+  const keys = Object.keys(cache.entries).filter((key) => {
+    return JSON.parse(key.replace(/^main:/, '')).request === 'foo';
+  });
+  assert.strictEqual(keys.length, 1);
+  return keys[0];
+}
+
+// Directory mtimes are compared for equality, move them clearly into the
+// past so that later changes are always detected.
+function age(p) {
+  const past = new Date(Date.now() - 3600 * 1000);
+  fs.utimesSync(p, past, past);
+}
+[appDir, path.join(appDir, 'node_modules'), pkgDir,
+ path.join(pkgDir, 'package.json')].forEach(age);
+
+// The first run resolves normally and writes the cache file.
+assert(!fs.existsSync(cacheFile));
+assert.strictEqual(resolveFoo(), fs.realpathSync(path.join(pkgDir, 'a.js')));
+let cache = readCache();
+const key = findEntry(cache);
+assert.strictEqual(cache.entries[key][0],
+                   fs.realpathSync(path.join(pkgDir, 'a.js')));
+assert(cache.packages[pkgDir]);
+assert.strictEqual(cache.packages[pkgDir][0], 'a.js');
+
+// A valid entry is used without probing the file system. Point it at a
+// different file to prove that.
+cache.entries[key][0] = path.join(pkgDir, 'b.js');
+fs.writeFileSync(cacheFile, JSON.stringify(cache));
+assert.strictEqual(resolveFoo(), path.join(pkgDir, 'b.js'));
+
+// Changing package.json invalidates the entry.
+fs.writeFileSync(path.join(pkgDir, 'package.json'), '{"main":"b.js"}');
+assert.strictEqual(resolveFoo(), fs.realpathSync(path.join(pkgDir, 'b.js')));
+cache = readCache();
+assert.strictEqual(cache.packages[pkgDir][0], 'b.js');
+
+// So does replacing the package with a file.
+const fooFile = path.join(appDir, 'node_modules', 'foo.js');
+fs.renameSync(pkgDir, `${pkgDir}-old`);
+fs.writeFileSync(fooFile, '');
+assert.strictEqual(resolveFoo(), fs.realpathSync(fooFile));
+
+// A corrupt cache file is ignored and replaced.
+fs.writeFileSync(cacheFile, '{');
+assert.strictEqual(resolveFoo(), fs.realpathSync(fooFile));
+findEntry(readCache());
+
+// Worker threads share the pid of the process, but each of them saves the
+// cache through a temporary file of its own.
+const workersFile = path.join(appDir, 'workers.js');
+fs.writeFileSync(workersFile, `
+  const Worker = require('worker_threads').Worker;
+  for (let i = 0; i < 4; i++)
+    new Worker('require.resolve("foo")', { eval: true });
+`);
+const child = spawnSync(process.execPath, [workersFile], {
+  cwd: appDir,
+  env: Object.assign({}, process.env, {
+    NODE_MODULE_RESOLUTION_CACHE: cacheFile
+  })
+});
+assert.strictEqual(child.status, 0, child.stderr.toString());
+findEntry(readCache());
+assert.deepStrictEqual(
+  fs.readdirSync(common.tmpDir).filter((name) => name.endsWith('.tmp')), []);
@@ -0,0 +1,43 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const spawn = require('child_process').spawn;
+
+if (common.isWindows) {
+  common.skip('SIGUSR2 is not available on Windows');
+  return;
+}
+
+// With --callback-stats the counts are kept from startup and printed to stderr
+// on SIGUSR2, which does not otherwise affect the process.
+const script = `
+  setTimeout(() => {
+    process.kill(process.pid, 'SIGUSR2');
+    setTimeout(() => {
+      console.log(JSON.stringify(process.callbackUsage()));
+    }, 50);
+  }, 10);
+`;
+const child = spawn(process.execPath, ['--callback-stats', '-e', script]);
+
+let stdout = '';
+let stderr = '';
+child.stdout.setEncoding('utf8');
+child.stderr.setEncoding('utf8');
+child.stdout.on('data', (data) => stdout += data);
+child.stderr.on('data', (data) => stderr += data);
+
+child.on('close', common.mustCall(function(code, signal) {
+  assert.strictEqual(code, 0);
+  assert.strictEqual(signal, null);
+
+  const lines = stderr.trim().split('\n');
+  assert(/^provider +calls +total \(ms\) +mean \(us\) +max \(us\)$/.test(
+      lines[0]), lines[0]);
+  assert(lines.some((line) => /^TIMERWRAP +1 /.test(line)), stderr);
+
+  const usage = JSON.parse(stdout);
+  // The callback that is still running has not been counted yet.
+  assert.strictEqual(usage.TIMERWRAP.count, 1);
+  assert.strictEqual(usage.SIGNALWRAP, undefined);
+}));
@@ -0,0 +1,54 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const net = require('net');
+
+// Counting starts with the first call.
+assert.deepStrictEqual(process.callbackUsage(), {});
+
+function block(ms) {
+  const end = Date.now() + ms;
+  while (Date.now() < end);
+}
+
+setTimeout(common.mustCall(function() {
+  block(30);
+  fs.stat(__filename, common.mustCall(function() {
+    block(10);
+    net.createServer(common.mustCall(function(socket) {
+      socket.end();
+      this.close();
+    })).listen(0, common.mustCall(function() {
+      const socket = net.connect(this.address().port);
+      socket.on('end', common.mustCall(check));
+      socket.resume();
+    }));
+  }));
+}), 1);
+
+function check() {
+  const usage = process.callbackUsage();
+  for (const name in usage) {
+    const stats = usage[name];
+    assert(stats.count > 0);
+    assert(stats.max > 0);
+    assert(stats.max <= stats.time);
+  }
+
+  assert.strictEqual(usage.TIMERWRAP.count, 1);
+  assert(usage.TIMERWRAP.max >= 29e3, `TIMERWRAP: ${usage.TIMERWRAP.max}`);
+  assert(usage.FSREQWRAP.count >= 1);
+  assert(usage.FSREQWRAP.max >= 9e3, `FSREQWRAP: ${usage.FSREQWRAP.max}`);
+  assert(usage.TCPWRAP.count >= 2);
+  assert(usage.TCPCONNECTWRAP.count >= 1);
+
+  // The numbers only go up.
+  setImmediate(common.mustCall(function() {
+    const later = process.callbackUsage();
+    for (const name in usage) {
+      assert(later[name].count >= usage[name].count);
+      assert(later[name].time >= usage[name].time);
+    }
+  }));
+}
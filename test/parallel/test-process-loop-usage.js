@@ -0,0 +1,49 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (common.isWindows) {
+  assert.throws(() => process.loopUsage(), /unable to obtain loop usage/);
+  common.skip('loop metrics are not supported on Windows');
+  return;
+}
+
+const keys = ['iterations', 'idle', 'timers', 'pending', 'prepare', 'poll',
+              'check', 'close'];
+
+// The counters start with the first call.
+const start = process.loopUsage();
+assert.deepStrictEqual(Object.keys(start), keys);
+for (const key of keys)
+  assert.strictEqual(start[key], 0);
+
+assert.throws(() => process.loopUsage(1), TypeError);
+assert.throws(() => process.loopUsage(null), TypeError);
+
+// Block in a timer, then sleep in the poll phase, then block in an immediate.
+setTimeout(common.mustCall(function() {
+  const end = Date.now() + 50;
+  while (Date.now() < end);
+  setTimeout(common.mustCall(function() {
+    setImmediate(common.mustCall(function() {
+      const end = Date.now() + 50;
+      while (Date.now() < end);
+      setImmediate(common.mustCall(check));
+    }));
+  }), 50);
+}), 1);
+
+function check() {
+  const usage = process.loopUsage();
+  assert(usage.iterations >= 3);
+  assert(usage.timers >= 49e3, `timers: ${usage.timers}`);
+  assert(usage.check >= 49e3, `check: ${usage.check}`);
+  assert(usage.idle >= 40e3, `idle: ${usage.idle}`);
+  assert(usage.poll < usage.idle);
+
+  const diff = process.loopUsage(usage);
+  for (const key of keys) {
+    assert(diff[key] >= 0);
+    assert(diff[key] <= usage[key]);
+  }
+}
@@ -0,0 +1,64 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+assert.throws(() => process.monitorLoopDelay(1), TypeError);
+assert.throws(() => process.monitorLoopDelay({ resolution: 0 }), RangeError);
+assert.throws(() => process.monitorLoopDelay({ resolution: 1.5 }),
+              RangeError);
+
+const monitor = process.monitorLoopDelay({ resolution: 5 });
+assert.strictEqual(monitor.count, 0);
+assert.strictEqual(monitor.percentile(50), 0);
+assert.throws(() => monitor.percentile(0), RangeError);
+assert.throws(() => monitor.percentile(101), RangeError);
+assert.throws(() => monitor.percentile('50'), RangeError);
+
+assert.strictEqual(monitor.enable(), true);
+assert.strictEqual(monitor.enable(), false);
+
+// Block the loop a few times for at least 50ms, the monitor records delays
+// of about that long, in nanoseconds.
+let blocks = 0;
+const timer = setInterval(common.mustCall(function() {
+  const end = Date.now() + 50;
+  while (Date.now() < end);
+  if (++blocks < 4)
+    return;
+  clearInterval(timer);
+  setTimeout(common.mustCall(check), 20);
+}, 4), 20);
+
+function check() {
+  assert.strictEqual(monitor.disable(), true);
+  assert.strictEqual(monitor.disable(), false);
+
+  assert(monitor.count >= 4, `count: ${monitor.count}`);
+  assert(monitor.min >= 0);
+  assert(monitor.min <= monitor.mean);
+  assert(monitor.mean <= monitor.max);
+  assert(monitor.max >= 40e6, `max: ${monitor.max}`);
+  assert(monitor.stddev > 0);
+
+  let last = 0;
+  for (const p of [1, 10, 50, 90, 99, 100]) {
+    const value = monitor.percentile(p);
+    assert(value >= last);
+    last = value;
+  }
+  assert.strictEqual(monitor.percentile(100), monitor.max);
+  assert(monitor.percentile(1) >= monitor.min);
+
+  // A disabled monitor keeps its samples until it is reset.
+  const count = monitor.count;
+  setTimeout(common.mustCall(function() {
+    assert.strictEqual(monitor.count, count);
+    monitor.reset();
+    assert.strictEqual(monitor.count, 0);
+    assert.strictEqual(monitor.max, 0);
+    assert.strictEqual(monitor.percentile(99), 0);
+  }), 20);
+}
+
+// An enabled monitor does not keep the process running.
+process.monitorLoopDelay().enable();
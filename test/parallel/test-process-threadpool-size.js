@@ -0,0 +1,46 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+
+function validate(info) {
+  assert.deepStrictEqual(Object.keys(info),
+                         ['min', 'max', 'size', 'active', 'queued']);
+  assert(info.min >= 1);
+  assert(info.max >= info.min);
+  assert(info.size >= 1 && info.size <= info.max);
+  assert(info.active >= 0 && info.active <= info.size);
+  assert(info.queued >= 0);
+}
+
+validate(process.threadpoolInfo());
+
+[0, 129, 1.5, -1, '2', null].forEach((size) => {
+  assert.throws(() => process.setThreadpoolSize(size), RangeError);
+});
+assert.throws(() => process.setThreadpoolSize(2, 1), RangeError);
+assert.throws(() => process.setThreadpoolSize(1, 129), RangeError);
+
+process.setThreadpoolSize(2, 8);
+let info = process.threadpoolInfo();
+validate(info);
+assert.strictEqual(info.min, 2);
+assert.strictEqual(info.max, 8);
+
+// Raising the minimum starts threads right away.
+process.setThreadpoolSize(6, 8);
+info = process.threadpoolInfo();
+assert.strictEqual(info.min, 6);
+assert(info.size >= 6);
+
+// The pool keeps working after it has been shrunk.
+process.setThreadpoolSize(1);
+info = process.threadpoolInfo();
+assert.strictEqual(info.min, 1);
+assert.strictEqual(info.max, 1);
+
+for (let i = 0; i < 10; i++) {
+  fs.access(__filename, common.mustCall((err) => {
+    assert.ifError(err);
+  }));
+}
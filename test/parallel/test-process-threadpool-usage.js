@@ -0,0 +1,40 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+
+const classes = ['fs', 'dns', 'cpu', 'user'];
+
+function validate(usage) {
+  assert.deepStrictEqual(Object.keys(usage), classes);
+  classes.forEach((name) => {
+    const c = usage[name];
+    assert.deepStrictEqual(Object.keys(c), [
+      'limit', 'queued', 'running', 'completed', 'waitTime', 'runTime',
+      'waitHistogram', 'runHistogram'
+    ]);
+    assert(c.limit >= 1);
+    assert(c.queued >= 0);
+    assert(c.running >= 0);
+    assert(c.completed >= 0);
+    assert(c.waitTime >= 0);
+    assert(c.runTime >= 0);
+    assert.strictEqual(c.waitHistogram.length, 24);
+    assert.strictEqual(c.runHistogram.length, 24);
+    const sum = (a, b) => a + b;
+    assert.strictEqual(c.runHistogram.reduce(sum, 0), c.completed);
+  });
+}
+
+const before = process.threadpoolUsage();
+validate(before);
+
+// Completed fs requests are accounted to the fs class. fs.access() is used
+// because it always runs on the thread pool, some other operations may be
+// completed by io_uring on Linux.
+fs.access(__filename, common.mustCall((err) => {
+  assert.ifError(err);
+  const after = process.threadpoolUsage();
+  validate(after);
+  assert(after.fs.completed >= before.fs.completed + 1);
+}));
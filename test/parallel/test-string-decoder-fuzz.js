@@ -0,0 +1,49 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+const StringDecoder = require('string_decoder').StringDecoder;
+
+// Decodes random bytes in random chunks and compares the result with what
+// Buffer#toString() returns for the whole input, malformed input included.
+
+// Lead, continuation and surrogate bytes are picked more often than others,
+// so that characters are often split between chunks.
+const interesting = [0x00, 0x41, 0x7f, 0x80, 0x8f, 0x9f, 0xbf, 0xc0, 0xc2, 0xdf,
+                     0xe0, 0xe1, 0xed, 0xef, 0xf0, 0xf4, 0xf5, 0xf8, 0xff, 0xd8,
+                     0xdb, 0xdc, 0xdf];
+
+// xorshift32, so that failures can be reproduced from the seed.
+let seed = (Date.now() % 0x7fffffff) || 1;
+const initialSeed = seed;
+function rand(n) {
+  seed ^= seed << 13;
+  seed ^= seed >>> 17;
+  seed ^= seed << 5;
+  return (seed >>> 0) % n;
+}
+
+function randomBytes(length) {
+  const buf = Buffer.allocUnsafe(length);
+  for (let i = 0; i < length; i++)
+    buf[i] = rand(2) ? interesting[rand(interesting.length)] : rand(256);
+  return buf;
+}
+
+for (const encoding of ['utf8', 'utf16le', 'base64']) {
+  for (let i = 0; i < 2000; i++) {
+    const input = randomBytes(rand(24));
+    const decoder = new StringDecoder(encoding);
+    const chunks = [];
+    let actual = '';
+    for (let start = 0; start < input.length;) {
+      const end = start + 1 + rand(5);
+      chunks.push(input.slice(start, end));
+      actual += decoder.write(chunks[chunks.length - 1]);
+      start = end;
+    }
+    actual += decoder.end();
+    assert.strictEqual(actual, input.toString(encoding),
+                       `${encoding}, seed ${initialSeed}, ` +
+                       `chunks ${JSON.stringify(chunks.map((c) => [...c]))}`);
+  }
+}
@@ -104,6 +104,19 @@ assert.strictEqual(decoder.write(Buffer.from('3DD8', 'hex')), '');
 assert.strictEqual(decoder.write(Buffer.from('4D', 'hex')), '');
 assert.strictEqual(decoder.end(), '\ud83d');
 
+// The state of a split character is kept in own properties, and assigning to
+// them changes it
+decoder = new StringDecoder('utf8');
+assert.strictEqual(decoder.write(Buffer.from('E18B', 'hex')), '');
+assert.strictEqual(decoder.lastNeed, 1);
+assert.strictEqual(decoder.lastTotal, 3);
+assert.deepStrictEqual(decoder.lastChar.slice(0, 2),
+                       Buffer.from('E18B', 'hex'));
+assert.deepStrictEqual(Object.keys(decoder).filter((k) => /^last/.test(k)),
+                       ['lastNeed', 'lastTotal', 'lastChar']);
+decoder.lastNeed = 0;
+assert.strictEqual(decoder.end(), '');
+
 // test verifies that StringDecoder will correctly decode the given input
 // buffer with the given encoding to the expected output. It will attempt all
 // possible ways to write() the input buffer, see writeSequences(). The
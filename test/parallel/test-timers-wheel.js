@@ -0,0 +1,105 @@
+'use strict';
+
+/*
+ * Timers that are started with timers._unrefActive() live in a timing wheel
+ * in C++. Check that they expire no earlier than they are due, in the order
+ * they are due, and that re-arming or cancelling timers of the same batch
+ * from a callback is honoured.
+ *
+ * This tests private implementation details that should not be considered
+ * public interface.
+ */
+const common = require('../common');
+const timers = require('timers');
+const assert = require('assert');
+const domain = require('domain');
+
+function makeTimer(msecs, onTimeout) {
+  const timer = { _onTimeout: onTimeout };
+  timers.enroll(timer, msecs);
+  return timer;
+}
+
+// Durations on both sides of where the first level of the wheel ends.
+{
+  const durations = [1, 2, 5, 17, 100, 255, 256, 257, 300, 511, 600];
+  const fired = [];
+  for (const msecs of durations) {
+    const start = Date.now();
+    const timer = makeTimer(msecs, common.mustCall(function() {
+      assert.ok(Date.now() - start >= msecs - 1);
+      assert.strictEqual(this, timer);
+      assert.strictEqual(timer._idleNext, null);
+      assert.strictEqual(timer._idlePrev, null);
+      fired.push(msecs);
+    }));
+    timers._unrefActive(timer);
+    // Re-arming a timer replaces its previous deadline.
+    timers._unrefActive(timer);
+  }
+  setTimeout(common.mustCall(function() {
+    assert.deepStrictEqual(fired, durations);
+  }), 1000);
+}
+
+// Timers of one batch that are cancelled or re-armed by an earlier callback
+// do not run with that batch.
+{
+  let rearmed = 0;
+  const cancelled = makeTimer(5, common.fail);
+  const reenrolled = makeTimer(5, common.fail);
+  const again = makeTimer(5, common.mustCall(function() {
+    rearmed++;
+    if (rearmed === 1)
+      timers._unrefActive(again);
+  }, 2));
+  const first = makeTimer(5, common.mustCall(function() {
+    timers.unenroll(cancelled);
+    timers.enroll(reenrolled, 5);
+    timers._unrefActive(again);
+  }));
+  timers._unrefActive(first);
+  timers._unrefActive(cancelled);
+  timers._unrefActive(reenrolled);
+  timers._unrefActive(again);
+}
+
+// Moving a timer between active() and _unrefActive() only keeps the latter.
+{
+  const timer = makeTimer(10, common.mustCall(function() {}));
+  timers.active(timer);
+  timers._unrefActive(timer);
+  const other = makeTimer(10, common.mustCall(function() {}));
+  timers._unrefActive(other);
+  timers.active(other);
+}
+
+// When a callback throws, the rest of its batch still runs, in order and in
+// their own domains, once the error has been handled.
+{
+  const order = [];
+  const d = domain.create();
+  d.on('error', common.mustCall(function(err) {
+    assert.strictEqual(err.message, 'boom');
+    order.push('error');
+  }));
+  const batch = [];
+  for (let i = 0; i < 5; i++) {
+    const timer = makeTimer(20, common.mustCall(function() {
+      assert.strictEqual(process.domain, timer.domain);
+      order.push(i);
+      if (i === 1)
+        throw new Error('boom');
+    }));
+    timer.domain = i === 1 ? d : domain.create();
+    batch.push(timer);
+  }
+  for (const timer of batch)
+    timers._unrefActive(timer);
+  setTimeout(common.mustCall(function() {
+    assert.deepStrictEqual(order, [0, 1, 'error', 2, 3, 4]);
+  }), 500);
+}
+
+// The wheel does not keep the process open.
+timers._unrefActive(makeTimer(1e6, common.fail));
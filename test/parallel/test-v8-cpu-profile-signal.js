@@ -0,0 +1,52 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const { spawn, spawnSync } = require('child_process');
+
+if (common.isWindows) {
+  common.skip('SIGUSR2 is not available on Windows');
+  return;
+}
+
+// With --cpu-prof-signal the profiler is started by the signal and the
+// profile written to the working directory by the next one.
+common.refreshTmpDir();
+
+const script = `
+  process.kill(process.pid, 'SIGUSR2');
+  setTimeout(() => {
+    const end = Date.now() + 50;
+    while (Date.now() < end);
+    process.kill(process.pid, 'SIGUSR2');
+    // Signal handlers do not keep the process running.
+    setTimeout(() => {}, 100);
+  }, 10);
+`;
+const child = spawn(process.execPath,
+                    ['--cpu-prof-signal=SIGUSR2', '-e', script],
+                    { cwd: common.tmpDir });
+
+let stderr = '';
+child.stderr.setEncoding('utf8');
+child.stderr.on('data', (data) => stderr += data);
+
+child.on('close', common.mustCall(function(code, signal) {
+  assert.strictEqual(code, 0, stderr);
+  assert.strictEqual(signal, null);
+
+  const files = fs.readdirSync(common.tmpDir);
+  assert.strictEqual(files.length, 1);
+  assert(/^node-cpu-\d+-\d+\.pb\.gz$/.test(files[0]), files[0]);
+  assert(stderr.includes(`CPU profile written to ${common.tmpDir}/${files[0]}`),
+         stderr);
+}));
+
+// Signals that node already uses are not taken over.
+for (const args of [['--cpu-prof-signal=SIGUSR1'],
+                    ['--callback-stats', '--cpu-prof-signal=SIGUSR2']]) {
+  const result = spawnSync(process.execPath, args.concat(['-e', '']));
+  assert.strictEqual(result.status, 0);
+  const stderr = result.stderr.toString();
+  assert(/--cpu-prof-signal: SIGUSR[12] is used by/.test(stderr), stderr);
+}
@@ -0,0 +1,76 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const v8 = require('v8');
+const zlib = require('zlib');
+
+assert.throws(() => v8.stopCpuProfile(), /^Error: CPU profile is not running$/);
+assert.throws(() => v8.startCpuProfile(1), TypeError);
+assert.throws(() => v8.startCpuProfile({ interval: 0 }), RangeError);
+assert.throws(() => v8.startCpuProfile({ interval: 1.5 }), RangeError);
+
+function spinForCpuProfile(ms) {
+  const end = Date.now() + ms;
+  let x = 0;
+  while (Date.now() < end)
+    x += Math.sqrt(x + 1);
+  return x;
+}
+
+// Collapsed stacks, one line per stack with its number of samples.
+{
+  v8.startCpuProfile({ interval: 500 });
+  assert.throws(() => v8.startCpuProfile(),
+                /^Error: CPU profile is already running$/);
+  spinForCpuProfile(200);
+  assert.throws(() => v8.stopCpuProfile({ format: 'json' }), TypeError);
+  const collapsed = v8.stopCpuProfile({ format: 'collapsed' });
+  assert.strictEqual(typeof collapsed, 'string');
+
+  const lines = collapsed.trim().split('\n');
+  let samples = 0;
+  for (const line of lines) {
+    const match = /^(.+) (\d+)$/.exec(line);
+    assert(match, line);
+    samples += +match[2];
+  }
+  // The sampler thread can be starved on a loaded machine.
+  assert(samples > 0);
+  const frame = /spinForCpuProfile \(.*test-v8-cpu-profile\.js:14\)(;| )/;
+  assert(lines.some((line) => frame.test(line)), collapsed);
+}
+
+// A gzipped pprof profile, also written to a file.
+{
+  common.refreshTmpDir();
+  const file = path.join(common.tmpDir, 'cpu.pb.gz');
+  v8.startCpuProfile();
+  spinForCpuProfile(100);
+  const profile = v8.stopCpuProfile({ file: file });
+  assert(Buffer.isBuffer(profile));
+  assert.deepStrictEqual(fs.readFileSync(file), profile);
+
+  // The string table holds the names of the sample types and functions.
+  const proto = zlib.gunzipSync(profile).toString('latin1');
+  for (const s of ['samples', 'count', 'cpu', 'nanoseconds',
+                   'spinForCpuProfile', __filename]) {
+    assert(proto.includes(s), s);
+  }
+}
+
+// A profile that V8 does not return is an error, after which the profiler
+// can be started again.
+{
+  const binding = process.binding('v8');
+  const stopCpuProfile = binding.stopCpuProfile;
+  v8.startCpuProfile();
+  binding.stopCpuProfile = () => { stopCpuProfile(); };
+  assert.throws(() => v8.stopCpuProfile(),
+                /^Error: CPU profile could not be collected$/);
+  binding.stopCpuProfile = stopCpuProfile;
+  v8.startCpuProfile();
+  const collapsed = v8.stopCpuProfile({ format: 'collapsed' });
+  assert.strictEqual(typeof collapsed, 'string');
+}
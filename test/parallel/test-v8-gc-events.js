@@ -0,0 +1,64 @@
+// Flags: --expose-gc
+'use strict';
+require('../common');
+const assert = require('assert');
+const v8 = require('v8');
+
+const notStarted = /^Error: GC tracking has not been started$/;
+assert.throws(() => v8.takeGCEvents(), notStarted);
+assert.throws(() => v8.stopGCTracking(),
+              /^Error: GC tracking is not running$/);
+
+v8.startGCTracking();
+assert.throws(() => v8.startGCTracking(),
+              /^Error: GC tracking is already running$/);
+assert.deepStrictEqual(v8.takeGCEvents(), []);
+
+const before = process.hrtime();
+let garbage = [];
+for (let i = 0; i < 1e5; i++)
+  garbage.push({ i });
+garbage = null;
+global.gc();
+const after = process.hrtime();
+
+const events = v8.takeGCEvents();
+assert(events.length > 0);
+const spaces = v8.getHeapSpaceStatistics().map((space) => space.space_name);
+events.forEach((event, i) => {
+  assert.strictEqual(event.index, i);
+  assert(['scavenge', 'mark-sweep-compact', 'incremental-marking',
+          'weak-callbacks'].includes(event.type), event.type);
+  assert(event.duration >= 0);
+  assert(event.startTime >= before[0] * 1e3 + before[1] / 1e6);
+  assert(event.startTime + event.duration <= after[0] * 1e3 + after[1] / 1e6);
+  assert(event.usedHeapSizeBefore > 0);
+  assert(event.usedHeapSizeAfter > 0);
+  assert(event.totalHeapSize >= event.usedHeapSizeAfter);
+  assert.deepStrictEqual(Object.keys(event.spaces), spaces);
+});
+
+// The forced collection comes last and freed the array.
+const last = events[events.length - 1];
+assert.strictEqual(last.type, 'mark-sweep-compact');
+assert.strictEqual(last.forced, true);
+assert(last.usedHeapSizeAfter < last.usedHeapSizeBefore);
+
+// Events are only returned once, and those recorded before tracking stopped
+// can still be taken.
+assert.deepStrictEqual(v8.takeGCEvents(), []);
+global.gc();
+v8.stopGCTracking();
+global.gc();
+const taken = v8.takeGCEvents();
+assert.strictEqual(taken.length, 1);
+assert.strictEqual(taken[0].index, events.length);
+assert.deepStrictEqual(v8.takeGCEvents(), []);
+
+// Collections while tracking was stopped are not recorded.
+v8.startGCTracking();
+global.gc();
+const restarted = v8.takeGCEvents();
+assert.strictEqual(restarted.length, 1);
+assert.strictEqual(restarted[0].index, events.length + 1);
+v8.stopGCTracking();
@@ -0,0 +1,96 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const v8 = require('v8');
+const zlib = require('zlib');
+
+const notRunning = /^Error: Heap profile is not running$/;
+assert.throws(() => v8.getHeapProfile(), notRunning);
+assert.throws(() => v8.stopHeapProfile(), notRunning);
+assert.throws(() => v8.startHeapProfile(1), TypeError);
+assert.throws(() => v8.startHeapProfile({ interval: 0 }), RangeError);
+assert.throws(() => v8.startHeapProfile({ stackDepth: 1.5 }), RangeError);
+
+const retained = [];
+function allocateForHeapProfile(n) {
+  for (let i = 0; i < n; i++)
+    retained.push(new Array(64).fill(i));
+}
+
+function find(node, name) {
+  if (node.name === name)
+    return node;
+  for (const child of node.children) {
+    const found = find(child, name);
+    if (found)
+      return found;
+  }
+}
+
+v8.startHeapProfile({ interval: 1024 });
+assert.throws(() => v8.startHeapProfile(),
+              /^Error: Heap profile is already running$/);
+allocateForHeapProfile(2000);
+
+// A tree of the allocations that are still alive, by the function that made
+// them.
+{
+  assert.throws(() => v8.getHeapProfile({ format: 'json' }), TypeError);
+  const root = v8.getHeapProfile();
+  const node = find(root, 'allocateForHeapProfile');
+  assert(node, JSON.stringify(root));
+  assert.strictEqual(node.url, __filename);
+  assert.strictEqual(node.line, 17);
+  assert(node.selfSize > 64 * 8 * 1000, `${node.selfSize} bytes`);
+  assert(node.selfCount > 0);
+  assert(node.totalSize >= node.selfSize);
+  assert(root.totalSize >= node.totalSize);
+  assert(root.totalCount >= node.totalCount);
+}
+
+// A gzipped pprof profile, also written to a file.
+{
+  common.refreshTmpDir();
+  const file = path.join(common.tmpDir, 'heap.pb.gz');
+  const profile = v8.getHeapProfile({ format: 'pprof', file: file });
+  assert(Buffer.isBuffer(profile));
+  assert.deepStrictEqual(fs.readFileSync(file), profile);
+
+  const proto = zlib.gunzipSync(profile).toString('latin1');
+  for (const s of ['objects', 'count', 'space', 'bytes',
+                   'allocateForHeapProfile', __filename]) {
+    assert(proto.includes(s), s);
+  }
+}
+
+v8.stopHeapProfile();
+assert.throws(() => v8.getHeapProfile(), notRunning);
+
+// Heap snapshots are written to a path or a file descriptor.
+{
+  assert.throws(() => v8.writeHeapSnapshot(-1), TypeError);
+  assert.throws(() => v8.writeHeapSnapshot({}), TypeError);
+
+  const file = path.join(common.tmpDir, 'path.heapsnapshot');
+  const written = v8.writeHeapSnapshot(file);
+  assert.strictEqual(fs.statSync(file).size, written);
+  const snapshot = JSON.parse(fs.readFileSync(file, 'utf8'));
+  assert(snapshot.snapshot.meta.node_fields.includes('name'));
+  assert(snapshot.nodes.length > 0);
+  assert(snapshot.strings.includes('allocateForHeapProfile'));
+
+  const fdFile = path.join(common.tmpDir, 'fd.heapsnapshot');
+  const fd = fs.openSync(fdFile, 'w');
+  fs.writeSync(fd, 'x');
+  const bytes = v8.writeHeapSnapshot(fd);
+  fs.closeSync(fd);
+  const contents = fs.readFileSync(fdFile, 'utf8');
+  assert.strictEqual(contents.length, bytes + 1);
+  JSON.parse(contents.slice(1));
+
+  const rd = fs.openSync(file, 'r');
+  assert.throws(() => v8.writeHeapSnapshot(rd), /EBADF/);
+  fs.closeSync(rd);
+}
@@ -0,0 +1,33 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const spawn = require('child_process').spawn;
+
+if (common.isWindows) {
+  common.skip('pipes to child processes are blocking on Windows');
+  return;
+}
+
+// process.stdout makes a pipe on fd 1 non-blocking. A heap snapshot written
+// to it has to wait for the reader instead of failing with EAGAIN.
+const script = `
+  process.stdout;
+  process._rawDebug(require('v8').writeHeapSnapshot(1));
+`;
+const child = spawn(process.execPath, ['-e', script]);
+
+const chunks = [];
+let stderr = '';
+// Let the pipe fill up before reading from it.
+child.stdout.pause();
+setTimeout(() => child.stdout.resume(), 200);
+child.stdout.on('data', (chunk) => chunks.push(chunk));
+child.stderr.setEncoding('utf8');
+child.stderr.on('data', (data) => stderr += data);
+
+child.on('close', common.mustCall((code) => {
+  assert.strictEqual(code, 0, stderr);
+  const output = Buffer.concat(chunks);
+  assert.strictEqual(output.length, +stderr);
+  assert(JSON.parse(output).nodes.length > 0);
+}));
@@ -0,0 +1,33 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const worker = require('worker_threads');
+
+// Long patterns are searched with Boyer-Moore, whose tables must not be
+// shared between threads that search at the same time.
+function search(id) {
+  let pattern = '';
+  for (let i = 0; i < 100; i++)
+    pattern += String.fromCharCode(97 + (i * (id + 3) + id) % 26);
+  // Near misses make the search switch from a linear scan to Boyer-Moore.
+  const prefix = (pattern.slice(0, -1) + '!').repeat(200);
+  for (const encoding of ['latin1', 'ucs2']) {
+    const haystack = Buffer.from(prefix + pattern, encoding);
+    const needle = Buffer.from(pattern, encoding);
+    const expected = haystack.length - needle.length;
+    for (let i = 0; i < 500; i++)
+      assert.strictEqual(haystack.indexOf(needle), expected);
+  }
+}
+
+if (worker.isMainThread) {
+  for (let id = 1; id <= 4; id++) {
+    const w = new worker.Worker(__filename, { workerData: id });
+    w.on('exit', common.mustCall((code) => {
+      assert.strictEqual(code, 0);
+    }));
+  }
+  search(0);
+} else {
+  search(worker.workerData);
+}
@@ -0,0 +1,50 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const worker = require('worker_threads');
+
+// A worker gets a copy of its parent's process.env. Changes on either side
+// are not seen by the other one.
+if (worker.isMainThread) {
+  process.env.WORKER_ENV_SHARED = 'parent';
+  process.env.WORKER_ENV_DELETED = 'parent';
+  const w = new worker.Worker(__filename);
+  process.env.WORKER_ENV_LATE = 'parent';
+  w.on('message', common.mustCall((message) => {
+    assert.deepStrictEqual(message, {
+      shared: 'parent',
+      late: undefined,
+      number: '42',
+      deleted: false,
+      keys: true,
+      child: 'worker'
+    });
+  }));
+  w.on('exit', common.mustCall((code) => {
+    assert.strictEqual(code, 0);
+    assert.strictEqual(process.env.WORKER_ENV_DELETED, 'parent');
+    assert.strictEqual(process.env.WORKER_ENV_SET, undefined);
+    assert.strictEqual(process.env.WORKER_ENV_NUMBER, undefined);
+  }));
+  // Changing the environment while the worker reads its copy is safe.
+  for (let i = 0; i < 1000; i++)
+    process.env[`WORKER_ENV_${i}`] = `${i}`;
+  for (let i = 0; i < 1000; i++)
+    delete process.env[`WORKER_ENV_${i}`];
+} else {
+  const execFileSync = require('child_process').execFileSync;
+  process.env.WORKER_ENV_NUMBER = 42;
+  process.env.WORKER_ENV_SET = 'worker';
+  delete process.env.WORKER_ENV_DELETED;
+  const child = execFileSync(process.execPath,
+                             ['-p', 'process.env.WORKER_ENV_SET'],
+                             { encoding: 'utf8' });
+  worker.parentPort.postMessage({
+    shared: process.env.WORKER_ENV_SHARED,
+    late: process.env.WORKER_ENV_LATE,
+    number: process.env.WORKER_ENV_NUMBER,
+    deleted: 'WORKER_ENV_DELETED' in process.env,
+    keys: Object.keys(process.env).includes('WORKER_ENV_SET'),
+    child: child.trim()
+  });
+}
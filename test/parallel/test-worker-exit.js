@@ -0,0 +1,80 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const spawnSync = require('child_process').spawnSync;
+const Worker = require('worker_threads').Worker;
+
+// process.exit() only stops the worker thread.
+new Worker('process.exit(3)', { eval: true })
+  .on('exit', common.mustCall((code) => {
+    assert.strictEqual(code, 3);
+  }));
+
+// Uncaught exceptions are reported to the parent.
+new Worker(`
+  const err = new TypeError('boom');
+  err.code = 'ERR_BOOM';
+  throw err;
+`, { eval: true })
+  .on('error', common.mustCall((err) => {
+    assert(err instanceof TypeError);
+    assert.strictEqual(err.message, 'boom');
+    assert.strictEqual(err.code, 'ERR_BOOM');
+    assert(/\[worker eval\]/.test(err.stack));
+  }))
+  .on('exit', common.mustCall((code) => {
+    assert.strictEqual(code, 1);
+  }));
+
+// uncaughtException handlers run in the worker.
+new Worker(`
+  process.on('uncaughtException', () => process.exit(5));
+  throw new Error('handled');
+`, { eval: true })
+  .on('error', common.fail)
+  .on('exit', common.mustCall((code) => {
+    assert.strictEqual(code, 5);
+  }));
+
+// terminate() interrupts running JS.
+const looping = new Worker(`
+  require('worker_threads').parentPort.postMessage('started');
+  for (;;);
+`, { eval: true });
+looping.on('message', common.mustCall(() => {
+  looping.terminate(common.mustCall((err, code) => {
+    assert.ifError(err);
+    assert.strictEqual(code, 1);
+  }));
+}));
+
+// Output of the worker is forwarded to the stdio of the main thread, before
+// the 'exit' event is emitted.
+const child = spawnSync(process.execPath, ['-e', `
+  const Worker = require('worker_threads').Worker;
+  new Worker('console.log("out"); console.error("err");', { eval: true })
+    .on('exit', () => console.log('exit'));
+`]);
+assert.strictEqual(child.status, 0);
+assert.strictEqual(child.stdout.toString(), 'out\nexit\n');
+assert.strictEqual(child.stderr.toString(), 'err\n');
+
+// The main thread stops its workers before it exits, whether with
+// process.exit() or because of an uncaught exception.
+for (const [exit, status] of [['process.exit(2)', 2],
+                              ['throw new Error("main")', 1]]) {
+  const child = spawnSync(process.execPath, ['-e', `
+    const Worker = require('worker_threads').Worker;
+    let started = 0;
+    for (let i = 0; i < 4; i++) {
+      new Worker(\`
+        require('worker_threads').parentPort.postMessage('started');
+        for (;;) new Array(1000).fill({});
+      \`, { eval: true }).on('message', () => {
+        if (++started === 4) ${exit};
+      });
+    }
+  `]);
+  assert.strictEqual(child.signal, null);
+  assert.strictEqual(child.status, status, child.stderr.toString());
+}
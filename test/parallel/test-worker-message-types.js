@@ -0,0 +1,112 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const Worker = require('worker_threads').Worker;
+const serdes = process.binding('serdes');
+
+function roundTrip(value) {
+  return serdes.deserialize(serdes.serialize(value));
+}
+
+[
+  undefined, null, true, false, 0, -1, 2147483647, -2147483648, 2 ** 40,
+  1.5, -Infinity, '', 'latin1 ÿ', 'two-byte ☃ 😀',
+  [1, 'two', [3]], { a: 1, b: { c: [] } }
+].forEach((value) => {
+  assert.deepStrictEqual(roundTrip(value), value);
+});
+
+assert(Object.is(roundTrip(-0), -0));
+assert(Number.isNaN(roundTrip(NaN)));
+
+// Sparse arrays and array-like keys.
+assert.deepStrictEqual(roundTrip({ 1: 'one', b: 2 }), { 1: 'one', b: 2 });
+
+const date = roundTrip(new Date(12345));
+assert(date instanceof Date);
+assert.strictEqual(date.getTime(), 12345);
+
+const regexp = roundTrip(/ab+c/gi);
+assert(regexp instanceof RegExp);
+assert.strictEqual(regexp.source, 'ab+c');
+assert.strictEqual(regexp.flags, 'gi');
+
+const map = roundTrip(new Map([[1, 'one'], [{}, [2]]]));
+assert(map instanceof Map);
+assert.deepStrictEqual(Array.from(map), [[1, 'one'], [{}, [2]]]);
+
+const set = roundTrip(new Set(['a', 1]));
+assert(set instanceof Set);
+assert.deepStrictEqual(Array.from(set), ['a', 1]);
+
+const buffer = roundTrip(Buffer.from('hello'));
+assert(Buffer.isBuffer(buffer));
+assert.strictEqual(buffer.toString(), 'hello');
+
+// Only the part of the ArrayBuffer that the view covers is copied.
+const bytes = new Uint8Array([1, 2, 3, 4, 5, 6, 7, 8]);
+const floats = roundTrip(new Float32Array(bytes.buffer, 4, 1));
+assert(floats instanceof Float32Array);
+assert.strictEqual(floats.buffer.byteLength, 4);
+assert.deepStrictEqual(new Uint8Array(floats.buffer), bytes.subarray(4));
+
+const arrayBuffer = roundTrip(bytes.buffer);
+assert(arrayBuffer instanceof ArrayBuffer);
+assert.deepStrictEqual(new Uint8Array(arrayBuffer), bytes);
+
+const view = roundTrip(new DataView(bytes.buffer, 1, 2));
+assert(view instanceof DataView);
+assert.strictEqual(view.getUint16(0), 0x0203);
+
+// Identity and cycles are preserved.
+const shared = { x: 1 };
+const cyclic = { a: shared, b: shared };
+cyclic.self = cyclic;
+const copy = roundTrip(cyclic);
+assert.strictEqual(copy.a, copy.b);
+assert.strictEqual(copy.self, copy);
+assert.notStrictEqual(copy.a, shared);
+
+// Values that have no meaningful copy.
+assert.throws(() => serdes.serialize(() => {}),
+              /^TypeError: #<Function> could not be cloned\.$/);
+assert.throws(() => serdes.serialize({ s: Symbol('s') }),
+              /^TypeError: symbol could not be cloned\.$/);
+assert.throws(() => serdes.serialize(Promise.resolve()), TypeError);
+assert.throws(() => serdes.serialize(new WeakMap()), TypeError);
+assert.throws(() => serdes.serialize(process.stdout), TypeError);
+
+let deep = [];
+for (let i = 0; i < 2000; i++)
+  deep = [deep];
+assert.throws(() => serdes.serialize(deep), RangeError);
+
+// Malformed input.
+assert.throws(() => serdes.deserialize(Buffer.from([1, 0x6f, 5])),
+              /^Error: Unable to deserialize cloned data\.$/);
+assert.throws(() => serdes.deserialize(Buffer.from([1, 0x54, 0x54])),
+              /Unable to deserialize/);
+assert.throws(() => serdes.deserialize(Buffer.from([0])),
+              /Unable to deserialize/);
+
+// The same types through a worker, both ways.
+const value = {
+  buffer: Buffer.from('worker'),
+  map: new Map([['k', new Set([1])]]),
+  date: new Date(1)
+};
+const w = new Worker(`
+  const parentPort = require('worker_threads').parentPort;
+  parentPort.once('message', (value) => {
+    parentPort.postMessage([Buffer.isBuffer(value.buffer), value]);
+  });
+`, { eval: true });
+w.postMessage(value);
+w.on('message', common.mustCall((message) => {
+  assert.strictEqual(message[0], true);
+  assert.deepStrictEqual(message[1], value);
+}));
+
+assert.throws(() => w.postMessage(() => {}), TypeError);
+assert.throws(() => new Worker('', { eval: true, workerData: Symbol() }),
+              TypeError);
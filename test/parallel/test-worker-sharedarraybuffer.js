@@ -0,0 +1,40 @@
+// Flags: --harmony-sharedarraybuffer
+/*global SharedArrayBuffer*/
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const Worker = require('worker_threads').Worker;
+
+const counter = new Int32Array(new SharedArrayBuffer(8), 4, 1);
+const workers = 4;
+const iterations = 1000;
+
+let exited = 0;
+for (let i = 0; i < workers; i++) {
+  new Worker(`
+    const counter = require('worker_threads').workerData.counter;
+    for (let i = 0; i < ${iterations}; i++)
+      Atomics.add(counter, 0, 1);
+  `, { eval: true, workerData: { counter: counter } })
+    .on('exit', common.mustCall((code) => {
+      assert.strictEqual(code, 0);
+      if (++exited === workers)
+        assert.strictEqual(counter[0], workers * iterations);
+    }));
+}
+
+// The memory is shared in both directions, and outlives the worker.
+const w = new Worker(`
+  const parentPort = require('worker_threads').parentPort;
+  const sab = new SharedArrayBuffer(4);
+  parentPort.postMessage({ sab: sab, view: new Uint8Array(sab, 1, 2) });
+  new Uint8Array(sab)[2] = 42;
+`, { eval: true });
+w.on('message', common.mustCall((message) => {
+  assert(message.sab instanceof SharedArrayBuffer);
+  assert.strictEqual(message.view.buffer, message.sab);
+  assert.strictEqual(message.view.byteOffset, 1);
+  w.on('exit', common.mustCall(() => {
+    assert.strictEqual(message.view[1], 42);
+  }));
+}));
@@ -0,0 +1,28 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const worker = require('worker_threads');
+
+// Unbounded recursion in a worker throws a RangeError instead of running off
+// the end of the thread's stack.
+if (worker.isMainThread) {
+  const w = new worker.Worker(__filename);
+  w.on('message', common.mustCall((message) => {
+    assert.strictEqual(message.name, 'RangeError');
+    assert(message.depth > 1000, `${message.depth}`);
+  }));
+  w.on('exit', common.mustCall((code) => {
+    assert.strictEqual(code, 0);
+  }));
+} else {
+  let depth = 0;
+  function recurse(a, b, c) {
+    depth++;
+    return recurse(a + 1, b + 1, c + 1) + 1;
+  }
+  try {
+    recurse(0, 0, 0);
+  } catch (err) {
+    worker.parentPort.postMessage({ name: err.name, depth });
+  }
+}
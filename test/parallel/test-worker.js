@@ -0,0 +1,44 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const worker = require('worker_threads');
+const Worker = worker.Worker;
+
+if (worker.isMainThread) {
+  assert.strictEqual(worker.threadId, 0);
+  assert.strictEqual(worker.parentPort, null);
+  assert.strictEqual(worker.workerData, null);
+
+  const w = new Worker(__filename, { workerData: { hello: 'world' } });
+  assert(w.threadId > 0);
+  w.on('online', common.mustCall(() => {
+    w.postMessage({ ping: 1 });
+  }));
+  w.on('message', common.mustCall((message) => {
+    assert.deepStrictEqual(message, {
+      pong: 1,
+      threadId: w.threadId,
+      workerData: { hello: 'world' }
+    });
+  }));
+  w.on('exit', common.mustCall((code) => {
+    assert.strictEqual(code, 0);
+  }));
+
+  assert.throws(() => new Worker('worker.js'), /relative path starting/);
+  assert.throws(() => new Worker(42), /"filename" argument must be a string/);
+} else {
+  assert.strictEqual(worker.isMainThread, false);
+  assert.throws(() => process.chdir('/'),
+                /process\.chdir\(\) is not supported in workers/);
+
+  // Keeps the thread alive until the message arrives.
+  worker.parentPort.once('message', (message) => {
+    assert.deepStrictEqual(message, { ping: 1 });
+    worker.parentPort.postMessage({
+      pong: 1,
+      threadId: worker.threadId,
+      workerData: worker.workerData
+    });
+  });
+}
@@ -0,0 +1,91 @@
+'use strict';
+
+// Generates a C++ source file with the V8 code cache for every core module,
+// to be embedded in the node binary with the --code-cache-path configure
+// option:
+//
+//   $ ./configure && make
+//   $ out/Release/node tools/generate_code_cache.js node_code_cache.cc
+//   $ ./configure --code-cache-path=node_code_cache.cc && make
+//
+// Run it with the node binary built from the same sources and without any V8
+// flags; V8 rejects a code cache produced with different flags. Entries for
+// modules whose source has changed since are ignored at runtime.
+
+const fs = require('fs');
+const vm = require('vm');
+const Module = require('module');
+
+const natives = process.binding('natives');
+
+// Not compiled as a NativeModule.
+const skip = ['config', 'internal/bootstrap_node'];
+
+if (process.argv.length !== 3) {
+  console.error('Usage: node tools/generate_code_cache.js <output file>');
+  process.exit(1);
+}
+
+// Must match CodeCacheSourceHash() in src/node_code_cache.h.
+function sourceHash(data) {
+  var hash = 2166136261;
+  for (var i = 0; i < data.length; i++) {
+    hash ^= data[i];
+    hash = Math.imul(hash, 16777619) >>> 0;
+  }
+  return hash;
+}
+
+function toCArray(data) {
+  const lines = [];
+  for (var i = 0; i < data.length; i += 16) {
+    lines.push('  ' + Array.prototype.join.call(data.slice(i, i + 16), ',') +
+               ',');
+  }
+  return lines.join('\n');
+}
+
+const definitions = [];
+const entries = [];
+
+Object.keys(natives).sort().forEach((id) => {
+  if (skip.indexOf(id) !== -1)
+    return;
+
+  // The natives are one-byte strings made from the raw bytes of the source
+  // files, latin1 gets those bytes back.
+  const source = Buffer.from(natives[id], 'latin1');
+  const script = new vm.Script(Module.wrap(natives[id]), {
+    filename: `${id}.js`,
+    produceCachedData: true
+  });
+  if (!script.cachedDataProduced) {
+    console.error(`Cannot produce code cache for ${id}`);
+    process.exit(1);
+  }
+
+  const name = `${id.replace(/[-/]/g, '_')}_code_cache`;
+  definitions.push(`static const uint8_t ${name}[] = {\n` +
+                   `${toCArray(script.cachedData)}\n};\n`);
+  entries.push(`  { "${id}", ${name}, sizeof(${name}), ` +
+               `${source.length}, ${sourceHash(source)}u },`);
+});
+
+const output = `// Generated by tools/generate_code_cache.js, do not edit.
+// V8 ${process.versions.v8}
+
+#include "node_code_cache.h"
+
+namespace node {
+
+${definitions.join('\n')}
+const CodeCacheEntry code_cache_entries[] = {
+${entries.join('\n')}
+};
+const size_t code_cache_entry_count =
+    sizeof(code_cache_entries) / sizeof(code_cache_entries[0]);
+
+}  // namespace node
+`;
+
+fs.writeFileSync(process.argv[2], output);